@@ -0,0 +1,150 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef BENCHMARK_BENCHMARK_REPORT_H_
+#define BENCHMARK_BENCHMARK_REPORT_H_
+
+// The benchmark report and baseline comparison, kept apart from the scenes
+// so the unit tests can check them without running the benchmark.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "engine/arctic_types.h"
+
+struct SceneResult {
+  std::string name;
+  arctic::Si32 frames = 0;
+  double mean_ms = 0.0;
+  double p50_ms = 0.0;
+  double p99_ms = 0.0;
+  double mpixels_per_s = 0.0;
+  // Redundant GL state filtering, see GlState.
+  double gl_state_issued_per_frame = 0.0;
+  double gl_state_saved_per_frame = 0.0;
+};
+
+// Nearest-rank percentile of sorted values, fraction is in [0, 1].
+inline double Percentile(const std::vector<double> &sorted, double fraction) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+  rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+  return sorted[rank - 1];
+}
+
+inline size_t SkipJsonSpaces(const std::string &json, size_t pos) {
+  while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\t' ||
+      json[pos] == '\n' || json[pos] == '\r')) {
+    ++pos;
+  }
+  return pos;
+}
+
+// Finds the quoted key at or after pos, returns the position just past
+// its colon, or npos.
+inline size_t FindJsonKey(const std::string &json, const std::string &key,
+    size_t pos, size_t end) {
+  const std::string quoted = "\"" + key + "\"";
+  while (true) {
+    pos = json.find(quoted, pos);
+    if (pos == std::string::npos || pos >= end) {
+      return std::string::npos;
+    }
+    pos = SkipJsonSpaces(json, pos + quoted.size());
+    if (pos < json.size() && json[pos] == ':') {
+      return pos + 1;
+    }
+  }
+}
+
+// Finds a numeric field of the named scene in a report written by
+// ResultsToJson. The scene objects are flat, so the object is the text
+// between the braces around its exact "name": "<scene>" pair.
+// Returns false if the scene or the field is missing.
+inline bool FindBaselineValue(const std::string &json,
+    const std::string &scene, const char *field, double *out_value) {
+  const std::string quoted_scene = "\"" + scene + "\"";
+  size_t pos = 0;
+  while (true) {
+    pos = FindJsonKey(json, "name", pos, json.size());
+    if (pos == std::string::npos) {
+      return false;
+    }
+    pos = SkipJsonSpaces(json, pos);
+    if (json.compare(pos, quoted_scene.size(), quoted_scene) == 0) {
+      break;
+    }
+  }
+  size_t begin = json.rfind('{', pos);
+  size_t end = json.find('}', pos);
+  if (begin == std::string::npos || end == std::string::npos) {
+    return false;
+  }
+  size_t value_pos = FindJsonKey(json, field, begin, end);
+  if (value_pos == std::string::npos) {
+    return false;
+  }
+  const char *value = json.c_str() + value_pos;
+  char *value_end = nullptr;
+  double parsed = strtod(value, &value_end);
+  if (value_end == value) {
+    return false;
+  }
+  *out_value = parsed;
+  return true;
+}
+
+// Prints a line per scene and returns the number of scenes whose mean or
+// median frame time grew by more than tolerance_pct percent over the baseline.
+inline arctic::Si32 CompareWithBaseline(
+    const std::vector<SceneResult> &results, const std::string &baseline,
+    double tolerance_pct) {
+  arctic::Si32 regressions = 0;
+  for (const SceneResult &r : results) {
+    double base_mean = 0.0;
+    double base_p50 = 0.0;
+    if (!FindBaselineValue(baseline, r.name, "mean_ms", &base_mean) ||
+        !FindBaselineValue(baseline, r.name, "p50_ms", &base_p50) ||
+        base_mean <= 0.0 || base_p50 <= 0.0) {
+      printf("%-10s no baseline\n", r.name.c_str());
+      continue;
+    }
+    double mean_pct = (r.mean_ms / base_mean - 1.0) * 100.0;
+    double p50_pct = (r.p50_ms / base_p50 - 1.0) * 100.0;
+    bool is_regression = mean_pct > tolerance_pct || p50_pct > tolerance_pct;
+    printf("%-10s mean %.3f -> %.3f ms (%+.1f%%) p50 %.3f -> %.3f ms (%+.1f%%)%s\n",
+      r.name.c_str(), base_mean, r.mean_ms, mean_pct,
+      base_p50, r.p50_ms, p50_pct, is_regression ? " REGRESSION" : "");
+    if (is_regression) {
+      ++regressions;
+    }
+  }
+  return regressions;
+}
+
+#endif  // BENCHMARK_BENCHMARK_REPORT_H_
@@ -1,300 +1,640 @@
-// The MIT License (MIT)
-//
-// Copyright (c) 2017 - 2021 Huldra
-// Copyright (c) 2021 Vlad2001_MFS
-//
-// Permission is hereby granted, free of charge, to any person obtaining a copy
-// of this software and associated documentation files (the "Software"), to deal
-// in the Software without restriction, including without limitation the rights
-// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
-// copies of the Software, and to permit persons to whom the Software is
-// furnished to do so, subject to the following conditions:
-//
-// The above copyright notice and this permission notice shall be included in
-// all copies or substantial portions of the Software.
-//
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
-// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
-// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
-// IN THE SOFTWARE.
-
-#include "engine/easy.h"
-
-using namespace arctic;  // NOLINT
-
-
-const auto WND_WIDTH = 1920;
-const auto WND_HEIGHT = 1080;
-
-const Si32 kBlockSpriteCount = 4;
-HwSprite g_hw_blocks[kBlockSpriteCount];
-Sprite g_sw_blocks[kBlockSpriteCount];
-
-Font g_font;
-
-bool g_is_hw_enabled = true;
-Si32 g_bench_idx = 1;
-double g_prev_time;
-double g_frame_acc = 1.0;
-double g_time_acc = 0.001;
-double g_fps = 0.0;
-
-struct Tile {
-    int block_idx;
-    int x, y;
-    int w, h;
-    float zoom;
-    Rgba color;
-    DrawBlendingMode blending;
-};
-
-std::vector<Tile> tiles;
-
-void Init() {
-  ResizeScreen(WND_WIDTH, WND_HEIGHT);
-
-  g_hw_blocks[1].Load("data/block_1.tga");
-  g_hw_blocks[2].Load("data/block_2.tga");
-  g_hw_blocks[0].Create(g_hw_blocks[1].Size());
-  g_hw_blocks[1].Draw(g_hw_blocks[0], 0, 0, kDrawBlendingModeColorize, kFilterNearest, Rgba(255, 255, 255, 160));
-  g_hw_blocks[1].SetPivot(g_hw_blocks[1].Size() / 2 + Vec2Si32(1, 1));
-
-  g_sw_blocks[1].Load("data/block_1.tga");
-  g_sw_blocks[2].Load("data/block_2.tga");
-  g_sw_blocks[0].Create(g_sw_blocks[1].Size());
-  g_sw_blocks[1].Draw(g_sw_blocks[0], 0, 0, kDrawBlendingModeColorize, kFilterNearest, Rgba(255, 255, 255, 160));
-  g_sw_blocks[1].SetPivot(g_sw_blocks[1].Size() / 2 + Vec2Si32(1, 1));
-  
-  g_font.Load("data/arctic_one_bmf.fnt");
-
-  const char *string = R"(
-Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
-Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
-pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
-imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
-Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
-Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
-pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
-imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
-Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
-Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
-pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
-imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
-Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
-Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
-pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
-imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
-Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
-Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
-pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
-imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
-Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
-Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
-pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
-imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
-Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
-Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
-pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
-imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
-Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
-Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
-pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
-imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
-Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
-Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
-pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
-imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
-)";
-  Sprite tmp;
-  tmp.Create(g_font.EvaluateSize(string, false));
-
-  g_font.Draw(tmp, string, 0, tmp.Size().y, kTextOriginTop);
-
-  g_hw_blocks[3].LoadFromSoftwareSprite(tmp);
-  g_sw_blocks[3] = tmp;
-
-  srand((Ui32)time(nullptr));
-}
-
-void InitTiles() {
-  tiles.clear();
-  if (g_bench_idx == 0) {
-    for (int x = 0; x < WND_WIDTH; x += g_sw_blocks[2].Size().x) {
-      for (int y = 0; y < WND_HEIGHT; y += g_sw_blocks[2].Size().y) {
-        for (int i = 0; i < 4; i++) {
-            Tile tile;
-            tile.block_idx = 1 + (x + y*WND_WIDTH) % 2;
-            tile.x = x + (i - 2)*5;
-            tile.y = y + (i - 2)*5;
-            tile.w = g_sw_blocks[2].Size().x;
-            tile.h = g_sw_blocks[2].Size().y;
-            tile.zoom = 1.0f;
-            tile.color = Rgba(255, 255, 255, 127);
-            tile.blending = kDrawBlendingModeColorize;
-            tiles.push_back(tile);
-        }
-      }
-    }
-  }
-// )         (background),         
-//     (   ),        ( ),
-//         ()
-  if (g_bench_idx == 1) {
-    Tile tile;
-    tile.block_idx = 0;
-    tile.x = 0;
-    tile.y = 0;
-    tile.w = WND_WIDTH;
-    tile.h = WND_HEIGHT;
-    tile.zoom = 1.0f;
-    tile.color = Rgba(255, 255, 255, 255);
-    tile.blending = kDrawBlendingModeCopyRgba;
-    tiles.push_back(tile);
-
-    tile.block_idx = 1;
-    tile.x = 0;
-    tile.y = 0;
-    tile.w = WND_WIDTH;
-    tile.h = WND_HEIGHT;
-    tile.zoom = 1.0f;
-    tile.blending = kDrawBlendingModeColorize;
-
-    tile.color = Rgba(255, 0, 0, 127);
-    tiles.push_back(tile);
-    tile.color = Rgba(0, 255, 0, 127);
-    tiles.push_back(tile);
-    tile.color = Rgba(0, 0, 255, 127);
-    tiles.push_back(tile);
-
-    for (int i = 0; i < 2000; i++) {
-      tile.block_idx = 1;
-      tile.x = rand() % WND_WIDTH;
-      tile.y = rand() % WND_HEIGHT;
-      tile.w = g_sw_blocks[1].Size().x;
-      tile.h = g_sw_blocks[1].Size().y;
-      tile.zoom = 1.0f;
-      tile.color = Rgba(255, 255, 255, 192);
-      tile.blending = kDrawBlendingModeColorize;
-      tiles.push_back(tile);
-    }
-
-    for (int i = 0; i < 5000; i++) {
-      tile.block_idx = 2;
-      tile.x = rand() % WND_WIDTH;
-      tile.y = rand() % WND_HEIGHT;
-      tile.w = g_sw_blocks[1].Size().x / 4;
-      tile.h = g_sw_blocks[1].Size().y / 4;
-      tile.zoom = 1.0f;
-      tile.color = Rgba(255, 255, 255, 127);
-      tile.blending = kDrawBlendingModeSolidColor;
-//    tile.blending = kDrawBlendingModeCopyRgba;
-      tiles.push_back(tile);
-    }
-  }
-// )         (lorem ipsum).         3 .
-  if (g_bench_idx == 2) {
-    Tile tile;
-    tile.block_idx = 0;
-    tile.x = 0;
-    tile.y = 0;
-    tile.w = WND_WIDTH;
-    tile.h = WND_HEIGHT;
-    tile.zoom = 1.0f;
-    tile.color = Rgba(255, 255, 255, 255);
-    tile.blending = kDrawBlendingModeCopyRgba;
-    tiles.push_back(tile);
-
-    tile.block_idx = 3;
-    tile.x = 0;
-    tile.y = 0;
-    tile.w = WND_WIDTH;
-    tile.h = WND_HEIGHT;
-    tile.zoom = 1.0f;
-    tile.color = Rgba(0, 127, 0, 255);
-    tile.blending = kDrawBlendingModeColorize;
-    tiles.push_back(tile);
-  }
-}
-
-void Update() {
-  if (g_bench_idx == 1) {
-    tiles[1].x = WND_WIDTH / 2 + static_cast<int>(sin(Time())*WND_WIDTH / 4);
-    tiles[1].y = WND_HEIGHT / 2;
-    tiles[1].zoom = sinf(static_cast<float>(Time())) / 2.0f + 0.5f + 0.5f;
-    tiles[2].x = WND_WIDTH / 2 + static_cast<int>(cos(Time())*WND_WIDTH / 4);
-    tiles[2].y = WND_HEIGHT / 2;
-    tiles[2].zoom = cosf(static_cast<float>(Time())) / 2.0f + 0.5f + 0.5f;
-    tiles[3].x = WND_WIDTH / 2;
-    tiles[3].y = WND_HEIGHT / 2 + static_cast<int>(sin(Time())*WND_HEIGHT / 4);
-    tiles[3].zoom = sinf(static_cast<float>(Time())) / 2.0f + 0.5f + 0.5f;
-  }
-
-}
-
-void Render() {
-  Clear();
-
-  if (g_is_hw_enabled) {
-    for (const auto &tile : tiles) {
-        g_hw_blocks[tile.block_idx].Draw(tile.x, tile.y, static_cast<int>(tile.w*tile.zoom), static_cast<int>(tile.h*tile.zoom), tile.blending, kFilterNearest, tile.color);
-    }
-  } else {
-    for (const auto &tile : tiles) {
-        g_sw_blocks[tile.block_idx].Draw(tile.x, tile.y, static_cast<int>(tile.w*tile.zoom), static_cast<int>(tile.h*tile.zoom), tile.blending, kFilterNearest, tile.color);
-    }
-  }
-
-  double time = Time();
-  double dt = time - g_prev_time;
-  g_prev_time = time;
-  g_frame_acc += 1.0;
-  g_time_acc += dt;
-
-  if (g_time_acc > 0.5) {
-    g_fps = g_frame_acc / g_time_acc;
-    g_frame_acc = 0.0;
-    g_time_acc = 0.0;
-  }
-
-  char fps_text[128];
-  snprintf(fps_text, sizeof(fps_text), u8"Mode: %s FPS: %.1F",
-      g_is_hw_enabled ? "Hardware" : "Sowfware", g_fps);
-  g_font.Draw(fps_text, 0, ScreenSize().y - 1, kTextOriginTop);
-
-  ShowFrame();
-}
-
-
-void EasyMain() {
-  SetVSync(false);
-  g_prev_time = Time();
-  g_frame_acc = 0.0;
-  g_time_acc = 0.0;
-  Init();
-  InitTiles();
-
-  while (!IsKeyDownward(kKeyEscape)) {
-    if (IsKeyDownward(kKey1)) {
-      g_bench_idx = 0;
-      InitTiles();
-    }
-    if (IsKeyDownward(kKey2)) {
-      g_bench_idx = 1;
-      InitTiles();
-    }
-    if (IsKeyDownward(kKey3)) {
-      g_bench_idx = 2;
-      InitTiles();
-    }
-    if (IsKeyDownward(kKeyH)) {
-      g_is_hw_enabled = !g_is_hw_enabled;
-      InitTiles();
-    }
-    Update();
-    Render();
-  }
-}
-
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 - 2021 Huldra
+// Copyright (c) 2021 Vlad2001_MFS
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark_report.h"
+#include "engine/easy.h"
+#include "engine/gl_state.h"
+
+using namespace arctic;  // NOLINT
+
+
+const auto WND_WIDTH = 1920;
+const auto WND_HEIGHT = 1080;
+
+const Si32 kBlockSpriteCount = 4;
+HwSprite g_hw_blocks[kBlockSpriteCount];
+Sprite g_sw_blocks[kBlockSpriteCount];
+
+Font g_font;
+std::string g_lorem;
+Vec2Si32 g_lorem_size;
+
+// Scene names as used in the benchmark report, indexed by g_bench_idx.
+const char *kSceneNames[] = {
+  "tiles", "blend", "text", "rotated", "bilinear", "font", "triangles"};
+const Si32 kSceneCount = sizeof(kSceneNames) / sizeof(kSceneNames[0]);
+
+const Ui32 kDefaultSeed = 20170101u;
+Ui32 g_seed = kDefaultSeed;
+// mt19937 produces the same sequence on every platform, rand() does not.
+std::mt19937 g_rng(kDefaultSeed);
+
+#ifdef ARCTIC_PLATFORM_HEADLESS
+bool g_is_hw_enabled = false;
+#else
+bool g_is_hw_enabled = true;
+#endif  // ARCTIC_PLATFORM_HEADLESS
+bool g_is_streaming_upload = true;
+bool g_is_scripted = false;
+Si32 g_bench_idx = 1;
+double g_scene_time = 0.0;
+Si64 g_frame_pixels = 0;
+double g_prev_time;
+double g_frame_acc = 1.0;
+double g_time_acc = 0.001;
+double g_fps = 0.0;
+
+struct Tile {
+    int block_idx;
+    int x, y;
+    int w, h;
+    float zoom;
+    float angle;
+    Rgba color;
+    DrawBlendingMode blending;
+    DrawFilterMode filter;
+};
+
+struct Triangle {
+    Vec2Si32 a, b, c;
+    Rgba color_a, color_b, color_c;
+};
+
+std::vector<Tile> tiles;
+std::vector<Triangle> triangles;
+
+Si32 RandomBelow(Si32 limit) {
+  return static_cast<Si32>(g_rng() % static_cast<Ui32>(limit));
+}
+
+float RandomUnit() {
+  return static_cast<float>(g_rng() % 65536u) / 65536.f;
+}
+
+void Init() {
+  ResizeScreen(WND_WIDTH, WND_HEIGHT);
+
+#ifndef ARCTIC_PLATFORM_HEADLESS
+  g_hw_blocks[1].Load("data/block_1.tga");
+  g_hw_blocks[2].Load("data/block_2.tga");
+  g_hw_blocks[0].Create(g_hw_blocks[1].Size());
+  g_hw_blocks[1].Draw(g_hw_blocks[0], 0, 0, kDrawBlendingModeColorize, kFilterNearest, Rgba(255, 255, 255, 160));
+  g_hw_blocks[1].SetPivot(g_hw_blocks[1].Size() / 2 + Vec2Si32(1, 1));
+#endif  // ARCTIC_PLATFORM_HEADLESS
+
+  g_sw_blocks[1].Load("data/block_1.tga");
+  g_sw_blocks[2].Load("data/block_2.tga");
+  g_sw_blocks[0].Create(g_sw_blocks[1].Size());
+  g_sw_blocks[1].Draw(g_sw_blocks[0], 0, 0, kDrawBlendingModeColorize, kFilterNearest, Rgba(255, 255, 255, 160));
+  g_sw_blocks[1].SetPivot(g_sw_blocks[1].Size() / 2 + Vec2Si32(1, 1));
+  
+  g_font.Load("data/arctic_one_bmf.fnt");
+
+  const char *string = R"(
+Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
+Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
+pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
+imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
+Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
+Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
+pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
+imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
+Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
+Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
+pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
+imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
+Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
+Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
+pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
+imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
+Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
+Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
+pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
+imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
+Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
+Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
+pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
+imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
+Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
+Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
+pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
+imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
+Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
+Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
+pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
+imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
+Lorem ipsum dolor sit amet, consectetur adipiscing elit. Integer sollicitudin feugiat nulla, vel malesuada tortor varius sed.
+Quisque imperdiet tincidunt libero ut pretium. Nullam sem lectus, pharetra nec felis ut, tempus tincidunt quam. Sed porttitor erat et
+pharetra suscipit. Interdum et malesuada fames ac ante ipsum primis in faucibus. Nulla tempor tortor vel nisi maximus rutrum. Cras vitae
+imperdiet nisl. Phasellus id laoreet sapien. Etiam dignissim diam eu tellus scelerisque bibendum.
+)";
+  g_lorem = string;
+  g_lorem_size = g_font.EvaluateSize(string, false);
+  Sprite tmp;
+  tmp.Create(g_lorem_size);
+
+  g_font.Draw(tmp, string, 0, tmp.Size().y, kTextOriginTop);
+
+#ifndef ARCTIC_PLATFORM_HEADLESS
+  g_hw_blocks[3].LoadFromSoftwareSprite(tmp);
+#endif  // ARCTIC_PLATFORM_HEADLESS
+  g_sw_blocks[3] = tmp;
+}
+
+Tile MakeTile(Si32 block_idx, Si32 x, Si32 y, Si32 w, Si32 h,
+    Rgba color, DrawBlendingMode blending) {
+  Tile tile;
+  tile.block_idx = block_idx;
+  tile.x = x;
+  tile.y = y;
+  tile.w = w;
+  tile.h = h;
+  tile.zoom = 1.0f;
+  tile.angle = 0.0f;
+  tile.color = color;
+  tile.blending = blending;
+  tile.filter = kFilterNearest;
+  return tile;
+}
+
+void AddBackgroundTile() {
+  tiles.push_back(MakeTile(0, 0, 0, WND_WIDTH, WND_HEIGHT,
+    Rgba(255, 255, 255, 255), kDrawBlendingModeCopyRgba));
+}
+
+void InitTiles() {
+  tiles.clear();
+  triangles.clear();
+  g_rng.seed(g_seed);
+  if (g_bench_idx == 0) {
+    for (int x = 0; x < WND_WIDTH; x += g_sw_blocks[2].Size().x) {
+      for (int y = 0; y < WND_HEIGHT; y += g_sw_blocks[2].Size().y) {
+        for (int i = 0; i < 4; i++) {
+            Tile tile;
+            tile.block_idx = 1 + (x + y*WND_WIDTH) % 2;
+            tile.x = x + (i - 2)*5;
+            tile.y = y + (i - 2)*5;
+            tile.w = g_sw_blocks[2].Size().x;
+            tile.h = g_sw_blocks[2].Size().y;
+            tile.zoom = 1.0f;
+            tile.angle = 0.0f;
+            tile.color = Rgba(255, 255, 255, 127);
+            tile.blending = kDrawBlendingModeColorize;
+            tile.filter = kFilterNearest;
+            tiles.push_back(tile);
+        }
+      }
+    }
+  }
+// )         (background),         
+//     (   ),        ( ),
+//         ()
+  if (g_bench_idx == 1) {
+    AddBackgroundTile();
+    Tile tile = tiles.back();
+
+    tile.block_idx = 1;
+    tile.x = 0;
+    tile.y = 0;
+    tile.w = WND_WIDTH;
+    tile.h = WND_HEIGHT;
+    tile.zoom = 1.0f;
+    tile.blending = kDrawBlendingModeColorize;
+
+    tile.color = Rgba(255, 0, 0, 127);
+    tiles.push_back(tile);
+    tile.color = Rgba(0, 255, 0, 127);
+    tiles.push_back(tile);
+    tile.color = Rgba(0, 0, 255, 127);
+    tiles.push_back(tile);
+
+    for (int i = 0; i < 2000; i++) {
+      tile.block_idx = 1;
+      tile.x = RandomBelow(WND_WIDTH);
+      tile.y = RandomBelow(WND_HEIGHT);
+      tile.w = g_sw_blocks[1].Size().x;
+      tile.h = g_sw_blocks[1].Size().y;
+      tile.zoom = 1.0f;
+      tile.color = Rgba(255, 255, 255, 192);
+      tile.blending = kDrawBlendingModeColorize;
+      tiles.push_back(tile);
+    }
+
+    for (int i = 0; i < 5000; i++) {
+      tile.block_idx = 2;
+      tile.x = RandomBelow(WND_WIDTH);
+      tile.y = RandomBelow(WND_HEIGHT);
+      tile.w = g_sw_blocks[1].Size().x / 4;
+      tile.h = g_sw_blocks[1].Size().y / 4;
+      tile.zoom = 1.0f;
+      tile.color = Rgba(255, 255, 255, 127);
+      tile.blending = kDrawBlendingModeSolidColor;
+//    tile.blending = kDrawBlendingModeCopyRgba;
+      tiles.push_back(tile);
+    }
+  }
+// )         (lorem ipsum).         3 .
+  if (g_bench_idx == 2) {
+    AddBackgroundTile();
+    Tile tile = tiles.back();
+
+    tile.block_idx = 3;
+    tile.x = 0;
+    tile.y = 0;
+    tile.w = WND_WIDTH;
+    tile.h = WND_HEIGHT;
+    tile.zoom = 1.0f;
+    tile.color = Rgba(0, 127, 0, 255);
+    tile.blending = kDrawBlendingModeColorize;
+    tiles.push_back(tile);
+  }
+  // Sprites rotated around their pivot, each spinning at its own angle.
+  if (g_bench_idx == 3) {
+    AddBackgroundTile();
+    for (int i = 0; i < 1500; i++) {
+      Tile tile = MakeTile(1, RandomBelow(WND_WIDTH), RandomBelow(WND_HEIGHT),
+        g_sw_blocks[1].Size().x, g_sw_blocks[1].Size().y,
+        Rgba(255, 255, 255, 192), kDrawBlendingModeAlphaBlend);
+      tile.angle = RandomUnit() * 6.2831853f;
+      tiles.push_back(tile);
+    }
+  }
+  // Downscaled sprites with bilinear filtering.
+  if (g_bench_idx == 4) {
+    AddBackgroundTile();
+    for (int i = 0; i < 2000; i++) {
+      Tile tile = MakeTile(1 + i % 2, RandomBelow(WND_WIDTH),
+        RandomBelow(WND_HEIGHT),
+        g_sw_blocks[1].Size().x, g_sw_blocks[1].Size().y,
+        Rgba(255, 255, 255, 192), kDrawBlendingModeAlphaBlend);
+      tile.zoom = 0.5f + RandomUnit() * 0.45f;
+      tile.filter = kFilterBilinear;
+      tiles.push_back(tile);
+    }
+  }
+  // Text is drawn glyph by glyph every frame, see Render().
+  if (g_bench_idx == 5) {
+    AddBackgroundTile();
+  }
+  // Gradient filled triangles.
+  if (g_bench_idx == 6) {
+    AddBackgroundTile();
+    for (int i = 0; i < 3000; i++) {
+      Triangle triangle;
+      Vec2Si32 center(RandomBelow(WND_WIDTH), RandomBelow(WND_HEIGHT));
+      triangle.a = center + Vec2Si32(RandomBelow(128) - 64, RandomBelow(128) - 64);
+      triangle.b = center + Vec2Si32(RandomBelow(128) - 64, RandomBelow(128) - 64);
+      triangle.c = center + Vec2Si32(RandomBelow(128) - 64, RandomBelow(128) - 64);
+      triangle.color_a = Rgba(static_cast<Ui32>(g_rng()));
+      triangle.color_b = Rgba(static_cast<Ui32>(g_rng()));
+      triangle.color_c = Rgba(static_cast<Ui32>(g_rng()));
+      triangles.push_back(triangle);
+    }
+  }
+}
+
+Si64 TilePixels(const Tile &tile) {
+  Si64 w = static_cast<Si64>(tile.w * tile.zoom);
+  Si64 h = static_cast<Si64>(tile.h * tile.zoom);
+  if (tile.angle != 0.0f) {
+    return w * h;
+  }
+  Si64 x1 = std::max<Si64>(tile.x, 0);
+  Si64 y1 = std::max<Si64>(tile.y, 0);
+  Si64 x2 = std::min<Si64>(tile.x + w, WND_WIDTH);
+  Si64 y2 = std::min<Si64>(tile.y + h, WND_HEIGHT);
+  return (x2 > x1 && y2 > y1) ? (x2 - x1) * (y2 - y1) : 0;
+}
+
+Si64 TrianglePixels(const Triangle &triangle) {
+  Vec2Si32 ab = triangle.b - triangle.a;
+  Vec2Si32 ac = triangle.c - triangle.a;
+  return std::abs(static_cast<Si64>(ab.x) * ac.y -
+    static_cast<Si64>(ab.y) * ac.x) / 2;
+}
+
+void Update() {
+  double time = g_scene_time;
+  if (g_bench_idx == 1) {
+    tiles[1].x = WND_WIDTH / 2 + static_cast<int>(sin(time)*WND_WIDTH / 4);
+    tiles[1].y = WND_HEIGHT / 2;
+    tiles[1].zoom = sinf(static_cast<float>(time)) / 2.0f + 0.5f + 0.5f;
+    tiles[2].x = WND_WIDTH / 2 + static_cast<int>(cos(time)*WND_WIDTH / 4);
+    tiles[2].y = WND_HEIGHT / 2;
+    tiles[2].zoom = cosf(static_cast<float>(time)) / 2.0f + 0.5f + 0.5f;
+    tiles[3].x = WND_WIDTH / 2;
+    tiles[3].y = WND_HEIGHT / 2 + static_cast<int>(sin(time)*WND_HEIGHT / 4);
+    tiles[3].zoom = sinf(static_cast<float>(time)) / 2.0f + 0.5f + 0.5f;
+  }
+  if (g_bench_idx == 3) {
+    for (size_t i = 1; i < tiles.size(); ++i) {
+      tiles[i].angle += 0.01f;
+    }
+  }
+}
+
+void Render() {
+  Clear();
+
+  g_frame_pixels = 0;
+  if (g_is_hw_enabled) {
+    for (const auto &tile : tiles) {
+      if (tile.angle != 0.0f) {
+        g_hw_blocks[tile.block_idx].Draw(Vec2F(static_cast<float>(tile.x), static_cast<float>(tile.y)), tile.angle, tile.zoom, tile.blending, tile.filter, tile.color);
+      } else {
+        g_hw_blocks[tile.block_idx].Draw(tile.x, tile.y, static_cast<int>(tile.w*tile.zoom), static_cast<int>(tile.h*tile.zoom), tile.blending, tile.filter, tile.color);
+      }
+      g_frame_pixels += TilePixels(tile);
+    }
+  } else {
+    for (const auto &tile : tiles) {
+      if (tile.angle != 0.0f) {
+        g_sw_blocks[tile.block_idx].Draw(Vec2F(static_cast<float>(tile.x), static_cast<float>(tile.y)), tile.angle, tile.zoom, tile.blending, tile.filter, tile.color);
+      } else {
+        g_sw_blocks[tile.block_idx].Draw(tile.x, tile.y, static_cast<int>(tile.w*tile.zoom), static_cast<int>(tile.h*tile.zoom), tile.blending, tile.filter, tile.color);
+      }
+      g_frame_pixels += TilePixels(tile);
+    }
+  }
+  if (g_bench_idx == 5) {
+    Si32 shift = static_cast<Si32>(g_scene_time * 60.0) % 64;
+    g_font.Draw(g_lorem.c_str(), shift, WND_HEIGHT - 1, kTextOriginTop,
+      kDrawBlendingModeColorize, kFilterNearest, Rgba(0, 127, 0, 255));
+    g_frame_pixels += static_cast<Si64>(g_lorem_size.x) * g_lorem_size.y;
+  }
+  for (const auto &triangle : triangles) {
+    DrawTriangle(triangle.a, triangle.b, triangle.c,
+      triangle.color_a, triangle.color_b, triangle.color_c);
+    g_frame_pixels += TrianglePixels(triangle);
+  }
+
+  if (g_is_scripted) {
+    ShowFrame();
+    return;
+  }
+
+  double time = Time();
+  double dt = time - g_prev_time;
+  g_prev_time = time;
+  g_frame_acc += 1.0;
+  g_time_acc += dt;
+
+  if (g_time_acc > 0.5) {
+    g_fps = g_frame_acc / g_time_acc;
+    g_frame_acc = 0.0;
+    g_time_acc = 0.0;
+  }
+
+  char fps_text[128];
+  snprintf(fps_text, sizeof(fps_text),
+      u8"Mode: %s Upload: %s FPS: %.1F Frame: %.2F ms",
+      g_is_hw_enabled ? "Hardware" : "Sowfware",
+      g_is_streaming_upload ? "Streaming" : "Direct", g_fps,
+      g_fps > 0.0 ? 1000.0 / g_fps : 0.0);
+  g_font.Draw(fps_text, 0, ScreenSize().y - 1, kTextOriginTop);
+
+  ShowFrame();
+}
+
+SceneResult RunScene(Si32 scene_idx, Si32 frames, Si32 warmup_frames) {
+  g_bench_idx = scene_idx;
+  InitTiles();
+  std::vector<double> frame_ms;
+  frame_ms.reserve(static_cast<size_t>(frames));
+  double pixels = 0.0;
+  for (Si32 frame = -warmup_frames; frame < frames; ++frame) {
+    // Scene animation advances with the frame number, not the wall clock,
+    // so every run renders exactly the same frames.
+    g_scene_time = (frame + warmup_frames) / 60.0;
+    Update();
+    if (frame == 0) {
+      GlState::ResetCallCounts();
+    }
+    auto begin = std::chrono::steady_clock::now();
+    Render();
+    auto end = std::chrono::steady_clock::now();
+    if (frame >= 0) {
+      frame_ms.push_back(
+        std::chrono::duration<double, std::milli>(end - begin).count());
+      pixels += static_cast<double>(g_frame_pixels);
+    }
+  }
+
+  SceneResult result;
+  result.name = kSceneNames[scene_idx];
+  result.frames = frames;
+  double total_ms = 0.0;
+  for (double ms : frame_ms) {
+    total_ms += ms;
+  }
+  std::sort(frame_ms.begin(), frame_ms.end());
+  result.mean_ms = total_ms / frames;
+  result.p50_ms = Percentile(frame_ms, 0.5);
+  result.p99_ms = Percentile(frame_ms, 0.99);
+  result.mpixels_per_s = total_ms > 0.0 ? pixels / (total_ms * 1000.0) : 0.0;
+  result.gl_state_issued_per_frame =
+    static_cast<double>(GlState::GetIssuedCallCount()) / frames;
+  result.gl_state_saved_per_frame =
+    static_cast<double>(GlState::GetSavedCallCount()) / frames;
+  return result;
+}
+
+std::string ResultsToJson(const std::vector<SceneResult> &results,
+    Si32 frames) {
+  std::stringstream json;
+  char line[512];
+  snprintf(line, sizeof(line),
+    "{\n  \"seed\": %u,\n  \"frames\": %d,\n"
+    "  \"width\": %d,\n  \"height\": %d,\n  \"renderer\": \"%s\",\n"
+    "  \"scenes\": [\n",
+    g_seed, frames, WND_WIDTH, WND_HEIGHT,
+    g_is_hw_enabled ? "hardware" : "software");
+  json << line;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const SceneResult &r = results[i];
+    snprintf(line, sizeof(line),
+      "    {\"name\": \"%s\", \"frames\": %d, \"mean_ms\": %.4f, "
+      "\"p50_ms\": %.4f, \"p99_ms\": %.4f, \"mpixels_per_s\": %.2f, "
+      "\"gl_state_issued_per_frame\": %.1f, "
+      "\"gl_state_saved_per_frame\": %.1f}%s\n",
+      r.name.c_str(), r.frames, r.mean_ms, r.p50_ms, r.p99_ms,
+      r.mpixels_per_s, r.gl_state_issued_per_frame,
+      r.gl_state_saved_per_frame, i + 1 < results.size() ? "," : "");
+    json << line;
+  }
+  json << "  ]\n}\n";
+  return json.str();
+}
+
+bool ArgValue(const char *arg, const char *name, const char **out_value) {
+  size_t len = strlen(name);
+  if (strncmp(arg, name, len) == 0 && arg[len] == '=') {
+    *out_value = arg + len + 1;
+    return true;
+  }
+  return false;
+}
+
+// Scripted mode, for example:
+//   benchmark --run --frames=300 --out=new.json --compare=base.json
+// Runs the listed scenes (--scenes=tiles,font; all by default) for a fixed
+// number of frames each, prints the JSON report and, with --compare,
+// exits with code 1 if any scene regressed by more than --tolerance percent.
+// --sw and --hw pick the renderer, the headless build defaults to --sw.
+bool RunScripted() {
+  Si64 argc = GetEngine()->GetArgc();
+  const char *const *argv = GetEngine()->GetArgv();
+  bool is_run = false;
+  Si32 frames = 300;
+  Si32 warmup_frames = 10;
+  double tolerance_pct = 10.0;
+  std::string out_path;
+  std::string compare_path;
+  std::vector<Si32> scenes;
+  for (Si64 i = 1; i < argc; ++i) {
+    const char *value = nullptr;
+    if (strcmp(argv[i], "--run") == 0) {
+      is_run = true;
+    } else if (strcmp(argv[i], "--sw") == 0) {
+      g_is_hw_enabled = false;
+    } else if (strcmp(argv[i], "--hw") == 0) {
+      g_is_hw_enabled = true;
+    } else if (ArgValue(argv[i], "--frames", &value)) {
+      frames = std::max(1, atoi(value));
+    } else if (ArgValue(argv[i], "--warmup", &value)) {
+      warmup_frames = std::max(0, atoi(value));
+    } else if (ArgValue(argv[i], "--seed", &value)) {
+      g_seed = static_cast<Ui32>(strtoul(value, nullptr, 10));
+    } else if (ArgValue(argv[i], "--tolerance", &value)) {
+      tolerance_pct = atof(value);
+    } else if (ArgValue(argv[i], "--out", &value)) {
+      out_path = value;
+    } else if (ArgValue(argv[i], "--compare", &value)) {
+      compare_path = value;
+    } else if (ArgValue(argv[i], "--scenes", &value)) {
+      std::stringstream list(value);
+      std::string name;
+      while (std::getline(list, name, ',')) {
+        Si32 scene = -1;
+        for (Si32 idx = 0; idx < kSceneCount; ++idx) {
+          if (name == kSceneNames[idx]) {
+            scene = idx;
+          }
+        }
+        if (scene < 0) {
+          // A misspelled scene would make a partial run look complete.
+          printf("Unknown scene \"%s\", the scenes are:", name.c_str());
+          for (Si32 idx = 0; idx < kSceneCount; ++idx) {
+            printf("%s %s", idx ? "," : "", kSceneNames[idx]);
+          }
+          printf("\n");
+          fflush(stdout);
+          ExitProgram(2);
+          return true;
+        }
+        scenes.push_back(scene);
+      }
+    }
+  }
+  if (!is_run) {
+    return false;
+  }
+  if (scenes.empty()) {
+    for (Si32 idx = 0; idx < kSceneCount; ++idx) {
+      scenes.push_back(idx);
+    }
+  }
+
+  g_is_scripted = true;
+  SetVSync(false);
+  Init();
+  std::vector<SceneResult> results;
+  for (Si32 idx : scenes) {
+    results.push_back(RunScene(idx, frames, warmup_frames));
+  }
+
+  std::string json = ResultsToJson(results, frames);
+  printf("%s", json.c_str());
+  if (!out_path.empty()) {
+    WriteFile(out_path.c_str(),
+      reinterpret_cast<const Ui8*>(json.data()), json.size());
+  }
+  Si32 exit_code = 0;
+  if (!compare_path.empty()) {
+    std::vector<Ui8> baseline = ReadFile(compare_path.c_str(), true);
+    if (baseline.empty()) {
+      printf("Can't read the baseline %s\n", compare_path.c_str());
+      exit_code = 2;
+    } else if (CompareWithBaseline(results,
+        std::string(baseline.begin(), baseline.end()), tolerance_pct)) {
+      exit_code = 1;
+    }
+  }
+  fflush(stdout);
+  ExitProgram(exit_code);
+  return true;
+}
+
+void EasyMain() {
+  if (RunScripted()) {
+    return;
+  }
+
+  SetVSync(false);
+  g_prev_time = Time();
+  g_frame_acc = 0.0;
+  g_time_acc = 0.0;
+  Init();
+  InitTiles();
+
+  while (!IsKeyDownward(kKeyEscape)) {
+    for (Si32 idx = 0; idx < kSceneCount; ++idx) {
+      if (IsKeyDownward(static_cast<KeyCode>(kKey1 + idx))) {
+        g_bench_idx = idx;
+        InitTiles();
+      }
+    }
+    if (IsKeyDownward(kKeyH)) {
+      g_is_hw_enabled = !g_is_hw_enabled;
+      InitTiles();
+    }
+    if (IsKeyDownward(kKeyP)) {
+      g_is_streaming_upload = !g_is_streaming_upload;
+      SetStreamingUpload(g_is_streaming_upload);
+    }
+    g_scene_time = Time();
+    Update();
+    Render();
+  }
+}
+
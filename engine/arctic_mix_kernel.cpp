@@ -0,0 +1,205 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/arctic_mix_kernel.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ARCTIC_MIX_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ARCTIC_MIX_NEON
+#include <arm_neon.h>
+#endif
+
+namespace arctic {
+
+// The scalar reference. The product of an Si16 and a gain below 65536 always
+// fits in Si32, and the arithmetic shift matches the vector shifts exactly.
+static void MixAddScalar(Si32 *accumulator, const Si16 *in, Si32 count,
+    Si32 gain) {
+  for (Si32 i = 0; i < count; ++i) {
+    accumulator[i] += (static_cast<Si32>(in[i]) * gain) >> 15;
+  }
+}
+
+static void MixPackScalar(Si16 *out, const Si32 *accumulator, Si32 count) {
+  for (Si32 i = 0; i < count; ++i) {
+    Si32 value = accumulator[i];
+    value = value < -32768 ? -32768 : (value > 32767 ? 32767 : value);
+    out[i] = static_cast<Si16>(value);
+  }
+}
+
+// The vector kernels multiply by an Si16, so gains of 1.0 and above
+// fall back to the scalar loop.
+#if defined(ARCTIC_MIX_SSE2)
+
+static void MixAddSse2(Si32 *accumulator, const Si16 *in, Si32 count,
+    Si32 gain) {
+  if (gain > 32767) {
+    MixAddScalar(accumulator, in, count, gain);
+    return;
+  }
+  const __m128i g = _mm_set1_epi16(static_cast<Si16>(gain));
+  Si32 i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    __m128i lo = _mm_mullo_epi16(x, g);
+    __m128i hi = _mm_mulhi_epi16(x, g);
+    __m128i p0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 15);
+    __m128i p1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 15);
+    __m128i *a = reinterpret_cast<__m128i*>(accumulator + i);
+    _mm_storeu_si128(a, _mm_add_epi32(_mm_loadu_si128(a), p0));
+    _mm_storeu_si128(a + 1, _mm_add_epi32(_mm_loadu_si128(a + 1), p1));
+  }
+  MixAddScalar(accumulator + i, in + i, count - i, gain);
+}
+
+static void MixPackSse2(Si16 *out, const Si32 *accumulator, Si32 count) {
+  Si32 i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m128i *a = reinterpret_cast<const __m128i*>(accumulator + i);
+    __m128i packed = _mm_packs_epi32(_mm_loadu_si128(a),
+      _mm_loadu_si128(a + 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+  }
+  MixPackScalar(out + i, accumulator + i, count - i);
+}
+
+#endif  // ARCTIC_MIX_SSE2
+
+#if defined(ARCTIC_MIX_NEON)
+
+static void MixAddNeon(Si32 *accumulator, const Si16 *in, Si32 count,
+    Si32 gain) {
+  if (gain > 32767) {
+    MixAddScalar(accumulator, in, count, gain);
+    return;
+  }
+  const int16_t g = static_cast<int16_t>(gain);
+  Si32 i = 0;
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t x = vld1q_s16(in + i);
+    int32x4_t p0 = vmull_n_s16(vget_low_s16(x), g);
+    int32x4_t p1 = vmull_n_s16(vget_high_s16(x), g);
+    vst1q_s32(accumulator + i, vsraq_n_s32(vld1q_s32(accumulator + i), p0, 15));
+    vst1q_s32(accumulator + i + 4,
+      vsraq_n_s32(vld1q_s32(accumulator + i + 4), p1, 15));
+  }
+  MixAddScalar(accumulator + i, in + i, count - i, gain);
+}
+
+static void MixPackNeon(Si16 *out, const Si32 *accumulator, Si32 count) {
+  Si32 i = 0;
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t packed = vcombine_s16(vqmovn_s32(vld1q_s32(accumulator + i)),
+      vqmovn_s32(vld1q_s32(accumulator + i + 4)));
+    vst1q_s16(out + i, packed);
+  }
+  MixPackScalar(out + i, accumulator + i, count - i);
+}
+
+#endif  // ARCTIC_MIX_NEON
+
+Si32 MixGain(float volume) {
+  float gain = std::round(volume * static_cast<float>(kMixGainOne));
+  if (!(gain > 0.f)) {
+    return 0;
+  }
+  if (gain >= static_cast<float>(kMixGainMax)) {
+    return kMixGainMax;
+  }
+  return static_cast<Si32>(gain);
+}
+
+bool IsMixKernelIsaSupported(MixKernelIsa isa) {
+  switch (isa) {
+  case kMixKernelIsaScalar:
+    return true;
+  case kMixKernelIsaSse2:
+#if defined(ARCTIC_MIX_SSE2)
+    return true;
+#else
+    return false;
+#endif
+  case kMixKernelIsaNeon:
+#if defined(ARCTIC_MIX_NEON)
+    return true;
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+MixKernelIsa GetMixKernelIsa() {
+  return IsMixKernelIsaSupported(kMixKernelIsaSse2) ? kMixKernelIsaSse2 :
+    IsMixKernelIsaSupported(kMixKernelIsaNeon) ? kMixKernelIsaNeon :
+    kMixKernelIsaScalar;
+}
+
+MixAddFunc GetMixAddFunc(MixKernelIsa isa) {
+  switch (isa) {
+  case kMixKernelIsaScalar:
+    break;
+  case kMixKernelIsaSse2:
+#if defined(ARCTIC_MIX_SSE2)
+    return MixAddSse2;
+#else
+    break;
+#endif
+  case kMixKernelIsaNeon:
+#if defined(ARCTIC_MIX_NEON)
+    return MixAddNeon;
+#else
+    break;
+#endif
+  }
+  return MixAddScalar;
+}
+
+MixPackFunc GetMixPackFunc(MixKernelIsa isa) {
+  switch (isa) {
+  case kMixKernelIsaScalar:
+    break;
+  case kMixKernelIsaSse2:
+#if defined(ARCTIC_MIX_SSE2)
+    return MixPackSse2;
+#else
+    break;
+#endif
+  case kMixKernelIsaNeon:
+#if defined(ARCTIC_MIX_NEON)
+    return MixPackNeon;
+#else
+    break;
+#endif
+  }
+  return MixPackScalar;
+}
+
+}  // namespace arctic
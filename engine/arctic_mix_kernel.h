@@ -0,0 +1,76 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_ARCTIC_MIX_KERNEL_H_
+#define ENGINE_ARCTIC_MIX_KERNEL_H_
+
+#include "engine/arctic_types.h"
+
+namespace arctic {
+
+/// @addtogroup global_sound
+/// @{
+
+enum MixKernelIsa {
+  kMixKernelIsaScalar = 0,  ///< Plain C++, available everywhere.
+  kMixKernelIsaSse2 = 1,  ///< x86 SSE2, 8 samples per step.
+  kMixKernelIsaNeon = 2  ///< ARM NEON, 8 samples per step.
+};
+
+/// @brief Gain of 1.0 in the Q15 fixed point format used by the mix kernels.
+static const Si32 kMixGainOne = 32768;
+/// @brief The largest supported gain, just under 2.0.
+static const Si32 kMixGainMax = 65535;
+
+/// @brief Adds count samples multiplied by a Q15 gain to the accumulator.
+/// @details accumulator[i] += (in[i] * gain) >> 15
+typedef void (*MixAddFunc)(Si32 *accumulator, const Si16 *in, Si32 count,
+    Si32 gain);
+
+/// @brief Converts count accumulated samples to Si16, saturating them.
+typedef void (*MixPackFunc)(Si16 *out, const Si32 *accumulator, Si32 count);
+
+/// @brief Converts a volume to a Q15 gain, clamping it to [0, kMixGainMax].
+Si32 MixGain(float volume);
+
+/// @brief Returns true if the kernels for the instruction set
+///  are compiled in and supported by the cpu the program runs on.
+bool IsMixKernelIsaSupported(MixKernelIsa isa);
+
+/// @brief Returns the fastest instruction set supported by the cpu.
+MixKernelIsa GetMixKernelIsa();
+
+/// @brief Returns the accumulating kernel for the instruction set.
+/// @details The isa must be supported. All kernels produce bit-identical
+///  results.
+MixAddFunc GetMixAddFunc(MixKernelIsa isa = GetMixKernelIsa());
+
+/// @brief Returns the saturating pack kernel for the instruction set.
+/// @details The isa must be supported. All kernels produce bit-identical
+///  results.
+MixPackFunc GetMixPackFunc(MixKernelIsa isa = GetMixKernelIsa());
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_ARCTIC_MIX_KERNEL_H_
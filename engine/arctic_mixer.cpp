@@ -25,7 +25,86 @@
 
 #include "engine/arctic_mixer.h"
 
+#include <cstring>
+
+#include "engine/arctic_mix_kernel.h"
+
 namespace arctic {
+
+static Si32 ReadSoundBufferSource(void *context, Si16 *out, Si32 frames) {
+  SoundBuffer *buffer = static_cast<SoundBuffer*>(context);
+  Si32 size = buffer->StreamOut(frames, out, frames * 2);
+  buffer->next_position += size;
+  return size;
+}
+
+Si32 SoundBuffer::Render(Si32 size, Si16 *out_buffer, Si32 out_buffer_samples,
+    Si16 *scratch, Si32 scratch_samples) {
+  if (ring && !ring->IsStarted()) {
+    // The decoder thread opens the sound, the voice is silent until then.
+    size = std::min(size, out_buffer_samples / 2);
+    memset(out_buffer, 0, static_cast<size_t>(size) * 4);
+    return size;
+  }
+  return resampler.Render(ReadSoundBufferSource, this, out_buffer,
+    std::min(size, out_buffer_samples / 2), scratch, scratch_samples / 2);
+}
+
+bool SoundBuffer::Skip(Si32 size) {
+  next_position += resampler.Skip(size);
+  return resampler.Position() < sound.DurationSamples();
+}
+
+void SoundMixerState::UpdateVoices(Si32 size) {
+  if (!virtual_buffers.empty()) {
+    for (SoundBuffer &voice : virtual_buffers) {
+      buffers.push_back(std::move(voice));
+    }
+    virtual_buffers.clear();
+  }
+  const float volume = master_volume.load();
+  for (size_t idx = 0; idx < buffers.size(); ++idx) {
+    if (MixGain(buffers[idx].volume * volume) == 0) {
+      virtual_buffers.push_back(std::move(buffers[idx]));
+      if (idx != buffers.size() - 1) {
+        buffers[idx] = std::move(buffers.back());
+      }
+      buffers.pop_back();
+      --idx;
+    }
+  }
+  const size_t limit = static_cast<size_t>(std::max(max_voices.load(), 0));
+  if (buffers.size() > limit) {
+    // The older voice wins a tie, so the same voices stay mixed
+    // from one period to the next.
+    std::nth_element(buffers.begin(), buffers.begin() + limit, buffers.end(),
+      [](const SoundBuffer &a, const SoundBuffer &b) {
+        if (a.priority != b.priority) {
+          return a.priority > b.priority;
+        }
+        if (a.volume != b.volume) {
+          return a.volume > b.volume;
+        }
+        return a.sequence < b.sequence;
+      });
+    for (size_t idx = limit; idx < buffers.size(); ++idx) {
+      virtual_buffers.push_back(std::move(buffers[idx]));
+    }
+    buffers.erase(buffers.begin() + limit, buffers.end());
+  }
+  for (size_t idx = 0; idx < virtual_buffers.size(); ++idx) {
+    SoundBuffer &voice = virtual_buffers[idx];
+    if (!voice.Skip(size)) {
+      voice.sound.GetInstance()->DecPlaying();
+      if (idx != virtual_buffers.size() - 1) {
+        voice = std::move(virtual_buffers.back());
+      }
+      virtual_buffers.pop_back();
+      --idx;
+    }
+  }
+}
+
 template class MpscVirtInfArray<SoundBuffer*, TuneDeletePayloadFlag<true>>;
 }  // namespace arctic
 
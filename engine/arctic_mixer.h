@@ -23,11 +23,15 @@
 #ifndef ENGINE_ARCTIC_MIXER_H_
 #define ENGINE_ARCTIC_MIXER_H_
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <deque>  // NOLINT
 #include <mutex>  // NOLINT
 #include <string>
 #include <vector>
 
+#include "engine/arctic_resampler.h"
+#include "engine/arctic_sound_decoder.h"
 #include "engine/arctic_types.h"
 #include "engine/easy_sound.h"
 #include "engine/mtq_mpsc_vinfarr.h"
@@ -44,8 +48,43 @@ struct SoundBuffer {
   };
   Sound sound;
   float volume = 1.0f;
+  float pitch = 1.0f;
+  Si32 priority = 0;
+  /// @brief The order of the start, set by the mixer.
+  Ui64 sequence = 0;
+  /// @brief The next source sample to read.
   Si32 next_position = 0;
   Action action = kStart;
+  /// @brief Decoder of this playback, created by the mixer on first use.
+  SoundStream stream;
+  /// @brief Samples decoded ahead by the SoundDecoder, the mixer uses them
+  ///   instead of the stream if set.
+  std::shared_ptr<SoundRing> ring;
+  /// @brief Converts the sound to the mixer sample rate and pitch.
+  SoundResampler resampler;
+
+  /// @brief Outputs up to size stereo samples from the next_position.
+  Si32 StreamOut(Si32 size, Si16 *out_buffer, Si32 out_buffer_samples) {
+    if (ring) {
+      return ring->Read(next_position, out_buffer,
+        std::min(size, out_buffer_samples / 2));
+    }
+    return sound.StreamOut(next_position, size, out_buffer,
+      out_buffer_samples, &stream);
+  }
+
+  /// @brief Outputs up to size stereo samples at the mixer sample rate.
+  /// @param [in] scratch The buffer to read the source samples to.
+  /// @param [in] scratch_samples The size of the scratch in Si16 values.
+  /// @return The number of stereo samples output, less than size only once
+  ///   the sound has ended.
+  Si32 Render(Si32 size, Si16 *out_buffer, Si32 out_buffer_samples,
+      Si16 *scratch, Si32 scratch_samples);
+
+  /// @brief Advances by size stereo samples at the mixer sample rate
+  ///   without outputting them.
+  /// @return False once the sound has ended.
+  bool Skip(Si32 size);
 };
 
 struct SoundMixerState {
@@ -58,9 +97,23 @@ struct SoundMixerState {
   std::string error_description = "Error description is not set.";
   // Mixer-only state begin
   std::atomic<float> master_volume = ATOMIC_VAR_INIT(0.7f);
+  /// @brief The voices to mix.
   std::vector<SoundBuffer> buffers;
+  /// @brief The voices that only advance, see UpdateVoices.
+  std::vector<SoundBuffer> virtual_buffers;
+  std::vector<Si16> scratch;
+  Ui64 next_sequence = 0;
+  // Thread-safe state
+  SoundDecoder decoder;
+  /// @brief The sample rate of the output device.
+  std::atomic<Si32> output_rate = ATOMIC_VAR_INIT(44100);
+  std::atomic<SoundResamplerQuality> resampler_quality =
+    ATOMIC_VAR_INIT(kSoundResamplerLinear);
+  std::atomic<Si32> max_voices = ATOMIC_VAR_INIT(128);
+  std::atomic<Si64> duplicate_interval_us = ATOMIC_VAR_INIT(0);
 
   static constexpr Si32 kPoolSize = 1024;
+  static constexpr Si32 kScratchFrames = 4096;
 
   SoundMixerState()
       : pool(kPoolSize) {
@@ -68,6 +121,35 @@ struct SoundMixerState {
       pool.enqueue(new SoundBuffer);
     }
     buffers.reserve(kPoolSize);
+    virtual_buffers.reserve(kPoolSize);
+    scratch.resize(2 * kScratchFrames);
+  }
+
+  /// @brief Returns true if the sound was started less than
+  ///   duplicate_interval_us ago, otherwise records the start.
+  bool IsDuplicate(Sound *sound) {
+    const Si64 interval = duplicate_interval_us.load();
+    if (interval <= 0) {
+      return false;
+    }
+    const Si64 now = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+    return !sound->GetInstance()->TryStart(now, interval);
+  }
+
+  /// @brief Chooses the voices to mix in the next size stereo samples,
+  ///   called by the mixer thread before mixing them.
+  /// @details The silent voices and, over max_voices, the ones with the
+  ///   lowest priority and volume move to the virtual_buffers. They advance
+  ///   by size without being mixed and return once there is room.
+  void UpdateVoices(Si32 size);
+
+  /// @brief Outputs up to size stereo samples of the sound at the mixer
+  ///   sample rate, called by the mixer thread.
+  Si32 Render(SoundBuffer *sound, Si32 size, Si16 *out_buffer,
+      Si32 out_buffer_samples) {
+    return sound->Render(size, out_buffer, out_buffer_samples,
+      scratch.data(), static_cast<Si32>(scratch.size()));
   }
 
   void SetError(std::string description) {  //-V813
@@ -88,10 +170,30 @@ struct SoundMixerState {
   void AddSoundTask(const SoundBuffer &buffer) {
     SoundBuffer *p = pool.dequeue();
     if (p == nullptr) {
-      tasks.enqueue(new SoundBuffer(buffer));
+      p = new SoundBuffer(buffer);
     } else {
       *p = buffer;
-      tasks.enqueue(p);
+    }
+    if (p->action == SoundBuffer::kStart) {
+      p->ring = decoder.Open(p->sound);
+      p->resampler.Start(p->sound.SampleRate(), output_rate.load(),
+        p->pitch, resampler_quality.load());
+    }
+    tasks.enqueue(p);
+  }
+
+  static void StopVoices(const std::shared_ptr<SoundInstance> &instance,
+      std::vector<SoundBuffer> *voices) {
+    for (size_t idx = 0; idx < voices->size(); ++idx) {
+      SoundBuffer &buffer = (*voices)[idx];
+      if (buffer.sound.GetInstance() == instance) {
+        buffer.sound.GetInstance()->DecPlaying();
+        if (idx != voices->size() - 1) {
+          buffer = voices->back();
+        }
+        voices->pop_back();
+        idx--;
+      }
     }
   }
 
@@ -103,20 +205,12 @@ struct SoundMixerState {
       }
       switch (task->action) {
       case SoundBuffer::kStart:
+        task->sequence = next_sequence++;
         buffers.push_back(std::move(*task));
         break;
       case SoundBuffer::kStop:
-        for (size_t idx = 0; idx < buffers.size(); ++idx) {
-          SoundBuffer &buffer = buffers[idx];
-          if (buffer.sound.GetInstance() == task->sound.GetInstance()) {
-            buffer.sound.GetInstance()->DecPlaying();
-            if (idx != buffers.size() - 1) {
-              buffers[idx] = buffers[buffers.size() - 1];
-            }
-            buffers.pop_back();
-            idx--;
-          }
-        }
+        StopVoices(task->sound.GetInstance(), &buffers);
+        StopVoices(task->sound.GetInstance(), &virtual_buffers);
         break;
       }
       if (!pool.enqueue(task)) {
@@ -29,6 +29,9 @@
 #define ARCTIC_PLATFORM_WINDOWS
 #elif defined __APPLE__
 #define ARCTIC_PLATFORM_MACOSX
+#elif defined PLATFORM_HEADLESS
+#define ARCTIC_PLATFORM_PI
+#define ARCTIC_PLATFORM_HEADLESS
 #elif defined PLATFORM_RPI
 #define ARCTIC_PLATFORM_PI
 #define ARCTIC_PLATFORM_PI_ES_EGL
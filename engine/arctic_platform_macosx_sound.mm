@@ -122,6 +122,7 @@ OSStatus SoundRenderProc(void *inRefCon,
   Float32 *mixL = (Float32*)ioData->mBuffers[0].mData;
   Float32 *mixR = (Float32*)ioData->mBuffers[1].mData;
   g_sound_mixer_state.InputTasksToMixerThread();
+  g_sound_mixer_state.UpdateVoices(static_cast<Si32>(inNumberFrames));
 
   if (g_sound_mixer_state.buffers.empty()) {
     memset(mixL, 0, inNumberFrames * sizeof(Float32));
@@ -140,7 +141,7 @@ OSStatus SoundRenderProc(void *inRefCon,
     if (mixer->tmp.size() < inNumberFrames * 2) {
       mixer->tmp.resize(inNumberFrames * 2);
     }
-    size = sound.sound.StreamOut(sound.next_position,
+    size = g_sound_mixer_state.Render(&sound,
         static_cast<Si32>(inNumberFrames),
         mixer->tmp.data(),
         static_cast<Si32>(inNumberFrames * 2));
@@ -155,10 +156,7 @@ OSStatus SoundRenderProc(void *inRefCon,
       mixR[i] = 0.f;
     }
 
-    sound.next_position += size;
-
-    if (sound.next_position == sound.sound.DurationSamples()
-        || size == 0) {
+    if (size < static_cast<Si32>(inNumberFrames)) {
       sound.sound.GetInstance()->DecPlaying();
       g_sound_mixer_state.buffers[idx] =
         g_sound_mixer_state.buffers[
@@ -175,7 +173,7 @@ OSStatus SoundRenderProc(void *inRefCon,
     if (mixer->tmp.size() < inNumberFrames * 2) {
       mixer->tmp.resize(inNumberFrames * 2);
     }
-    size = sound.sound.StreamOut(sound.next_position,
+    size = g_sound_mixer_state.Render(&sound,
         static_cast<Si32>(inNumberFrames),
         mixer->tmp.data(),
         static_cast<Si32>(inNumberFrames * 2));
@@ -185,10 +183,8 @@ OSStatus SoundRenderProc(void *inRefCon,
       mixL[i] += static_cast<float>(in_data[i * 2]) * volume;
       mixR[i] += static_cast<float>(in_data[i * 2 + 1]) * volume;
     }
-    sound.next_position += size;
 
-    if (sound.next_position == sound.sound.DurationSamples()
-        || size == 0) {
+    if (size < static_cast<Si32>(inNumberFrames)) {
       sound.sound.GetInstance()->DecPlaying();
       g_sound_mixer_state.buffers[idx] =
         g_sound_mixer_state.buffers[
@@ -239,6 +235,18 @@ void SoundPlayerImpl::Initialize() {
   status = AudioUnitInitialize(output_unit);
   CheckStatus(status, "Couldn't initialize output unit");
 
+  AudioStreamBasicDescription stream_format;
+  UInt32 stream_format_size = sizeof(stream_format);
+  status = AudioUnitGetProperty(output_unit,
+      kAudioUnitProperty_StreamFormat,
+      kAudioUnitScope_Input,
+      0,
+      &stream_format,
+      &stream_format_size);
+  CheckStatus(status, "Couldn't get the output stream format");
+  g_sound_mixer_state.output_rate.store(
+      static_cast<Si32>(stream_format.mSampleRate));
+
   status = AudioOutputUnitStart(output_unit);
   CheckStatus(status, "Couldn't start output unit");
 
@@ -254,11 +262,14 @@ void SoundPlayerImpl::Deinitialize() {
   }
 }
 
-void StartSoundBuffer(Sound sound, float volume) {
-  if (sound.GetInstance()) {
+void StartSoundBuffer(Sound sound, float volume, float pitch,
+    Si32 priority) {
+  if (sound.GetInstance() && !g_sound_mixer_state.IsDuplicate(&sound)) {
     SoundBuffer buffer;
     buffer.sound = sound;
     buffer.volume = volume;
+    buffer.pitch = pitch;
+    buffer.priority = priority;
     buffer.next_position = 0;
     buffer.sound.GetInstance()->IncPlaying();
     buffer.action = SoundBuffer::kStart;
@@ -285,6 +296,23 @@ float GetMasterVolume() {
   return g_sound_mixer_state.master_volume.load();
 }
 
+void SetSoundReadAhead(double seconds) {
+  g_sound_mixer_state.decoder.SetReadAhead(seconds);
+}
+
+void SetSoundResamplerQuality(SoundResamplerQuality quality) {
+  g_sound_mixer_state.resampler_quality.store(quality);
+}
+
+void SetMaxSoundVoices(Si32 count) {
+  g_sound_mixer_state.max_voices.store(count);
+}
+
+void SetSoundDuplicateInterval(double seconds) {
+  g_sound_mixer_state.duplicate_interval_us.store(
+    static_cast<Si64>(seconds * 1000000.0));
+}
+
 
 }  // namespace arctic
 
@@ -0,0 +1,406 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/arctic_platform_def.h"
+#include "engine/arctic_platform.h"
+
+#ifdef ARCTIC_PLATFORM_HEADLESS
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <string>
+
+#include "engine/arctic_mixer.h"
+#include "engine/easy.h"
+#include "engine/opengl.h"
+
+extern void EasyMain();
+
+// The headless platform has no window, no OpenGL context and no sound
+// device. ShowFrame only rasterizes the software backbuffer, sounds play
+// to nowhere in real time. The run is set up with environment variables:
+//   ARCTIC_HEADLESS_SIZE=1280x720 sets the window size, 1920x1080 by default.
+//   ARCTIC_HEADLESS_FRAMES=600 exits the program after the 600th frame.
+//   ARCTIC_HEADLESS_DUMP=out/frame_ saves the frames as out/frame_000001.tga
+//   ARCTIC_HEADLESS_DUMP_EVERY=10 saves only every 10th frame.
+
+namespace arctic {
+
+SoundMixerState g_sound_mixer_state;
+
+static Si32 g_window_width = 1920;
+static Si32 g_window_height = 1080;
+static Si64 g_frame_count = 0;
+static Si64 g_frame_limit = 0;
+static std::string g_dump_prefix;
+static Si64 g_dump_every = 1;
+static double g_sound_time = 0.0;
+static arctic::SoundPlayer g_sound_player;
+
+static void ReadHeadlessSettings() {
+  const char *size = getenv("ARCTIC_HEADLESS_SIZE");
+  if (size) {
+    int width = 0;
+    int height = 0;
+    Check(sscanf(size, "%dx%d", &width, &height) == 2
+        && width > 0 && height > 0,
+      "Can't parse ARCTIC_HEADLESS_SIZE, expected WIDTHxHEIGHT: ", size);
+    g_window_width = width;
+    g_window_height = height;
+  }
+  const char *frames = getenv("ARCTIC_HEADLESS_FRAMES");
+  if (frames) {
+    g_frame_limit = std::max(atoll(frames), 0ll);
+  }
+  const char *dump = getenv("ARCTIC_HEADLESS_DUMP");
+  if (dump) {
+    g_dump_prefix = dump;
+  }
+  const char *dump_every = getenv("ARCTIC_HEADLESS_DUMP_EVERY");
+  if (dump_every) {
+    g_dump_every = std::max(atoll(dump_every), 1ll);
+  }
+}
+
+class SoundPlayerImpl {
+};
+
+std::deque<AudioDeviceInfo> SoundPlayer::GetDeviceList() {
+  std::deque<AudioDeviceInfo> list;
+  list.emplace_back("null", "No sound output", false, true);
+  return list;
+}
+
+void SoundPlayer::Initialize() {
+  // Nothing reads the samples, so nothing is decoded ahead.
+  g_sound_mixer_state.decoder.SetReadAhead(0.0);
+}
+
+void SoundPlayer::Initialize(const char * /*input_device_system_name*/,
+    const char * /*output_device_system_name*/) {
+}
+
+void SoundPlayer::Deinitialize() {
+}
+
+bool SoundPlayer::IsOk() {
+  return g_sound_mixer_state.IsOk();
+}
+
+std::string SoundPlayer::GetErrorDescription() {
+  return g_sound_mixer_state.GetErrorDescription();
+}
+
+SoundPlayer::~SoundPlayer() {
+}
+
+void StartSoundBuffer(Sound sound, float volume, float pitch,
+    Si32 priority) {
+  if (sound.GetInstance() && !g_sound_mixer_state.IsDuplicate(&sound)) {
+    SoundBuffer buffer;
+    buffer.sound = sound;
+    buffer.volume = volume;
+    buffer.pitch = pitch;
+    buffer.priority = priority;
+    buffer.next_position = 0;
+    buffer.sound.GetInstance()->IncPlaying();
+    buffer.action = SoundBuffer::kStart;
+    g_sound_mixer_state.AddSoundTask(buffer);
+  }
+}
+
+void StopSoundBuffer(Sound sound) {
+  if (sound.GetInstance()) {
+    SoundBuffer buffer;
+    buffer.sound = sound;
+    buffer.volume = 0.f;
+    buffer.next_position = 0;
+    buffer.action = SoundBuffer::kStop;
+    g_sound_mixer_state.AddSoundTask(buffer);
+  }
+}
+
+void SetMasterVolume(float volume) {
+  g_sound_mixer_state.master_volume.store(volume);
+}
+
+float GetMasterVolume() {
+  return g_sound_mixer_state.master_volume.load();
+}
+
+void SetSoundReadAhead(double seconds) {
+  g_sound_mixer_state.decoder.SetReadAhead(seconds);
+}
+
+void SetSoundResamplerQuality(SoundResamplerQuality quality) {
+  g_sound_mixer_state.resampler_quality.store(quality);
+}
+
+void SetMaxSoundVoices(Si32 count) {
+  g_sound_mixer_state.max_voices.store(count);
+}
+
+void SetSoundDuplicateInterval(double seconds) {
+  g_sound_mixer_state.duplicate_interval_us.store(
+    static_cast<Si64>(seconds * 1000000.0));
+}
+
+/// @brief Advances the playing sounds by the time passed since the last call
+/// without mixing them, so IsPlaying() changes as it would with a device.
+static void PlayToNullDevice() {
+  const double time = GetEngine()->GetTime();
+  const Si32 samples = static_cast<Si32>((time - g_sound_time) * 44100.0);
+  if (samples <= 0) {
+    return;
+  }
+  g_sound_time += static_cast<double>(samples) / 44100.0;
+  g_sound_mixer_state.InputTasksToMixerThread();
+  std::vector<SoundBuffer> &buffers = g_sound_mixer_state.buffers;
+  size_t idx = 0;
+  while (idx < buffers.size()) {
+    SoundBuffer &sound = buffers[idx];
+    if (!sound.Skip(samples)) {
+      sound.sound.GetInstance()->DecPlaying();
+      buffers[idx] = buffers.back();
+      buffers.pop_back();
+    } else {
+      ++idx;
+    }
+  }
+}
+
+void ExitProgram(Si32 exit_code) {
+  arctic::g_sound_player.Deinitialize();
+  arctic::StopLogger();
+
+  exit(exit_code);
+}
+
+void Swap() {
+  ++g_frame_count;
+  if (!g_dump_prefix.empty() && g_frame_count % g_dump_every == 0) {
+    char number[32];
+    snprintf(number, sizeof(number), "%06lld.tga",
+      static_cast<long long>(g_frame_count));
+    GetEngine()->GetBackbuffer().Save(g_dump_prefix + number);
+  }
+  PlayToNullDevice();
+  arctic::GetEngine()->OnWindowResize(g_window_width, g_window_height);
+  if (g_frame_limit > 0 && g_frame_count >= g_frame_limit) {
+    ExitProgram(0);
+  }
+}
+
+bool IsVSyncSupported() {
+  return false;
+}
+
+bool SetVSync(bool/* is_enable*/) {
+  return false;
+}
+
+bool IsFullScreen() {
+  return false;
+}
+
+void SetFullScreen(bool/* is_enable*/) {
+  return;
+}
+
+void SetCursorVisible(bool/* is_enable*/) {
+  return;
+}
+
+}  // namespace arctic
+
+// The headless build does not link libGL, so the engine's GL calls land
+// on a null device: it hands out object names, reports every shader and
+// framebuffer as complete and draws nothing.
+extern "C" {
+
+static GLuint g_null_gl_name = 0;
+
+static void GenNullGlNames(GLsizei n, GLuint *names) {
+  for (GLsizei i = 0; i < n; ++i) {
+    names[i] = ++g_null_gl_name;
+  }
+}
+
+static void GetNullGlStatus(GLenum pname, GLint *params) {
+  *params = (pname == GL_COMPILE_STATUS || pname == GL_LINK_STATUS)
+    ? GL_TRUE : 0;
+}
+
+void glActiveTexture(GLenum) {}
+void glAttachShader(GLuint, GLuint) {}
+void glBindAttribLocation(GLuint, GLuint, const GLchar *) {}
+void glBindBuffer(GLenum, GLuint) {}
+void glBindFramebuffer(GLenum, GLuint) {}
+void glBindTexture(GLenum, GLuint) {}
+void glBlendFunc(GLenum, GLenum) {}
+void glBufferData(GLenum, GLsizeiptr, const void *, GLenum) {}
+void glBufferSubData(GLenum, GLintptr, GLsizeiptr, const void *) {}
+void glClear(GLbitfield) {}
+void glClearColor(GLclampf, GLclampf, GLclampf, GLclampf) {}
+void glCompileShader(GLuint) {}
+void glDeleteBuffers(GLsizei, const GLuint *) {}
+void glDeleteFramebuffers(GLsizei, const GLuint *) {}
+void glDeleteProgram(GLuint) {}
+void glDeleteShader(GLuint) {}
+void glDeleteTextures(GLsizei, const GLuint *) {}
+void glDisable(GLenum) {}
+void glDisableVertexAttribArray(GLuint) {}
+void glDrawArrays(GLenum, GLint, GLsizei) {}
+void glEnable(GLenum) {}
+void glEnableVertexAttribArray(GLuint) {}
+void glFramebufferTexture2D(GLenum, GLenum, GLenum, GLuint, GLint) {}
+void glLinkProgram(GLuint) {}
+void glPixelStorei(GLenum, GLint) {}
+void glReadPixels(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, GLvoid *) {}
+void glScissor(GLint, GLint, GLsizei, GLsizei) {}
+void glShaderSource(GLuint, GLsizei, const GLchar *const *, const GLint *) {}
+void glTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum,
+    GLenum, const GLvoid *) {}
+void glTexParameteri(GLenum, GLenum, GLint) {}
+void glTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum,
+    GLenum, const GLvoid *) {}
+void glUniform1f(GLint, GLfloat) {}
+void glUniform1i(GLint, GLint) {}
+void glUniform2f(GLint, GLfloat, GLfloat) {}
+void glUniform2i(GLint, GLint, GLint) {}
+void glUniform3f(GLint, GLfloat, GLfloat, GLfloat) {}
+void glUniform3i(GLint, GLint, GLint, GLint) {}
+void glUniform4f(GLint, GLfloat, GLfloat, GLfloat, GLfloat) {}
+void glUniform4i(GLint, GLint, GLint, GLint, GLint) {}
+void glUseProgram(GLuint) {}
+void glVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei,
+    const void *) {}
+void glViewport(GLint, GLint, GLsizei, GLsizei) {}
+
+void glGenBuffers(GLsizei n, GLuint *buffers) {
+  GenNullGlNames(n, buffers);
+}
+
+void glGenFramebuffers(GLsizei n, GLuint *framebuffers) {
+  GenNullGlNames(n, framebuffers);
+}
+
+void glGenTextures(GLsizei n, GLuint *textures) {
+  GenNullGlNames(n, textures);
+}
+
+GLuint glCreateProgram(void) {
+  return ++g_null_gl_name;
+}
+
+GLuint glCreateShader(GLenum) {
+  return ++g_null_gl_name;
+}
+
+GLenum glCheckFramebufferStatus(GLenum) {
+  return GL_FRAMEBUFFER_COMPLETE;
+}
+
+GLenum glGetError(void) {
+  return GL_NO_ERROR;
+}
+
+GLboolean glIsTexture(GLuint texture) {
+  return texture != 0 ? GL_TRUE : GL_FALSE;
+}
+
+void glGetIntegerv(GLenum pname, GLint *params) {
+  *params = (pname == GL_MAX_TEXTURE_SIZE) ? 4096 : 0;
+}
+
+void glGetShaderiv(GLuint, GLenum pname, GLint *params) {
+  GetNullGlStatus(pname, params);
+}
+
+void glGetProgramiv(GLuint, GLenum pname, GLint *params) {
+  GetNullGlStatus(pname, params);
+}
+
+void glGetShaderInfoLog(GLuint, GLsizei, GLsizei *length, GLchar *info_log) {
+  if (length) {
+    *length = 0;
+  }
+  info_log[0] = 0;
+}
+
+void glGetProgramInfoLog(GLuint, GLsizei, GLsizei *length,
+    GLchar *info_log) {
+  if (length) {
+    *length = 0;
+  }
+  info_log[0] = 0;
+}
+
+void glGetActiveUniform(GLuint, GLuint, GLsizei, GLsizei *length,
+    GLint *size, GLenum *type, GLchar *name) {
+  if (length) {
+    *length = 0;
+  }
+  *size = 0;
+  *type = 0;
+  name[0] = 0;
+}
+
+// Every name is a valid uniform, so the uniform setters reach the no-op
+// glUniform* calls instead of failing the lookup.
+GLint glGetUniformLocation(GLuint, const GLchar *name) {
+  static std::map<std::string, GLint> locations;
+  auto it = locations.emplace(name, static_cast<GLint>(locations.size()));
+  return it.first->second;
+}
+
+}  // extern "C"
+
+#ifndef ARCTIC_NO_MAIN
+namespace arctic {
+  void PrepareForTheEasyMainCall();
+}
+
+int main(int argc, char **argv) {
+  arctic::StartLogger();
+  arctic::ReadHeadlessSettings();
+  arctic::g_sound_player.Initialize();
+  arctic::GetEngine();
+  arctic::GetEngine()->SetArgcArgv(argc,
+    const_cast<const char **>(argv));
+  arctic::GetEngine()->Init(arctic::g_window_width,
+      arctic::g_window_height);
+
+  arctic::PrepareForTheEasyMainCall();
+  EasyMain();
+
+  arctic::g_sound_player.Deinitialize();
+  arctic::StopLogger();
+
+  return 0;
+}
+#endif  // ARCTIC_NO_MAIN
+
+#endif  // ARCTIC_PLATFORM_HEADLESS
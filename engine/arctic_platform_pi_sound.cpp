@@ -25,7 +25,7 @@
 
 #include "engine/arctic_platform_def.h"
 
-#ifdef ARCTIC_PLATFORM_PI
+#if defined(ARCTIC_PLATFORM_PI) && !defined(ARCTIC_PLATFORM_HEADLESS)
 
 #include <alsa/asoundlib.h>
 #include <alsa/control.h>
@@ -36,6 +36,7 @@
 #include <thread>  // NOLINT
 #include <vector>
 
+#include "engine/arctic_mix_kernel.h"
 #include "engine/arctic_mixer.h"
 #include "engine/arctic_platform_sound.h"
 #include "engine/arctic_platform_fatal.h"
@@ -118,11 +119,14 @@ bool SoundCheck(bool condition, const char *error_message,
   return false;
 }
 
-void StartSoundBuffer(Sound sound, float volume) {
-  if (sound.GetInstance()) {
+void StartSoundBuffer(Sound sound, float volume, float pitch,
+    Si32 priority) {
+  if (sound.GetInstance() && !g_sound_mixer_state.IsDuplicate(&sound)) {
     SoundBuffer buffer;
     buffer.sound = sound;
     buffer.volume = volume;
+    buffer.pitch = pitch;
+    buffer.priority = priority;
     buffer.next_position = 0;
     buffer.sound.GetInstance()->IncPlaying();
     buffer.action = SoundBuffer::kStart;
@@ -149,6 +153,23 @@ float GetMasterVolume() {
   return g_sound_mixer_state.master_volume.load();
 }
 
+void SetSoundReadAhead(double seconds) {
+  g_sound_mixer_state.decoder.SetReadAhead(seconds);
+}
+
+void SetSoundResamplerQuality(SoundResamplerQuality quality) {
+  g_sound_mixer_state.resampler_quality.store(quality);
+}
+
+void SetMaxSoundVoices(Si32 count) {
+  g_sound_mixer_state.max_voices.store(count);
+}
+
+void SetSoundDuplicateInterval(double seconds) {
+  g_sound_mixer_state.duplicate_interval_us.store(
+    static_cast<Si64>(seconds * 1000000.0));
+}
+
 static unsigned int g_buffer_time_us = 50000;
 static unsigned int g_period_time_us = 10000;
 
@@ -171,49 +192,36 @@ void MixSound() {
   Si32 buffer_samples_total = data->period_size * 2;
   Si32 buffer_bytes = data->period_size * 4;
 
-  float master_volume = 1.0f;
-  {
-    memset(data->mix.data(), 0, 2 * buffer_bytes);
+  static const MixAddFunc mix_add = GetMixAddFunc();
+  static const MixPackFunc mix_pack = GetMixPackFunc();
 
-    g_sound_mixer_state.InputTasksToMixerThread();
+  memset(data->mix.data(), 0, 2 * buffer_bytes);
 
-    master_volume = g_sound_mixer_state.master_volume.load();
+  g_sound_mixer_state.InputTasksToMixerThread();
+  g_sound_mixer_state.UpdateVoices(data->period_size);
 
-    for (Ui32 idx = 0;
-        idx < g_sound_mixer_state.buffers.size(); ++idx) {
-      SoundBuffer &sound = g_sound_mixer_state.buffers[idx];
+  float master_volume = g_sound_mixer_state.master_volume.load();
 
-      Ui32 size = data->period_size;
-      size = sound.sound.StreamOut(sound.next_position, size,
-          data->tmp.data(), buffer_samples_total);
-      Si16 *in_data = data->tmp.data();
-      for (Ui32 i = 0; i < size; ++i) {
-        data->mix[i * 2] += static_cast<Si32>(
-            static_cast<float>(in_data[i * 2]) * sound.volume);
-        data->mix[i * 2 + 1] += static_cast<Si32>(
-            static_cast<float>(in_data[i * 2 + 1]) * sound.volume);
-        ++sound.next_position;
-      }
+  for (Ui32 idx = 0;
+      idx < g_sound_mixer_state.buffers.size(); ++idx) {
+    SoundBuffer &sound = g_sound_mixer_state.buffers[idx];
 
-      if (sound.next_position == sound.sound.DurationSamples()
-          || size == 0) {
-        sound.sound.GetInstance()->DecPlaying();
-        g_sound_mixer_state.buffers[idx] =
-          g_sound_mixer_state.buffers[
-          g_sound_mixer_state.buffers.size() - 1];
-        g_sound_mixer_state.buffers.pop_back();
-        --idx;
-      }
+    Si32 size = g_sound_mixer_state.Render(&sound, data->period_size,
+      data->tmp.data(), buffer_samples_total);
+    mix_add(data->mix.data(), data->tmp.data(), size * 2,
+      MixGain(sound.volume * master_volume));
+
+    if (size < data->period_size) {
+      sound.sound.GetInstance()->DecPlaying();
+      g_sound_mixer_state.buffers[idx] =
+        g_sound_mixer_state.buffers[
+        g_sound_mixer_state.buffers.size() - 1];
+      g_sound_mixer_state.buffers.pop_back();
+      --idx;
     }
   }
 
-  unsigned char *out_buffer = (unsigned char *)data->samples.data();
-  for (Ui32 i = 0; i < buffer_samples_total; ++i) {
-    float val = static_cast<float>(data->mix[i]) * master_volume;
-    Si16 res = static_cast<Si16>(std::min(std::max(val, -32767.0f), 32767.0f));
-    out_buffer[i * 2 + 0] = res & 0xff;
-    out_buffer[i * 2 + 1] = (res >> 8) & 0xff;
-  }
+  mix_pack(data->samples.data(), data->mix.data(), buffer_samples_total);
 }
 
 static void SoundMixerCallback(snd_async_handler_t *ahandler) {
@@ -324,8 +332,9 @@ void StartSoundMixer(const char* output_device_name) {
   if (!is_ok) {
     return;
   }
-  err = snd_pcm_hw_params_set_rate_resample(g_data.handle, hwparams, 1);
-  is_ok = is_ok && SoundCheck(err >= 0, "Can't set sound resampling: ",
+  // The mixer resamples the sounds itself, so the plug layer is not needed.
+  err = snd_pcm_hw_params_set_rate_resample(g_data.handle, hwparams, 0);
+  is_ok = is_ok && SoundCheck(err >= 0, "Can't disable sound resampling: ",
       snd_strerror(err));
   if (!is_ok) {
     return;
@@ -352,13 +361,12 @@ void StartSoundMixer(const char* output_device_name) {
   }
   unsigned int rate = 44100;
   err = snd_pcm_hw_params_set_rate_near(g_data.handle, hwparams, &rate, 0);
-  is_ok = is_ok && SoundCheck(err >= 0, "Can't set 44100 Hz rate for sound: ",
+  is_ok = is_ok && SoundCheck(err >= 0, "Can't set sound rate: ",
       snd_strerror(err));
-  is_ok = is_ok && SoundCheck(rate == 44100,
-      "Sound output rate doesn't match requested 44100 Hz.");
   if (!is_ok) {
     return;
   }
+  g_sound_mixer_state.output_rate.store(static_cast<Si32>(rate));
   int dir;
   err = snd_pcm_hw_params_set_buffer_time_near(g_data.handle, hwparams,
       &g_buffer_time_us, &dir);
@@ -524,4 +532,4 @@ std::deque<AudioDeviceInfo> SoundPlayerImpl::GetDeviceList() {
 
 
 
-#endif  // ARCTIC_PLATFORM_PI
+#endif  // defined(ARCTIC_PLATFORM_PI) && !defined(ARCTIC_PLATFORM_HEADLESS)
@@ -26,6 +26,7 @@
 #include <deque>
 #include <string>
 
+#include "engine/arctic_resampler.h"
 #include "engine/easy_sound.h"
 
 namespace arctic {
@@ -71,7 +72,9 @@ class SoundPlayer {
 /// @param sound Sound to play
 /// @param volume Volume to play the sound at.
 /// 0.f is silent, 1.f is the original record level.
-void StartSoundBuffer(Sound sound, float volume);
+/// @param pitch Playback speed, 1.f is the original.
+/// @param priority Voices with higher priority are mixed first.
+void StartSoundBuffer(Sound sound, float volume, float pitch, Si32 priority);
 
 /// @brief Stops playback of a sound
 /// @param sound Sound to play
@@ -89,6 +92,27 @@ void SetMasterVolume(float volume);
 /// @return The master volume level
 float GetMasterVolume();
 
+/// @brief Sets how far ahead of the playback the compressed sounds are
+/// decoded on a background thread, 0.25 seconds by default.
+/// Affects the sounds started afterwards.
+/// @param seconds Read-ahead time, 0 decodes on the mixer thread.
+void SetSoundReadAhead(double seconds);
+
+/// @brief Sets the interpolation used to convert the sounds to the output
+/// sample rate and pitch, kSoundResamplerLinear by default.
+/// Affects the sounds started afterwards.
+void SetSoundResamplerQuality(SoundResamplerQuality quality);
+
+/// @brief Sets the number of voices mixed at once, 128 by default.
+/// The voices over the limit with the lowest priority, and the silent ones,
+/// keep their position advancing without being mixed.
+void SetMaxSoundVoices(Si32 count);
+
+/// @brief Sets the time during which a repeated start of the same sound
+/// is ignored, 0 by default.
+/// @param seconds The interval, 0 allows any number of starts.
+void SetSoundDuplicateInterval(double seconds);
+
 /// @}
 
 }  // namespace arctic
@@ -80,6 +80,7 @@ PFNGLCREATESHADERPROC glCreateShader = nullptr;
 PFNGLDELETEPROGRAMPROC glDeleteProgram = nullptr;
 PFNGLDELETESHADERPROC glDeleteShader = nullptr;
 PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArray = nullptr;
+PFNGLGETACTIVEUNIFORMPROC glGetActiveUniform = nullptr;
 PFNGLGETPROGRAMIVPROC glGetProgramiv = nullptr;
 PFNGLGETPROGRAMINFOLOGPROC glGetProgramInfoLog = nullptr;
 PFNGLGETSHADERIVPROC glGetShaderiv = nullptr;
@@ -108,6 +109,16 @@ PFNGLDELETEBUFFERSPROC glDeleteBuffers = nullptr;
 PFNGLBINDBUFFERPROC glBindBuffer = nullptr;
 PFNGLBUFFERDATAPROC glBufferData = nullptr;
 PFNGLBUFFERSUBDATAPROC glBufferSubData = nullptr;
+PFNGLMAPBUFFERRANGEPROC glMapBufferRange = nullptr;
+PFNGLUNMAPBUFFERPROC glUnmapBuffer = nullptr;
+PFNGLFENCESYNCPROC glFenceSync = nullptr;
+PFNGLCLIENTWAITSYNCPROC glClientWaitSync = nullptr;
+PFNGLDELETESYNCPROC glDeleteSync = nullptr;
+PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisor = nullptr;
+PFNGLDRAWARRAYSINSTANCEDPROC glDrawArraysInstanced = nullptr;
+PFNGLGETPROGRAMBINARYPROC glGetProgramBinary = nullptr;
+PFNGLPROGRAMBINARYPROC glProgramBinary = nullptr;
+PFNGLPROGRAMPARAMETERIPROC glProgramParameteri = nullptr;
 
 namespace arctic {
 
@@ -561,6 +572,11 @@ void LoadGlFunction(const char* name, T *out_ptr) {
   Check(*out_ptr != nullptr, "Error loading function: ", name);
 }
 
+template<class T>
+void LoadOptionalGlFunction(const char* name, T *out_ptr) {
+  *out_ptr = reinterpret_cast<T>(wglGetProcAddress(name));
+}
+
 void LoadGl() {
   LoadGlFunction("glActiveTexture", &glActiveTexture);
   LoadGlFunction("glAttachShader", &glAttachShader);
@@ -571,6 +587,7 @@ void LoadGl() {
   LoadGlFunction("glDeleteProgram", &glDeleteProgram);
   LoadGlFunction("glDeleteShader", &glDeleteShader);
   LoadGlFunction("glEnableVertexAttribArray", &glEnableVertexAttribArray);
+  LoadGlFunction("glGetActiveUniform", &glGetActiveUniform);
   LoadGlFunction("glGetProgramiv", &glGetProgramiv);
   LoadGlFunction("glGetProgramInfoLog", &glGetProgramInfoLog);
   LoadGlFunction("glGetShaderiv", &glGetShaderiv);
@@ -599,6 +616,16 @@ void LoadGl() {
   LoadGlFunction("glBindBuffer", &glBindBuffer);
   LoadGlFunction("glBufferData", &glBufferData);
   LoadGlFunction("glBufferSubData", &glBufferSubData);
+  LoadOptionalGlFunction("glMapBufferRange", &glMapBufferRange);
+  LoadOptionalGlFunction("glUnmapBuffer", &glUnmapBuffer);
+  LoadOptionalGlFunction("glFenceSync", &glFenceSync);
+  LoadOptionalGlFunction("glClientWaitSync", &glClientWaitSync);
+  LoadOptionalGlFunction("glDeleteSync", &glDeleteSync);
+  LoadOptionalGlFunction("glVertexAttribDivisor", &glVertexAttribDivisor);
+  LoadOptionalGlFunction("glDrawArraysInstanced", &glDrawArraysInstanced);
+  LoadOptionalGlFunction("glGetProgramBinary", &glGetProgramBinary);
+  LoadOptionalGlFunction("glProgramBinary", &glProgramBinary);
+  LoadOptionalGlFunction("glProgramParameteri", &glProgramParameteri);
 }
 
 bool CreateMainWindow(HINSTANCE instance_handle, int cmd_show,
@@ -53,6 +53,7 @@
 #include "engine/easy.h"
 #include "engine/arctic_input.h"
 #include "engine/arctic_platform.h"
+#include "engine/arctic_mix_kernel.h"
 #include "engine/arctic_mixer.h"
 #include "engine/log.h"
 #include "engine/rgb.h"
@@ -104,11 +105,14 @@ SoundPlayer::~SoundPlayer() {
 
 
 
-void StartSoundBuffer(Sound sound, float volume) {
-  if (sound.GetInstance()) {
+void StartSoundBuffer(Sound sound, float volume, float pitch,
+    Si32 priority) {
+  if (sound.GetInstance() && !g_sound_mixer_state.IsDuplicate(&sound)) {
     SoundBuffer buffer;
     buffer.sound = sound;
     buffer.volume = volume;
+    buffer.pitch = pitch;
+    buffer.priority = priority;
     buffer.next_position = 0;  //-V1048
     buffer.sound.GetInstance()->IncPlaying();
     buffer.action = SoundBuffer::kStart;  //-V1048
@@ -135,6 +139,23 @@ float GetMasterVolume() {
   return g_sound_mixer_state.master_volume.load();
 }
 
+void SetSoundReadAhead(double seconds) {
+  g_sound_mixer_state.decoder.SetReadAhead(seconds);
+}
+
+void SetSoundResamplerQuality(SoundResamplerQuality quality) {
+  g_sound_mixer_state.resampler_quality.store(quality);
+}
+
+void SetMaxSoundVoices(Si32 count) {
+  g_sound_mixer_state.max_voices.store(count);
+}
+
+void SetSoundDuplicateInterval(double seconds) {
+  g_sound_mixer_state.duplicate_interval_us.store(
+    static_cast<Si64>(seconds * 1000000.0));
+}
+
 void SoundMixerThreadFunction() {
   Si32 bytes_per_sample = 2;
 
@@ -142,6 +163,8 @@ void SoundMixerThreadFunction() {
   format.wFormatTag = WAVE_FORMAT_PCM;
   format.nChannels = 2;
   format.nSamplesPerSec = 44100;
+  g_sound_mixer_state.output_rate.store(
+    static_cast<Si32>(format.nSamplesPerSec));
   format.nAvgBytesPerSec =
     bytes_per_sample * format.nChannels * format.nSamplesPerSec;
   format.nBlockAlign = bytes_per_sample * format.nChannels;
@@ -193,7 +216,9 @@ void SoundMixerThreadFunction() {
   std::vector<WAVEHDR> wave_headers(buffer_count);
   std::vector<std::vector<Si16>> wave_buffers(buffer_count);
   std::vector<Si16> tmp(buffer_samples_total);
-  std::vector<float> mix(buffer_samples_total);
+  std::vector<Si32> mix(buffer_samples_total);
+  const MixAddFunc mix_add = GetMixAddFunc();
+  const MixPackFunc mix_pack = GetMixPackFunc();
   memset(&(mix[0]), 0, 2 * size_t(buffer_bytes));
   for (Ui32 i = 0; i < wave_headers.size(); ++i) {
     wave_buffers[i].resize(buffer_samples_total);
@@ -222,6 +247,8 @@ void SoundMixerThreadFunction() {
     }
 
     g_sound_mixer_state.InputTasksToMixerThread();
+    g_sound_mixer_state.UpdateVoices(
+      static_cast<Si32>(buffer_samples_per_channel));
 
     (*(volatile DWORD*)&wave_headers[cur_buffer_idx].dwFlags) &= ~WHDR_DONE;
 
@@ -231,17 +258,11 @@ void SoundMixerThreadFunction() {
       idx < g_sound_mixer_state.buffers.size(); ++idx) {
       SoundBuffer &sound = g_sound_mixer_state.buffers[idx];
 
-      Ui32 size = buffer_samples_per_channel;
-      size = sound.sound.StreamOut(sound.next_position, size,
-        tmp.data(), buffer_samples_total);
-      Si16 *in_data = tmp.data();
-      for (Ui32 i = 0; i < size; ++i) {
-        mix[size_t(i) * 2] +=
-          static_cast<float>(in_data[i * 2]) * sound.volume;
-        mix[size_t(i) * 2 + 1] +=
-          static_cast<float>(in_data[i * 2 + 1]) * sound.volume;
-      }
-      sound.next_position += size;
+      Ui32 size = static_cast<Ui32>(g_sound_mixer_state.Render(&sound,
+        static_cast<Si32>(buffer_samples_per_channel), tmp.data(),
+        static_cast<Si32>(buffer_samples_total)));
+      mix_add(mix.data(), tmp.data(), static_cast<Si32>(size) * 2,
+        MixGain(sound.volume * master_volume));
 
       if (size < buffer_samples_per_channel) {
         sound.sound.GetInstance()->DecPlaying();
@@ -253,11 +274,8 @@ void SoundMixerThreadFunction() {
       }
     }
 
-    Si16* out_data = &(wave_buffers[cur_buffer_idx][0]);
-    for (Ui32 i = 0; i < buffer_samples_total; ++i) {
-      out_data[i] = static_cast<Si16>(Clamp(
-        mix[i] * master_volume, -32767.f, 32767.f));
-    }
+    mix_pack(&(wave_buffers[cur_buffer_idx][0]), mix.data(),
+      static_cast<Si32>(buffer_samples_total));
 
     waveOutWrite(wave_out_handle,
       &wave_headers[cur_buffer_idx], sizeof(WAVEHDR));
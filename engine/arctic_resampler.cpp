@@ -0,0 +1,231 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/arctic_resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace arctic {
+
+namespace {
+
+const Si32 kSincHalfTaps = 8;
+const Si32 kSincTaps = 2 * kSincHalfTaps;
+const Si32 kPhaseBits = 8;
+const Si32 kPhases = 1 << kPhaseBits;
+const Si32 kFilterBits = 14;
+// Downsampling needs a lower cutoff to avoid aliasing, each table serves
+// the steps up to its limit.
+const double kStepLimits[] = {1.0, 1.25, 1.5, 2.0, 3.0, 4.0, 6.0, 8.0};
+const Si32 kStepLimitCount = sizeof(kStepLimits) / sizeof(kStepLimits[0]);
+
+struct SincTables {
+  Si16 coefficients[kStepLimitCount][kPhases][kSincTaps];
+
+  SincTables() {
+    const double pi = 3.14159265358979323846;
+    for (Si32 limit = 0; limit < kStepLimitCount; ++limit) {
+      const double cutoff = 0.9 / kStepLimits[limit];
+      for (Si32 phase = 0; phase < kPhases; ++phase) {
+        const double fraction = static_cast<double>(phase) / kPhases;
+        double h[kSincTaps];
+        double sum = 0.0;
+        for (Si32 tap = 0; tap < kSincTaps; ++tap) {
+          double x = static_cast<double>(tap - kSincHalfTaps + 1) - fraction;
+          double u = x / kSincHalfTaps;
+          double window = 0.42 + 0.5 * std::cos(pi * u)
+            + 0.08 * std::cos(2.0 * pi * u);
+          double sinc = (x == 0.0) ? 1.0 :
+            std::sin(pi * cutoff * x) / (pi * cutoff * x);
+          h[tap] = std::abs(u) < 1.0 ? cutoff * sinc * window : 0.0;
+          sum += h[tap];
+        }
+        // Rows sum to exactly 1.0 so a constant signal passes unchanged.
+        Si32 total = 0;
+        for (Si32 tap = 0; tap < kSincTaps; ++tap) {
+          Si32 c = static_cast<Si32>(std::lround(
+            h[tap] / sum * (1 << kFilterBits)));
+          coefficients[limit][phase][tap] = static_cast<Si16>(c);
+          total += c;
+        }
+        coefficients[limit][phase][kSincHalfTaps - 1] = static_cast<Si16>(
+          coefficients[limit][phase][kSincHalfTaps - 1]
+          + (1 << kFilterBits) - total);
+      }
+    }
+  }
+};
+
+const Si16 *GetSincFilter(double step) {
+  static const SincTables tables;
+  Si32 limit = 0;
+  while (limit < kStepLimitCount - 1 && step > kStepLimits[limit]) {
+    ++limit;
+  }
+  return &tables.coefficients[limit][0][0];
+}
+
+inline Si16 Saturate(Si32 value) {
+  return static_cast<Si16>(std::min(std::max(value, -32768), 32767));
+}
+
+}  // namespace
+
+void SoundResampler::Start(Si32 source_rate, Si32 output_rate, float pitch,
+    SoundResamplerQuality quality) {
+  pitch = std::min(std::max(pitch, kMinPitch), kMaxPitch);
+  step_ = kOne;
+  if (source_rate > 0 && output_rate > 0) {
+    step_ = std::max<Si64>(1, std::llround(static_cast<double>(source_rate)
+      * static_cast<double>(pitch) / output_rate
+      * static_cast<double>(kOne)));
+  }
+  quality_ = quality;
+  if (quality_ == kSoundResamplerSinc) {
+    half_taps_ = kSincHalfTaps;
+    filter_ = GetSincFilter(static_cast<double>(step_) / kOne);
+  } else {
+    half_taps_ = 1;
+    filter_ = nullptr;
+  }
+  time_ = 0;
+  read_ = 0;
+  end_ = -1;
+  memset(history_, 0, sizeof(history_));
+}
+
+Si32 SoundResampler::Render(SoundSourceFunc source, void *context,
+    Si16 *out, Si32 count, Si16 *scratch, Si32 scratch_frames) {
+  if (IsPassThrough()) {
+    if (end_ >= 0) {
+      return 0;
+    }
+    Si32 got = source(context, out, count);
+    if (got < count) {
+      end_ = read_ + got;
+    }
+    read_ += got;
+    time_ += got * kOne;
+    return got;
+  }
+
+  const Si32 history = 2 * half_taps_;
+  // The sinc filter takes the nearest phase, so it may need the next frame.
+  const Si64 rounding = quality_ == kSoundResamplerSinc ?
+    (kOne >> (kPhaseBits + 1)) : 0;
+  Si32 produced = 0;
+  while (produced < count) {
+    if (end_ >= 0 && (time_ >> 32) >= end_) {
+      break;
+    }
+    // The scratch holds the history followed by the new source frames.
+    memcpy(scratch, history_, sizeof(Si16) * 2 * history);
+    Si64 last = (time_ + rounding + (count - produced - 1) * step_) >> 32;
+    Si32 frames = static_cast<Si32>(std::min<Si64>(
+      std::max<Si64>(last + half_taps_ + 1 - read_, 0),
+      scratch_frames - history));
+    Si16 *fresh = scratch + 2 * history;
+    Si32 got = 0;
+    if (end_ < 0 && frames > 0) {
+      got = source(context, fresh, frames);
+      if (got < frames) {
+        end_ = read_ + got;
+      }
+    }
+    memset(fresh + 2 * got, 0, sizeof(Si16) * 2 * (frames - got));
+    const Si64 base = read_ - history;
+    read_ += frames;
+
+    Si32 n = 0;
+    Si16 *to = out + 2 * produced;
+    if (quality_ == kSoundResamplerSinc) {
+      while (produced + n < count) {
+        if (end_ >= 0 && (time_ >> 32) >= end_) {
+          break;
+        }
+        Si64 t = time_ + rounding;
+        Si64 i = t >> 32;
+        if (i + half_taps_ >= read_) {
+          break;
+        }
+        Si32 phase = static_cast<Si32>(t >> (32 - kPhaseBits)) & (kPhases - 1);
+        const Si16 *h = filter_ + phase * kSincTaps;
+        const Si16 *s = scratch + 2 * (i - base - kSincHalfTaps + 1);
+        Si32 left = 0;
+        Si32 right = 0;
+        for (Si32 tap = 0; tap < kSincTaps; ++tap) {
+          left += s[2 * tap] * h[tap];
+          right += s[2 * tap + 1] * h[tap];
+        }
+        const Si32 half = 1 << (kFilterBits - 1);
+        to[2 * n] = Saturate((left + half) >> kFilterBits);
+        to[2 * n + 1] = Saturate((right + half) >> kFilterBits);
+        time_ += step_;
+        ++n;
+      }
+    } else {
+      while (produced + n < count) {
+        if (end_ >= 0 && (time_ >> 32) >= end_) {
+          break;
+        }
+        Si64 i = time_ >> 32;
+        if (i + 1 >= read_) {
+          break;
+        }
+        Si32 fraction = static_cast<Si32>(time_ >> 17) & 0x7fff;
+        const Si16 *s = scratch + 2 * (i - base);
+        to[2 * n] = static_cast<Si16>(
+          s[0] + (((s[2] - s[0]) * fraction) >> 15));
+        to[2 * n + 1] = static_cast<Si16>(
+          s[1] + (((s[3] - s[1]) * fraction) >> 15));
+        time_ += step_;
+        ++n;
+      }
+    }
+    produced += n;
+    memcpy(history_, scratch + 2 * frames, sizeof(Si16) * 2 * history);
+    if (frames == 0 && n == 0) {
+      break;
+    }
+  }
+  return produced;
+}
+
+Si32 SoundResampler::Skip(Si32 count) {
+  time_ += count * step_;
+  // The frames the filter needs for the next output frame are read anew,
+  // the history before them is not used.
+  const Si64 rounding = quality_ == kSoundResamplerSinc ?
+    (kOne >> (kPhaseBits + 1)) : 0;
+  Si64 first = IsPassThrough() ? (time_ >> 32) :
+    ((time_ + rounding) >> 32) - half_taps_ + 1;
+  if (first <= read_) {
+    return 0;
+  }
+  Si64 frames = first - read_;
+  read_ = first;
+  return static_cast<Si32>(frames);
+}
+
+}  // namespace arctic
@@ -0,0 +1,109 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_ARCTIC_RESAMPLER_H_
+#define ENGINE_ARCTIC_RESAMPLER_H_
+
+#include "engine/arctic_types.h"
+
+namespace arctic {
+
+/// @addtogroup global_sound
+/// @{
+
+enum SoundResamplerQuality {
+  kSoundResamplerLinear = 0,  ///< Linear interpolation, the cheapest.
+  kSoundResamplerSinc = 1  ///< 16-tap windowed sinc polyphase filter.
+};
+
+/// @brief Reads up to frames stereo source frames into out.
+/// @return The number of frames read, less than requested only at the end.
+typedef Si32 (*SoundSourceFunc)(void *context, Si16 *out, Si32 frames);
+
+/// @brief Converts the sample rate and the pitch of one playing voice.
+/// @details Keeps the position between the source frames and the last
+///   source frames read, so each call continues where the last one stopped.
+///   Source frames before the start and after the end are silent.
+class SoundResampler {
+ public:
+  static constexpr float kMinPitch = 1.f / 64.f;
+  static constexpr float kMaxPitch = 64.f;
+
+  /// @brief Starts a new voice at the first source frame.
+  /// @param [in] source_rate The sample rate of the sound.
+  /// @param [in] output_rate The sample rate of the mixer.
+  /// @param [in] pitch Playback speed, 2 plays twice as fast and an octave
+  ///   higher. Clamped to [kMinPitch, kMaxPitch].
+  /// @param [in] quality The interpolation to use.
+  void Start(Si32 source_rate, Si32 output_rate, float pitch,
+    SoundResamplerQuality quality);
+
+  /// @brief Returns true if the output is the source itself.
+  bool IsPassThrough() const {
+    return step_ == kOne;
+  }
+
+  /// @brief Outputs up to count stereo frames.
+  /// @param [in] source Reads the source frames that follow the last read.
+  /// @param [in] context The context passed to the source.
+  /// @param [out] out The output buffer, at least count stereo frames.
+  /// @param [in] count The number of frames to output.
+  /// @param [in] scratch The buffer for the source frames.
+  /// @param [in] scratch_frames The size of the scratch in stereo frames,
+  ///   larger than 2 * kMaxHalfTaps.
+  /// @return The number of frames output, less than count only at the end.
+  Si32 Render(SoundSourceFunc source, void *context, Si16 *out, Si32 count,
+    Si16 *scratch, Si32 scratch_frames);
+
+  /// @brief Advances by count output frames without producing them.
+  /// @return The number of source frames the reads have to skip, the next
+  ///   read continues from the frame after them.
+  Si32 Skip(Si32 count);
+
+  /// @brief Returns the source frame the next output frame is at.
+  Si64 Position() const {
+    return time_ >> 32;
+  }
+
+ private:
+  static constexpr Si64 kOne = Si64(1) << 32;
+  static constexpr Si32 kMaxHalfTaps = 8;
+
+  // The position of the next output frame in source frames, 32.32 fixed.
+  Si64 time_ = 0;
+  Si64 step_ = kOne;
+  // The index of the next source frame to read.
+  Si64 read_ = 0;
+  // The index of the source frame after the last one, -1 if not reached.
+  Si64 end_ = -1;
+  SoundResamplerQuality quality_ = kSoundResamplerLinear;
+  Si32 half_taps_ = 1;
+  const Si16 *filter_ = nullptr;
+  // The last 2 * half_taps_ source frames read.
+  Si16 history_[4 * kMaxHalfTaps] = {};
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_ARCTIC_RESAMPLER_H_
@@ -0,0 +1,196 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/arctic_sound_decoder.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <utility>
+
+namespace arctic {
+
+SoundRing::SoundRing(Sound sound, Si64 capacity_frames)
+    : sound_(std::move(sound))
+    , samples_(static_cast<size_t>(capacity_frames) * 2)
+    , capacity_(capacity_frames) {
+}
+
+void SoundRing::FillSilence(Si16 *out_buffer, Si32 from, Si32 to) {
+  if (to > from) {
+    memset(out_buffer + from * 2, 0, static_cast<size_t>(to - from) * 4);
+  }
+}
+
+Si32 SoundRing::Read(Si64 offset, Si16 *out_buffer, Si32 size) {
+  Si32 restart = restart_.load(std::memory_order_acquire);
+  if (restart == kRestartReady) {
+    read_.store(restart_position_.load(std::memory_order_relaxed),
+      std::memory_order_release);
+    restart_.store(kRestartNone, std::memory_order_release);
+    restart = kRestartNone;
+  }
+  Si64 read = read_.load(std::memory_order_relaxed);
+  if (restart == kRestartNone && offset < read) {
+    restart_position_.store(offset, std::memory_order_relaxed);
+    restart_.store(kRestartRequested, std::memory_order_release);
+    restart = kRestartRequested;
+  }
+  if (restart != kRestartNone) {
+    FillSilence(out_buffer, 0, size);
+    return size;
+  }
+
+  // The end is published after the last samples, so it is loaded first.
+  const Si64 end = end_.load(std::memory_order_acquire);
+  const Si64 written = written_.load(std::memory_order_acquire);
+  read = offset;
+  const Si32 available = static_cast<Si32>(
+    std::max<Si64>(0, std::min<Si64>(written - read, size)));
+  Si32 copied = 0;
+  while (copied < available) {
+    const Si64 slot = (read + copied) % capacity_;
+    const Si32 count = static_cast<Si32>(
+      std::min<Si64>(available - copied, capacity_ - slot));
+    memcpy(out_buffer + copied * 2, samples_.data() + slot * 2,
+      static_cast<size_t>(count) * 4);
+    copied += count;
+  }
+  Si32 result = size;
+  if (end >= 0 && read + available >= end) {
+    result = available;
+  } else {
+    // The decoder is late, the cursor moves on and it catches up.
+    FillSilence(out_buffer, available, size);
+  }
+  read_.store(read + result, std::memory_order_release);
+  return result;
+}
+
+bool SoundRing::Fill(Si32 max_frames) {
+  const Si32 restart = restart_.load(std::memory_order_acquire);
+  if (restart == kRestartReady) {
+    return false;
+  }
+  if (restart == kRestartRequested) {
+    // StreamOut seeks as the position differs from the decoder one.
+    end_.store(-1, std::memory_order_relaxed);
+    written_.store(restart_position_.load(std::memory_order_relaxed),
+      std::memory_order_relaxed);
+    restart_.store(kRestartReady, std::memory_order_release);
+    return true;
+  }
+  if (end_.load(std::memory_order_relaxed) >= 0) {
+    return false;
+  }
+  const Si64 read = read_.load(std::memory_order_acquire);
+  Si64 written = written_.load(std::memory_order_relaxed);
+  if (read - written > capacity_) {
+    written = read;
+  }
+  Si64 to_write = std::min<Si64>(max_frames,
+    std::min(capacity_, capacity_ - (written - read)));
+  if (to_write <= 0) {
+    return false;
+  }
+  while (to_write > 0) {
+    const Si64 slot = written % capacity_;
+    const Si32 count = static_cast<Si32>(
+      std::min(to_write, capacity_ - slot));
+    const Si32 decoded = sound_.StreamOut(static_cast<Si32>(written), count,
+      samples_.data() + slot * 2, count * 2, &stream_);
+    written += decoded;
+    to_write -= decoded;
+    written_.store(written, std::memory_order_release);
+    if (decoded < count) {
+      end_.store(written, std::memory_order_release);
+      break;
+    }
+  }
+  is_started_.store(true, std::memory_order_release);
+  return true;
+}
+
+SoundDecoder::~SoundDecoder() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    do_quit_ = true;
+  }
+  wake_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+std::shared_ptr<SoundRing> SoundDecoder::Open(Sound sound) {
+  const double read_ahead = read_ahead_.load();
+  if (read_ahead <= 0.0 || !sound.GetInstance()
+      || sound.GetInstance()->GetFormat() != kSoundDataVorbis) {
+    return nullptr;
+  }
+  const Si64 capacity = std::max<Si64>(kFramesPerFill,
+    static_cast<Si64>(read_ahead * sound.SampleRate()));
+  std::shared_ptr<SoundRing> ring = std::make_shared<SoundRing>(
+    std::move(sound), capacity);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    added_.push_back(ring);
+    if (!thread_.joinable()) {
+      thread_ = std::thread(&SoundDecoder::ThreadFunction, this);
+    }
+  }
+  wake_.notify_one();
+  return ring;
+}
+
+void SoundDecoder::ThreadFunction() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!do_quit_) {
+    rings_.insert(rings_.end(), added_.begin(), added_.end());
+    added_.clear();
+    lock.unlock();
+
+    bool is_busy = false;
+    for (size_t idx = 0; idx < rings_.size(); ) {
+      // The voice is gone, the decoder is freed here and not on the mixer
+      // thread.
+      if (rings_[idx].use_count() == 1) {
+        rings_[idx] = std::move(rings_.back());
+        rings_.pop_back();
+        continue;
+      }
+      is_busy = rings_[idx]->Fill(kFramesPerFill) || is_busy;
+      ++idx;
+    }
+
+    lock.lock();
+    if (!is_busy) {
+      // The mixer consumes a period every few milliseconds.
+      wake_.wait_for(lock, std::chrono::milliseconds(5), [this] {
+        return do_quit_ || !added_.empty();
+      });
+    }
+  }
+  rings_.clear();
+}
+
+}  // namespace arctic
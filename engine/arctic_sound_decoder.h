@@ -0,0 +1,121 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_ARCTIC_SOUND_DECODER_H_
+#define ENGINE_ARCTIC_SOUND_DECODER_H_
+
+#include <atomic>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/easy_sound.h"
+
+namespace arctic {
+
+/// @addtogroup global_sound
+/// @{
+
+/// @brief Decoded samples of one playing voice. The decoder thread fills it
+/// ahead of the play cursor, the mixer thread reads it without locks.
+/// @details Frames are indexed by their position in the sound, so a voice
+/// that skips forward simply moves its cursor and the decoder catches up.
+/// A jump back is a restart the decoder has to acknowledge.
+class SoundRing {
+  enum RestartState {
+    kRestartNone = 0,
+    kRestartRequested = 1,
+    kRestartReady = 2
+  };
+
+  // Decoder thread only
+  Sound sound_;
+  SoundStream stream_;
+  // Shared
+  std::vector<Si16> samples_;
+  Si64 capacity_;
+  std::atomic<Si64> written_ = ATOMIC_VAR_INIT(0);
+  std::atomic<Si64> read_ = ATOMIC_VAR_INIT(0);
+  std::atomic<Si64> end_ = ATOMIC_VAR_INIT(-1);
+  std::atomic<Si32> restart_ = ATOMIC_VAR_INIT(kRestartNone);
+  std::atomic<Si64> restart_position_ = ATOMIC_VAR_INIT(0);
+  std::atomic<bool> is_started_ = ATOMIC_VAR_INIT(false);
+
+  void FillSilence(Si16 *out_buffer, Si32 from, Si32 to);
+
+ public:
+  SoundRing(Sound sound, Si64 capacity_frames);
+
+  /// @brief Mixer thread. Outputs up to size stereo samples starting at the
+  ///   offset. Samples not decoded yet are output as silence.
+  /// @return The number of samples output, less than size only at the end.
+  Si32 Read(Si64 offset, Si16 *out_buffer, Si32 size);
+  /// @brief Mixer thread. Tells if the decoder has filled the ring for the
+  ///   first time, the voice waits for it instead of skipping its start.
+  bool IsStarted() const {
+    return is_started_.load(std::memory_order_acquire);
+  }
+  /// @brief Decoder thread. Decodes up to max_frames ahead of the cursor.
+  /// @return true if there was anything to do.
+  bool Fill(Si32 max_frames);
+};
+
+/// @brief Thread decoding the compressed sounds for the mixer.
+class SoundDecoder {
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::thread thread_;
+  bool do_quit_ = false;
+  std::vector<std::shared_ptr<SoundRing>> added_;
+  // Decoder thread only
+  std::vector<std::shared_ptr<SoundRing>> rings_;
+  std::atomic<double> read_ahead_ = ATOMIC_VAR_INIT(0.25);
+
+  void ThreadFunction();
+
+ public:
+  static constexpr Si32 kFramesPerFill = 4096;
+
+  ~SoundDecoder();
+
+  /// @brief Starts decoding the sound for a new voice.
+  /// @return The ring to read the voice samples from, nullptr if the sound
+  ///   is not compressed or the read-ahead is 0.
+  std::shared_ptr<SoundRing> Open(Sound sound);
+  /// @brief Sets how far ahead of the play cursor the voices started
+  ///   afterwards are decoded, 0 decodes on the mixer thread.
+  void SetReadAhead(double seconds) {
+    read_ahead_.store(seconds);
+  }
+  double GetReadAhead() const {
+    return read_ahead_.load();
+  }
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_ARCTIC_SOUND_DECODER_H_
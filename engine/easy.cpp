@@ -39,6 +39,7 @@
 #include "engine/easy_sound.h"
 #include "engine/easy_sprite.h"
 #include "engine/easy_util.h"
+#include "engine/gl_program_cache.h"
 #include "engine/log.h"
 #include "engine/vec4si32.h"
 #include "engine/vec4f.h"
@@ -121,6 +122,9 @@ void DrawLine(Vec2Si32 a, Vec2Si32 b, Rgba color_a, Rgba color_b) {
 
 void DrawLine(Sprite to_sprite, Vec2Si32 a, Vec2Si32 b,
     Rgba color_a, Rgba color_b) {
+  GetEngine()->GetTiledRasterizer().FlushBeforeWrite(to_sprite);
+  to_sprite.MarkDirty(Vec2Si32(std::min(a.x, b.x), std::min(a.y, b.y)),
+    Vec2Si32(std::max(a.x, b.x) + 1, std::max(a.y, b.y) + 1));
   Vec2Si32 ab = b - a;
   Vec2Si32 abs_ab(std::abs(ab.x), std::abs(ab.y));
   if (abs_ab.x >= abs_ab.y) {
@@ -131,7 +135,8 @@ void DrawLine(Sprite to_sprite, Vec2Si32 a, Vec2Si32 b,
       if (ab.x == 0) {
         if (a.x >= 0 && a.x < back_size.x &&
             a.y >= 0 && a.y < back_size.y) {
-          to_sprite.RgbaData()[a.x + a.y * to_sprite.StridePixels()] = color_a;
+          to_sprite.UntrackedRgbaData()[
+            a.x + a.y * to_sprite.StridePixels()] = color_a;
         }
         return;
       }
@@ -189,7 +194,7 @@ void DrawLine(Sprite to_sprite, Vec2Si32 a, Vec2Si32 b,
             static_cast<Ui8>(rgba_1.y),
             static_cast<Ui8>(rgba_1.z),
             static_cast<Ui8>(rgba_1.w));
-          to_sprite.RgbaData()[
+          to_sprite.UntrackedRgbaData()[
             x1 + y1 * to_sprite.StridePixels()] = color;
         }
         return;
@@ -206,7 +211,7 @@ void DrawLine(Sprite to_sprite, Vec2Si32 a, Vec2Si32 b,
           static_cast<Ui8>(rgba_16.y >> 16),
           static_cast<Ui8>(rgba_16.z >> 16),
           static_cast<Ui8>(rgba_16.w >> 16));
-        to_sprite.RgbaData()[x + (y_16 >> 16) * stride] = color;
+        to_sprite.UntrackedRgbaData()[x + (y_16 >> 16) * stride] = color;
         rgba_16 += rgba_12_16_step;
         y_16 += y12_16_step;
       }
@@ -219,7 +224,7 @@ void DrawLine(Sprite to_sprite, Vec2Si32 a, Vec2Si32 b,
       if (ab.y == 0) {
         if (a.y >= 0 && a.y < back_size.y &&
           a.x >= 0 && a.x < back_size.x) {
-          to_sprite.RgbaData()[
+          to_sprite.UntrackedRgbaData()[
             a.x + a.y * to_sprite.StridePixels()] = color_a;
         }
         return;
@@ -276,7 +281,7 @@ void DrawLine(Sprite to_sprite, Vec2Si32 a, Vec2Si32 b,
         if (y2 == y1) {
           Rgba color((Ui8)rgba_1.y, (Ui8)rgba_1.x,
             (Ui8)rgba_1.z, (Ui8)rgba_1.w);
-          to_sprite.RgbaData()[
+          to_sprite.UntrackedRgbaData()[
             x1 + y1 * to_sprite.StridePixels()] = color;
         }
         return;
@@ -293,7 +298,7 @@ void DrawLine(Sprite to_sprite, Vec2Si32 a, Vec2Si32 b,
           static_cast<Ui8>(rgba_16.y >> 16u),
           static_cast<Ui8>(rgba_16.z >> 16u),
           static_cast<Ui8>(rgba_16.w >> 16u));
-        to_sprite.RgbaData()[(x_16 >> 16u) + y * stride] = color;
+        to_sprite.UntrackedRgbaData()[(x_16 >> 16u) + y * stride] = color;
         rgba_16 += rgba_12_16_step;
         x_16 += x12_16_step;
       }
@@ -388,6 +393,7 @@ void DrawTriangle(Vec2Si32 a, Vec2Si32 b, Vec2Si32 c,
 
 void DrawTriangle(Sprite to_sprite, Vec2Si32 a, Vec2Si32 b, Vec2Si32 c,
     Rgba color_a, Rgba color_b, Rgba color_c) {
+  GetEngine()->GetTiledRasterizer().FlushBeforeWrite(to_sprite);
   if (a.y > b.y) {
       std::swap(a, b);
       std::swap(color_a, color_b);
@@ -403,9 +409,13 @@ void DrawTriangle(Sprite to_sprite, Vec2Si32 a, Vec2Si32 b, Vec2Si32 c,
   if (a.y == c.y) {
       return;
   }
+  // The edges are stepped in floating point, so the bound is widened.
+  to_sprite.MarkDirty(
+    Vec2Si32(std::min(a.x, std::min(b.x, c.x)) - 1, a.y),
+    Vec2Si32(std::max(a.x, std::max(b.x, c.x)) + 2, c.y + 1));
 
   Si32 stride = to_sprite.StridePixels();
-  Rgba *dst = to_sprite.RgbaData();
+  Rgba *dst = to_sprite.UntrackedRgbaData();
   Si32 width = to_sprite.Width();
   Si32 height = to_sprite.Height();
 
@@ -513,13 +523,15 @@ void DrawRectangle(Vec2Si32 ll, Vec2Si32 ur, Rgba color) {
 }
 
 void DrawRectangle(Sprite to_sprite, Vec2Si32 ll, Vec2Si32 ur, Rgba color) {
+  GetEngine()->GetTiledRasterizer().FlushBeforeWrite(to_sprite);
   Vec2Si32 limit = to_sprite.Size();
   Si32 x1 = std::max(std::min(ll.x, ur.x), 0);
   Si32 x2 = std::min(std::max(ll.x, ur.x) + 1, limit.x);
   Si32 y1 = std::max(std::min(ll.y, ur.y), 0);
   Si32 y2 = std::min(std::max(ll.y, ur.y) + 1, limit.y);
   if (x1 < x2 && y1 < y2) {
-    Rgba *data = to_sprite.RgbaData();
+    to_sprite.MarkDirty(Vec2Si32(x1, y1), Vec2Si32(x2, y2));
+    Rgba *data = to_sprite.UntrackedRgbaData();
     Si32 stride = to_sprite.StridePixels();
     Rgba *p_begin = data + stride * y1 + x1;
     Si32 w = x2 - x1;
@@ -536,23 +548,29 @@ void DrawRectangle(Sprite to_sprite, Vec2Si32 ll, Vec2Si32 ur, Rgba color) {
 }
 
 void SetPixel(const Sprite &to_sprite, Si32 x, Si32 y, Rgba color) {
+  GetEngine()->GetTiledRasterizer().FlushBeforeWrite(to_sprite);
   Rgba *data = const_cast<Rgba*>(to_sprite.RgbaData());
   Si32 stride = to_sprite.StridePixels();
   if (x >= 0 && x < to_sprite.Width() && y >= 0 && y < to_sprite.Height()) {
+    const_cast<Sprite&>(to_sprite).MarkDirty(Vec2Si32(x, y),
+      Vec2Si32(x + 1, y + 1));
     data[x + y * stride] = color;
   }
 }
 
 void SetPixel(Si32 x, Si32 y, Rgba color) {
   Sprite to_sprite = GetEngine()->GetBackbuffer();
-  Rgba *data = to_sprite.RgbaData();
+  GetEngine()->GetTiledRasterizer().FlushBeforeWrite(to_sprite);
+  Rgba *data = to_sprite.UntrackedRgbaData();
   Si32 stride = to_sprite.StridePixels();
   if (x >= 0 && x < to_sprite.Width() && y >= 0 && y < to_sprite.Height()) {
+    to_sprite.MarkDirty(Vec2Si32(x, y), Vec2Si32(x + 1, y + 1));
     data[x + y * stride] = color;
   }
 }
 
 void ReplaceColor(Sprite to_sprite, Rgba old_color, Rgba new_color) {
+  GetEngine()->GetTiledRasterizer().FlushBeforeWrite(to_sprite);
   Rgba *data = to_sprite.RgbaData();
   Si32 stride = to_sprite.StridePixels();
   const Si32 height = to_sprite.Height();
@@ -569,6 +587,7 @@ void ReplaceColor(Sprite to_sprite, Rgba old_color, Rgba new_color) {
 }
 
 Rgba GetPixel(const Sprite &from_sprite, Si32 x, Si32 y) {
+  GetEngine()->GetTiledRasterizer().FlushBeforeRead(from_sprite);
   const Rgba *data = from_sprite.RgbaData();
   Si32 stride = from_sprite.StridePixels();
   if (x >= 0 && x < from_sprite.Width() && y >= 0 && y < from_sprite.Height()) {
@@ -579,8 +598,9 @@ Rgba GetPixel(const Sprite &from_sprite, Si32 x, Si32 y) {
 }
 
 Rgba GetPixel(Si32 x, Si32 y) {
-  Sprite from_sprite = GetEngine()->GetBackbuffer();
-  Rgba *data = from_sprite.RgbaData();
+  const Sprite &from_sprite = GetEngine()->GetBackbuffer();
+  GetEngine()->GetTiledRasterizer().FlushBeforeRead(from_sprite);
+  const Rgba *data = from_sprite.RgbaData();
   Si32 stride = from_sprite.StridePixels();
   if (x >= 0 && x < from_sprite.Width() && y >= 0 && y < from_sprite.Height()) {
     return data[x + y * stride];
@@ -602,14 +622,16 @@ void DrawOval(Vec2Si32 c, Vec2Si32 r, Rgba color) {
 }
 
 void DrawOval(Sprite to_sprite, Vec2Si32 c, Vec2Si32 r, Rgba color) {
+  GetEngine()->GetTiledRasterizer().FlushBeforeWrite(to_sprite);
   Sprite back = to_sprite;
   Vec2Si32 limit = back.Size();
   MathTables &tables = GetEngine()->GetMathTables();
 
-  Rgba *data = back.RgbaData();
+  Rgba *data = back.UntrackedRgbaData();
   Si32 stride = back.StridePixels();
 
   if (r.x >= 0) {
+    back.MarkDirty(c - r, c + r + Vec2Si32(1, 1));
     // from c up
     {
       Si32 y1 = std::max(c.y + 1, 0);
@@ -943,6 +965,38 @@ void SetInverseY(bool is_inverse) {
   GetEngine()->SetInverseY(is_inverse);
 }
 
+void SetTiledRendering(bool is_enabled, Si32 thread_count) {
+  GetEngine()->SetTiledRendering(is_enabled, thread_count);
+}
+
+void SetStreamingUpload(bool is_enabled) {
+  GetEngine()->SetStreamingUpload(is_enabled);
+}
+
+void SetHwBackbufferDirect(bool is_enabled) {
+  GetEngine()->SetHwBackbufferDirect(is_enabled);
+}
+
+void SetHwSpriteAtlas(bool is_enabled) {
+  GetEngine()->GetHwSpriteAtlas().SetEnabled(is_enabled);
+}
+
+void SetHwSpritePoolLimit(Si64 limit_bytes) {
+  GetEngine()->GetHwSpritePool().SetLimit(limit_bytes);
+}
+
+void SetHwSpriteUploadBudget(Si64 bytes_per_frame) {
+  GetEngine()->GetHwSpriteUploadQueue().SetBytesPerFrame(bytes_per_frame);
+}
+
+void SetShaderCacheDirectory(const char *path) {
+  GlProgramCache::SetDirectory(path ? path : "");
+}
+
+void FlushDraws() {
+  GetEngine()->GetTiledRasterizer().Flush();
+}
+
 void Clear() {
   GetEngine()->GetBackbuffer().Clear();
   GetEngine()->GetHwBackbuffer().Clear();
@@ -27,6 +27,7 @@
 #include "engine/arctic_types.h"
 #include "engine/csv.h"
 #include "engine/easy_advanced.h"
+#include "engine/easy_draw_list.h"
 #include "engine/easy_drawing.h"
 #include "engine/easy_files.h"
 #include "engine/easy_input.h"
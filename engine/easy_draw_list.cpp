@@ -0,0 +1,366 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/easy_draw_list.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "engine/easy_advanced.h"
+#include "engine/engine.h"
+#include "engine/tiled_rasterizer.h"
+
+namespace arctic {
+
+void DrawList::Add(const Sprite &sprite, const Si32 to_x, const Si32 to_y,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    Rgba in_color) {
+  Add(sprite, to_x, to_y, sprite.Width(), sprite.Height(),
+    0, 0, sprite.Width(), sprite.Height(),
+    blending_mode, filter_mode, in_color);
+}
+
+void DrawList::Add(const Sprite &sprite, const Si32 to_x, const Si32 to_y,
+    const Si32 to_width, const Si32 to_height,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    Rgba in_color) {
+  Add(sprite, to_x, to_y, to_width, to_height,
+    0, 0, sprite.Width(), sprite.Height(),
+    blending_mode, filter_mode, in_color);
+}
+
+void DrawList::Add(const Sprite &sprite, const Si32 to_x, const Si32 to_y,
+    const Si32 to_width, const Si32 to_height,
+    const Si32 from_x, const Si32 from_y,
+    const Si32 from_width, const Si32 from_height,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    Rgba in_color) {
+  if (!sprite.SpriteInstance()) {
+    return;
+  }
+  Command command;
+  command.sprite_idx = SpriteIndex(sprite);
+  command.to_x = to_x;
+  command.to_y = to_y;
+  command.to_width = to_width;
+  command.to_height = to_height;
+  command.from_x = from_x;
+  command.from_y = from_y;
+  command.from_width = from_width;
+  command.from_height = from_height;
+  command.angle_radians = 0.f;
+  command.zoom = 1.f;
+  command.color = in_color;
+  command.blending_mode = static_cast<Ui8>(blending_mode);
+  command.filter_mode = static_cast<Ui8>(filter_mode);
+  command.is_rotated = false;
+  command.rotated_to = Vec2F(0.f, 0.f);
+  commands_.push_back(command);
+}
+
+void DrawList::AddRotated(const Sprite &sprite, const Vec2F to,
+    float angle_radians, float zoom,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    Rgba in_color) {
+  if (!sprite.SpriteInstance()) {
+    return;
+  }
+  Command command;
+  command.sprite_idx = SpriteIndex(sprite);
+  command.to_x = 0;
+  command.to_y = 0;
+  command.to_width = sprite.Width();
+  command.to_height = sprite.Height();
+  command.from_x = 0;
+  command.from_y = 0;
+  command.from_width = sprite.Width();
+  command.from_height = sprite.Height();
+  command.angle_radians = angle_radians;
+  command.zoom = zoom;
+  command.color = in_color;
+  command.blending_mode = static_cast<Ui8>(blending_mode);
+  command.filter_mode = static_cast<Ui8>(filter_mode);
+  command.is_rotated = true;
+  command.rotated_to = to;
+  commands_.push_back(command);
+}
+
+void DrawList::Clear() {
+  commands_.clear();
+  sprites_.clear();
+  last_sprite_idx_.clear();
+}
+
+Si32 DrawList::SpriteIndex(const Sprite &sprite) {
+  const void *instance = sprite.SpriteInstance().get();
+  auto it = last_sprite_idx_.find(instance);
+  if (it != last_sprite_idx_.end()) {
+    const Sprite &last = sprites_[static_cast<size_t>(it->second)];
+    if (last.RefPos() == sprite.RefPos() && last.Size() == sprite.Size()
+        && last.Pivot() == sprite.Pivot()) {
+      return it->second;
+    }
+  }
+  const Si32 idx = static_cast<Si32>(sprites_.size());
+  sprites_.push_back(sprite);
+  last_sprite_idx_[instance] = idx;
+  return idx;
+}
+
+void DrawList::Execute() {
+  Execute(GetEngine()->GetBackbuffer());
+}
+
+void DrawList::Execute(Sprite to_sprite) {
+  if (commands_.empty() || !to_sprite.SpriteInstance()) {
+    return;
+  }
+  bool is_culling = false;
+  if (is_overdraw_culling_) {
+    for (const Command &command : commands_) {
+      if (!command.is_rotated
+          && command.blending_mode == kDrawBlendingModeCopyRgba) {
+        is_culling = true;
+        break;
+      }
+    }
+    // A draw that reads the target would see the skipped pixels missing.
+    for (const Sprite &sprite : sprites_) {
+      if (sprite.SpriteInstance() == to_sprite.SpriteInstance()) {
+        is_culling = false;
+        break;
+      }
+    }
+  }
+  if (!is_culling) {
+    for (const Command &command : commands_) {
+      ExecuteCommand(command, to_sprite);
+    }
+    return;
+  }
+  // Clipped draws bypass the tiled rasterizer, so while it is recording
+  // the partially hidden draws are performed in full.
+  Cull(to_sprite, !GetEngine()->GetTiledRasterizer().IsRecording());
+  for (size_t idx = 0; idx < commands_.size(); ++idx) {
+    const Command &command = commands_[idx];
+    if (visibility_[idx] == kVisibilityFull) {
+      ExecuteCommand(command, to_sprite);
+    } else if (visibility_[idx] == kVisibilityPartial) {
+      const Sprite &sprite = sprites_[static_cast<size_t>(command.sprite_idx)];
+      const Si32 first = first_clip_[idx];
+      for (Si32 clip = first; clip < first + clip_count_[idx]; ++clip) {
+        to_sprite.MarkDirty(clips_[static_cast<size_t>(clip * 2)],
+          clips_[static_cast<size_t>(clip * 2 + 1)]);
+        DrawSpriteClipped(to_sprite, command.to_x, command.to_y,
+          command.to_width, command.to_height,
+          sprite, command.from_x, command.from_y,
+          command.from_width, command.from_height,
+          static_cast<DrawBlendingMode>(command.blending_mode),
+          static_cast<DrawFilterMode>(command.filter_mode), command.color,
+          clips_[static_cast<size_t>(clip * 2)],
+          clips_[static_cast<size_t>(clip * 2 + 1)]);
+      }
+    }
+  }
+}
+
+void DrawList::ExecuteCommand(const Command &command, Sprite to_sprite) {
+  Sprite &sprite = sprites_[static_cast<size_t>(command.sprite_idx)];
+  if (command.is_rotated) {
+    sprite.Draw(command.rotated_to.x, command.rotated_to.y,
+      command.angle_radians, command.zoom, to_sprite,
+      static_cast<DrawBlendingMode>(command.blending_mode),
+      static_cast<DrawFilterMode>(command.filter_mode), command.color);
+  } else {
+    sprite.Draw(command.to_x, command.to_y,
+      command.to_width, command.to_height,
+      command.from_x, command.from_y,
+      command.from_width, command.from_height, to_sprite,
+      static_cast<DrawBlendingMode>(command.blending_mode),
+      static_cast<DrawFilterMode>(command.filter_mode), command.color);
+  }
+}
+
+bool DrawList::Bound(const Command &command, Vec2Si32 target_size,
+    Vec2Si32 *out_begin, Vec2Si32 *out_end) const {
+  const Sprite &sprite = sprites_[static_cast<size_t>(command.sprite_idx)];
+  Vec2Si32 begin(0, 0);
+  Vec2Si32 end = target_size;
+  if (command.is_rotated) {
+    // Same corners as in Sprite::Draw, widened by a couple of pixels
+    // to cover the rounding of the triangle edges.
+    const float sin_a = sinf(command.angle_radians) * command.zoom;
+    const float cos_a = cosf(command.angle_radians) * command.zoom;
+    const Vec2F pivot = command.rotated_to;
+    const Vec2F left = Vec2F(-cos_a, -sin_a)
+      * static_cast<float>(sprite.Pivot().x);
+    const Vec2F right = Vec2F(cos_a, sin_a)
+      * static_cast<float>(sprite.Width() - 1 - sprite.Pivot().x);
+    const Vec2F up = Vec2F(-sin_a, cos_a)
+      * static_cast<float>(sprite.Height() - 1 - sprite.Pivot().y);
+    const Vec2F down = Vec2F(sin_a, -cos_a)
+      * static_cast<float>(sprite.Pivot().y);
+    const Vec2F corners[4] = {pivot + left + down, pivot + right + down,
+      pivot + right + up, pivot + left + up};
+    float x1 = corners[0].x;
+    float x2 = corners[0].x;
+    float y1 = corners[0].y;
+    float y2 = corners[0].y;
+    for (const Vec2F &corner : corners) {
+      x1 = std::min(x1, corner.x);
+      x2 = std::max(x2, corner.x);
+      y1 = std::min(y1, corner.y);
+      y2 = std::max(y2, corner.y);
+    }
+    if (x1 <= x2 && y1 <= y2) {
+      const float width_f = static_cast<float>(target_size.x);
+      const float height_f = static_cast<float>(target_size.y);
+      begin = Vec2Si32(
+        static_cast<Si32>(std::floor(std::min(std::max(x1, -2.f), width_f))) - 2,
+        static_cast<Si32>(std::floor(std::min(std::max(y1, -2.f), height_f))) - 2);
+      end = Vec2Si32(
+        static_cast<Si32>(std::max(std::min(x2, width_f + 2.f), -2.f)) + 3,
+        static_cast<Si32>(std::max(std::min(y2, height_f + 2.f), -2.f)) + 3);
+    }
+  } else {
+    if (!command.to_width || !command.to_height
+        || !command.from_width || !command.from_height) {
+      return false;
+    }
+    if (command.to_width > 0 && command.to_height > 0
+        && command.from_width > 0 && command.from_height > 0) {
+      begin = Vec2Si32(
+        command.to_x - sprite.Pivot().x * command.to_width / command.from_width,
+        command.to_y - sprite.Pivot().y * command.to_height / command.from_height);
+      end = begin + Vec2Si32(command.to_width, command.to_height);
+    }
+  }
+  out_begin->x = std::max(begin.x, 0);
+  out_begin->y = std::max(begin.y, 0);
+  out_end->x = std::min(end.x, target_size.x);
+  out_end->y = std::min(end.y, target_size.y);
+  return out_begin->x < out_end->x && out_begin->y < out_end->y;
+}
+
+bool DrawList::OpaqueBound(const Command &command, Vec2Si32 *in_out_begin,
+    Vec2Si32 *in_out_end) const {
+  if (command.is_rotated
+      || command.blending_mode != kDrawBlendingModeCopyRgba
+      || command.to_width <= 0 || command.to_height <= 0
+      || command.from_width <= 0 || command.from_height <= 0) {
+    return false;
+  }
+  const Sprite &sprite = sprites_[static_cast<size_t>(command.sprite_idx)];
+  if (command.to_width == command.from_width
+      && command.to_height == command.from_height
+      && !sprite.IsRef() && !sprite.Opaque().empty()) {
+    // The unscaled path copies only the opaque span of each row,
+    // so only the columns inside all of the spans are sure to be written.
+    const std::vector<SpanSi32> &opaque = sprite.Opaque();
+    const Si32 to_x = command.to_x - sprite.Pivot().x;
+    const Si32 to_y = command.to_y - sprite.Pivot().y;
+    for (Si32 y = in_out_begin->y; y < in_out_end->y; ++y) {
+      const SpanSi32 &span =
+        opaque[static_cast<size_t>(command.from_y + y - to_y)];
+      in_out_begin->x = std::max(in_out_begin->x,
+        to_x + span.begin - command.from_x);
+      in_out_end->x = std::min(in_out_end->x,
+        to_x + span.end - command.from_x);
+      if (in_out_begin->x >= in_out_end->x) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void DrawList::Cull(const Sprite &to_sprite, bool is_partial_allowed) {
+  const Vec2Si32 size = to_sprite.Size();
+  const Si32 cell = kCullCellSize;
+  const Si32 cells_x = (size.x + cell - 1) / cell;
+  const Si32 cells_y = (size.y + cell - 1) / cell;
+  covered_cells_.assign(static_cast<size_t>(cells_x * cells_y), 0);
+  visibility_.assign(commands_.size(), kVisibilityHidden);
+  first_clip_.assign(commands_.size(), 0);
+  clip_count_.assign(commands_.size(), 0);
+  clips_.clear();
+
+  // Back to front: a draw is hidden where a later copy overwrites it.
+  for (size_t idx = commands_.size(); idx-- > 0;) {
+    const Command &command = commands_[idx];
+    Vec2Si32 begin;
+    Vec2Si32 end;
+    if (!Bound(command, size, &begin, &end)) {
+      continue;
+    }
+    const Si32 cx1 = begin.x / cell;
+    const Si32 cy1 = begin.y / cell;
+    const Si32 cx2 = (end.x - 1) / cell;
+    const Si32 cy2 = (end.y - 1) / cell;
+    Si32 covered_count = 0;
+    for (Si32 cy = cy1; cy <= cy2; ++cy) {
+      for (Si32 cx = cx1; cx <= cx2; ++cx) {
+        covered_count += covered_cells_[static_cast<size_t>(cy * cells_x + cx)];
+      }
+    }
+    if (covered_count == (cx2 - cx1 + 1) * (cy2 - cy1 + 1)) {
+      continue;
+    }
+    visibility_[idx] = kVisibilityFull;
+    if (covered_count && is_partial_allowed && !command.is_rotated) {
+      visibility_[idx] = kVisibilityPartial;
+      first_clip_[idx] = static_cast<Si32>(clips_.size() / 2);
+      for (Si32 cy = cy1; cy <= cy2; ++cy) {
+        const Ui8 *row = &covered_cells_[static_cast<size_t>(cy * cells_x)];
+        for (Si32 cx = cx1; cx <= cx2; ++cx) {
+          if (row[cx]) {
+            continue;
+          }
+          const Si32 run_begin = cx;
+          while (cx < cx2 && !row[cx + 1]) {
+            ++cx;
+          }
+          clips_.push_back(Vec2Si32(std::max(run_begin * cell, begin.x),
+            std::max(cy * cell, begin.y)));
+          clips_.push_back(Vec2Si32(std::min((cx + 1) * cell, end.x),
+            std::min((cy + 1) * cell, end.y)));
+          ++clip_count_[idx];
+        }
+      }
+    }
+    if (OpaqueBound(command, &begin, &end)) {
+      for (Si32 cy = cy1; cy <= cy2; ++cy) {
+        if (cy * cell < begin.y || std::min((cy + 1) * cell, size.y) > end.y) {
+          continue;
+        }
+        for (Si32 cx = cx1; cx <= cx2; ++cx) {
+          if (cx * cell >= begin.x
+              && std::min((cx + 1) * cell, size.x) <= end.x) {
+            covered_cells_[static_cast<size_t>(cy * cells_x + cx)] = 1;
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace arctic
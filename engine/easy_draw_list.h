@@ -0,0 +1,148 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_EASY_DRAW_LIST_H_
+#define ENGINE_EASY_DRAW_LIST_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/easy_sprite.h"
+#include "engine/rgba.h"
+#include "engine/vec2f.h"
+#include "engine/vec2si32.h"
+
+namespace arctic {
+
+/// @addtogroup global_drawing
+/// @{
+
+/// @brief Records sprite draws and performs them later, in one pass.
+/// @details Each recorded draw produces exactly the same pixels as the
+///  corresponding Sprite::Draw call. Before executing the list works out
+///  which parts of the draws are going to be overwritten by the later
+///  kDrawBlendingModeCopyRgba draws and skips them, so the layers hidden
+///  under opaque backgrounds and panels cost nothing.
+///  The sprites are referenced by the list until Clear is called.
+class DrawList {
+ public:
+  static const Si32 kCullCellSize = 32;
+
+  /// @brief Records Sprite::Draw(to_x, to_y, blending_mode, filter_mode,
+  ///  in_color).
+  void Add(const Sprite &sprite, const Si32 to_x, const Si32 to_y,
+    DrawBlendingMode blending_mode = kDrawBlendingModeAlphaBlend,
+    DrawFilterMode filter_mode = kFilterNearest,
+    Rgba in_color = Rgba(0xffffffff));
+  /// @brief Records Sprite::Draw(to_x, to_y, to_width, to_height,
+  ///  blending_mode, filter_mode, in_color).
+  void Add(const Sprite &sprite, const Si32 to_x, const Si32 to_y,
+    const Si32 to_width, const Si32 to_height,
+    DrawBlendingMode blending_mode = kDrawBlendingModeAlphaBlend,
+    DrawFilterMode filter_mode = kFilterNearest,
+    Rgba in_color = Rgba(0xffffffff));
+  /// @brief Records Sprite::Draw(to_x, to_y, to_width, to_height,
+  ///  from_x, from_y, from_width, from_height,
+  ///  blending_mode, filter_mode, in_color).
+  void Add(const Sprite &sprite, const Si32 to_x, const Si32 to_y,
+    const Si32 to_width, const Si32 to_height,
+    const Si32 from_x, const Si32 from_y,
+    const Si32 from_width, const Si32 from_height,
+    DrawBlendingMode blending_mode = kDrawBlendingModeAlphaBlend,
+    DrawFilterMode filter_mode = kFilterNearest,
+    Rgba in_color = Rgba(0xffffffff));
+  /// @brief Records Sprite::Draw(in_color, to.x, to.y, angle_radians, zoom,
+  ///  blending_mode, filter_mode).
+  void AddRotated(const Sprite &sprite, const Vec2F to,
+    float angle_radians, float zoom,
+    DrawBlendingMode blending_mode = kDrawBlendingModeAlphaBlend,
+    DrawFilterMode filter_mode = kFilterNearest,
+    Rgba in_color = Rgba(0xffffffff));
+
+  /// @brief Performs the recorded draws on the backbuffer.
+  void Execute();
+  /// @brief Performs the recorded draws on the sprite.
+  /// @details The list is kept, so it can be executed again.
+  void Execute(Sprite to_sprite);
+  /// @brief Removes all the recorded draws.
+  void Clear();
+  /// @brief Returns the number of recorded draws.
+  Si32 Size() const {
+    return static_cast<Si32>(commands_.size());
+  }
+  /// @brief Enables or disables skipping the pixels hidden by later
+  ///  kDrawBlendingModeCopyRgba draws. Enabled by default.
+  void SetOverdrawCulling(bool is_enabled) {
+    is_overdraw_culling_ = is_enabled;
+  }
+
+ private:
+  struct Command {
+    Si32 sprite_idx;
+    Si32 to_x;
+    Si32 to_y;
+    Si32 to_width;
+    Si32 to_height;
+    Si32 from_x;
+    Si32 from_y;
+    Si32 from_width;
+    Si32 from_height;
+    Vec2F rotated_to;
+    float angle_radians;
+    float zoom;
+    Rgba color;
+    Ui8 blending_mode;
+    Ui8 filter_mode;
+    bool is_rotated;
+  };
+  enum Visibility {
+    kVisibilityHidden = 0,
+    kVisibilityFull = 1,
+    kVisibilityPartial = 2
+  };
+
+  Si32 SpriteIndex(const Sprite &sprite);
+  bool Bound(const Command &command, Vec2Si32 target_size,
+    Vec2Si32 *out_begin, Vec2Si32 *out_end) const;
+  bool OpaqueBound(const Command &command, Vec2Si32 *in_out_begin,
+    Vec2Si32 *in_out_end) const;
+  void Cull(const Sprite &to_sprite, bool is_partial_allowed);
+  void ExecuteCommand(const Command &command, Sprite to_sprite);
+
+  std::vector<Sprite> sprites_;
+  std::unordered_map<const void*, Si32> last_sprite_idx_;
+  std::vector<Command> commands_;
+  bool is_overdraw_culling_ = true;
+
+  std::vector<Ui8> visibility_;
+  std::vector<Si32> first_clip_;
+  std::vector<Si32> clip_count_;
+  std::vector<Vec2Si32> clips_;
+  std::vector<Ui8> covered_cells_;
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_EASY_DRAW_LIST_H_
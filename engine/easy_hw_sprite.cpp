@@ -49,12 +49,52 @@ void HwSprite::DrawSprite(const std::shared_ptr<GlProgram> &gl_program, const Un
     const HwSprite &from_sprite, const float from_x, const float from_y, const float from_width, const float from_height,
     Rgba in_color, DrawBlendingMode blending_mode, DrawFilterMode filter_mode, float angle_radians, float zoom) {
 
+    HwSpriteBatch &batch = GetEngine()->GetHwSpriteBatch();
+    if (gl_program == GetEngine()->GetDefaultSpriteProgram() && gl_program_uniforms.Size() == 0) {
+        const Vec2F scale(zoom * to_width / from_width, zoom * to_height / from_height);
+        const Vec2F pivot(to_x_pivot, to_y_pivot);
+        float sin_a = sinf(angle_radians);
+        float cos_a = cosf(angle_radians);
+        Vec2F left = Vec2F(-cos_a, -sin_a) * static_cast<float>(from_sprite.Pivot().x);
+        Vec2F right = Vec2F(cos_a, sin_a) * static_cast<float>(from_sprite.Width() - from_sprite.Pivot().x);
+        Vec2F up = Vec2F(-sin_a, cos_a) * static_cast<float>(from_sprite.Height() - from_sprite.Pivot().y);
+        Vec2F down = Vec2F(sin_a, -cos_a) * static_cast<float>(from_sprite.Pivot().y);
+
+        // Only the colorizing modes tint the sprite.
+        Rgba color = (blending_mode == kDrawBlendingModeColorize || blending_mode == kDrawBlendingModeSolidColor)
+            ? in_color : Rgba(255, 255, 255, 255);
+
+        // The referenced part of the texture.
+        const std::shared_ptr<HwSpriteInstance> &from_instance = from_sprite.sprite_instance();
+        const float tex_w = static_cast<float>(from_instance->width());
+        const float tex_h = static_cast<float>(from_instance->height());
+        const float u0 = static_cast<float>(from_sprite.ref_pos_.x) / tex_w;
+        const float v0 = static_cast<float>(from_sprite.ref_pos_.y) / tex_h;
+        const float u1 = static_cast<float>(from_sprite.ref_pos_.x + from_sprite.ref_size_.x) / tex_w;
+        const float v1 = static_cast<float>(from_sprite.ref_pos_.y + from_sprite.ref_size_.y) / tex_h;
+
+        // d c
+        // a b
+        const HwSpriteVertex quad[4] = {
+            {(left + down) * scale + pivot, Vec2F(u0, v0), color},
+            {(right + down) * scale + pivot, Vec2F(u1, v0), color},
+            {(right + up) * scale + pivot, Vec2F(u1, v1), color},
+            {(left + up) * scale + pivot, Vec2F(u0, v1), color},
+        };
+        batch.AddQuad(to_sprite.sprite_instance(),
+            Vec4Si32(to_sprite.ref_pos_.x + to_sprite.Pivot().x, to_sprite.ref_pos_.y + to_sprite.Pivot().y,
+                to_sprite.Width(), to_sprite.Height()),
+            from_instance, blending_mode, filter_mode, quad);
+        return;
+    }
+    // Custom programs expect the per sprite vertex buffer and uniforms.
+    batch.Flush();
+
     from_sprite.UpdateVertexBuffer(angle_radians);
     from_sprite.gl_buffer_->Bind();
     ARCTIC_GL_CHECK_ERROR(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 16, 0));
-    ARCTIC_GL_CHECK_ERROR(glEnableVertexAttribArray(0));
     ARCTIC_GL_CHECK_ERROR(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 16, (void*)8));
-    ARCTIC_GL_CHECK_ERROR(glEnableVertexAttribArray(1));
+    GlState::SetVertexAttribArrays(0x3);
 
     gl_program->Bind();
     gl_program_uniforms.Apply(*gl_program);
@@ -68,7 +108,8 @@ void HwSprite::DrawSprite(const std::shared_ptr<GlProgram> &gl_program, const Un
     ));
 
     to_sprite.sprite_instance()->framebuffer().Bind();
-    GlState::SetViewport(to_sprite.Pivot().x, to_sprite.Pivot().y, to_sprite.Width(), to_sprite.Height());
+    GlState::SetViewport(to_sprite.ref_pos_.x + to_sprite.Pivot().x, to_sprite.ref_pos_.y + to_sprite.Pivot().y,
+        to_sprite.Width(), to_sprite.Height());
 
     GlTexture2D &texture = from_sprite.sprite_instance()->texture();
     texture.SetFilterMode(filter_mode);
@@ -122,14 +163,22 @@ void HwSprite::UpdateVertexBuffer(float angle) const {
         Vec2F c(right + up);
         Vec2F d(left + up);
 
+        // The referenced part of the texture.
+        const float tex_w = static_cast<float>(sprite_instance_->width());
+        const float tex_h = static_cast<float>(sprite_instance_->height());
+        const float u0 = static_cast<float>(ref_pos_.x) / tex_w;
+        const float v0 = static_cast<float>(ref_pos_.y) / tex_h;
+        const float u1 = static_cast<float>(ref_pos_.x + ref_size_.x) / tex_w;
+        const float v1 = static_cast<float>(ref_pos_.y + ref_size_.y) / tex_h;
+
         const Vec2F kVerts[] = {
-            a, Vec2F(0.0f, 0.0f),
-            b, Vec2F(1.0f, 0.0f),
-            c, Vec2F(1.0f, 1.0f),
+            a, Vec2F(u0, v0),
+            b, Vec2F(u1, v0),
+            c, Vec2F(u1, v1),
 
-            d, Vec2F(0.0f, 1.0f),
-            a, Vec2F(0.0f, 0.0f),
-            c, Vec2F(1.0f, 1.0f),
+            d, Vec2F(u0, v1),
+            a, Vec2F(u0, v0),
+            c, Vec2F(u1, v1),
         };
 
         gl_buffer_->UpdateData(kVerts);
@@ -138,6 +187,20 @@ void HwSprite::UpdateVertexBuffer(float angle) const {
 
 
 
+void HwSprite::LoadPixels(const Rgba *data, Si32 stride_pixels, Si32 width, Si32 height) {
+    upload_ticket_ = nullptr;
+    atlas_region_ = GetEngine()->GetHwSpriteAtlas().Add(data, stride_pixels, width, height);
+    if (atlas_region_) {
+        sprite_instance_ = atlas_region_->instance();
+        ref_pos_ = atlas_region_->pos();
+    } else {
+        sprite_instance_ = std::make_shared<HwSpriteInstance>(width, height);
+        sprite_instance_->texture().UpdateData(data);
+        ref_pos_ = Vec2Si32(0, 0);
+    }
+    ref_size_ = Vec2Si32(width, height);
+}
+
 HwSprite::HwSprite() {
   ref_pos_ = Vec2Si32(0, 0);
   ref_size_ = Vec2Si32(0, 0);
@@ -151,6 +214,8 @@ HwSprite::HwSprite() {
 
 HwSprite::HwSprite(const HwSprite &other) {
   sprite_instance_ = other.sprite_instance_;
+  atlas_region_ = other.atlas_region_;
+  upload_ticket_ = other.upload_ticket_;
   ref_pos_ = other.ref_pos_;
   ref_size_ = other.ref_size_;
   pivot_ = other.pivot_;
@@ -164,6 +229,8 @@ HwSprite::HwSprite(const HwSprite &other) {
 
 HwSprite::HwSprite(HwSprite &&other) {
   sprite_instance_ = other.sprite_instance_;
+  atlas_region_ = other.atlas_region_;
+  upload_ticket_ = other.upload_ticket_;
   ref_pos_ = other.ref_pos_;
   ref_size_ = other.ref_size_;
   pivot_ = other.pivot_;
@@ -175,6 +242,8 @@ HwSprite::HwSprite(HwSprite &&other) {
   last_angle_ = 0.0f;
 
   other.sprite_instance_ = nullptr;
+  other.atlas_region_ = nullptr;
+  other.upload_ticket_ = nullptr;
   other.ref_pos_ = Vec2Si32(0, 0);
   other.ref_size_ = Vec2Si32(0, 0);
   other.pivot_ = Vec2Si32(0, 0);
@@ -188,6 +257,8 @@ HwSprite::HwSprite(HwSprite &&other) {
 
 HwSprite &HwSprite::operator=(const HwSprite &other) {
   sprite_instance_ = other.sprite_instance_;
+  atlas_region_ = other.atlas_region_;
+  upload_ticket_ = other.upload_ticket_;
   ref_pos_ = other.ref_pos_;
   ref_size_ = other.ref_size_;
   pivot_ = other.pivot_;
@@ -203,6 +274,8 @@ HwSprite &HwSprite::operator=(const HwSprite &other) {
 
 HwSprite &HwSprite::operator=(HwSprite &&other) {
   sprite_instance_ = other.sprite_instance_;
+  atlas_region_ = other.atlas_region_;
+  upload_ticket_ = other.upload_ticket_;
   ref_pos_ = other.ref_pos_;
   ref_size_ = other.ref_size_;
   pivot_ = other.pivot_;
@@ -214,6 +287,8 @@ HwSprite &HwSprite::operator=(HwSprite &&other) {
   last_angle_ = 0.0f;
 
   other.sprite_instance_ = nullptr;
+  other.atlas_region_ = nullptr;
+  other.upload_ticket_ = nullptr;
   other.ref_pos_ = Vec2Si32(0, 0);
   other.ref_size_ = Vec2Si32(0, 0);
   other.pivot_ = Vec2Si32(0, 0);
@@ -254,16 +329,15 @@ void HwSprite::LoadFromData(const Ui8* data, Ui64 size_bytes,
           " Not loading sprite.";
       return;
     }
-    sprite_instance_ = HwSpriteInstance::LoadTga(data, static_cast<Si64>(size_bytes));
-    if (!sprite_instance_) {
+    std::shared_ptr<SpriteInstance> sw_instance = arctic::LoadTga(data, static_cast<Si64>(size_bytes));
+    if (!sw_instance) {
       *Log() << "Error in HwSprite::Load, file: \""
         << file_name << "\" could not be loaded with LoadTga."
           " Not loading sprite.";
       return;
     }
-    ref_pos_ = Vec2Si32(0, 0);
-    ref_size_ = Vec2Si32(sprite_instance_->width(),
-                         sprite_instance_->height());
+    LoadPixels(reinterpret_cast<const Rgba*>(sw_instance->RawData()), sw_instance->width(),
+      sw_instance->width(), sw_instance->height());
     pivot_ = Vec2Si32(0, 0);
     gl_program_ = GetEngine()->GetDefaultSpriteProgram();
     gl_program_uniforms_.Clear();
@@ -301,10 +375,17 @@ void HwSprite::Load(const char *file_name) {
           " Not loading sprite.";
       return;
     }
-    sprite_instance_ = HwSpriteInstance::LoadTga(data.data(), static_cast<Si64>(data.size()));
-    ref_pos_ = Vec2Si32(0, 0);
-    ref_size_ = sprite_instance_ ? Vec2Si32(sprite_instance_->width(),
-      sprite_instance_->height()) : Vec2Si32(0, 0);
+    std::shared_ptr<SpriteInstance> sw_instance = arctic::LoadTga(data.data(), static_cast<Si64>(data.size()));
+    if (sw_instance) {
+      LoadPixels(reinterpret_cast<const Rgba*>(sw_instance->RawData()), sw_instance->width(),
+        sw_instance->width(), sw_instance->height());
+    } else {
+      sprite_instance_ = nullptr;
+      atlas_region_ = nullptr;
+      upload_ticket_ = nullptr;
+      ref_pos_ = Vec2Si32(0, 0);
+      ref_size_ = Vec2Si32(0, 0);
+    }
     pivot_ = Vec2Si32(0, 0);
     gl_program_ = GetEngine()->GetDefaultSpriteProgram();
     gl_program_uniforms_.Clear();
@@ -326,10 +407,21 @@ void HwSprite::Load(const std::string &file_name) {
 }
 
 void HwSprite::LoadFromSoftwareSprite(Sprite sw_sprite) {
+    GetEngine()->GetTiledRasterizer().FlushBeforeRead(sw_sprite);
+    upload_ticket_ = nullptr;
     const std::shared_ptr<SpriteInstance> &sw_sprite_instance = sw_sprite.SpriteInstance();
-    sprite_instance_ = std::make_shared<HwSpriteInstance>(sw_sprite_instance->width(), sw_sprite_instance->height());
-    sprite_instance_->texture().UpdateData(sw_sprite_instance->RawData());
-    ref_pos_ = sw_sprite.RefPos();
+    const Si32 stride = sw_sprite_instance->width();
+    atlas_region_ = GetEngine()->GetHwSpriteAtlas().Add(
+        reinterpret_cast<const Rgba*>(sw_sprite_instance->RawData()) + sw_sprite.RefPos().y * stride + sw_sprite.RefPos().x,
+        stride, sw_sprite.Width(), sw_sprite.Height());
+    if (atlas_region_) {
+        sprite_instance_ = atlas_region_->instance();
+        ref_pos_ = atlas_region_->pos();
+    } else {
+        sprite_instance_ = std::make_shared<HwSpriteInstance>(sw_sprite_instance->width(), sw_sprite_instance->height());
+        sprite_instance_->texture().UpdateData(sw_sprite_instance->RawData());
+        ref_pos_ = sw_sprite.RefPos();
+    }
     ref_size_ = sw_sprite.Size();
     pivot_ = sw_sprite.Pivot();
     gl_program_ = GetEngine()->GetDefaultSpriteProgram();
@@ -340,6 +432,116 @@ void HwSprite::LoadFromSoftwareSprite(Sprite sw_sprite) {
     last_angle_ = 0.0f;
 }
 
+void HwSprite::LoadAsync(const char *file_name) {
+  if (!file_name) {
+    *Log() << "Error in HwSprite::LoadAsync, file_name is nullptr."
+      " Not loading sprite.";
+    return;
+  }
+  const char *last_dot = strchr(file_name, '.');
+  if (!last_dot || strcmp(last_dot, ".tga") != 0) {
+    // Only *.tga files are decoded in the background.
+    Load(file_name);
+    return;
+  }
+  std::vector<Ui8> data = ReadFile(file_name, true);
+  // The size is in the 18 byte header, the pixels are decoded later.
+  const size_t kTgaHeaderSize = 18;
+  if (data.size() < kTgaHeaderSize) {
+    *Log() << "Error in HwSprite::LoadAsync, file: \""
+      << file_name << "\" could not be loaded (data is too short)."
+        " Not loading sprite.";
+    return;
+  }
+  const Vec2Si32 size(
+    static_cast<Si32>(data[12]) | (static_cast<Si32>(data[13]) << 8),
+    static_cast<Si32>(data[14]) | (static_cast<Si32>(data[15]) << 8));
+  if (size.x == 0 || size.y == 0) {
+    *Log() << "Error in HwSprite::LoadAsync, file: \""
+      << file_name << "\" has zero size."
+        " Not loading sprite.";
+    return;
+  }
+  atlas_region_ = GetEngine()->GetHwSpriteAtlas().Allocate(size.x, size.y);
+  if (atlas_region_) {
+    sprite_instance_ = atlas_region_->instance();
+    ref_pos_ = atlas_region_->pos();
+  } else {
+    sprite_instance_ = std::make_shared<HwSpriteInstance>(size.x, size.y);
+    ref_pos_ = Vec2Si32(0, 0);
+  }
+  ref_size_ = size;
+  upload_ticket_ = GetEngine()->GetHwSpriteUploadQueue().EnqueueFile(
+    file_name, std::move(data), size, sprite_instance_, atlas_region_);
+  pivot_ = Vec2Si32(0, 0);
+  gl_program_ = GetEngine()->GetDefaultSpriteProgram();
+  gl_program_uniforms_.Clear();
+  gl_buffer_ = nullptr;
+  last_buffer_pivot_ = Vec2Si32(0, 0);
+  last_buffer_ref_size_ = Vec2Si32(0, 0);
+  last_angle_ = 0.0f;
+}
+
+void HwSprite::LoadAsync(const std::string &file_name) {
+  LoadAsync(file_name.c_str());
+}
+
+void HwSprite::LoadFromSoftwareSpriteAsync(Sprite sw_sprite) {
+  if (sw_sprite.Width() <= 0 || sw_sprite.Height() <= 0) {
+    LoadFromSoftwareSprite(sw_sprite);
+    return;
+  }
+  GetEngine()->GetTiledRasterizer().FlushBeforeRead(sw_sprite);
+  const std::shared_ptr<SpriteInstance> &sw_sprite_instance = sw_sprite.SpriteInstance();
+  const Si32 stride = sw_sprite_instance->width();
+  const Rgba *data = reinterpret_cast<const Rgba*>(sw_sprite_instance->RawData())
+    + sw_sprite.RefPos().y * stride + sw_sprite.RefPos().x;
+  // The pixels are copied now, the software sprite may change before the upload.
+  std::vector<Rgba> pixels;
+  atlas_region_ = GetEngine()->GetHwSpriteAtlas().Allocate(sw_sprite.Width(), sw_sprite.Height());
+  if (atlas_region_) {
+    HwSpriteAtlas::Extrude(data, stride, sw_sprite.Width(), sw_sprite.Height(), &pixels);
+    sprite_instance_ = atlas_region_->instance();
+    ref_pos_ = atlas_region_->pos();
+  } else {
+    pixels.resize(static_cast<size_t>(sw_sprite.Width()) * sw_sprite.Height());
+    for (Si32 y = 0; y < sw_sprite.Height(); ++y) {
+      memcpy(static_cast<void*>(
+          pixels.data() + static_cast<size_t>(y) * sw_sprite.Width()),
+        data + static_cast<size_t>(y) * stride,
+        static_cast<size_t>(sw_sprite.Width()) * sizeof(Rgba));
+    }
+    sprite_instance_ = std::make_shared<HwSpriteInstance>(sw_sprite.Width(), sw_sprite.Height());
+    ref_pos_ = Vec2Si32(0, 0);
+  }
+  ref_size_ = sw_sprite.Size();
+  upload_ticket_ = GetEngine()->GetHwSpriteUploadQueue().EnqueuePixels(
+    std::move(pixels), ref_size_, sprite_instance_, atlas_region_);
+  pivot_ = sw_sprite.Pivot();
+  gl_program_ = GetEngine()->GetDefaultSpriteProgram();
+  gl_program_uniforms_.Clear();
+  gl_buffer_ = nullptr;
+  last_buffer_pivot_ = Vec2Si32(0, 0);
+  last_buffer_ref_size_ = Vec2Si32(0, 0);
+  last_angle_ = 0.0f;
+}
+
+bool HwSprite::IsResident() const {
+  return !upload_ticket_ || upload_ticket_->is_resident;
+}
+
+HwSpriteReadback HwSprite::ReadAsync() const {
+  if (!sprite_instance_) {
+    return HwSpriteReadback();
+  }
+  return GetEngine()->GetHwSpriteReadbackQueue().Read(*sprite_instance_,
+    ref_pos_, ref_size_, pivot_);
+}
+
+Sprite HwSprite::ToSoftwareSprite() const {
+  return ReadAsync().Get();
+}
+
 /*void HwSprite::Save(const char *file_name) {
   std::vector<Ui8> data = SaveToData(file_name);
   if (!data.empty()) {
@@ -369,7 +571,9 @@ void HwSprite::Create(const Vec2Si32 size) {
 }
 
 void HwSprite::Create(const Si32 width, const Si32 height) {
-  sprite_instance_ = std::make_shared<HwSpriteInstance>(width, height);
+  sprite_instance_ = GetEngine()->GetHwSpritePool().Acquire(width, height);
+  atlas_region_ = nullptr;
+  upload_ticket_ = nullptr;
   ref_pos_ = Vec2Si32(0, 0);
   ref_size_ = Vec2Si32(width, height);
   pivot_ = Vec2Si32(0, 0);
@@ -382,6 +586,25 @@ void HwSprite::Create(const Si32 width, const Si32 height) {
   Clear();
 }
 
+void HwSprite::CreateWindowTarget(const Si32 width, const Si32 height) {
+  sprite_instance_ = HwSpriteInstance::CreateDefaultFramebuffer(width, height);
+  atlas_region_ = nullptr;
+  upload_ticket_ = nullptr;
+  ref_pos_ = Vec2Si32(0, 0);
+  ref_size_ = Vec2Si32(width, height);
+  pivot_ = Vec2Si32(0, 0);
+  gl_program_ = GetEngine()->GetDefaultSpriteProgram();
+  gl_program_uniforms_.Clear();
+  gl_buffer_ = nullptr;
+  last_buffer_pivot_ = Vec2Si32(0, 0);
+  last_buffer_ref_size_ = Vec2Si32(0, 0);
+  last_angle_ = 0.0f;
+}
+
+bool HwSprite::IsWindowTarget() const {
+  return sprite_instance_ && sprite_instance_->IsDefaultFramebuffer();
+}
+
 void HwSprite::InvReference(const HwSprite &from, const Si32 from_x, const Si32 from_inv_y,
     const Si32 from_width, const Si32 from_height) {
   Reference(from, from_x, from.ref_size_.y - from_inv_y - from_height, from_width , from_height);
@@ -398,6 +621,8 @@ void HwSprite::Reference(const HwSprite &from, const Si32 from_x, const Si32 fro
     std::min(from_height, max_size.y));
   pivot_ = Vec2Si32(0, 0);
   sprite_instance_ = from.sprite_instance_;
+  atlas_region_ = from.atlas_region_;
+  upload_ticket_ = from.upload_ticket_;
   gl_program_ = from.Program();
   gl_program_uniforms_ = from.Uniforms();
   gl_buffer_ = nullptr;
@@ -415,20 +640,27 @@ void HwSprite::Clear(Rgba color) {
     return;
   }
 
+  GetEngine()->GetHwSpriteBatch().Flush();
   sprite_instance_->framebuffer().Bind();
-  glClearColor(
-    static_cast<float>(color.r) / 255.0f,
-    static_cast<float>(color.g) / 255.0f,
-    static_cast<float>(color.b) / 255.0f,
-    static_cast<float>(color.a) / 255.0f
-  );
+  GlState::SetClearColor(color);
+  // A reference shares the texture, so only its part is cleared.
+  const bool is_ref = IsRef();
+  if (is_ref) {
+    GlState::SetScissorTest(true);
+    GlState::SetScissor(ref_pos_.x, ref_pos_.y, ref_size_.x, ref_size_.y);
+  }
   glClear(GL_COLOR_BUFFER_BIT);
+  if (is_ref) {
+    GlState::SetScissorTest(false);
+  }
   //GlFramebuffer::BindDefault();
 }
 
 void HwSprite::Clone(const HwSprite &from, CloneTransform transform) {
   if (!from.sprite_instance_) {
     sprite_instance_ = nullptr;
+    atlas_region_ = nullptr;
+    upload_ticket_ = nullptr;
     ref_pos_ = Vec2Si32(0, 0);
     ref_size_ = Vec2Si32(0, 0);
     pivot_ = Vec2Si32(0, 0);
@@ -619,6 +851,58 @@ void HwSprite::Draw(const float to_x, const float to_y, float angle_radians, flo
         0, 0, static_cast<float>(Width()), static_cast<float>(Height()), in_color, blending_mode, filter_mode, angle_radians, zoom);
 }
 
+void HwSprite::DrawInstanced(const HwSpriteInstanceAttribs *instances, Si32 count,
+        DrawBlendingMode blending_mode, DrawFilterMode filter_mode) {
+    DrawInstanced(GetEngine()->GetHwBackbuffer(), instances, count, blending_mode, filter_mode);
+}
+
+void HwSprite::DrawInstanced(const std::vector<HwSpriteInstanceAttribs> &instances,
+        DrawBlendingMode blending_mode, DrawFilterMode filter_mode) {
+    DrawInstanced(GetEngine()->GetHwBackbuffer(), instances.data(), static_cast<Si32>(instances.size()),
+        blending_mode, filter_mode);
+}
+
+void HwSprite::DrawInstanced(const HwSprite &to_sprite, const HwSpriteInstanceAttribs *instances, Si32 count,
+        DrawBlendingMode blending_mode, DrawFilterMode filter_mode) {
+    if (!sprite_instance_ || !gl_program_ || count <= 0) {
+        return;
+    }
+    HwSpriteInstancer &instancer = GetEngine()->GetHwSpriteInstancer();
+    if (!instancer.IsSupported() || gl_program_ != GetEngine()->GetDefaultSpriteProgram()
+            || gl_program_uniforms_.Size() != 0) {
+        for (Si32 idx = 0; idx < count; ++idx) {
+            const HwSpriteInstanceAttribs &instance = instances[idx];
+            Draw(instance.pos.x, instance.pos.y, instance.angle_radians, instance.zoom, to_sprite,
+                blending_mode, filter_mode, instance.color);
+        }
+        return;
+    }
+
+    const float tex_w = static_cast<float>(sprite_instance_->width());
+    const float tex_h = static_cast<float>(sprite_instance_->height());
+    const float u0 = static_cast<float>(ref_pos_.x) / tex_w;
+    const float v0 = static_cast<float>(ref_pos_.y) / tex_h;
+    const float u1 = static_cast<float>(ref_pos_.x + ref_size_.x) / tex_w;
+    const float v1 = static_cast<float>(ref_pos_.y + ref_size_.y) / tex_h;
+    const float left = static_cast<float>(-pivot_.x);
+    const float right = static_cast<float>(ref_size_.x - pivot_.x);
+    const float down = static_cast<float>(-pivot_.y);
+    const float up = static_cast<float>(ref_size_.y - pivot_.y);
+    const Rgba white(255, 255, 255, 255);
+    // d c
+    // a b
+    const HwSpriteVertex quad[4] = {
+        {Vec2F(left, down), Vec2F(u0, v0), white},
+        {Vec2F(right, down), Vec2F(u1, v0), white},
+        {Vec2F(right, up), Vec2F(u1, v1), white},
+        {Vec2F(left, up), Vec2F(u0, v1), white},
+    };
+    instancer.Draw(to_sprite.sprite_instance(),
+        Vec4Si32(to_sprite.ref_pos_.x + to_sprite.Pivot().x, to_sprite.ref_pos_.y + to_sprite.Pivot().y,
+            to_sprite.Width(), to_sprite.Height()),
+        sprite_instance_, blending_mode, filter_mode, quad, instances, count);
+}
+
 Si32 HwSprite::Width() const {
   return ref_size_.x;
 }
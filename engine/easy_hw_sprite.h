@@ -29,7 +29,11 @@
 #include <vector>
 
 #include "engine/easy_sprite.h"
+#include "engine/easy_hw_sprite_atlas.h"
 #include "engine/easy_hw_sprite_instance.h"
+#include "engine/easy_hw_sprite_instancer.h"
+#include "engine/easy_hw_sprite_readback.h"
+#include "engine/easy_hw_sprite_upload_queue.h"
 #include "engine/arctic_types.h"
 #include "engine/vec2si32.h"
 #include "engine/rgba.h"
@@ -44,6 +48,8 @@ namespace arctic {
 class HwSprite {
  private:
   std::shared_ptr<HwSpriteInstance> sprite_instance_;
+  std::shared_ptr<HwSpriteAtlas::Region> atlas_region_;
+  std::shared_ptr<HwSpriteUploadQueue::Ticket> upload_ticket_;
   Vec2Si32 ref_pos_;
   Vec2Si32 ref_size_;
   Vec2Si32 pivot_;
@@ -59,6 +65,9 @@ class HwSprite {
     const HwSprite &from_sprite, const float from_x, const float from_y, const float from_width, const float from_height,
     Rgba in_color, DrawBlendingMode blending_mode, DrawFilterMode filter_mode, float angle_radians, float zoom);
   void UpdateVertexBuffer(float angle) const;
+  /// @brief Puts the pixels into the atlas, or a texture of their own if
+  ///   they don't fit there, and makes the sprite show them.
+  void LoadPixels(const Rgba *data, Si32 stride_pixels, Si32 width, Si32 height);
 
  public:
   HwSprite();
@@ -76,6 +85,22 @@ class HwSprite {
   void Load(const std::string &file_name);
   /// @brief Load sprite data from software sprite
   void LoadFromSoftwareSprite(Sprite sw_sprite);
+  /// @brief Start loading sprite data from file in the background.
+  /// The sprite gets its size right away and stays transparent until
+  /// the pixels are uploaded, see IsResident.
+  void LoadAsync(const char *file_name);
+  /// @brief Start loading sprite data from file in the background
+  void LoadAsync(const std::string &file_name);
+  /// @brief Start uploading sprite data from software sprite in the background
+  void LoadFromSoftwareSpriteAsync(Sprite sw_sprite);
+  /// @brief Returns false while the pixels of an async load are on the way
+  bool IsResident() const;
+  /// @brief Start reading the sprite pixels back to the CPU without waiting
+  /// for the GPU. The readback resolves to a software sprite a frame or two
+  /// later, see HwSpriteReadback.
+  HwSpriteReadback ReadAsync() const;
+  /// @brief Read the sprite pixels back to the CPU, waits for the GPU
+  Sprite ToSoftwareSprite() const;
   // @brief Load sprite data from file
   //void Save(const char *file_name);
   // @brief Load sprite data from file
@@ -85,6 +110,13 @@ class HwSprite {
   void Create(const Vec2Si32 size);
   /// @brief Make current sprite an empty sprite of the specified size
   void Create(const Si32 width, const Si32 height);
+  /// @brief Make current sprite a target that draws straight to the window
+  /// @details The window contents are undefined at the start of each frame,
+  ///   so the target has to be cleared before drawing. It can not be drawn
+  ///   from, references to it are targets too.
+  void CreateWindowTarget(const Si32 width, const Si32 height);
+  /// @brief Returns true if the sprite draws straight to the window
+  bool IsWindowTarget() const;
   /// @brief Make current sprite reference to a rectangular part of another sprite using inverted y
   void InvReference(const HwSprite &from, const Si32 from_x, const Si32 from_inv_y,
     const Si32 from_width, const Si32 from_height);
@@ -187,6 +219,14 @@ class HwSprite {
   void Draw(const float to_x, const float to_y, float angle_radians, float zoom, const HwSprite &to_sprite,
       DrawBlendingMode blending_mode = kDrawBlendingModeAlphaBlend, DrawFilterMode filter_mode = kFilterNearest,
       Rgba in_color = Rgba(0xffffffff));
+  /// @brief Draw a copy of the sprite for each of the instances with one instanced
+  /// draw call, or batched where instancing is not available
+  void DrawInstanced(const HwSpriteInstanceAttribs *instances, Si32 count,
+      DrawBlendingMode blending_mode = kDrawBlendingModeAlphaBlend, DrawFilterMode filter_mode = kFilterNearest);
+  void DrawInstanced(const std::vector<HwSpriteInstanceAttribs> &instances,
+      DrawBlendingMode blending_mode = kDrawBlendingModeAlphaBlend, DrawFilterMode filter_mode = kFilterNearest);
+  void DrawInstanced(const HwSprite &to_sprite, const HwSpriteInstanceAttribs *instances, Si32 count,
+      DrawBlendingMode blending_mode = kDrawBlendingModeAlphaBlend, DrawFilterMode filter_mode = kFilterNearest);
 
   /// @brief Get width of the sprite in pixels
   Si32 Width() const;
@@ -0,0 +1,238 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/easy_hw_sprite_atlas.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include "engine/arctic_platform.h"
+#include "engine/easy_advanced.h"
+#include "engine/engine.h"
+#include "engine/log.h"
+#include "engine/opengl.h"
+
+namespace arctic {
+
+namespace {
+
+bool Intersects(const RectSi32 &a, const RectSi32 &b) {
+  return a.begin.x < b.end.x && b.begin.x < a.end.x
+    && a.begin.y < b.end.y && b.begin.y < a.end.y;
+}
+
+bool Contains(const RectSi32 &outer, const RectSi32 &inner) {
+  return outer.begin.x <= inner.begin.x && outer.begin.y <= inner.begin.y
+    && inner.end.x <= outer.end.x && inner.end.y <= outer.end.y;
+}
+
+}  // namespace
+
+HwSpriteAtlas::Page::Page(Si32 size) {
+  instance_ = std::make_shared<HwSpriteInstance>(size, size);
+  RectSi32 all;
+  all.begin = Vec2Si32(0, 0);
+  all.end = Vec2Si32(size, size);
+  free_rects_.push_back(all);
+}
+
+bool HwSpriteAtlas::Page::Allocate(Si32 width, Si32 height,
+    RectSi32 *out_rect) {
+  // Best short side fit.
+  Si32 best_short = std::numeric_limits<Si32>::max();
+  Si32 best_long = std::numeric_limits<Si32>::max();
+  const RectSi32 *best = nullptr;
+  for (const RectSi32 &rect : free_rects_) {
+    Si32 left_x = rect.end.x - rect.begin.x - width;
+    Si32 left_y = rect.end.y - rect.begin.y - height;
+    if (left_x < 0 || left_y < 0) {
+      continue;
+    }
+    Si32 short_side = std::min(left_x, left_y);
+    Si32 long_side = std::max(left_x, left_y);
+    if (short_side < best_short
+        || (short_side == best_short && long_side < best_long)) {
+      best_short = short_side;
+      best_long = long_side;
+      best = &rect;
+    }
+  }
+  if (!best) {
+    return false;
+  }
+  out_rect->begin = best->begin;
+  out_rect->end = best->begin + Vec2Si32(width, height);
+  SplitFreeRects(*out_rect);
+  PruneFreeRects();
+  ++region_count_;
+  return true;
+}
+
+void HwSpriteAtlas::Page::Free(const RectSi32 &rect) {
+  --region_count_;
+  if (region_count_ == 0) {
+    // Nothing is left, so the whole page is one free rectangle again.
+    RectSi32 all;
+    all.begin = Vec2Si32(0, 0);
+    all.end = Vec2Si32(instance_->width(), instance_->height());
+    free_rects_.assign(1, all);
+    return;
+  }
+  free_rects_.push_back(rect);
+  PruneFreeRects();
+}
+
+void HwSpriteAtlas::Page::SplitFreeRects(const RectSi32 &used) {
+  std::vector<RectSi32> split;
+  split.reserve(free_rects_.size() + 4);
+  for (const RectSi32 &rect : free_rects_) {
+    if (!Intersects(rect, used)) {
+      split.push_back(rect);
+      continue;
+    }
+    RectSi32 part;
+    if (used.begin.x > rect.begin.x) {
+      part.begin = rect.begin;
+      part.end = Vec2Si32(used.begin.x, rect.end.y);
+      split.push_back(part);
+    }
+    if (used.end.x < rect.end.x) {
+      part.begin = Vec2Si32(used.end.x, rect.begin.y);
+      part.end = rect.end;
+      split.push_back(part);
+    }
+    if (used.begin.y > rect.begin.y) {
+      part.begin = rect.begin;
+      part.end = Vec2Si32(rect.end.x, used.begin.y);
+      split.push_back(part);
+    }
+    if (used.end.y < rect.end.y) {
+      part.begin = Vec2Si32(rect.begin.x, used.end.y);
+      part.end = rect.end;
+      split.push_back(part);
+    }
+  }
+  free_rects_.swap(split);
+}
+
+void HwSpriteAtlas::Page::PruneFreeRects() {
+  for (size_t i = 0; i < free_rects_.size(); ++i) {
+    for (size_t j = i + 1; j < free_rects_.size(); ++j) {
+      if (Contains(free_rects_[j], free_rects_[i])) {
+        free_rects_.erase(free_rects_.begin() + static_cast<std::ptrdiff_t>(i));
+        --i;
+        break;
+      }
+      if (Contains(free_rects_[i], free_rects_[j])) {
+        free_rects_.erase(free_rects_.begin() + static_cast<std::ptrdiff_t>(j));
+        --j;
+      }
+    }
+  }
+}
+
+HwSpriteAtlas::Region::Region(const std::shared_ptr<Page> &page,
+    const RectSi32 &rect)
+    : page_(page)
+    , rect_(rect) {
+}
+
+HwSpriteAtlas::Region::~Region() {
+  page_->Free(rect_);
+}
+
+HwSpriteAtlas::HwSpriteAtlas() {
+}
+
+std::shared_ptr<HwSpriteAtlas::Region> HwSpriteAtlas::Allocate(Si32 width,
+    Si32 height) {
+  if (!is_enabled_ || width <= 0 || height <= 0
+      || width > kMaxSpriteSize || height > kMaxSpriteSize) {
+    return nullptr;
+  }
+  if (page_size_ == 0) {
+    GLint max_size = 0;
+    ARCTIC_GL_CHECK_ERROR(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size));
+    page_size_ = std::min(kPageSize, static_cast<Si32>(max_size));
+  }
+
+  for (size_t i = pages_.size(); i > 1; --i) {
+    if (pages_[i - 1]->region_count() == 0) {
+      pages_.erase(pages_.begin() + static_cast<std::ptrdiff_t>(i - 1));
+    }
+  }
+
+  const Si32 padded_width = width + 2 * kPadding;
+  const Si32 padded_height = height + 2 * kPadding;
+  RectSi32 rect;
+  std::shared_ptr<Page> page;
+  for (const std::shared_ptr<Page> &candidate : pages_) {
+    if (candidate->Allocate(padded_width, padded_height, &rect)) {
+      page = candidate;
+      break;
+    }
+  }
+  if (!page) {
+    if (static_cast<Si32>(pages_.size()) >= kMaxPageCount) {
+      return nullptr;
+    }
+    pages_.push_back(std::make_shared<Page>(page_size_));
+    if (!pages_.back()->Allocate(padded_width, padded_height, &rect)) {
+      return nullptr;
+    }
+    page = pages_.back();
+  }
+  return std::make_shared<Region>(page, rect);
+}
+
+std::shared_ptr<HwSpriteAtlas::Region> HwSpriteAtlas::Add(const Rgba *data,
+    Si32 stride_pixels, Si32 width, Si32 height) {
+  std::shared_ptr<Region> region = Allocate(width, height);
+  if (!region) {
+    return nullptr;
+  }
+  Extrude(data, stride_pixels, width, height, &padded_);
+  // Queued draws may still sample a region freed since they were recorded.
+  GetEngine()->GetHwSpriteBatch().Flush();
+  const RectSi32 &rect = region->rect();
+  region->instance()->texture().UpdateSubData(padded_.data(), rect.begin,
+    rect.end - rect.begin);
+  return region;
+}
+
+void HwSpriteAtlas::Extrude(const Rgba *data, Si32 stride_pixels,
+    Si32 width, Si32 height, std::vector<Rgba> *out_padded) {
+  const Si32 padded_width = width + 2 * kPadding;
+  const Si32 padded_height = height + 2 * kPadding;
+  out_padded->resize(static_cast<size_t>(padded_width) * padded_height);
+  for (Si32 y = 0; y < padded_height; ++y) {
+    const Si32 from_y = std::min(std::max(y - kPadding, 0), height - 1);
+    const Rgba *from = data + static_cast<size_t>(from_y) * stride_pixels;
+    Rgba *to = out_padded->data() + static_cast<size_t>(y) * padded_width;
+    for (Si32 x = 0; x < padded_width; ++x) {
+      to[x] = from[std::min(std::max(x - kPadding, 0), width - 1)];
+    }
+  }
+}
+
+}  // namespace arctic
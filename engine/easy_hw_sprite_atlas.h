@@ -0,0 +1,150 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_EASY_HW_SPRITE_ATLAS_H_
+#define ENGINE_EASY_HW_SPRITE_ATLAS_H_
+
+#include <memory>
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/easy_hw_sprite_instance.h"
+#include "engine/easy_sprite_instance.h"
+#include "engine/rgba.h"
+#include "engine/vec2si32.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief Packs small HwSprites into shared texture pages, so the sprites of
+/// a scene mostly come from a few textures and their draws batch together.
+/// Pages use a maxrects allocator. A page whose sprites are all gone is
+/// reset to a single free rectangle, and empty pages beyond the first one are
+/// released. Sprites that don't fit get a texture of their own.
+class HwSpriteAtlas {
+ public:
+  static const Si32 kPageSize = 2048;
+  /// @brief Sprites larger than this in either dimension are not packed.
+  static const Si32 kMaxSpriteSize = 256;
+  static const Si32 kMaxPageCount = 8;
+  /// @brief Border of repeated edge pixels around each sprite, so bilinear
+  /// filtering never samples the neighbours.
+  static const Si32 kPadding = 1;
+
+  class Page {
+   private:
+    std::shared_ptr<HwSpriteInstance> instance_;
+    std::vector<RectSi32> free_rects_;
+    Si32 region_count_ = 0;
+
+    void SplitFreeRects(const RectSi32 &used);
+    void PruneFreeRects();
+
+   public:
+    explicit Page(Si32 size);
+    /// @brief Finds a place for a width x height rectangle.
+    /// @return false if it does not fit.
+    bool Allocate(Si32 width, Si32 height, RectSi32 *out_rect);
+    void Free(const RectSi32 &rect);
+
+    const std::shared_ptr<HwSpriteInstance> &instance() const {
+      return instance_;
+    }
+    Si32 region_count() const {
+      return region_count_;
+    }
+  };
+
+  /// @brief A sprite-sized part of a page. Sprites that show it share the
+  /// region, and it is freed when the last of them is gone.
+  class Region {
+   private:
+    std::shared_ptr<Page> page_;
+    RectSi32 rect_;
+
+   public:
+    Region(const std::shared_ptr<Page> &page, const RectSi32 &rect);
+    ~Region();
+
+    const std::shared_ptr<HwSpriteInstance> &instance() const {
+      return page_->instance();
+    }
+    /// @brief Position of the sprite pixels in the page, past the padding.
+    Vec2Si32 pos() const {
+      return rect_.begin + Vec2Si32(kPadding, kPadding);
+    }
+    /// @brief The place in the page, padding included.
+    const RectSi32 &rect() const {
+      return rect_;
+    }
+  };
+
+ private:
+  HwSpriteAtlas(HwSpriteAtlas &other) = delete;
+  HwSpriteAtlas(HwSpriteAtlas &&other) = delete;
+  HwSpriteAtlas &operator=(HwSpriteAtlas &other) = delete;
+  HwSpriteAtlas &operator=(HwSpriteAtlas &&other) = delete;
+
+  std::vector<std::shared_ptr<Page>> pages_;
+  std::vector<Rgba> padded_;
+  Si32 page_size_ = 0;
+  bool is_enabled_ = true;
+
+ public:
+  HwSpriteAtlas();
+
+  /// @brief Finds a place for a width x height sprite without uploading
+  ///   anything, see Extrude for the pixels to put there.
+  /// @return The region, or nullptr if the atlas is disabled, the sprite is
+  ///   too large or all the pages are full.
+  std::shared_ptr<Region> Allocate(Si32 width, Si32 height);
+  /// @brief Packs the pixels into a page and uploads them.
+  /// @param [in] data The first pixel of the bottom row.
+  /// @param [in] stride_pixels Distance between the rows, in pixels.
+  /// @return The region, or nullptr if the atlas is disabled, the sprite is
+  ///   too large or all the pages are full.
+  std::shared_ptr<Region> Add(const Rgba *data, Si32 stride_pixels,
+    Si32 width, Si32 height);
+
+  /// @brief Makes the pixels of a region: the sprite with its edge pixels
+  ///   repeated kPadding times on each side.
+  static void Extrude(const Rgba *data, Si32 stride_pixels,
+    Si32 width, Si32 height, std::vector<Rgba> *out_padded);
+
+  void SetEnabled(bool is_enabled) {
+    is_enabled_ = is_enabled;
+  }
+  bool IsEnabled() const {
+    return is_enabled_;
+  }
+  Si32 PageCount() const {
+    return static_cast<Si32>(pages_.size());
+  }
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_EASY_HW_SPRITE_ATLAS_H_
@@ -0,0 +1,120 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/easy_hw_sprite_batch.h"
+
+#include <cstddef>
+#include <sstream>
+
+#include "engine/arctic_platform.h"
+#include "engine/gl_state.h"
+#include "engine/log.h"
+#include "engine/opengl.h"
+
+namespace arctic {
+
+HwSpriteBatch::HwSpriteBatch() : viewport_(0, 0, 0, 0) {
+}
+
+void HwSpriteBatch::Init(const std::shared_ptr<GlProgram> &program) {
+    program_ = program;
+    vertex_buffer_.Create(nullptr, 0);
+    vertices_.clear();
+    vertices_.reserve(1024 * 6);
+    to_ = nullptr;
+    from_ = nullptr;
+    draw_call_count_ = 0;
+}
+
+void HwSpriteBatch::AddQuad(const std::shared_ptr<HwSpriteInstance> &to,
+    const Vec4Si32 &viewport,
+    const std::shared_ptr<HwSpriteInstance> &from,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    const HwSpriteVertex (&quad)[4]) {
+    if (!vertices_.empty() && (to != to_ || from != from_
+            || viewport != viewport_
+            || blending_mode != blending_mode_
+            || filter_mode != filter_mode_
+            || vertices_.size() >= static_cast<size_t>(kMaxQuads) * 6)) {
+        Flush();
+    }
+    if (vertices_.empty()) {
+        to_ = to;
+        from_ = from;
+        viewport_ = viewport;
+        blending_mode_ = blending_mode;
+        filter_mode_ = filter_mode;
+    }
+
+    // d c
+    // a b
+    vertices_.push_back(quad[0]);
+    vertices_.push_back(quad[1]);
+    vertices_.push_back(quad[2]);
+    vertices_.push_back(quad[3]);
+    vertices_.push_back(quad[0]);
+    vertices_.push_back(quad[2]);
+}
+
+void HwSpriteBatch::Flush() {
+    if (vertices_.empty()) {
+        return;
+    }
+
+    vertex_buffer_.StreamData(vertices_.data(),
+        vertices_.size() * sizeof(HwSpriteVertex));
+    const GLsizei stride = sizeof(HwSpriteVertex);
+    ARCTIC_GL_CHECK_ERROR(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride,
+        (void*)offsetof(HwSpriteVertex, pos)));
+    ARCTIC_GL_CHECK_ERROR(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride,
+        (void*)offsetof(HwSpriteVertex, tex)));
+    ARCTIC_GL_CHECK_ERROR(glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+        (void*)offsetof(HwSpriteVertex, color)));
+    GlState::SetVertexAttribArrays(0x7);
+
+    program_->Bind();
+    program_->SetUniform("s_texture", 0);
+    program_->SetUniform("to_sprite_size", Vec2F(
+        static_cast<float>(viewport_.z), static_cast<float>(viewport_.w)));
+    program_->SetUniform("is_solid_color",
+        static_cast<int>(blending_mode_ == kDrawBlendingModeSolidColor));
+    program_->CheckActiveUniforms(3);
+
+    to_->framebuffer().Bind();
+    GlState::SetViewport(viewport_.x, viewport_.y, viewport_.z, viewport_.w);
+
+    GlTexture2D &texture = from_->texture();
+    texture.SetFilterMode(filter_mode_);
+    texture.Bind(0);
+
+    GlState::SetBlending(blending_mode_);
+
+    ARCTIC_GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLES, 0,
+        static_cast<GLsizei>(vertices_.size())));
+    ++draw_call_count_;
+
+    vertices_.clear();
+    to_ = nullptr;
+    from_ = nullptr;
+}
+
+}  // namespace arctic
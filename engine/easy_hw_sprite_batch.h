@@ -0,0 +1,107 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_EASY_HW_SPRITE_BATCH_H_
+#define ENGINE_EASY_HW_SPRITE_BATCH_H_
+
+#include <memory>
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/easy_sprite.h"
+#include "engine/easy_hw_sprite_instance.h"
+#include "engine/gl_buffer.h"
+#include "engine/gl_program.h"
+#include "engine/rgba.h"
+#include "engine/vec2f.h"
+#include "engine/vec4si32.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+struct HwSpriteVertex {
+  Vec2F pos;
+  Vec2F tex;
+  Rgba color;
+};
+
+/// @brief Collects HwSprite draws into a single streaming vertex buffer.
+/// Quads are transformed on the CPU and drawn with one call per run of
+/// sprites that share the source texture, the filter mode, the blending
+/// mode and the target. A draw that changes any of these flushes the batch.
+class HwSpriteBatch {
+ public:
+  /// @brief Quads per draw call, a batch that grows larger is flushed.
+  static const Si32 kMaxQuads = 16384;
+
+ private:
+  HwSpriteBatch(HwSpriteBatch &other) = delete;
+  HwSpriteBatch(HwSpriteBatch &&other) = delete;
+  HwSpriteBatch &operator=(HwSpriteBatch &other) = delete;
+  HwSpriteBatch &operator=(HwSpriteBatch &&other) = delete;
+
+  std::shared_ptr<GlProgram> program_;
+  GlBuffer vertex_buffer_;
+  std::vector<HwSpriteVertex> vertices_;
+
+  // The instances are held until the flush, so the sprites may be destroyed
+  // right after a draw.
+  std::shared_ptr<HwSpriteInstance> to_;
+  std::shared_ptr<HwSpriteInstance> from_;
+  Vec4Si32 viewport_;
+  DrawBlendingMode blending_mode_ = kDrawBlendingModeAlphaBlend;
+  DrawFilterMode filter_mode_ = kFilterNearest;
+
+  Si64 draw_call_count_ = 0;
+
+ public:
+  HwSpriteBatch();
+
+  void Init(const std::shared_ptr<GlProgram> &program);
+  /// @brief Appends a quad, flushing the batch first if the state differs.
+  /// @param [in] quad The corners in the target pixel space, counterclockwise
+  ///   starting at the bottom left one.
+  void AddQuad(const std::shared_ptr<HwSpriteInstance> &to,
+    const Vec4Si32 &viewport,
+    const std::shared_ptr<HwSpriteInstance> &from,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    const HwSpriteVertex (&quad)[4]);
+  /// @brief Draws the collected quads. Must be called before anything
+  ///   else touches the textures or the framebuffers involved.
+  void Flush();
+
+  bool IsEmpty() const {
+    return vertices_.empty();
+  }
+  /// @brief Returns the number of draw calls issued since Init.
+  Si64 DrawCallCount() const {
+    return draw_call_count_;
+  }
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_EASY_HW_SPRITE_BATCH_H_
@@ -40,11 +40,22 @@
 namespace arctic {
 
 
-  HwSpriteInstance::HwSpriteInstance(Si32 width, Si32 height) {
+  HwSpriteInstance::HwSpriteInstance(Si32 width, Si32 height)
+      : width_(width)
+      , height_(height) {
     texture_.Create(width, height);
     framebuffer_.Create(texture_);
   }
 
+  std::shared_ptr<HwSpriteInstance> HwSpriteInstance::CreateDefaultFramebuffer(
+      Si32 width, Si32 height) {
+    // The framebuffer is never created, so it binds framebuffer 0.
+    std::shared_ptr<HwSpriteInstance> sprite(new HwSpriteInstance());
+    sprite->width_ = width;
+    sprite->height_ = height;
+    return sprite;
+  }
+
   std::shared_ptr<HwSpriteInstance> HwSpriteInstance::LoadTga(const Ui8 *data, const Si64 size) {
     std::shared_ptr<SpriteInstance> sw_sprite = arctic::LoadTga(data, size);
     std::shared_ptr<HwSpriteInstance> sprite = std::make_shared<HwSpriteInstance>(sw_sprite->width(), sw_sprite->height());
@@ -39,10 +39,23 @@ class HwSpriteInstance {
  private:
   GlTexture2D texture_;
   GlFramebuffer framebuffer_;
+  Si32 width_ = 0;
+  Si32 height_ = 0;
+
+  HwSpriteInstance() {
+  }
 
  public:
   HwSpriteInstance(Si32 width, Si32 height);
 
+  /// @brief Creates an instance that renders straight to the default
+  ///   framebuffer. It has no texture, so it can not be drawn from.
+  static std::shared_ptr<HwSpriteInstance> CreateDefaultFramebuffer(
+      Si32 width, Si32 height);
+  bool IsDefaultFramebuffer() const {
+    return texture_.texture_id() == 0;
+  }
+
   GlTexture2D &texture() {
     return texture_;
   }
@@ -52,11 +65,11 @@ class HwSpriteInstance {
   }
 
   Si32 width() const {
-    return texture_.width();
+    return width_;
   }
 
   Si32 height() const {
-      return texture_.height();
+    return height_;
   }
 
   /// @brief Creates a sprite instance from *.tga file data
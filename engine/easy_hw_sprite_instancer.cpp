@@ -0,0 +1,139 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/easy_hw_sprite_instancer.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <sstream>
+
+#include "engine/arctic_platform.h"
+#include "engine/easy_advanced.h"
+#include "engine/engine.h"
+#include "engine/gl_state.h"
+#include "engine/log.h"
+#include "engine/opengl.h"
+
+namespace arctic {
+
+static_assert(sizeof(HwSpriteInstanceAttribs) == 20,
+  "HwSpriteInstanceAttribs is uploaded as is, it must have no padding");
+
+HwSpriteInstancer::HwSpriteInstancer() {
+}
+
+bool HwSpriteInstancer::IsContextSupported() {
+#ifdef ARCTIC_GL_INSTANCING
+#ifdef ARCTIC_PLATFORM_WINDOWS
+  if (!glVertexAttribDivisor || !glDrawArraysInstanced) {
+    return false;
+  }
+#endif  // ARCTIC_PLATFORM_WINDOWS
+  const char *version = reinterpret_cast<const char*>(
+    glGetString(GL_VERSION));
+  int major = 0;
+  int minor = 0;
+  if (!version || sscanf(version, "%d.%d", &major, &minor) != 2) {
+    return false;
+  }
+  return major > 3 || (major == 3 && minor >= 3);
+#else
+  return false;
+#endif  // ARCTIC_GL_INSTANCING
+}
+
+void HwSpriteInstancer::Init(const std::shared_ptr<GlProgram> &program) {
+  program_ = program;
+  is_supported_ = IsContextSupported();
+  if (is_supported_) {
+    quad_buffer_.Create(nullptr, 0);
+    instance_buffer_.Create(nullptr, 0);
+  }
+  draw_call_count_ = 0;
+}
+
+void HwSpriteInstancer::Draw(const std::shared_ptr<HwSpriteInstance> &to,
+    const Vec4Si32 &viewport,
+    const std::shared_ptr<HwSpriteInstance> &from,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    const HwSpriteVertex (&quad)[4],
+    const HwSpriteInstanceAttribs *instances, Si32 count) {
+#ifdef ARCTIC_GL_INSTANCING
+  if (count <= 0) {
+    return;
+  }
+  GetEngine()->GetHwSpriteBatch().Flush();
+
+  // d c
+  // a b
+  // The triangles are split like in HwSpriteBatch, so that the texture
+  // coordinates are interpolated the same way.
+  const HwSpriteVertex triangles[6] = {
+    quad[0], quad[1], quad[2], quad[0], quad[2], quad[3]};
+  quad_buffer_.StreamData(triangles, sizeof(triangles));
+  const GLsizei stride = sizeof(HwSpriteVertex);
+  ARCTIC_GL_CHECK_ERROR(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride,
+    (void*)offsetof(HwSpriteVertex, pos)));
+  ARCTIC_GL_CHECK_ERROR(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride,
+    (void*)offsetof(HwSpriteVertex, tex)));
+
+  instance_buffer_.StreamData(instances,
+    static_cast<size_t>(count) * sizeof(HwSpriteInstanceAttribs));
+  const GLsizei instance_stride = sizeof(HwSpriteInstanceAttribs);
+  ARCTIC_GL_CHECK_ERROR(glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+    instance_stride, (void*)offsetof(HwSpriteInstanceAttribs, color)));
+  ARCTIC_GL_CHECK_ERROR(glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE,
+    instance_stride, (void*)offsetof(HwSpriteInstanceAttribs, pos)));
+  GlState::SetVertexAttribArrays(0xf);
+  GlState::SetInstancedVertexAttribs(0xc);
+
+  program_->Bind();
+  program_->SetUniform("s_texture", 0);
+  program_->SetUniform("to_sprite_size", Vec2F(
+    static_cast<float>(viewport.z), static_cast<float>(viewport.w)));
+  program_->SetUniform("is_solid_color",
+    static_cast<int>(blending_mode == kDrawBlendingModeSolidColor));
+  // Only the colorizing modes tint the sprite.
+  program_->SetUniform("is_tinted",
+    static_cast<int>(blending_mode == kDrawBlendingModeColorize
+      || blending_mode == kDrawBlendingModeSolidColor));
+  program_->CheckActiveUniforms(4);
+
+  to->framebuffer().Bind();
+  GlState::SetViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+
+  GlTexture2D &texture = from->texture();
+  texture.SetFilterMode(filter_mode);
+  texture.Bind(0);
+
+  GlState::SetBlending(blending_mode);
+
+  ARCTIC_GL_CHECK_ERROR(glDrawArraysInstanced(GL_TRIANGLES, 0, 6,
+    static_cast<GLsizei>(count)));
+  ++draw_call_count_;
+
+  // The other paths expect every attribute to advance per vertex.
+  GlState::SetInstancedVertexAttribs(0);
+#endif  // ARCTIC_GL_INSTANCING
+}
+
+}  // namespace arctic
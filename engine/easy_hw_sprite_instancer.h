@@ -0,0 +1,101 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_EASY_HW_SPRITE_INSTANCER_H_
+#define ENGINE_EASY_HW_SPRITE_INSTANCER_H_
+
+#include <memory>
+
+#include "engine/arctic_types.h"
+#include "engine/easy_sprite.h"
+#include "engine/easy_hw_sprite_batch.h"
+#include "engine/easy_hw_sprite_instance.h"
+#include "engine/gl_buffer.h"
+#include "engine/gl_program.h"
+#include "engine/rgba.h"
+#include "engine/vec2f.h"
+#include "engine/vec4si32.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief Where and how to draw one copy of a sprite,
+///   see HwSprite::DrawInstanced. Uploaded to the GPU as is.
+struct HwSpriteInstanceAttribs {
+  /// @brief Position of the sprite pivot in the target.
+  Vec2F pos;
+  float angle_radians = 0.0f;
+  float zoom = 1.0f;
+  /// @brief Only the colorizing blending modes use it, like with Draw.
+  Rgba color = Rgba(255, 255, 255, 255);
+};
+
+/// @brief Draws many copies of one sprite with a single instanced draw call.
+/// The quad is uploaded once per call and the copies differ only in the
+/// per instance attributes, so nothing is computed on the CPU per copy.
+class HwSpriteInstancer {
+ private:
+  HwSpriteInstancer(HwSpriteInstancer &other) = delete;
+  HwSpriteInstancer(HwSpriteInstancer &&other) = delete;
+  HwSpriteInstancer &operator=(HwSpriteInstancer &other) = delete;
+  HwSpriteInstancer &operator=(HwSpriteInstancer &&other) = delete;
+
+  std::shared_ptr<GlProgram> program_;
+  GlBuffer quad_buffer_;
+  GlBuffer instance_buffer_;
+  bool is_supported_ = false;
+  Si64 draw_call_count_ = 0;
+
+ public:
+  HwSpriteInstancer();
+
+  /// @brief Returns true if the current OpenGL context has instanced arrays.
+  static bool IsContextSupported();
+
+  void Init(const std::shared_ptr<GlProgram> &program);
+  /// @brief Returns false if the copies have to be drawn one by one.
+  bool IsSupported() const {
+    return is_supported_;
+  }
+  /// @brief Draws the copies. Flushes the HwSpriteBatch first.
+  /// @param [in] quad The corners relative to the sprite pivot, unrotated
+  ///   and unscaled, counterclockwise starting at the bottom left one.
+  void Draw(const std::shared_ptr<HwSpriteInstance> &to,
+    const Vec4Si32 &viewport,
+    const std::shared_ptr<HwSpriteInstance> &from,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    const HwSpriteVertex (&quad)[4],
+    const HwSpriteInstanceAttribs *instances, Si32 count);
+
+  /// @brief Returns the number of draw calls issued since Init.
+  Si64 DrawCallCount() const {
+    return draw_call_count_;
+  }
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_EASY_HW_SPRITE_INSTANCER_H_
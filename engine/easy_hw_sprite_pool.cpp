@@ -0,0 +1,105 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/easy_hw_sprite_pool.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace arctic {
+
+void HwSpritePool::State::Release(HwSpriteInstance *instance) {
+  const Si64 bytes = SizeBytes(instance->width(), instance->height());
+  if (bytes > limit_bytes) {
+    delete instance;
+    return;
+  }
+  Idle idle;
+  idle.key = Key(instance->width(), instance->height());
+  idle.instance.reset(instance);
+  lru.push_front(std::move(idle));
+  buckets[lru.front().key].push_back(lru.begin());
+  idle_bytes += bytes;
+  Trim(limit_bytes);
+}
+
+void HwSpritePool::State::Trim(Si64 limit) {
+  while (idle_bytes > limit && !lru.empty()) {
+    auto oldest = std::prev(lru.end());
+    auto bucket = buckets.find(oldest->key);
+    std::vector<std::list<Idle>::iterator> &entries = bucket->second;
+    entries.erase(std::find(entries.begin(), entries.end(), oldest));
+    if (entries.empty()) {
+      buckets.erase(bucket);
+    }
+    idle_bytes -= SizeBytes(oldest->instance->width(),
+      oldest->instance->height());
+    lru.erase(oldest);
+  }
+}
+
+HwSpritePool::HwSpritePool()
+    : state_(std::make_shared<State>()) {
+}
+
+std::shared_ptr<HwSpriteInstance> HwSpritePool::Acquire(Si32 width,
+    Si32 height) {
+  State &state = *state_;
+  HwSpriteInstance *instance = nullptr;
+  auto bucket = state.buckets.find(Key(width, height));
+  if (bucket != state.buckets.end()) {
+    // The most recently released one is the most likely to be warm.
+    auto idle = bucket->second.back();
+    bucket->second.pop_back();
+    if (bucket->second.empty()) {
+      state.buckets.erase(bucket);
+    }
+    instance = idle->instance.release();
+    state.idle_bytes -= SizeBytes(width, height);
+    state.lru.erase(idle);
+    ++state.reuse_count;
+  } else {
+    instance = new HwSpriteInstance(width, height);
+    ++state.allocation_count;
+  }
+  std::weak_ptr<State> weak_state = state_;
+  return std::shared_ptr<HwSpriteInstance>(instance,
+    [weak_state](HwSpriteInstance *released) {
+      std::shared_ptr<State> owner = weak_state.lock();
+      if (owner) {
+        owner->Release(released);
+      } else {
+        delete released;
+      }
+    });
+}
+
+void HwSpritePool::SetLimit(Si64 limit_bytes) {
+  state_->limit_bytes = limit_bytes;
+  state_->Trim(limit_bytes);
+}
+
+void HwSpritePool::Clear() {
+  state_->Trim(0);
+}
+
+}  // namespace arctic
@@ -0,0 +1,114 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_EASY_HW_SPRITE_POOL_H_
+#define ENGINE_EASY_HW_SPRITE_POOL_H_
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/easy_hw_sprite_instance.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief Keeps the texture and framebuffer pairs of released HwSprite
+/// render targets, so creating a sprite of the same size again does not
+/// allocate anything in the driver.
+/// Idle pairs are kept in buckets by exact size. When they take more memory
+/// than the limit, the least recently released ones are deleted.
+class HwSpritePool {
+ public:
+  static const Si64 kDefaultLimitBytes = 64ll << 20;
+
+ private:
+  HwSpritePool(HwSpritePool &other) = delete;
+  HwSpritePool(HwSpritePool &&other) = delete;
+  HwSpritePool &operator=(HwSpritePool &other) = delete;
+  HwSpritePool &operator=(HwSpritePool &&other) = delete;
+
+  struct Idle {
+    Ui64 key;
+    std::unique_ptr<HwSpriteInstance> instance;
+  };
+
+  /// @brief Outlives the pool while sprites still hold its instances.
+  struct State {
+    /// @brief The most recently released first.
+    std::list<Idle> lru;
+    std::unordered_map<Ui64, std::vector<std::list<Idle>::iterator>> buckets;
+    Si64 idle_bytes = 0;
+    Si64 limit_bytes = kDefaultLimitBytes;
+    Si64 allocation_count = 0;
+    Si64 reuse_count = 0;
+
+    void Release(HwSpriteInstance *instance);
+    void Trim(Si64 limit);
+  };
+
+  std::shared_ptr<State> state_;
+
+  static Ui64 Key(Si32 width, Si32 height) {
+    return (static_cast<Ui64>(static_cast<Ui32>(width)) << 32)
+      | static_cast<Ui32>(height);
+  }
+  static Si64 SizeBytes(Si32 width, Si32 height) {
+    return static_cast<Si64>(width) * height * 4;
+  }
+
+ public:
+  HwSpritePool();
+
+  /// @brief Returns an instance of exactly this size with undefined pixels.
+  /// It goes back to the pool once the last reference to it is gone.
+  std::shared_ptr<HwSpriteInstance> Acquire(Si32 width, Si32 height);
+  /// @brief Sets the memory limit for the idle instances and trims them.
+  void SetLimit(Si64 limit_bytes);
+  /// @brief Deletes all the idle instances.
+  void Clear();
+
+  Si64 GetLimit() const {
+    return state_->limit_bytes;
+  }
+  Si64 IdleBytes() const {
+    return state_->idle_bytes;
+  }
+  /// @brief Number of instances created by the pool.
+  Si64 AllocationCount() const {
+    return state_->allocation_count;
+  }
+  /// @brief Number of requests served with an idle instance.
+  Si64 ReuseCount() const {
+    return state_->reuse_count;
+  }
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_EASY_HW_SPRITE_POOL_H_
@@ -0,0 +1,254 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/easy_hw_sprite_readback.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include "engine/easy_advanced.h"
+#include "engine/engine.h"
+#include "engine/gl_pixel_buffer_ring.h"
+#include "engine/gl_state.h"
+#include "engine/log.h"
+#include "engine/rgba.h"
+
+namespace arctic {
+
+bool HwSpriteReadback::IsReady() const {
+  if (!state_) {
+    return false;
+  }
+  return GetEngine()->GetHwSpriteReadbackQueue().Resolve(state_.get(), false);
+}
+
+Sprite HwSpriteReadback::Get() const {
+  if (!state_) {
+    return Sprite();
+  }
+  GetEngine()->GetHwSpriteReadbackQueue().Resolve(state_.get(), true);
+  return state_->sprite;
+}
+
+HwSpriteReadbackQueue::HwSpriteReadbackQueue() {
+}
+
+HwSpriteReadbackQueue::~HwSpriteReadbackQueue() {
+  Clear();
+}
+
+HwSpriteReadback HwSpriteReadbackQueue::Read(HwSpriteInstance &instance,
+    Vec2Si32 pos, Vec2Si32 size, Vec2Si32 pivot) {
+  std::shared_ptr<HwSpriteReadback::State> state =
+    std::make_shared<HwSpriteReadback::State>();
+  state->size = size;
+  state->pivot = pivot;
+  if (size.x <= 0 || size.y <= 0) {
+    state->is_ready = true;
+    return HwSpriteReadback(state);
+  }
+
+  // The pending draws to the sprite have to land before the read.
+  GetEngine()->GetHwSpriteBatch().Flush();
+  instance.framebuffer().Bind();
+  GlState::SetPixelStore(GL_PACK_ALIGNMENT, 4);
+  if (is_supported_ < 0) {
+    is_supported_ = GlPixelBufferRing::IsSupported() ? 1 : 0;
+  }
+#ifdef ARCTIC_GL_PIXEL_BUFFERS
+  if (is_supported_) {
+    const size_t bytes = static_cast<size_t>(size.x) * size.y * sizeof(Rgba);
+    Buffer buffer = AcquireBuffer(bytes);
+    state->buffer_id = buffer.id;
+    state->buffer_size = buffer.size;
+    // With a pixel pack buffer bound the data pointer is an offset into it.
+    GlState::BindPixelPackBuffer(state->buffer_id);
+    ARCTIC_GL_CHECK_ERROR(glReadPixels(pos.x, pos.y, size.x, size.y,
+      GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+    GlState::BindPixelPackBuffer(0);
+    GLsync fence = nullptr;
+    ARCTIC_GL_CHECK_ERROR(fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,
+      0));
+    state->fence = fence;
+    pending_.push_back(state);
+    return HwSpriteReadback(state);
+  }
+#endif  // ARCTIC_GL_PIXEL_BUFFERS
+  state->sprite.Create(size.x, size.y);
+  ARCTIC_GL_CHECK_ERROR(glReadPixels(pos.x, pos.y, size.x, size.y,
+    GL_RGBA, GL_UNSIGNED_BYTE, state->sprite.RgbaData()));
+  state->sprite.SetPivot(pivot);
+  state->is_ready = true;
+  return HwSpriteReadback(state);
+}
+
+void HwSpriteReadbackQueue::Update() {
+  for (size_t idx = pending_.size(); idx > 0; --idx) {
+    std::shared_ptr<HwSpriteReadback::State> state = pending_[idx - 1];
+    if (state.use_count() == 2) {
+      // Only the pending list and the copy above hold it, so nobody waits
+      // for the pixels and the buffer is only to be recycled.
+      if (IsGpuDone(state.get(), false)) {
+        ReleaseBuffer(state.get());
+        Erase(state.get());
+      }
+    } else {
+      Resolve(state.get(), false);
+    }
+  }
+}
+
+bool HwSpriteReadbackQueue::Resolve(HwSpriteReadback::State *state,
+    bool is_waiting) {
+  if (state->is_ready) {
+    return true;
+  }
+  if (!IsGpuDone(state, is_waiting)) {
+    return false;
+  }
+#ifdef ARCTIC_GL_PIXEL_BUFFERS
+  state->sprite.Create(state->size.x, state->size.y);
+  state->sprite.SetPivot(state->pivot);
+  const size_t bytes = static_cast<size_t>(state->size.x) * state->size.y
+    * sizeof(Rgba);
+  GlState::BindPixelPackBuffer(state->buffer_id);
+  const void *src = nullptr;
+  ARCTIC_GL_CHECK_ERROR(src = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes,
+    GL_MAP_READ_BIT));
+  if (src) {
+    memcpy(state->sprite.RgbaData(), src, bytes);
+    ARCTIC_GL_CHECK_ERROR(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+  } else {
+    *Log() << "Error in HwSpriteReadbackQueue::Resolve,"
+      " could not map the pixel pack buffer.";
+  }
+  GlState::BindPixelPackBuffer(0);
+  ReleaseBuffer(state);
+#endif  // ARCTIC_GL_PIXEL_BUFFERS
+  state->is_ready = true;
+  Erase(state);
+  return true;
+}
+
+bool HwSpriteReadbackQueue::IsGpuDone(HwSpriteReadback::State *state,
+    bool is_waiting) {
+#ifdef ARCTIC_GL_PIXEL_BUFFERS
+  if (state->fence) {
+    const GLsync fence = static_cast<GLsync>(state->fence);
+    GLenum result = GL_TIMEOUT_EXPIRED;
+    do {
+      result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+        is_waiting ? 1000000000ull : 0ull);
+    } while (is_waiting && result == GL_TIMEOUT_EXPIRED);
+    if (result == GL_TIMEOUT_EXPIRED) {
+      return false;
+    }
+    ARCTIC_GL_CHECK_ERROR(glDeleteSync(fence));
+    state->fence = nullptr;
+  }
+#endif  // ARCTIC_GL_PIXEL_BUFFERS
+  return true;
+}
+
+HwSpriteReadbackQueue::Buffer HwSpriteReadbackQueue::AcquireBuffer(
+    size_t size) {
+  Buffer buffer;
+#ifdef ARCTIC_GL_PIXEL_BUFFERS
+  // The smallest free buffer that fits.
+  auto best = free_buffers_.end();
+  for (auto it = free_buffers_.begin(); it != free_buffers_.end(); ++it) {
+    if (it->size >= size && (best == free_buffers_.end()
+        || it->size < best->size)) {
+      best = it;
+    }
+  }
+  if (best != free_buffers_.end()) {
+    buffer = *best;
+    free_buffers_.erase(best);
+    return buffer;
+  }
+  buffer.size = size;
+  ARCTIC_GL_CHECK_ERROR(glGenBuffers(1, &buffer.id));
+  GlState::BindPixelPackBuffer(buffer.id);
+  ARCTIC_GL_CHECK_ERROR(glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr,
+    GL_STREAM_READ));
+  GlState::BindPixelPackBuffer(0);
+#endif  // ARCTIC_GL_PIXEL_BUFFERS
+  return buffer;
+}
+
+void HwSpriteReadbackQueue::ReleaseBuffer(HwSpriteReadback::State *state) {
+  if (!state->buffer_id) {
+    return;
+  }
+  Buffer buffer;
+  buffer.id = state->buffer_id;
+  buffer.size = state->buffer_size;
+  state->buffer_id = 0;
+  state->buffer_size = 0;
+  free_buffers_.push_back(buffer);
+  if (static_cast<Si32>(free_buffers_.size()) > kMaxFreeBuffers) {
+    // Drops the smallest one, the large readbacks are the costly ones.
+    auto smallest = std::min_element(free_buffers_.begin(),
+      free_buffers_.end(), [](const Buffer &a, const Buffer &b) {
+        return a.size < b.size;
+      });
+    GlState::OnBufferDeleted(smallest->id);
+    ARCTIC_GL_CHECK_ERROR(glDeleteBuffers(1, &smallest->id));
+    free_buffers_.erase(smallest);
+  }
+}
+
+void HwSpriteReadbackQueue::Erase(const HwSpriteReadback::State *state) {
+  for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+    if (it->get() == state) {
+      pending_.erase(it);
+      return;
+    }
+  }
+}
+
+void HwSpriteReadbackQueue::Clear() {
+#ifdef ARCTIC_GL_PIXEL_BUFFERS
+  for (const std::shared_ptr<HwSpriteReadback::State> &state : pending_) {
+    if (state->fence) {
+      ARCTIC_GL_CHECK_ERROR(glDeleteSync(static_cast<GLsync>(state->fence)));
+      state->fence = nullptr;
+    }
+    if (state->buffer_id) {
+      GlState::OnBufferDeleted(state->buffer_id);
+      ARCTIC_GL_CHECK_ERROR(glDeleteBuffers(1, &state->buffer_id));
+      state->buffer_id = 0;
+    }
+    state->is_ready = true;
+  }
+  for (Buffer &buffer : free_buffers_) {
+    GlState::OnBufferDeleted(buffer.id);
+    ARCTIC_GL_CHECK_ERROR(glDeleteBuffers(1, &buffer.id));
+  }
+#endif  // ARCTIC_GL_PIXEL_BUFFERS
+  pending_.clear();
+  free_buffers_.clear();
+}
+
+}  // namespace arctic
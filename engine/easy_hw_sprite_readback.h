@@ -0,0 +1,132 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_EASY_HW_SPRITE_READBACK_H_
+#define ENGINE_EASY_HW_SPRITE_READBACK_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/easy_hw_sprite_instance.h"
+#include "engine/easy_sprite.h"
+#include "engine/opengl.h"
+#include "engine/vec2si32.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief The pixels of an HwSprite on their way to the CPU,
+///   see HwSprite::ReadAsync.
+class HwSpriteReadback {
+ public:
+  struct State {
+    GLuint buffer_id = 0;
+    size_t buffer_size = 0;
+    void *fence = nullptr;
+    Vec2Si32 size;
+    Vec2Si32 pivot;
+    Sprite sprite;
+    bool is_ready = false;
+  };
+
+ private:
+  std::shared_ptr<State> state_;
+
+ public:
+  HwSpriteReadback() {
+  }
+  explicit HwSpriteReadback(std::shared_ptr<State> state)
+    : state_(std::move(state)) {
+  }
+
+  /// @brief Returns false for a default constructed readback.
+  bool IsValid() const {
+    return !!state_;
+  }
+  /// @brief Returns true once the pixels have arrived. Never waits.
+  bool IsReady() const;
+  /// @brief Returns the pixels as a software sprite, waits for them if they
+  ///   have not arrived yet.
+  Sprite Get() const;
+};
+
+/// @brief Reads HwSprite pixels back through pixel pack buffers.
+/// glReadPixels into a pixel pack buffer returns right away, the GPU copies
+/// the pixels when it gets to them and a fence tells when they are there.
+/// Where there are no pixel pack buffers the pixels are read synchronously.
+class HwSpriteReadbackQueue {
+ public:
+  static const Si32 kMaxFreeBuffers = 4;
+
+ private:
+  HwSpriteReadbackQueue(HwSpriteReadbackQueue &other) = delete;
+  HwSpriteReadbackQueue(HwSpriteReadbackQueue &&other) = delete;
+  HwSpriteReadbackQueue &operator=(HwSpriteReadbackQueue &other) = delete;
+  HwSpriteReadbackQueue &operator=(HwSpriteReadbackQueue &&other) = delete;
+
+  struct Buffer {
+    GLuint id = 0;
+    size_t size = 0;
+  };
+
+  std::vector<std::shared_ptr<HwSpriteReadback::State>> pending_;
+  std::vector<Buffer> free_buffers_;
+  Si32 is_supported_ = -1;
+
+  /// @brief Polls or waits for the fence of the readback.
+  bool IsGpuDone(HwSpriteReadback::State *state, bool is_waiting);
+  Buffer AcquireBuffer(size_t size);
+  void ReleaseBuffer(HwSpriteReadback::State *state);
+  void Erase(const HwSpriteReadback::State *state);
+
+ public:
+  HwSpriteReadbackQueue();
+  ~HwSpriteReadbackQueue();
+
+  /// @brief Starts reading the size.x by size.y rectangle of the instance
+  ///   at pos. Must be called on the GL thread.
+  HwSpriteReadback Read(HwSpriteInstance &instance, Vec2Si32 pos,
+    Vec2Si32 size, Vec2Si32 pivot);
+  /// @brief Completes the readbacks the GPU is done with. Never waits.
+  void Update();
+  /// @brief Completes the readback if the GPU is done with it.
+  /// @param [in] is_waiting Wait for the GPU if it is not done yet.
+  /// @return true if the pixels are in the sprite.
+  bool Resolve(HwSpriteReadback::State *state, bool is_waiting);
+  /// @brief Frees the buffers, pending readbacks are lost.
+  void Clear();
+
+  /// @brief Number of readbacks the GPU may still be working on.
+  Si32 PendingCount() const {
+    return static_cast<Si32>(pending_.size());
+  }
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_EASY_HW_SPRITE_READBACK_H_
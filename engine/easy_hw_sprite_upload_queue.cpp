@@ -0,0 +1,244 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/easy_hw_sprite_upload_queue.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+#include "engine/easy_advanced.h"
+#include "engine/easy_sprite_instance.h"
+#include "engine/engine.h"
+#include "engine/gl_state.h"
+#include "engine/log.h"
+#include "engine/opengl.h"
+
+namespace arctic {
+
+HwSpriteUploadQueue::HwSpriteUploadQueue() {
+  SetBytesPerFrame(kDefaultBytesPerFrame);
+}
+
+HwSpriteUploadQueue::~HwSpriteUploadQueue() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = true;
+  }
+  job_added_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+std::shared_ptr<HwSpriteUploadQueue::Ticket> HwSpriteUploadQueue::EnqueueFile(
+    const char *file_name, std::vector<Ui8> &&file_data, Vec2Si32 sprite_size,
+    const std::shared_ptr<HwSpriteInstance> &instance,
+    const std::shared_ptr<HwSpriteAtlas::Region> &region) {
+  std::unique_ptr<Job> job(new Job());
+  job->file_name = file_name;
+  job->file_data = std::move(file_data);
+  job->sprite_size = sprite_size;
+  job->instance = instance;
+  job->region = region;
+  return Enqueue(std::move(job), false);
+}
+
+std::shared_ptr<HwSpriteUploadQueue::Ticket> HwSpriteUploadQueue::EnqueuePixels(
+    std::vector<Rgba> &&pixels, Vec2Si32 sprite_size,
+    const std::shared_ptr<HwSpriteInstance> &instance,
+    const std::shared_ptr<HwSpriteAtlas::Region> &region) {
+  std::unique_ptr<Job> job(new Job());
+  job->staging = std::move(pixels);
+  job->sprite_size = sprite_size;
+  job->instance = instance;
+  job->region = region;
+  return Enqueue(std::move(job), true);
+}
+
+std::shared_ptr<HwSpriteUploadQueue::Ticket> HwSpriteUploadQueue::Enqueue(
+    std::unique_ptr<Job> job, bool is_decoded) {
+  std::shared_ptr<Ticket> ticket = std::make_shared<Ticket>();
+  job->ticket = ticket;
+  if (job->region) {
+    job->pos = job->region->rect().begin;
+    job->size = job->region->rect().end - job->region->rect().begin;
+    job->is_padded = true;
+  } else {
+    job->pos = Vec2Si32(0, 0);
+    job->size = job->sprite_size;
+  }
+
+  // The placeholder is transparent. An atlas region may still hold the
+  // pixels of a released sprite, and queued draws may still sample them.
+  GetEngine()->GetHwSpriteBatch().Flush();
+  job->instance->framebuffer().Bind();
+  GlState::SetClearColor(Rgba(0, 0, 0, 0));
+  GlState::SetScissorTest(true);
+  GlState::SetScissor(job->pos.x, job->pos.y, job->size.x, job->size.y);
+  ARCTIC_GL_CHECK_ERROR(glClear(GL_COLOR_BUFFER_BIT));
+  GlState::SetScissorTest(false);
+
+  if (is_decoded) {
+    upload_jobs_.push_back(std::move(job));
+    return ticket;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    decode_jobs_.push_back(std::move(job));
+    if (workers_.empty()) {
+      const Si32 hardware_threads =
+        static_cast<Si32>(std::thread::hardware_concurrency());
+      const Si32 worker_count = std::max(1, std::min(2, hardware_threads - 1));
+      for (Si32 i = 0; i < worker_count; ++i) {
+        workers_.emplace_back(&HwSpriteUploadQueue::WorkerLoop, this);
+      }
+    }
+  }
+  job_added_.notify_one();
+  return ticket;
+}
+
+void HwSpriteUploadQueue::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    job_added_.wait(lock, [this] {
+      return is_stopping_ || !decode_jobs_.empty();
+    });
+    if (is_stopping_) {
+      return;
+    }
+    std::unique_ptr<Job> job = std::move(decode_jobs_.front());
+    decode_jobs_.pop_front();
+    ++decoding_count_;
+    lock.unlock();
+    Decode(job.get());
+    lock.lock();
+    --decoding_count_;
+    ready_jobs_.push_back(std::move(job));
+    job_decoded_.notify_all();
+  }
+}
+
+void HwSpriteUploadQueue::Decode(Job *job) {
+  std::shared_ptr<SpriteInstance> sw_instance = LoadTga(job->file_data.data(),
+    static_cast<Si64>(job->file_data.size()));
+  std::vector<Ui8>().swap(job->file_data);
+  if (!sw_instance || sw_instance->width() != job->sprite_size.x
+      || sw_instance->height() != job->sprite_size.y) {
+    // Empty staging memory marks the failure.
+    return;
+  }
+  const Rgba *pixels = reinterpret_cast<const Rgba*>(sw_instance->RawData());
+  if (job->is_padded) {
+    HwSpriteAtlas::Extrude(pixels, sw_instance->width(),
+      sw_instance->width(), sw_instance->height(), &job->staging);
+  } else {
+    job->staging.assign(pixels, pixels
+      + static_cast<size_t>(sw_instance->width()) * sw_instance->height());
+  }
+}
+
+Si64 HwSpriteUploadQueue::UploadRows(Job *job, Si64 max_bytes) {
+  if (!pixel_buffers_.IsValid() && GlPixelBufferRing::IsSupported()) {
+    pixel_buffers_.Create(kPixelBufferWidth, pixel_buffer_rows_);
+  }
+  const Si64 row_bytes = static_cast<Si64>(job->size.x) * sizeof(Rgba);
+  const Si32 rows = static_cast<Si32>(std::max(static_cast<Si64>(1),
+    std::min(static_cast<Si64>(job->size.y - job->next_row),
+      max_bytes / row_bytes)));
+  pixel_buffers_.UploadSubData(job->instance->texture(),
+    job->staging.data() + static_cast<size_t>(job->next_row) * job->size.x,
+    job->pos + Vec2Si32(0, job->next_row), Vec2Si32(job->size.x, rows));
+  job->next_row += rows;
+  return rows * row_bytes;
+}
+
+void HwSpriteUploadQueue::Complete(Job *job) {
+  job->ticket->is_resident = true;
+  std::vector<Rgba>().swap(job->staging);
+}
+
+void HwSpriteUploadQueue::Update() {
+  Upload(bytes_per_frame_);
+}
+
+void HwSpriteUploadQueue::Upload(Si64 budget) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!ready_jobs_.empty()) {
+      upload_jobs_.push_back(std::move(ready_jobs_.front()));
+      ready_jobs_.pop_front();
+    }
+  }
+  if (upload_jobs_.empty()) {
+    return;
+  }
+  GetEngine()->GetHwSpriteBatch().Flush();
+  while (!upload_jobs_.empty() && budget > 0) {
+    Job *job = upload_jobs_.front().get();
+    if (job->ticket.use_count() == 1) {
+      // All the sprites waiting for it are gone.
+    } else if (job->staging.empty()) {
+      *Log() << "Error in HwSprite::LoadAsync, file: \"" << job->file_name
+        << "\" could not be loaded with LoadTga.";
+      job->ticket->is_failed = true;
+    } else {
+      budget -= UploadRows(job, budget);
+      if (job->next_row < job->size.y) {
+        continue;
+      }
+      Complete(job);
+    }
+    upload_jobs_.pop_front();
+  }
+}
+
+void HwSpriteUploadQueue::Finish() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    job_decoded_.wait(lock, [this] {
+      return decode_jobs_.empty() && decoding_count_ == 0;
+    });
+  }
+  Upload(std::numeric_limits<Si64>::max());
+}
+
+void HwSpriteUploadQueue::SetBytesPerFrame(Si64 bytes_per_frame) {
+  bytes_per_frame_ = std::max(static_cast<Si64>(1), bytes_per_frame);
+  // The buffers are sized for the budget.
+  const Si64 rows = bytes_per_frame_
+    / (static_cast<Si64>(kPixelBufferWidth) * sizeof(Rgba));
+  pixel_buffer_rows_ = static_cast<Si32>(std::min(
+    std::max(rows, static_cast<Si64>(1)),
+    static_cast<Si64>(kMaxPixelBufferRows)));
+  pixel_buffers_.Destroy();
+}
+
+Si32 HwSpriteUploadQueue::PendingCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<Si32>(decode_jobs_.size() + ready_jobs_.size()
+    + upload_jobs_.size()) + decoding_count_;
+}
+
+}  // namespace arctic
@@ -0,0 +1,152 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_EASY_HW_SPRITE_UPLOAD_QUEUE_H_
+#define ENGINE_EASY_HW_SPRITE_UPLOAD_QUEUE_H_
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/easy_hw_sprite_atlas.h"
+#include "engine/easy_hw_sprite_instance.h"
+#include "engine/gl_pixel_buffer_ring.h"
+#include "engine/rgba.h"
+#include "engine/vec2si32.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief Loads HwSprite pixels in the background.
+/// Worker threads decode the files into staging memory, and Update, called
+/// on the GL thread once a frame, uploads at most a budget of bytes from the
+/// staging memory to the textures through pixel unpack buffers. Until then
+/// the sprites show transparent placeholders of the right size.
+class HwSpriteUploadQueue {
+ public:
+  static const Si64 kDefaultBytesPerFrame = 4ll << 20;
+  static const Si32 kPixelBufferWidth = 1024;
+  static const Si32 kMaxPixelBufferRows = 4096;
+
+  /// @brief Shared by the sprites that wait for the same upload.
+  struct Ticket {
+    bool is_resident = false;
+    bool is_failed = false;
+  };
+
+ private:
+  HwSpriteUploadQueue(HwSpriteUploadQueue &other) = delete;
+  HwSpriteUploadQueue(HwSpriteUploadQueue &&other) = delete;
+  HwSpriteUploadQueue &operator=(HwSpriteUploadQueue &other) = delete;
+  HwSpriteUploadQueue &operator=(HwSpriteUploadQueue &&other) = delete;
+
+  struct Job {
+    std::shared_ptr<Ticket> ticket;
+    std::shared_ptr<HwSpriteInstance> instance;
+    /// @brief Keeps the place in the atlas, if the sprite is there.
+    std::shared_ptr<HwSpriteAtlas::Region> region;
+    /// @brief The sprite size, without the padding.
+    Vec2Si32 sprite_size;
+    /// @brief The rectangle of the texture to fill, padding included.
+    Vec2Si32 pos;
+    Vec2Si32 size;
+    bool is_padded = false;
+    std::string file_name;
+    std::vector<Ui8> file_data;
+    std::vector<Rgba> staging;
+    Si32 next_row = 0;
+  };
+
+  std::mutex mutex_;
+  std::condition_variable job_added_;
+  std::condition_variable job_decoded_;
+  std::deque<std::unique_ptr<Job>> decode_jobs_;
+  std::deque<std::unique_ptr<Job>> ready_jobs_;
+  Si32 decoding_count_ = 0;
+  bool is_stopping_ = false;
+  std::vector<std::thread> workers_;
+
+  /// @brief Only touched on the GL thread.
+  std::deque<std::unique_ptr<Job>> upload_jobs_;
+  GlPixelBufferRing pixel_buffers_;
+  Si64 bytes_per_frame_ = kDefaultBytesPerFrame;
+  /// @brief Height of the pixel buffers, sized for the budget.
+  Si32 pixel_buffer_rows_ = 0;
+
+  void WorkerLoop();
+  static void Decode(Job *job);
+  std::shared_ptr<Ticket> Enqueue(std::unique_ptr<Job> job, bool is_decoded);
+  /// @brief Uploads rows of the job, at most max_bytes of them but at least
+  ///   one row. @return The number of bytes uploaded.
+  Si64 UploadRows(Job *job, Si64 max_bytes);
+  void Complete(Job *job);
+  /// @brief Uploads the decoded pixels, at most budget bytes of them.
+  void Upload(Si64 budget);
+
+ public:
+  HwSpriteUploadQueue();
+  ~HwSpriteUploadQueue();
+
+  /// @brief Decodes the *.tga file data on a worker, then uploads it.
+  /// @param [in] instance The texture to upload to.
+  /// @param [in] region The place in the atlas the pixels go to, or nullptr
+  ///   if they fill the whole instance.
+  std::shared_ptr<Ticket> EnqueueFile(const char *file_name,
+    std::vector<Ui8> &&file_data, Vec2Si32 sprite_size,
+    const std::shared_ptr<HwSpriteInstance> &instance,
+    const std::shared_ptr<HwSpriteAtlas::Region> &region);
+  /// @brief Uploads the pixels, which are already in the right layout.
+  std::shared_ptr<Ticket> EnqueuePixels(std::vector<Rgba> &&pixels,
+    Vec2Si32 sprite_size,
+    const std::shared_ptr<HwSpriteInstance> &instance,
+    const std::shared_ptr<HwSpriteAtlas::Region> &region);
+
+  /// @brief Uploads the decoded pixels within the per frame budget.
+  /// Must be called on the GL thread.
+  void Update();
+  /// @brief Waits for all the decoding and uploads everything.
+  void Finish();
+
+  void SetBytesPerFrame(Si64 bytes_per_frame);
+  Si64 BytesPerFrame() const {
+    return bytes_per_frame_;
+  }
+  /// @brief Height of the pixel buffers the uploads go through.
+  Si32 PixelBufferRows() const {
+    return pixel_buffer_rows_;
+  }
+  /// @brief Number of sprites that are not resident yet.
+  Si32 PendingCount();
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_EASY_HW_SPRITE_UPLOAD_QUEUE_H_
@@ -62,21 +62,32 @@ void Sound::Load(const char *file_name, bool do_unpack) {
     if (!data.empty()) {
       if (do_unpack) {
         int error = 0;
-        vorbis_codec_ = stb_vorbis_open_memory(data.data(),
+        stb_vorbis *vorbis_codec = stb_vorbis_open_memory(data.data(),
           static_cast<int>(data.size()), &error, nullptr);
-        if (vorbis_codec_) {
-          Ui32 size = stb_vorbis_stream_length_in_samples(vorbis_codec_);
+        if (vorbis_codec) {
+          Ui32 size = stb_vorbis_stream_length_in_samples(vorbis_codec);
           sound_instance_ = std::make_shared<SoundInstance>(size);
+          sound_instance_->SetSampleRate(static_cast<Si32>(
+            stb_vorbis_get_info(vorbis_codec).sample_rate));
           // int res =
           stb_vorbis_get_samples_short_interleaved(
-            vorbis_codec_, 2,
+            vorbis_codec, 2,
             sound_instance_->GetWavData(), static_cast<Si32>(size * 2));
           // TODO(Huldra): if (res) {
-          stb_vorbis_close(vorbis_codec_);
-          vorbis_codec_ = nullptr;
+          stb_vorbis_close(vorbis_codec);
         }
       } else {
         sound_instance_ = std::make_shared<SoundInstance>(data);
+        int error = 0;
+        stb_vorbis *vorbis_codec = stb_vorbis_open_memory(data.data(),
+          static_cast<int>(data.size()), &error, nullptr);
+        if (vorbis_codec) {
+          sound_instance_->SetSampleRate(static_cast<Si32>(
+            stb_vorbis_get_info(vorbis_codec).sample_rate));
+          sound_instance_->SetVorbisDurationSamples(static_cast<Si32>(
+            stb_vorbis_stream_length_in_samples(vorbis_codec)));
+          stb_vorbis_close(vorbis_codec);
+        }
       }
     } else {
       Log("Error loading file \"", file_name, "\", size is 0");
@@ -94,12 +105,13 @@ void Sound::Load(const std::string &file_name, bool do_unpack) {
   Load(file_name.c_str(), do_unpack);
 }
 
-void Sound::Create(double duration) {
+void Sound::Create(double duration, Si32 sample_rate) {
   Clear();
   file_name_ = "CREATE";
-  double samples = duration * 44100.f + 0.5f;
+  double samples = duration * static_cast<double>(sample_rate) + 0.5;
   // TODO(Huldra): Handle overflows
   sound_instance_ = std::make_shared<SoundInstance>(static_cast<Si32>(samples));
+  sound_instance_->SetSampleRate(sample_rate);
   Si16 *data = sound_instance_->GetWavData();
   Si32 size = sound_instance_->GetDurationSamples() * 2;
   for (Si32 idx = 0; idx < size; ++idx) {
@@ -109,10 +121,6 @@ void Sound::Create(double duration) {
 
 void Sound::Clear() {
   file_name_ = "CLEAR";
-  if (vorbis_codec_) {
-    stb_vorbis_close(vorbis_codec_);
-    vorbis_codec_ = nullptr;
-  }
   sound_instance_.reset();
 }
 
@@ -121,8 +129,16 @@ void Sound::Play() {
 }
 
 void Sound::Play(float volume) {
+  Play(volume, 1.0f);
+}
+
+void Sound::Play(float volume, float pitch) {
+  Play(volume, pitch, 0);
+}
+
+void Sound::Play(float volume, float pitch, Si32 priority) {
   if (sound_instance_) {
-    arctic::StartSoundBuffer(*this, volume);
+    arctic::StartSoundBuffer(*this, volume, pitch, priority);
   }
 }
 
@@ -133,32 +149,12 @@ void Sound::Stop() {
 }
 
 double Sound::Duration() const {
-  Ui32 duration_samples = 0;
-  if (sound_instance_) {
-    switch (sound_instance_->GetFormat()) {
-    case kSoundDataWav: {
-      duration_samples = static_cast<Ui32>(
-        sound_instance_->GetDurationSamples());
-      break;
-    }
-    case kSoundDataVorbis: {
-      if (vorbis_codec_) {
-        duration_samples =
-          stb_vorbis_stream_length_in_samples(vorbis_codec_);
-      } else {
-        int error = 0;
-        stb_vorbis *vorbis_codec = stb_vorbis_open_memory(
-          sound_instance_->GetVorbisData(),
-          sound_instance_->GetVorbisSize(), &error, nullptr);
-        duration_samples = stb_vorbis_stream_length_in_samples(
-          vorbis_codec_);
-        stb_vorbis_close(vorbis_codec);
-      }
-      break;
-    }
-    }
+  if (!sound_instance_) {
+    return 0.0;
   }
-  return static_cast<double>(duration_samples) * (1.0 / 44100.0);
+  // The vorbis length is found once, when the sound is loaded.
+  return static_cast<double>(sound_instance_->GetDurationSamples())
+    / static_cast<double>(sound_instance_->GetSampleRate());
 }
 
 Si16 *Sound::RawData() {
@@ -169,8 +165,18 @@ Si32 Sound::DurationSamples() {
   return sound_instance_->GetDurationSamples();
 }
 
+Si32 Sound::SampleRate() const {
+  return sound_instance_ ? sound_instance_->GetSampleRate() : 44100;
+}
+
 Si32 Sound::StreamOut(Si32 offset, Si32 size,
   Si16 *out_buffer, Si32 out_buffer_samples) {
+  SoundStream stream;
+  return StreamOut(offset, size, out_buffer, out_buffer_samples, &stream);
+}
+
+Si32 Sound::StreamOut(Si32 offset, Si32 size,
+  Si16 *out_buffer, Si32 out_buffer_samples, SoundStream *stream) {
   switch (sound_instance_->GetFormat()) {
   case kSoundDataWav: {
     Si16 *data = sound_instance_->GetWavData();
@@ -187,11 +193,13 @@ Si32 Sound::StreamOut(Si32 offset, Si32 size,
   }
   case kSoundDataVorbis: {
     int error = 0;
-    if (!vorbis_codec_) {
-      vorbis_codec_ = stb_vorbis_open_memory(
+    if (!stream->vorbis_codec) {
+      stream->vorbis_codec.reset(stb_vorbis_open_memory(
         sound_instance_->GetVorbisData(),
-        sound_instance_->GetVorbisSize(), &error, nullptr);
-      if (!vorbis_codec_) {
+        sound_instance_->GetVorbisSize(), &error, nullptr),
+        stb_vorbis_close);
+      stream->position = 0;
+      if (!stream->vorbis_codec) {
         Fatal(static_cast<const std::stringstream&>(std::stringstream()
               << "StreamOut encountered error: " << error
               << " while opening sound file: \"" << file_name_
@@ -201,13 +209,19 @@ Si32 Sound::StreamOut(Si32 offset, Si32 size,
         return 0;
       }
     }
-    stb_vorbis_seek(vorbis_codec_, static_cast<Ui32>(offset));
-    int res = stb_vorbis_get_samples_short_interleaved(
-      vorbis_codec_, 2, out_buffer, out_buffer_samples);
-    if (res < out_buffer_samples / 2) {
-      stb_vorbis_close(vorbis_codec_);
-      vorbis_codec_ = nullptr;
+    // Seeking means finding the page and decoding up to the sample, so
+    // it is only done when the voice jumps.
+    if (offset != stream->position) {
+      if (!stb_vorbis_seek(stream->vorbis_codec.get(),
+          static_cast<Ui32>(offset))) {
+        return 0;
+      }
+      stream->position = offset;
     }
+    const Si32 to_decode = std::min(size, out_buffer_samples / 2);
+    int res = stb_vorbis_get_samples_short_interleaved(
+      stream->vorbis_codec.get(), 2, out_buffer, to_decode * 2);
+    stream->position += res;
     return res;
   }
   }
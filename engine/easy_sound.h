@@ -34,24 +34,56 @@ namespace arctic {
 
 /// @addtogroup global_sound
 /// @{
+
+/// @brief Decoder state of one playback of a Sound. Each playing voice owns
+/// one, so the simultaneous playbacks of a Sound do not share a decoder.
+struct SoundStream {
+  std::shared_ptr<stb_vorbis> vorbis_codec;
+  /// @brief The sample the decoder outputs next.
+  Si32 position = 0;
+};
+
 class Sound {
  private:
   std::shared_ptr<SoundInstance> sound_instance_;
-  stb_vorbis *vorbis_codec_ = nullptr;
   std::string file_name_ = "CLEAR";
  public:
   void Load(const std::string &file_name, bool do_unpack);
   void Load(const char *file_name, bool do_unpack);
   void Load(const char *file_name);
   void Load(const std::string &file_name);
-  void Create(double duration);
+  /// @brief Creates a silent sound.
+  /// @param [in] duration Duration in seconds.
+  /// @param [in] sample_rate Sample rate in Hz.
+  void Create(double duration, Si32 sample_rate = 44100);
   void Clear();
   void Play();
   void Play(float volume);
+  /// @brief Starts a new playback of the sound.
+  /// @param [in] volume 0.f is silent, 1.f is the original record level.
+  /// @param [in] pitch Playback speed, 1.f is the original, 2.f is twice
+  ///   as fast and an octave higher.
+  void Play(float volume, float pitch);
+  /// @brief Starts a new playback of the sound.
+  /// @param [in] volume 0.f is silent, 1.f is the original record level.
+  /// @param [in] pitch Playback speed, 1.f is the original.
+  /// @param [in] priority When more sounds play than the voice limit, the
+  ///   ones with the lowest priority are not mixed, 0 by default.
+  void Play(float volume, float pitch, Si32 priority);
   void Stop();
   double Duration() const;
   Si32 DurationSamples();
+  /// @brief Returns the sample rate of the sound in Hz.
+  Si32 SampleRate() const;
   Si16 *RawData();
+  /// @brief Outputs up to size stereo samples starting at the offset.
+  /// @details The decoder continues from where the last call on the stream
+  ///   stopped and only seeks if the offset is somewhere else.
+  /// @return The number of stereo samples output.
+  Si32 StreamOut(Si32 offset, Si32 size,
+      Si16 *out_buffer, Si32 out_buffer_samples, SoundStream *stream);
+  /// @brief Outputs up to size stereo samples starting at the offset, opens
+  ///   a new decoder on each call.
   Si32 StreamOut(Si32 offset, Si32 size,
       Si16 *out_buffer, Si32 out_buffer_samples);
   std::shared_ptr<SoundInstance> GetInstance();
@@ -26,6 +26,7 @@
 #include "engine/easy_sound_instance.h"
 
 #include <cstring>
+#include <limits>
 #include <sstream>
 
 #include "engine/arctic_platform.h"
@@ -71,12 +72,14 @@ struct WaveHeader {
 SoundInstance::SoundInstance(Ui32 wav_samples) {
   format_ = kSoundDataWav;
   playing_count_ = 0;
+  last_start_us_ = std::numeric_limits<Si64>::min() / 2;
   data_.resize(wav_samples * 2 * sizeof(Si16));
 }
 
 SoundInstance::SoundInstance(std::vector<Ui8> vorbis_file) {
   format_ = kSoundDataVorbis;
   playing_count_ = 0;
+  last_start_us_ = std::numeric_limits<Si64>::min() / 2;
   data_.resize(vorbis_file.size());
   std::memcpy(data_.data(), vorbis_file.data(), vorbis_file.size());
 }
@@ -105,10 +108,32 @@ Si32 SoundInstance::GetDurationSamples() {
   if (format_ == kSoundDataWav) {
     return static_cast<Si32>(data_.size() / 4);
   } else {
-    return 0;
+    return vorbis_duration_samples_;
   }
 }
 
+Si32 SoundInstance::GetSampleRate() const {
+  return sample_rate_;
+}
+
+void SoundInstance::SetSampleRate(Si32 sample_rate) {
+  sample_rate_ = sample_rate;
+}
+
+void SoundInstance::SetVorbisDurationSamples(Si32 duration_samples) {
+  vorbis_duration_samples_ = duration_samples;
+}
+
+bool SoundInstance::TryStart(Si64 time_us, Si64 interval_us) {
+  Si64 last = last_start_us_.load();
+  do {
+    if (time_us - last < interval_us) {
+      return false;
+    }
+  } while (!last_start_us_.compare_exchange_weak(last, time_us));
+  return true;
+}
+
 std::shared_ptr<SoundInstance> LoadWav(const Ui8 *data,
     const Si64 size) {
   if (size < sizeof(WaveHeader)) {
@@ -172,10 +197,10 @@ std::shared_ptr<SoundInstance> LoadWav(const Ui8 *data,
   }
 
   std::shared_ptr<SoundInstance> sound;
-  Ui32 in_sample_count = wav->subchunk_2_size / wav->block_align;
-  Ui32 sample_count = (Ui32)(44100ull * (Ui64)in_sample_count
-      / (Ui64)wav->sample_rate);
+  // The samples keep their rate, the mixer converts it on playback.
+  Ui32 sample_count = wav->subchunk_2_size / wav->block_align;
   sound.reset(new SoundInstance(sample_count));
+  sound->SetSampleRate(static_cast<Si32>(wav->sample_rate));
   const Ui8 *in_data = data + 44;
   Si16 *out_data = sound->GetWavData();
   if (out_data == nullptr) {
@@ -184,89 +209,49 @@ std::shared_ptr<SoundInstance> LoadWav(const Ui8 *data,
   }
   Ui16 block_align = wav->block_align;
 
-  if (wav->sample_rate == 44100) {
-    if (wav->bits_per_sample == 8) {
-      if (wav->channels == 1) {
-        for (Ui32 idx = 0; idx < sample_count; ++idx) {
-          Si16 value = static_cast<Si16>(*static_cast<const Si8*>(
-                static_cast<const void*>(in_data))) * 256;
-          out_data[idx * 2] = value;
-          out_data[idx * 2 + 1] = value;
-          in_data += block_align;
-        }
-      } else {
-        for (Ui32 idx = 0; idx < sample_count; ++idx) {
-          Si16 value = static_cast<Si16>(*static_cast<const Si8*>(
-                static_cast<const void*>(in_data))) * 256;
-          out_data[idx * 2] = value;
-          value = static_cast<Si16>(*static_cast<const Si8*>(
-                static_cast<const void*>(in_data + sizeof(Ui16)))) * 256;
-          out_data[idx * 2 + 1] = value;
-          in_data += block_align;
-        }
-      }
-    } else if (wav->bits_per_sample == 16) {
-      if (wav->channels == 1) {
-        for (Ui32 idx = 0; idx < sample_count; ++idx) {
-          Si16 value = *static_cast<const Si16*>(
-              static_cast<const void*>(in_data));
-          out_data[idx * 2] = value;
-          out_data[idx * 2 + 1] = value;
-          in_data += block_align;
-        }
-      } else {
-        for (Ui32 idx = 0; idx < sample_count; ++idx) {
-          Si16 value = *static_cast<const Si16*>(
-              static_cast<const void*>(in_data));
-          out_data[idx * 2] = value;
-          value = *static_cast<const Si16*>(
-              static_cast<const void*>(in_data + sizeof(Si16)));
-          out_data[idx * 2 + 1] = value;
-          in_data += block_align;
-        }
+  if (wav->bits_per_sample == 8) {
+    if (wav->channels == 1) {
+      for (Ui32 idx = 0; idx < sample_count; ++idx) {
+        Si16 value = static_cast<Si16>(*static_cast<const Si8*>(
+              static_cast<const void*>(in_data))) * 256;
+        out_data[idx * 2] = value;
+        out_data[idx * 2 + 1] = value;
+        in_data += block_align;
       }
     } else {
-      *Log() << "Error in LoadWav, unsupported bits_per_sample";
-      return nullptr;
+      for (Ui32 idx = 0; idx < sample_count; ++idx) {
+        Si16 value = static_cast<Si16>(*static_cast<const Si8*>(
+              static_cast<const void*>(in_data))) * 256;
+        out_data[idx * 2] = value;
+        value = static_cast<Si16>(*static_cast<const Si8*>(
+              static_cast<const void*>(in_data + sizeof(Ui16)))) * 256;
+        out_data[idx * 2 + 1] = value;
+        in_data += block_align;
+      }
     }
-  } else {
-    for (Ui64 idx = 0; idx < sample_count; ++idx) {
-      Ui64 in_sample_idx = (Ui64)wav->sample_rate * (Ui64)idx / 44100ull;
-      const Ui8 *in_block = in_data + in_sample_idx * block_align;
-      Si16 value1 = 0;
-      Si16 value2 = 0;
-
-      if (wav->bits_per_sample == 8) {
-        value1 = static_cast<Si16>(*static_cast<const Si8*>(
-              static_cast<const void*>(in_block))) * 256;
-        if (wav->channels == 1) {
-          value2 = value1;
-        } else {
-          value2 = static_cast<Si16>(*static_cast<const Si8*>(
-                static_cast<const void*>(in_block + sizeof(Ui16)))) * 256;
-        }
-      } else if (wav->bits_per_sample == 16) {
-        value1 = *static_cast<const Si16*>(static_cast<const void*>(
-              in_block));
-        if (wav->channels == 1) {
-          value2 = value1;
-        } else {
-          value2 = *static_cast<const Si16*>(static_cast<const void*>(
-                in_block + sizeof(Si16)));
-        }
-      } else {
-        *Log() << "Error in LoadWav, unsupported bits_per_sample";
-        return nullptr;
+  } else if (wav->bits_per_sample == 16) {
+    if (wav->channels == 1) {
+      for (Ui32 idx = 0; idx < sample_count; ++idx) {
+        Si16 value = *static_cast<const Si16*>(
+            static_cast<const void*>(in_data));
+        out_data[idx * 2] = value;
+        out_data[idx * 2 + 1] = value;
+        in_data += block_align;
       }
-
-      if (idx*2*sizeof(Si16) < sample_count * 2 * sizeof(Si16)) {
-        *Log() << "Reading past end of sample memory buffer.";
-        return nullptr;
+    } else {
+      for (Ui32 idx = 0; idx < sample_count; ++idx) {
+        Si16 value = *static_cast<const Si16*>(
+            static_cast<const void*>(in_data));
+        out_data[idx * 2] = value;
+        value = *static_cast<const Si16*>(
+            static_cast<const void*>(in_data + sizeof(Si16)));
+        out_data[idx * 2 + 1] = value;
+        in_data += block_align;
       }
-
-      out_data[idx * 2] = value1;
-      out_data[idx * 2 + 1] = value2;
     }
+  } else {
+    *Log() << "Error in LoadWav, unsupported bits_per_sample";
+    return nullptr;
   }
   return sound;
 }
@@ -43,6 +43,9 @@ class SoundInstance {
   SoundDataFormat format_;
   std::vector<Ui8> data_;
   std::atomic<Si32> playing_count_;
+  Si32 sample_rate_ = 44100;
+  Si32 vorbis_duration_samples_ = 0;
+  std::atomic<Si64> last_start_us_;
  public:
   explicit SoundInstance(Ui32 wav_samples);
   explicit SoundInstance(std::vector<Ui8> vorbis_file);
@@ -51,6 +54,13 @@ class SoundInstance {
   Si32 GetVorbisSize() const;
   SoundDataFormat GetFormat() const;
   Si32 GetDurationSamples();
+  Si32 GetSampleRate() const;
+  void SetSampleRate(Si32 sample_rate);
+  void SetVorbisDurationSamples(Si32 duration_samples);
+  /// @brief Records a start of playback at the time, unless the last one
+  ///   was less than interval_us ago.
+  /// @return True if the start is recorded.
+  bool TryStart(Si64 time_us, Si64 interval_us);
   bool IsPlaying();
   void IncPlaying();
   void DecPlaying();
@@ -26,6 +26,7 @@
 
 #include "engine/easy_sprite.h"
 
+#include <cmath>
 #include <cstring>
 
 #include <memory>
@@ -37,21 +38,200 @@
 #include "engine/vec2f.h"
 #include "engine/log.h"
 #include "engine/easy_advanced.h"
+#include "engine/easy_drawing.h"
 #include "engine/easy_files.h"
+#include "engine/easy_sprite_blend.h"
 #include "engine/rgba.h"
+#include "engine/tiled_rasterizer.h"
 
 namespace arctic {
 
+static const Si32 kBlendChunkPixels = 256;
+static const Si32 kNoClip = 0x7fffffff;
+
 struct Edge {
   float x;
   Vec2F tex;
 };
 
+// Fully transparent source pixels leave the destination untouched
+// in these modes, so the transparent parts of a sprite may be skipped.
+static inline bool IsTransparentNoOp(DrawBlendingMode blending_mode) {
+  return blending_mode == kDrawBlendingModeAlphaBlend
+    || blending_mode == kDrawBlendingModePremultipliedAlphaBlend
+    || blending_mode == kDrawBlendingModeColorize
+    || blending_mode == kDrawBlendingModeSolidColor;
+}
+
+static inline bool IsInSi32Range(Si64 value) {
+  return value >= -0x7fffffffll - 1 && value <= 0x7fffffffll;
+}
+
+static inline Si64 FloorDiv(Si64 a, Si64 b) {
+  return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// Narrows [*in_out_first, *in_out_end) to the k for which
+// value + k * step lies in [lo, hi).
+static void LimitLinearRange(Si64 value, Si64 step, Si64 lo, Si64 hi,
+    Si64 *in_out_first, Si64 *in_out_end) {
+  Si64 first;
+  Si64 end;
+  if (step > 0) {
+    first = -FloorDiv(value - lo, step);
+    end = -FloorDiv(value - hi, step);
+  } else if (step < 0) {
+    first = FloorDiv(value - hi, -step) + 1;
+    end = FloorDiv(value - lo, -step) + 1;
+  } else {
+    first = (value >= lo && value < hi) ? *in_out_first : *in_out_end;
+    end = *in_out_end;
+  }
+  *in_out_first = std::max(*in_out_first, first);
+  *in_out_end = std::min(*in_out_end, end);
+}
+
+// Returns the mip level for drawing each destination pixel from scale
+// source pixels. It is the smallest level still not smaller than
+// the destination, so the level is only ever minified.
+// Bilinear sampling needs at least 2 source pixels in each direction,
+// so the level is limited by the smaller of the source sizes.
+static Si32 MipLevelForScale(float scale, Si32 min_size) {
+  if (!(scale >= 2.f)) {
+    return 0;
+  }
+  Si32 max_level = 0;
+  while ((min_size >> (max_level + 1)) >= 2) {
+    ++max_level;
+  }
+  const Si32 level = static_cast<Si32>(std::floor(std::log2(scale)));
+  return std::min(level, max_level);
+}
+
+// Replaces the source of a minified sprite draw with the matching mip level.
+// The destination rectangle stays the same, the pivot is applied
+// to the destination position as the level has no pivot.
+static void SelectMipLevel(Sprite *in_out_from_sprite,
+    Si32 *in_out_to_x_pivot, Si32 *in_out_to_y_pivot,
+    const Si32 to_width, const Si32 to_height,
+    Si32 *in_out_from_x, Si32 *in_out_from_y,
+    Si32 *in_out_from_width, Si32 *in_out_from_height) {
+  const Si32 from_width = *in_out_from_width;
+  const Si32 from_height = *in_out_from_height;
+  if (to_width <= 0 || to_height <= 0 || from_width <= 0 || from_height <= 0
+      || !in_out_from_sprite->SpriteInstance()) {
+    return;
+  }
+  const Si32 level = MipLevelForScale(std::min(
+      static_cast<float>(from_width) / static_cast<float>(to_width),
+      static_cast<float>(from_height) / static_cast<float>(to_height)),
+    std::min(from_width, from_height));
+  if (level == 0) {
+    return;
+  }
+  const Sprite &from = *in_out_from_sprite;
+  Sprite mip = from.MipLevel(level);
+  const Vec2Si32 begin = from.RefPos() + Vec2Si32(*in_out_from_x, *in_out_from_y);
+  const Vec2Si32 end = begin + Vec2Si32(from_width, from_height);
+  const Vec2Si32 mip_begin(begin.x >> level, begin.y >> level);
+  const Vec2Si32 mip_end(std::max(end.x >> level, mip_begin.x + 1),
+    std::max(end.y >> level, mip_begin.y + 1));
+  *in_out_to_x_pivot -= from.Pivot().x * to_width / from_width;
+  *in_out_to_y_pivot -= from.Pivot().y * to_height / from_height;
+  *in_out_from_x = mip_begin.x - mip.RefPos().x;
+  *in_out_from_y = mip_begin.y - mip.RefPos().y;
+  *in_out_from_width = mip_end.x - mip_begin.x;
+  *in_out_from_height = mip_end.y - mip_begin.y;
+  mip.SetPivot(Vec2Si32(0, 0));
+  *in_out_from_sprite = mip;
+}
+
+// Replaces the texture of a minified triangle draw with the matching
+// mip level, the level is chosen by the ratio of the areas.
+static void SelectTriangleMipLevel(Sprite *in_out_texture,
+    Vec2F a, Vec2F b, Vec2F c,
+    Vec2F *in_out_ta, Vec2F *in_out_tb, Vec2F *in_out_tc) {
+  if (!in_out_texture->SpriteInstance()) {
+    return;
+  }
+  const float area = std::fabs((b.x - a.x) * (c.y - a.y)
+    - (b.y - a.y) * (c.x - a.x));
+  const Vec2F tab = *in_out_tb - *in_out_ta;
+  const Vec2F tac = *in_out_tc - *in_out_ta;
+  const float tex_area = std::fabs(tab.x * tac.y - tab.y * tac.x);
+  if (!(area > 0.f)) {
+    return;
+  }
+  const Si32 level = MipLevelForScale(std::sqrt(tex_area / area),
+    std::min(in_out_texture->Width(), in_out_texture->Height()));
+  if (level == 0) {
+    return;
+  }
+  const Sprite &texture = *in_out_texture;
+  Sprite mip = texture.MipLevel(level);
+  const float mul = 1.f / static_cast<float>(1 << level);
+  const Vec2F offset = Vec2F(texture.RefPos()) * mul - Vec2F(mip.RefPos());
+  // Bilinear sampling reads the next texel too, so it must stay inside.
+  const Vec2F tex_max = Vec2F(mip.Size()) - Vec2F(1.01f, 1.01f);
+  Vec2F *tex[3] = {in_out_ta, in_out_tb, in_out_tc};
+  for (Vec2F *t : tex) {
+    const Vec2F mip_t = *t * mul + offset;
+    *t = Vec2F(std::min(std::max(mip_t.x, 0.f), std::max(tex_max.x, 0.f)),
+      std::min(std::max(mip_t.y, 0.f), std::max(tex_max.y, 0.f)));
+  }
+  *in_out_texture = mip;
+}
+
+// Marks the pixels a sprite draw may write as changed.
+static void MarkSpriteDrawDirty(Sprite *to_sprite,
+    const Si32 to_x_pivot, const Si32 to_y_pivot,
+    const Si32 to_width, const Si32 to_height,
+    const Sprite &from_sprite, const Si32 from_width, const Si32 from_height) {
+  if (!from_width || !from_height || !to_width || !to_height) {
+    return;
+  }
+  const Vec2Si32 begin(
+    to_x_pivot - from_sprite.Pivot().x * to_width / from_width,
+    to_y_pivot - from_sprite.Pivot().y * to_height / from_height);
+  const Vec2Si32 end = begin + Vec2Si32(to_width, to_height);
+  to_sprite->MarkDirty(
+    Vec2Si32(std::min(begin.x, end.x), std::min(begin.y, end.y)),
+    Vec2Si32(std::max(begin.x, end.x), std::max(begin.y, end.y)));
+}
+
+// Marks the pixels a triangle draw may write as changed. The edges are
+// interpolated in floating point, so the bound is widened by a pixel.
+static void MarkTriangleDirty(Sprite *to_sprite, Vec2F a, Vec2F b, Vec2F c) {
+  if (!to_sprite->SpriteInstance()
+      || !to_sprite->SpriteInstance()->IsDirtyTracked()) {
+    return;
+  }
+  const float x1 = std::min(a.x, std::min(b.x, c.x));
+  const float x2 = std::max(a.x, std::max(b.x, c.x));
+  const float y1 = std::min(a.y, std::min(b.y, c.y));
+  const float y2 = std::max(a.y, std::max(b.y, c.y));
+  if (!(x1 <= x2 && y1 <= y2)) {
+    to_sprite->MarkDirty();
+    return;
+  }
+  const float width_f = static_cast<float>(to_sprite->Width());
+  const float height_f = static_cast<float>(to_sprite->Height());
+  to_sprite->MarkDirty(
+    Vec2Si32(
+      static_cast<Si32>(std::floor(std::min(std::max(x1, -1.f), width_f))) - 1,
+      static_cast<Si32>(std::floor(std::min(std::max(y1, -1.f), height_f))) - 1),
+    Vec2Si32(
+      static_cast<Si32>(std::max(std::min(x2, width_f + 1.f), -1.f)) + 2,
+      static_cast<Si32>(std::max(std::min(y2, height_f + 1.f), -1.f)) + 2));
+}
+
 template<DrawBlendingMode kBlendingMode, DrawFilterMode kFilterMode>
 void DrawTriangle(Sprite to_sprite,
     Vec2F a, Vec2F b, Vec2F c,
     Vec2F tex_a, Vec2F tex_b, Vec2F tex_c,
-    Sprite texture, Rgba in_color) {
+    Sprite texture, Rgba in_color,
+    const Vec2Si32 clip_begin = Vec2Si32(0, 0),
+    const Vec2Si32 clip_end = Vec2Si32(kNoClip, kNoClip)) {
   if (a.y > b.y) {
     std::swap(a, b);
     std::swap(tex_a, tex_b);
@@ -66,7 +246,7 @@ void DrawTriangle(Sprite to_sprite,
   }
 
   Si32 stride = to_sprite.StridePixels();
-  Rgba *dst = to_sprite.RgbaData();
+  Rgba *dst = to_sprite.UntrackedRgbaData();
   Si32 width = to_sprite.Width();
   Si32 height = to_sprite.Height();
   float height_f = static_cast<float>(height);
@@ -406,10 +586,41 @@ void DrawTriangle(Sprite to_sprite,
     }
   }
 
-  // Fill
+  // Fill, the edges are always set up for the whole destination sprite
+  // so that a clipped triangle samples exactly the same texels.
   Si32 tex_stride = texture.StridePixels();
-  const Rgba * const tex_data = texture.RgbaData();
-  for (Si32 y = first_y; y <= last_y; ++y) {
+  const Rgba * const tex_data = texture.UntrackedRgbaData();
+  // The pixels sampling only the texels outside of the box bounding
+  // the runs of the texture are transparent, so they are skipped.
+  const SpriteInstance &tex_instance = *texture.SpriteInstance();
+  const bool is_box_limited = IsTransparentNoOp(kBlendingMode)
+    && tex_instance.HasRuns()
+    && texture.SpriteInstance() != to_sprite.SpriteInstance();
+  Si64 box_x1_16 = 0;
+  Si64 box_x2_16 = 0;
+  Si64 box_y1_16 = 0;
+  Si64 box_y2_16 = 0;
+  if (is_box_limited) {
+    if (tex_instance.OpaqueEnd().y == 0) {
+      return;
+    }
+    const Vec2Si32 box_begin = tex_instance.OpaqueBegin() - texture.RefPos();
+    const Vec2Si32 box_end = tex_instance.OpaqueEnd() - texture.RefPos();
+    if (kFilterMode == kFilterNearest) {
+      box_x1_16 = (static_cast<Si64>(box_begin.x) << 16) - 32768;
+      box_x2_16 = (static_cast<Si64>(box_end.x) << 16) - 32768;
+      box_y1_16 = (static_cast<Si64>(box_begin.y) << 16) - 32768;
+      box_y2_16 = (static_cast<Si64>(box_end.y) << 16) - 32768;
+    } else {
+      box_x1_16 = static_cast<Si64>(box_begin.x - 1) << 16;
+      box_x2_16 = static_cast<Si64>(box_end.x) << 16;
+      box_y1_16 = static_cast<Si64>(box_begin.y - 1) << 16;
+      box_y2_16 = static_cast<Si64>(box_end.y) << 16;
+    }
+  }
+  const Si32 clip_first_y = std::max(first_y, clip_begin.y);
+  const Si32 clip_last_y = std::min(last_y, clip_end.y - 1);
+  for (Si32 y = clip_first_y; y <= clip_last_y; ++y) {
     const Edge &edge_l = edge[y * 2];
     const Edge &edge_r = edge[y * 2 + 1];
     if (edge_r.x < 0.f || edge_l.x >= width) {
@@ -440,7 +651,45 @@ void DrawTriangle(Sprite to_sprite,
     Si32 tex1_y_16 = static_cast<Si32>(tex1.y * 65536.f);
     Si32 dtdx_x_16 = static_cast<Si32>(dtdx.x * 65536.f);
     Si32 dtdx_y_16 = static_cast<Si32>(dtdx.y * 65536.f);
-    for (Si32 x = x1_i; x <= x2_i; ++x) {
+    const Si32 clip_x1_i = std::max(x1_i, clip_begin.x);
+    const Si32 clip_x2_i = std::min(x2_i, clip_end.x - 1);
+    if (clip_x1_i > clip_x2_i) {
+      continue;
+    }
+    Si32 skip_x_i = clip_x1_i;
+    Si32 last_x_i = clip_x2_i;
+    if (is_box_limited) {
+      const Si64 tex_x_16 = static_cast<Si64>(tex1_x_16)
+        + static_cast<Si64>(dtdx_x_16) * (clip_x1_i - x1_i);
+      const Si64 tex_y_16 = static_cast<Si64>(tex1_y_16)
+        + static_cast<Si64>(dtdx_y_16) * (clip_x1_i - x1_i);
+      const Si64 count = clip_x2_i - clip_x1_i + 1;
+      Si64 first = 0;
+      Si64 end = count;
+      // Only valid while the fixed point coordinates do not overflow,
+      // they never do for the textures that fit in memory.
+      if (IsInSi32Range(tex_x_16) && IsInSi32Range(tex_y_16)
+          && IsInSi32Range(tex_x_16 + dtdx_x_16 * (count - 1))
+          && IsInSi32Range(tex_y_16 + dtdx_y_16 * (count - 1))) {
+        LimitLinearRange(tex_x_16, dtdx_x_16, box_x1_16, box_x2_16,
+          &first, &end);
+        LimitLinearRange(tex_y_16, dtdx_y_16, box_y1_16, box_y2_16,
+          &first, &end);
+        if (first >= end) {
+          continue;
+        }
+        skip_x_i = clip_x1_i + static_cast<Si32>(first);
+        last_x_i = clip_x1_i + static_cast<Si32>(end) - 1;
+      }
+    }
+    if (skip_x_i > x1_i) {
+      const Ui32 skip = static_cast<Ui32>(skip_x_i - x1_i);
+      tex1_x_16 = static_cast<Si32>(static_cast<Ui32>(tex1_x_16)
+        + static_cast<Ui32>(dtdx_x_16) * skip);
+      tex1_y_16 = static_cast<Si32>(static_cast<Ui32>(tex1_y_16)
+        + static_cast<Ui32>(dtdx_y_16) * skip);
+    }
+    for (Si32 x = skip_x_i; x <= last_x_i; ++x) {
       // output to p_line[x]
       // texture at tex1
       Rgba * const to_rgba = p_line + x;
@@ -562,41 +811,86 @@ void DrawSprite(Sprite *to_sprite,
     const Si32 to_width, const Si32 to_height,
     const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
     const Si32 from_width, const Si32 from_height,
-    Rgba in_color) {
+    Rgba in_color,
+    const Vec2Si32 clip_begin = Vec2Si32(0, 0),
+    const Vec2Si32 clip_end = Vec2Si32(kNoClip, kNoClip)) {
   if (!from_width || !from_height || !to_width || !to_height) {
     return;
   }
+  const Si32 clip_x1 = std::max(clip_begin.x, 0);
+  const Si32 clip_y1 = std::max(clip_begin.y, 0);
+  const Si32 clip_x2 = std::min(clip_end.x, to_sprite->Width());
+  const Si32 clip_y2 = std::min(clip_end.y, to_sprite->Height());
   const Si32 from_stride_pixels = from_sprite.StridePixels();
   const Si32 to_stride_pixels = to_sprite->StridePixels();
+  // The vector kernels read several source pixels before writing any of them,
+  // so a sprite drawn onto itself is blended by the in-order scalar kernel.
+  const bool is_aliased =
+    from_sprite.SpriteInstance() == to_sprite->SpriteInstance();
+  const BlendKernelIsa isa =
+    is_aliased ? kBlendKernelIsaScalar : GetBlendKernelIsa();
 
   if (to_width == from_width && to_height == from_height
       && !from_sprite.IsRef() && !from_sprite.Opaque().empty()) {
     const std::vector<SpanSi32> &opaque = from_sprite.Opaque();
+    const BlendRowFunc blend_row = GetBlendRowFunc(kBlendingMode, false, isa);
 
     const Si32 to_x = to_x_pivot - from_sprite.Pivot().x;
     const Si32 to_y = to_y_pivot - from_sprite.Pivot().y;
 
-    Rgba *to = to_sprite->RgbaData()
+    Rgba *to = to_sprite->UntrackedRgbaData()
       + to_y * to_stride_pixels
       + to_x;
     const Rgba *from = from_sprite.RgbaData()
       + from_y * from_stride_pixels
       + from_x;
 
-    const Si32 to_y_db = (to_y >= 0 ? 0 : -to_y);
-    const Si32 to_y_d_max = to_sprite->Height() - to_y;
+    const Si32 to_y_db = (to_y >= clip_y1 ? 0 : clip_y1 - to_y);
+    const Si32 to_y_d_max = clip_y2 - to_y;
     const Si32 to_y_de = (to_height < to_y_d_max ? to_height : to_y_d_max);
 
-    const Si32 k_to_x_db = (to_x >= 0 ? 0 : -to_x);
-    const Si32 to_x_d_max = to_sprite->Width() - to_x;
+    const Si32 k_to_x_db = (to_x >= clip_x1 ? 0 : clip_x1 - to_x);
+    const Si32 to_x_d_max = clip_x2 - to_x;
     const Si32 k_to_x_de = (to_width < to_x_d_max ? to_width : to_x_d_max);
     const Si32 from_x_ab = k_to_x_db + from_x;
     const Si32 from_x_ae = k_to_x_de + from_x;
 
+    if (IsTransparentNoOp(kBlendingMode) && !is_aliased) {
+      // Only the runs are drawn, the opaque ones are plain copies
+      // for the modes that copy opaque pixels as is.
+      const SpriteInstance &instance = *from_sprite.SpriteInstance();
+      const bool is_opaque_copied =
+        (kBlendingMode == kDrawBlendingModeAlphaBlend
+          || kBlendingMode == kDrawBlendingModePremultipliedAlphaBlend);
+      for (Si32 to_y_disp = to_y_db; to_y_disp < to_y_de; ++to_y_disp) {
+        const Rgba *from_line = from + to_y_disp * from_stride_pixels;
+        Rgba *to_line = to + to_y_disp * to_stride_pixels;
+        const RunSi32 *run_end = instance.RowRunsEnd(from_y + to_y_disp);
+        for (const RunSi32 *run = instance.RowRunsBegin(from_y + to_y_disp);
+            run != run_end; ++run) {
+          const Si32 to_x_db = std::max(k_to_x_db, run->begin - from_x);
+          const Si32 to_x_de = std::min(k_to_x_de, run->end - from_x);
+          if (to_x_de <= to_x_db) {
+            if (run->begin - from_x >= k_to_x_de) {
+              break;
+            }
+            continue;
+          }
+          if (run->is_opaque && is_opaque_copied) {
+            memcpy(static_cast<void*>(to_line + to_x_db), from_line + to_x_db,
+              sizeof(Rgba) * static_cast<size_t>(to_x_de - to_x_db));
+          } else {
+            blend_row(to_line + to_x_db, from_line + to_x_db,
+              to_x_de - to_x_db, in_color);
+          }
+        }
+      }
+      return;
+    }
+
     for (Si32 to_y_disp = to_y_db; to_y_disp < to_y_de; ++to_y_disp) {
       const Si32 from_y_disp = to_y_disp;
 
-      Si32 from_x_acc = 0;
       const SpanSi32 &span = opaque[static_cast<size_t>(from_y + to_y_disp)];
 
       Si32 to_x_db = k_to_x_db;
@@ -608,87 +902,14 @@ void DrawSprite(Sprite *to_sprite,
         Si32 offset = span.end - from_x_ae;
         to_x_de += offset;
       }
+      if (to_x_de <= to_x_db) {
+        continue;
+      }
 
       const Rgba *from_line = from + from_y_disp * from_stride_pixels;
       Rgba *to_line = to + to_y_disp * to_stride_pixels;
-
-      for (Si32 to_x_disp = to_x_db; to_x_disp < to_x_de; ++to_x_disp) {
-        Rgba *to_rgba = to_line + to_x_disp;
-        const Si32 from_x_disp = to_x_db + from_x_acc;
-        from_x_acc++;
-        const Rgba *from_rgba = from_line + from_x_disp;
-        Rgba color = *from_rgba;
-        if (kBlendingMode == kDrawBlendingModeCopyRgba) {
-          to_rgba->rgba = from_rgba->rgba;
-        } else if (kBlendingMode == kDrawBlendingModeAlphaBlend) {
-          if (color.a == 255) {
-            to_rgba->rgba = color.rgba;
-          } else if (color.a) {
-            Ui32 m = 255 - color.a;
-            Ui32 rb = (to_rgba->rgba & 0x00ff00fful) * m;
-            Ui32 g = ((to_rgba->rgba & 0x0000ff00ul) >> 8u) * m;
-            Ui32 m2 = color.a;
-            Ui32 rb2 = (color.rgba & 0x00ff00fful) * m2;
-            Ui32 g2 = ((color.rgba & 0x0000ff00ul) >> 8u) * m2;
-            to_rgba->rgba = (((rb + rb2) >> 8u) & 0x00ff00fful) |
-            ((g + g2) & 0x0000ff00ul);
-          }
-        } else if (kBlendingMode == kDrawBlendingModePremultipliedAlphaBlend) {
-          if (color.a == 255) {
-            to_rgba->rgba = color.rgba;;
-          } else if (color.a) {
-            Ui32 m = 255 - color.a;
-            Ui32 rb = ((to_rgba->rgba & 0x00ff00fful) * m) >> 8u;
-            Ui32 g = ((to_rgba->rgba & 0x0000ff00ul) >> 8u) * m;
-            Ui32 rb2 = (color.rgba & 0x00ff00fful);
-            Ui32 g2 = (color.rgba & 0x0000ff00ul);
-            to_rgba->rgba = ((rb + rb2) & 0x00ff00fful) | ((g + g2) & 0x0000ff00ul);
-          }
-        } else if (kBlendingMode == kDrawBlendingModeColorize) {
-          Ui32 ca = (Ui32(color.a) * (Ui32(in_color.a) + 1u)) >> 8u;
-          if (ca == 255) {
-            Ui32 r2 = (Ui32(color.r) * (Ui32(in_color.r) + 1)) >> 8u;
-            Ui32 g2 = (Ui32(color.g) * (Ui32(in_color.g) + 1)) >> 8u;
-            Ui32 b2 = (Ui32(color.b) * (Ui32(in_color.b) + 1)) >> 8u;
-            to_rgba->rgba = Rgba((Ui8)r2, (Ui8)g2, (Ui8)b2).rgba;
-          } else if (ca) {
-            Ui32 m = 255 - ca;
-            Ui32 rb = (to_rgba->rgba & 0x00ff00fful) * m;
-            Ui32 g = ((to_rgba->rgba & 0x0000ff00ul) >> 8u) * m;
-
-            Ui32 m2 = ca;
-            Ui32 rb2_ = (((color.rgba & 0x00ff00fful) * m2) & 0xff00ff00u) >> 8u;
-            Ui32 rb2  = ((rb2_ & 0x00ff0000u) * ((in_color.rgba & 0x00ff0000u) >> 16u)) | ((rb2_ & 0x000000ffu) * (in_color.rgba & 0x000000ffu));
-            Ui32 g2 = (Ui32(color.g) * m2 * (Ui32(in_color.g) + 1)) >> 8u;
-
-            to_rgba->rgba = (((rb + rb2) >> 8u) & 0x00ff00fful) | ((g + g2) & 0x0000ff00ul);
-          }
-        } else if (kBlendingMode == kDrawBlendingModeSolidColor) {
-          Ui32 ca = (Ui32(color.a) * (Ui32(in_color.a) + 1u)) >> 8u;
-          if (ca == 255) {
-            to_rgba->rgba = in_color.rgba;
-          } else if (ca) {
-            Ui32 m = 255 - ca;
-            Ui32 rb = (to_rgba->rgba & 0x00ff00fful) * m;
-            Ui32 g = ((to_rgba->rgba & 0x0000ff00ul) >> 8u) * m;
-            
-            Ui32 rb2 = (in_color.rgba & 0x00ff00fful) * ca;
-            Ui32 g2 = ((in_color.rgba & 0x0000ff00ul) >> 8u) * ca;
-
-            to_rgba->rgba = (((rb + rb2) >> 8u) & 0x00ff00fful) | ((g + g2) & 0x0000ff00ul);
-          }
-        } else if (kBlendingMode == kDrawBlendingModeAdd) {
-          Ui32 r2 = Ui32(color.r) + Ui32(to_rgba->r);
-          Ui32 g2 = Ui32(color.g) + Ui32(to_rgba->g);
-          Ui32 b2 = Ui32(color.b) + Ui32(to_rgba->b);
-          r2 = r2 > 255 ? 255 : r2;
-          g2 = g2 > 255 ? 255 : g2;
-          b2 = b2 > 255 ? 255 : b2;
-          to_rgba->rgba = Rgba((Ui8)r2, (Ui8)g2, (Ui8)b2).rgba;
-        } else {  // Unknown blending mode!
-          to_rgba->rgba = color.rgba;
-        }
-      }
+      blend_row(to_line + to_x_db, from_line + to_x_db,
+          to_x_de - to_x_db, in_color);
     }
     return;
   }
@@ -698,7 +919,7 @@ void DrawSprite(Sprite *to_sprite,
   const Si32 to_y = to_y_pivot -
     from_sprite.Pivot().y * to_height / from_height;
 
-  Rgba *to = to_sprite->RgbaData()
+  Rgba *to = to_sprite->UntrackedRgbaData()
     + to_y * to_stride_pixels
     + to_x;
   const Rgba *from = from_sprite.RgbaData()
@@ -713,142 +934,180 @@ void DrawSprite(Sprite *to_sprite,
   const Si32 to_x_d_max = to_sprite->Width() - to_x;
   const Si32 to_x_de = (to_width < to_x_d_max ? to_width : to_x_d_max);
 
+  // Sampling always starts at the edge of the destination sprite, the clip
+  // rectangle only selects the pixels to write. The accumulators are
+  // advanced to the first clipped pixel so the result does not depend on it.
+  const Si32 clip_y_db = std::max(to_y_db, clip_y1 - to_y);
+  const Si32 clip_y_de = std::min(to_y_de, clip_y2 - to_y);
+  const Si32 clip_x_db = std::max(to_x_db, clip_x1 - to_x);
+  const Si32 clip_x_de = std::min(to_x_de, clip_x2 - to_x);
+
   const Si32 from_y_step_16 = 65536 * from_height / to_height;
-  Si32 from_y_disp_16 = Si32((65535ull * from_height * to_y_db) / to_height);
+  Si32 from_y_disp_16 = Si32((65536ull * from_height * to_y_db) / to_height);
   Si32 from_y_acc_16 = 0;
   if (kFilterMode == kFilterBilinear) {
     from_y_acc_16 = -32767;
   }
   Ui32 from_y_8 = 0;
-  for (Si32 to_y_disp = to_y_db; to_y_disp < to_y_de; ++to_y_disp) {
-    const Si32 from_x_b = (from_width * to_x_db) / to_width;
-    const Si32 from_x_step_16 = 65536 * from_width / to_width;
-    Si32 from_x_acc_16 = 0;
-    if (kFilterMode == kFilterBilinear) {
-      from_x_acc_16 = -32767;
+  if (clip_y_db > to_y_db) {
+    from_y_acc_16 = static_cast<Si32>(static_cast<Ui32>(from_y_acc_16)
+      + static_cast<Ui32>(from_y_step_16)
+      * static_cast<Ui32>(clip_y_db - to_y_db));
+    if (from_y_acc_16 > 0) {
+      from_y_8 = (static_cast<Ui32>(from_y_acc_16) & 65535ul) >> 8u;
+    }
+  }
+  // Source pixels are sampled into a short row and then blended by a kernel,
+  // CopyRgba samples straight into the destination.
+  const bool is_direct = (kBlendingMode == kDrawBlendingModeCopyRgba);
+  const BlendRowFunc blend_row = GetBlendRowFunc(kBlendingMode, true, isa);
+  const Si32 chunk_pixels = (is_aliased ? 1 : kBlendChunkPixels);
+  Rgba row[kBlendChunkPixels];
+  const Si32 from_x_b = (from_width * to_x_db) / to_width;
+  const Si32 from_x_step_16 = 65536 * from_width / to_width;
+  const Si32 from_x_acc_16_init = (kFilterMode == kFilterBilinear ? -32767 : 0);
+  // The runs of the source rows limit the drawn part of each row. A pixel
+  // samples column from_x_b + (acc >> 16) (and the next one when filtering),
+  // acc growing by from_x_step_16 per pixel, so the columns of a run map
+  // to a contiguous range of the destination pixels.
+  const SpriteInstance &instance = *from_sprite.SpriteInstance();
+  const Si32 run_x_offset = from_sprite.RefPos().x + from_x;
+  const Si32 run_y_offset = from_sprite.RefPos().y + from_y;
+  const bool is_run_skipping = IsTransparentNoOp(kBlendingMode)
+    && !is_aliased && instance.HasRuns() && from_x_step_16 > 0
+    && run_y_offset >= 0 && run_y_offset + from_height <= instance.height();
+  const auto first_x_at_column = [&](Si32 column) -> Si32 {
+    if (column <= from_x_b) {
+      return to_x_db;
     }
+    const Si64 acc = (static_cast<Si64>(column - from_x_b) << 16)
+      - from_x_acc_16_init;
+    const Si64 x = to_x_db + (acc + from_x_step_16 - 1) / from_x_step_16;
+    return static_cast<Si32>(std::min(x, static_cast<Si64>(clip_x_de)));
+  };
 
+  for (Si32 to_y_disp = clip_y_db; to_y_disp < clip_y_de; ++to_y_disp) {
     Si32 from_y_disp = ((from_y_disp_16 + from_y_acc_16) / 65536);
     from_y_acc_16 += from_y_step_16;
 
+    const Si32 from_y_disp_1 = std::min(from_height - 1, from_y_disp + 1);
     const Rgba *from_line_0 = from + from_y_disp * from_stride_pixels;
-    const Rgba *from_line_1 = from +
-      std::min(from_height - 1, from_y_disp + 1) * from_stride_pixels;
+    const Rgba *from_line_1 = from + from_y_disp_1 * from_stride_pixels;
     Rgba *to_line = to + to_y_disp * to_stride_pixels;
 
-    Ui32 from_x_8 = 0;
-    Si32 from_x_disp_00 = from_x_b;
-    Si32 from_x_disp_01 = from_x_b + 1;
-    Rgba *to_rgba = to_line + to_x_db;
-    for (Si32 to_x_disp = to_x_db; to_x_disp < to_x_de; ++to_x_disp) {
-      from_x_acc_16 += from_x_step_16;
-
-      Rgba color;
-      if (kFilterMode == kFilterNearest) {
-        color = *(from_line_0 + from_x_disp_00);
-      } else if (kFilterMode == kFilterBilinear) {
-        Rgba color00 = *(from_line_0 + from_x_disp_00);
-        Rgba color01 = *(from_line_0 + from_x_disp_00 + 1);
-        Rgba color10 = *(from_line_1 + from_x_disp_00);
-        Rgba color11 = *(from_line_1 + from_x_disp_00 + 1);
-        color = Rgba(
-           (Ui8)(((Ui32(color00.r) * ((255 - from_x_8) * (255 - from_y_8))) +
-            (Ui32(color01.r) * ((from_x_8) * (255 - from_y_8))) +
-            (Ui32(color10.r) * ((255 - from_x_8) * (from_y_8))) +
-            (Ui32(color11.r) * ((from_x_8) * (from_y_8)))) >> 16u),
-           (Ui8)(((Ui32(color00.g) * ((255 - from_x_8) * (255 - from_y_8))) +
-            (Ui32(color01.g) * ((from_x_8) * (255 - from_y_8))) +
-            (Ui32(color10.g) * ((255 - from_x_8) * (from_y_8))) +
-            (Ui32(color11.g) * ((from_x_8) * (from_y_8)))) >> 16u),
-           (Ui8)(((Ui32(color00.b) * ((255 - from_x_8) * (255 - from_y_8))) +
-            (Ui32(color01.b) * ((from_x_8) * (255 - from_y_8))) +
-            (Ui32(color10.b) * ((255 - from_x_8) * (from_y_8))) +
-            (Ui32(color11.b) * ((from_x_8) * (from_y_8)))) >> 16u),
-           (Ui8)(((Ui32(color00.a) * ((255 - from_x_8) * (255 - from_y_8))) +
-            (Ui32(color01.a) * ((from_x_8) * (255 - from_y_8))) +
-            (Ui32(color10.a) * ((255 - from_x_8) * (from_y_8))) +
-            (Ui32(color11.a) * ((from_x_8) * (from_y_8)))) >> 16u));
+    // Draws the [x_db, x_de) part of the row, the accumulators are
+    // advanced to x_db so the result does not depend on where it starts.
+    const auto draw_part = [&](Si32 x_db, Si32 x_de) {
+      Si32 from_x_acc_16 = static_cast<Si32>(
+        static_cast<Ui32>(from_x_acc_16_init)
+        + static_cast<Ui32>(from_x_step_16)
+        * static_cast<Ui32>(x_db - to_x_db));
+      Ui32 from_x_8 = 0;
+      Si32 from_x_disp_00 = from_x_b;
+      if (from_x_acc_16 > 0) {
+        from_x_8 = (static_cast<Ui32>(from_x_acc_16) & 65535ul) >> 8u;
+        from_x_disp_00 = from_x_b + static_cast<Si32>(
+          (static_cast<Ui32>(from_x_acc_16) >> 16u));
       }
 
+      Rgba *to_rgba = to_line + x_db;
+      Si32 to_x_disp = x_db;
+      while (to_x_disp < x_de) {
+        const Si32 count = std::min(chunk_pixels, x_de - to_x_disp);
+        Rgba *sampled = is_direct ? to_rgba : row;
+        for (Si32 idx = 0; idx < count; ++idx) {
+          from_x_acc_16 += from_x_step_16;
+
+          Rgba &color = sampled[idx];
+          if (kFilterMode == kFilterNearest) {
+            color.rgba = from_line_0[from_x_disp_00].rgba;
+          } else if (kFilterMode == kFilterBilinear
+              && kBlendingMode == kDrawBlendingModeSolidColor) {
+            // SolidColor only reads the alpha of the source.
+            Rgba color00 = *(from_line_0 + from_x_disp_00);
+            Rgba color01 = *(from_line_0 + from_x_disp_00 + 1);
+            Rgba color10 = *(from_line_1 + from_x_disp_00);
+            Rgba color11 = *(from_line_1 + from_x_disp_00 + 1);
+            color.rgba = ((Ui32(color00.a) * ((255 - from_x_8) * (255 - from_y_8))) +
+                (Ui32(color01.a) * ((from_x_8) * (255 - from_y_8))) +
+                (Ui32(color10.a) * ((255 - from_x_8) * (from_y_8))) +
+                (Ui32(color11.a) * ((from_x_8) * (from_y_8)))) >> 16u << 24u;
+          } else if (kFilterMode == kFilterBilinear) {
+            Rgba color00 = *(from_line_0 + from_x_disp_00);
+            Rgba color01 = *(from_line_0 + from_x_disp_00 + 1);
+            Rgba color10 = *(from_line_1 + from_x_disp_00);
+            Rgba color11 = *(from_line_1 + from_x_disp_00 + 1);
+            color = Rgba(
+               (Ui8)(((Ui32(color00.r) * ((255 - from_x_8) * (255 - from_y_8))) +
+                (Ui32(color01.r) * ((from_x_8) * (255 - from_y_8))) +
+                (Ui32(color10.r) * ((255 - from_x_8) * (from_y_8))) +
+                (Ui32(color11.r) * ((from_x_8) * (from_y_8)))) >> 16u),
+               (Ui8)(((Ui32(color00.g) * ((255 - from_x_8) * (255 - from_y_8))) +
+                (Ui32(color01.g) * ((from_x_8) * (255 - from_y_8))) +
+                (Ui32(color10.g) * ((255 - from_x_8) * (from_y_8))) +
+                (Ui32(color11.g) * ((from_x_8) * (from_y_8)))) >> 16u),
+               (Ui8)(((Ui32(color00.b) * ((255 - from_x_8) * (255 - from_y_8))) +
+                (Ui32(color01.b) * ((from_x_8) * (255 - from_y_8))) +
+                (Ui32(color10.b) * ((255 - from_x_8) * (from_y_8))) +
+                (Ui32(color11.b) * ((from_x_8) * (from_y_8)))) >> 16u),
+               (Ui8)(((Ui32(color00.a) * ((255 - from_x_8) * (255 - from_y_8))) +
+                (Ui32(color01.a) * ((from_x_8) * (255 - from_y_8))) +
+                (Ui32(color10.a) * ((255 - from_x_8) * (from_y_8))) +
+                (Ui32(color11.a) * ((from_x_8) * (from_y_8)))) >> 16u));
+          }
 
-      if (kBlendingMode == kDrawBlendingModeCopyRgba) {
-        to_rgba->rgba = color.rgba;
-      } else if (kBlendingMode == kDrawBlendingModeAlphaBlend) {
-        if (color.a == 255) {
-          to_rgba->rgba = color.rgba;
-        } else if (color.a) {
-          Ui32 m = 255 - color.a;
-          Ui32 rb = (to_rgba->rgba & 0x00ff00fful) * m;
-          Ui32 g = ((to_rgba->rgba & 0x0000ff00ul) >> 8u) * m;
-          Ui32 m2 = color.a;
-          Ui32 rb2 = (color.rgba & 0x00ff00fful) * m2;
-          Ui32 g2 = ((color.rgba & 0x0000ff00ul) >> 8u) * m2;
-          to_rgba->rgba = (((rb + rb2) >> 8u) & 0x00ff00fful) |
-            ((g + g2) & 0x0000ff00ul);
+          if (from_x_acc_16 > 0) {
+            from_x_8 = (static_cast<Ui32>(from_x_acc_16) & 65535ul) >> 8u;
+            from_x_disp_00 = from_x_b + static_cast<Si32>((static_cast<Ui32>(from_x_acc_16) >> 16u));
+          }
         }
-      } else if (kBlendingMode == kDrawBlendingModePremultipliedAlphaBlend) {
-        if (color.a == 255) {
-          to_rgba->rgba = color.rgba;;
-        } else if (color.a) {
-          Ui32 m = 255 - color.a;
-          Ui32 rb = ((to_rgba->rgba & 0x00ff00fful) * m) >> 8u;
-          Ui32 g = ((to_rgba->rgba & 0x0000ff00ul) >> 8u) * m;
-          Ui32 rb2 = (color.rgba & 0x00ff00fful);
-          Ui32 g2 = (color.rgba & 0x0000ff00ul);
-          to_rgba->rgba = ((rb + rb2) & 0x00ff00fful) | ((g + g2) & 0x0000ff00ul);
+        if (!is_direct) {
+          blend_row(to_rgba, row, count, in_color);
         }
-      } else if (kBlendingMode == kDrawBlendingModeColorize) {
-        Ui32 ca = (Ui32(color.a) * (Ui32(in_color.a) + 1)) >> 8u;
-        if (ca == 255) {
-          Ui32 r2 = (Ui32(color.r) * (Ui32(in_color.r) + 1)) >> 8u;
-          Ui32 g2 = (Ui32(color.g) * (Ui32(in_color.g) + 1)) & 0xff00u;
-          Ui32 b2 = ((Ui32(color.b) * (Ui32(in_color.b) + 1)) << 8u)
-            & 0xff0000ull;
-          to_rgba->rgba = r2 | g2 | b2;
-        } else if (ca) {
-          Ui32 m = 255 - ca;
-          Ui32 rb = (to_rgba->rgba & 0x00ff00fful) * m;
-          Ui32 g = ((to_rgba->rgba & 0x0000ff00ul) >> 8u) * m;
-
-          Ui32 m2 = ca;
-          Ui32 rb2_ = (((color.rgba & 0x00ff00fful) * m2) & 0xff00ff00u) >> 8u;
-          Ui32 rb2  = ((rb2_ & 0x00ff0000u) * ((in_color.rgba & 0x00ff0000u) >> 16u)) | ((rb2_ & 0x000000ffu) * (in_color.rgba & 0x000000ffu));
-          Ui32 g2 = (Ui32(color.g) * m2 * (Ui32(in_color.g) + 1)) >> 8u;
+        to_rgba += count;
+        to_x_disp += count;
+      }
+    };
 
-          to_rgba->rgba = (((rb + rb2) >> 8u) & 0x00ff00fful) | ((g + g2) & 0x0000ff00ul);
+    if (!is_run_skipping) {
+      draw_part(clip_x_db, clip_x_de);
+    } else {
+      // Merges the runs of the sampled rows, a filtered pixel also
+      // samples the column to the right so the runs are widened to the left.
+      const Si32 widen = (kFilterMode == kFilterBilinear ? 1 : 0);
+      const RunSi32 *run_0 = instance.RowRunsBegin(run_y_offset + from_y_disp);
+      const RunSi32 *run_0_end = instance.RowRunsEnd(run_y_offset + from_y_disp);
+      const RunSi32 *run_1 = run_0_end;
+      const RunSi32 *run_1_end = run_0_end;
+      if (kFilterMode == kFilterBilinear) {
+        run_1 = instance.RowRunsBegin(run_y_offset + from_y_disp_1);
+        run_1_end = instance.RowRunsEnd(run_y_offset + from_y_disp_1);
+      }
+      const auto next_run = [&]() -> const RunSi32* {
+        if (run_1 == run_1_end
+            || (run_0 != run_0_end && run_0->begin <= run_1->begin)) {
+          return run_0 == run_0_end ? nullptr : run_0++;
         }
-      } else if (kBlendingMode == kDrawBlendingModeSolidColor) {
-        Ui32 ca = (Ui32(color.a) * (Ui32(in_color.a) + 1u)) >> 8u;
-        if (ca == 255) {
-          to_rgba->rgba = in_color.rgba;
-        } else if (ca) {
-          Ui32 m = 255 - ca;
-          Ui32 rb = (to_rgba->rgba & 0x00ff00fful) * m;
-          Ui32 g = ((to_rgba->rgba & 0x0000ff00ul) >> 8u) * m;
-          
-          Ui32 rb2 = (in_color.rgba & 0x00ff00fful) * ca;
-          Ui32 g2 = ((in_color.rgba & 0x0000ff00ul) >> 8u) * ca;
-
-          to_rgba->rgba = (((rb + rb2) >> 8u) & 0x00ff00fful) | ((g + g2) & 0x0000ff00ul);
+        return run_1++;
+      };
+      const RunSi32 *run = next_run();
+      while (run) {
+        const Si32 column_b = run->begin - run_x_offset - widen;
+        Si32 column_e = run->end - run_x_offset;
+        run = next_run();
+        while (run && run->begin - run_x_offset - widen <= column_e) {
+          column_e = std::max(column_e, run->end - run_x_offset);
+          run = next_run();
+        }
+        const Si32 x_db = std::max(clip_x_db, first_x_at_column(column_b));
+        const Si32 x_de = first_x_at_column(column_e);
+        if (x_db >= clip_x_de) {
+          break;
+        }
+        if (x_db < x_de) {
+          draw_part(x_db, x_de);
         }
-      } else if (kBlendingMode == kDrawBlendingModeAdd) {
-        Ui32 r2 = Ui32(color.r) + Ui32(to_rgba->r);
-        Ui32 g2 = Ui32(color.g) + Ui32(to_rgba->g);
-        Ui32 b2 = Ui32(color.b) + Ui32(to_rgba->b);
-        r2 = r2 > 255 ? 255 : r2;
-        g2 = g2 > 255 ? 255 : g2;
-        b2 = b2 > 255 ? 255 : b2;
-        to_rgba->rgba = Rgba((Ui8)r2, (Ui8)g2, (Ui8)b2).rgba;
-      } else {  // Unknown blending mode!
-        to_rgba->rgba = color.rgba;
-      }
-
-      if (from_x_acc_16 > 0) {
-        from_x_8 = (static_cast<Ui32>(from_x_acc_16) & 65535ul) >> 8u;
-        from_x_disp_00 = from_x_b + static_cast<Si32>((static_cast<Ui32>(from_x_acc_16) >> 16u));
-        from_x_disp_01 = from_x_disp_00 + 1;
       }
-      ++to_rgba;
     }
     if (from_y_acc_16 > 0) {
       from_y_8 = (static_cast<Ui32>(from_y_acc_16) & 65535ul) >> 8u;
@@ -861,61 +1120,61 @@ template void DrawSprite<kDrawBlendingModeCopyRgba, kFilterNearest>(
   const Si32 to_width, const Si32 to_height,
   const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
   const Si32 from_width, const Si32 from_height,
-  Rgba color);
+  Rgba color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end);
 template void DrawSprite<kDrawBlendingModeAlphaBlend, kFilterNearest>(
   Sprite *to_sprite, const Si32 to_x_pivot, const Si32 to_y_pivot,
   const Si32 to_width, const Si32 to_height,
   const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
   const Si32 from_width, const Si32 from_height,
-  Rgba color);
+  Rgba color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end);
 template void DrawSprite<kDrawBlendingModePremultipliedAlphaBlend, kFilterNearest>(
   Sprite *to_sprite, const Si32 to_x_pivot, const Si32 to_y_pivot,
   const Si32 to_width, const Si32 to_height,
   const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
   const Si32 from_width, const Si32 from_height,
-  Rgba color);
+  Rgba color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end);
 template void DrawSprite<kDrawBlendingModeColorize, kFilterNearest>(
   Sprite *to_sprite, const Si32 to_x_pivot, const Si32 to_y_pivot,
   const Si32 to_width, const Si32 to_height,
   const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
   const Si32 from_width, const Si32 from_height,
-  Rgba color);
+  Rgba color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end);
 template void DrawSprite<kDrawBlendingModeSolidColor, kFilterNearest>(
   Sprite *to_sprite, const Si32 to_x_pivot, const Si32 to_y_pivot,
   const Si32 to_width, const Si32 to_height,
   const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
   const Si32 from_width, const Si32 from_height,
-  Rgba color);
+  Rgba color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end);
 template void DrawSprite<kDrawBlendingModeCopyRgba, kFilterBilinear>(
   Sprite *to_sprite, const Si32 to_x_pivot, const Si32 to_y_pivot,
   const Si32 to_width, const Si32 to_height,
   const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
   const Si32 from_width, const Si32 from_height,
-  Rgba color);
+  Rgba color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end);
 template void DrawSprite<kDrawBlendingModeAlphaBlend, kFilterBilinear>(
   Sprite *to_sprite, const Si32 to_x_pivot, const Si32 to_y_pivot,
   const Si32 to_width, const Si32 to_height,
   const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
   const Si32 from_width, const Si32 from_height,
-  Rgba color);
+  Rgba color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end);
 template void DrawSprite<kDrawBlendingModePremultipliedAlphaBlend, kFilterBilinear>(
   Sprite *to_sprite, const Si32 to_x_pivot, const Si32 to_y_pivot,
   const Si32 to_width, const Si32 to_height,
   const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
   const Si32 from_width, const Si32 from_height,
-  Rgba color);
+  Rgba color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end);
 template void DrawSprite<kDrawBlendingModeColorize, kFilterBilinear>(
   Sprite *to_sprite, const Si32 to_x_pivot, const Si32 to_y_pivot,
   const Si32 to_width, const Si32 to_height,
   const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
   const Si32 from_width, const Si32 from_height,
-  Rgba color);
+  Rgba color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end);
 template void DrawSprite<kDrawBlendingModeSolidColor, kFilterBilinear>(
   Sprite *to_sprite, const Si32 to_x_pivot, const Si32 to_y_pivot,
   const Si32 to_width, const Si32 to_height,
   const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
   const Si32 from_width, const Si32 from_height,
-  Rgba color);
+  Rgba color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end);
 
 
 Sprite::Sprite() {
@@ -1070,21 +1329,28 @@ void Sprite::Clear() {
   if (!sprite_instance_) {
     return;
   }
+  GetEngine()->GetTiledRasterizer().FlushBeforeWrite(*this);
+  MarkDirty();
   const size_t size = static_cast<size_t>(ref_size_.x) * sizeof(Rgba);
-  Ui8 *data = sprite_instance_->RawData();
+  Ui8 *data = reinterpret_cast<Ui8*>(UntrackedRgbaData());
   const Si32 stride = StrideBytes();
   for (Si32 y = 0; y < ref_size_.y; ++y) {
     memset(data, 0, size);
     data += stride;
   }
+  if (!IsRef()) {
+    sprite_instance_->SetSolidColor(Rgba(0, 0, 0, 0));
+  }
 }
 
 void Sprite::Clear(Rgba color) {
   if (!sprite_instance_) {
     return;
   }
+  GetEngine()->GetTiledRasterizer().FlushBeforeWrite(*this);
+  MarkDirty();
   const Si32 stride = StridePixels();
-  Rgba *begin = reinterpret_cast<Rgba*>(sprite_instance_->RawData());
+  Rgba *begin = UntrackedRgbaData();
   Rgba *end = begin + ref_size_.x;
   for (Si32 y = 0; y < ref_size_.y; ++y) {
     Rgba *p = begin;
@@ -1095,6 +1361,9 @@ void Sprite::Clear(Rgba color) {
     begin += stride;
     end += stride;
   }
+  if (!IsRef()) {
+    sprite_instance_->SetSolidColor(color);
+  }
 }
 
 void Sprite::Clone(Sprite from, CloneTransform transform) {
@@ -1105,6 +1374,7 @@ void Sprite::Clone(Sprite from, CloneTransform transform) {
     pivot_ = Vec2Si32(0, 0);
     return;
   }
+  GetEngine()->GetTiledRasterizer().FlushBeforeRead(from);
   if (transform == kCloneUntransformed) {
     Create(from.Width(), from.Height());
     from.Draw(from.Pivot().x, from.Pivot().y, from.Width(), from.Height(),
@@ -1148,7 +1418,7 @@ void Sprite::Clone(Sprite from, CloneTransform transform) {
   Si32 hei = from.Height();
   Si32 src_stride = from.StridePixels();
   Si32 dst_stride = StridePixels();
-  Rgba *src_data = from.RgbaData();
+  const Rgba *src_data = from.UntrackedRgbaData();
   Rgba *dst_data = RgbaData();
   for (Si32 y = 0; y < hei; ++y) {
     for (Si32 x = 0; x < wid; ++x) {
@@ -1175,6 +1445,17 @@ void Sprite::Draw(Sprite to_sprite,
   if (!sprite_instance_) {
     return;
   }
+  if (filter_mode == kFilterMipmap) {
+    filter_mode = kFilterBilinear;
+  }
+  to_sprite.MarkDirty(Vec2Si32(to_x_pivot, to_y_pivot) - pivot_,
+    Vec2Si32(to_x_pivot, to_y_pivot) - pivot_ + Size());
+  TiledRasterizer &tiles = GetEngine()->GetTiledRasterizer();
+  if (tiles.IsRecording() && tiles.RecordSprite(to_sprite,
+      to_x_pivot, to_y_pivot, Width(), Height(),
+      *this, 0, 0, Width(), Height(), blending_mode, filter_mode, color)) {
+    return;
+  }
   switch (filter_mode) {
     case kFilterNearest:
       switch (blending_mode) {
@@ -1222,6 +1503,7 @@ void Sprite::Draw(Sprite to_sprite,
           break;
       }
       break;
+    case kFilterMipmap:
     case kFilterBilinear:
       switch (blending_mode) {
         case kDrawBlendingModeAlphaBlend:
@@ -1333,6 +1615,39 @@ void Sprite::Draw(const float to_x, const float to_y,
   Vec2F td(0.01f,
     static_cast<float>(ref_size_.y) - 1.01f);
 
+  if (filter_mode == kFilterMipmap) {
+    // Both halves of the quad have the same area ratio, so the same level.
+    Sprite texture = *this;
+    Vec2F mip_ta = ta;
+    Vec2F mip_tb = tb;
+    Vec2F mip_tc = tc;
+    SelectTriangleMipLevel(&texture, a, b, c, &mip_ta, &mip_tb, &mip_tc);
+    if (texture.SpriteInstance() != sprite_instance_) {
+      Sprite texture_dac = *this;
+      Vec2F mip_td = td;
+      Vec2F mip_ta_dac = ta;
+      Vec2F mip_tc_dac = tc;
+      SelectTriangleMipLevel(&texture_dac, d, a, c,
+        &mip_td, &mip_ta_dac, &mip_tc_dac);
+      DrawTriangle(to_sprite, a, b, c, mip_ta, mip_tb, mip_tc, texture,
+        blending_mode, kFilterBilinear, in_color);
+      DrawTriangle(to_sprite, d, a, c, mip_td, mip_ta_dac, mip_tc_dac,
+        texture_dac, blending_mode, kFilterBilinear, in_color);
+      return;
+    }
+    filter_mode = kFilterBilinear;
+  }
+
+  MarkTriangleDirty(&to_sprite, a, b, c);
+  MarkTriangleDirty(&to_sprite, d, a, c);
+  TiledRasterizer &tiles = GetEngine()->GetTiledRasterizer();
+  if (tiles.IsRecording() && tiles.RecordTriangle(to_sprite,
+      a, b, c, ta, tb, tc, *this, blending_mode, filter_mode, in_color)) {
+    tiles.RecordTriangle(to_sprite,
+      d, a, c, td, ta, tc, *this, blending_mode, filter_mode, in_color);
+    return;
+  }
+
   switch (filter_mode) {
     case kFilterNearest:
       switch (blending_mode) {
@@ -1374,6 +1689,7 @@ void Sprite::Draw(const float to_x, const float to_y,
           break;
       }
       break;
+    case kFilterMipmap:
     case kFilterBilinear:
       switch (blending_mode) {
         case kDrawBlendingModeCopyRgba:
@@ -1423,6 +1739,16 @@ void DrawTriangle(Sprite to_sprite,
     Vec2F ta, Vec2F tb, Vec2F tc,
     Sprite texture,
     DrawBlendingMode blending_mode, DrawFilterMode filter_mode, Rgba in_color) {
+  if (filter_mode == kFilterMipmap) {
+    SelectTriangleMipLevel(&texture, a, b, c, &ta, &tb, &tc);
+    filter_mode = kFilterBilinear;
+  }
+  MarkTriangleDirty(&to_sprite, a, b, c);
+  TiledRasterizer &tiles = GetEngine()->GetTiledRasterizer();
+  if (tiles.IsRecording() && tiles.RecordTriangle(to_sprite,
+      a, b, c, ta, tb, tc, texture, blending_mode, filter_mode, in_color)) {
+    return;
+  }
   switch (filter_mode) {
     case kFilterNearest:
       switch (blending_mode) {
@@ -1452,6 +1778,7 @@ void DrawTriangle(Sprite to_sprite,
           break;
       }
       break;
+    case kFilterMipmap:
     case kFilterBilinear:
       switch (blending_mode) {
         case kDrawBlendingModeCopyRgba:
@@ -1484,6 +1811,195 @@ void DrawTriangle(Sprite to_sprite,
   }
 }
 
+void DrawSpriteClipped(Sprite to_sprite,
+    const Si32 to_x_pivot, const Si32 to_y_pivot,
+    const Si32 to_width, const Si32 to_height,
+    const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
+    const Si32 from_width, const Si32 from_height,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    Rgba in_color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end) {
+  if (!from_sprite.SpriteInstance()) {
+    return;
+  }
+  if (filter_mode == kFilterMipmap) {
+    Sprite mip = from_sprite;
+    Si32 mip_to_x_pivot = to_x_pivot;
+    Si32 mip_to_y_pivot = to_y_pivot;
+    Si32 mip_from_x = from_x;
+    Si32 mip_from_y = from_y;
+    Si32 mip_from_width = from_width;
+    Si32 mip_from_height = from_height;
+    SelectMipLevel(&mip, &mip_to_x_pivot, &mip_to_y_pivot, to_width, to_height,
+      &mip_from_x, &mip_from_y, &mip_from_width, &mip_from_height);
+    DrawSpriteClipped(to_sprite, mip_to_x_pivot, mip_to_y_pivot,
+      to_width, to_height, mip, mip_from_x, mip_from_y,
+      mip_from_width, mip_from_height, blending_mode, kFilterBilinear,
+      in_color, clip_begin, clip_end);
+    return;
+  }
+  switch (filter_mode) {
+    case kFilterNearest:
+      switch (blending_mode) {
+        default:
+        case kDrawBlendingModeCopyRgba:
+          DrawSprite<kDrawBlendingModeCopyRgba, kFilterNearest>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              from_sprite, from_x, from_y, from_width, from_height,
+              in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeAlphaBlend:
+          DrawSprite<kDrawBlendingModeAlphaBlend, kFilterNearest>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              from_sprite, from_x, from_y, from_width, from_height,
+              in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModePremultipliedAlphaBlend:
+          DrawSprite<kDrawBlendingModePremultipliedAlphaBlend, kFilterNearest>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              from_sprite, from_x, from_y, from_width, from_height,
+              in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeColorize:
+          DrawSprite<kDrawBlendingModeColorize, kFilterNearest>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              from_sprite, from_x, from_y, from_width, from_height,
+              in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeSolidColor:
+          DrawSprite<kDrawBlendingModeSolidColor, kFilterNearest>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              from_sprite, from_x, from_y, from_width, from_height,
+              in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeAdd:
+          DrawSprite<kDrawBlendingModeAdd, kFilterNearest>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              from_sprite, from_x, from_y, from_width, from_height,
+              in_color, clip_begin, clip_end);
+          break;
+      }
+      break;
+    case kFilterMipmap:
+    case kFilterBilinear:
+      switch (blending_mode) {
+        default:
+        case kDrawBlendingModeCopyRgba:
+          DrawSprite<kDrawBlendingModeCopyRgba, kFilterBilinear>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              from_sprite, from_x, from_y, from_width, from_height,
+              in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeAlphaBlend:
+          DrawSprite<kDrawBlendingModeAlphaBlend, kFilterBilinear>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              from_sprite, from_x, from_y, from_width, from_height,
+              in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModePremultipliedAlphaBlend:
+          DrawSprite<kDrawBlendingModePremultipliedAlphaBlend, kFilterBilinear>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              from_sprite, from_x, from_y, from_width, from_height,
+              in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeColorize:
+          DrawSprite<kDrawBlendingModeColorize, kFilterBilinear>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              from_sprite, from_x, from_y, from_width, from_height,
+              in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeSolidColor:
+          DrawSprite<kDrawBlendingModeSolidColor, kFilterBilinear>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              from_sprite, from_x, from_y, from_width, from_height,
+              in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeAdd:
+          DrawSprite<kDrawBlendingModeAdd, kFilterBilinear>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              from_sprite, from_x, from_y, from_width, from_height,
+              in_color, clip_begin, clip_end);
+          break;
+      }
+      break;
+  }
+}
+
+void DrawTriangleClipped(Sprite to_sprite,
+    Vec2F a, Vec2F b, Vec2F c,
+    Vec2F ta, Vec2F tb, Vec2F tc,
+    const Sprite &texture,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    Rgba in_color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end) {
+  if (filter_mode == kFilterMipmap) {
+    Sprite mip = texture;
+    SelectTriangleMipLevel(&mip, a, b, c, &ta, &tb, &tc);
+    DrawTriangleClipped(to_sprite, a, b, c, ta, tb, tc, mip,
+      blending_mode, kFilterBilinear, in_color, clip_begin, clip_end);
+    return;
+  }
+  switch (filter_mode) {
+    case kFilterNearest:
+      switch (blending_mode) {
+        default:
+        case kDrawBlendingModeCopyRgba:
+          DrawTriangle<kDrawBlendingModeCopyRgba, kFilterNearest>(to_sprite,
+            a, b, c, ta, tb, tc, texture, in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeAlphaBlend:
+          DrawTriangle<kDrawBlendingModeAlphaBlend, kFilterNearest>(to_sprite,
+            a, b, c, ta, tb, tc, texture, in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModePremultipliedAlphaBlend:
+          DrawTriangle<kDrawBlendingModePremultipliedAlphaBlend, kFilterNearest>(to_sprite,
+            a, b, c, ta, tb, tc, texture, in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeColorize:
+          DrawTriangle<kDrawBlendingModeColorize, kFilterNearest>(to_sprite,
+            a, b, c, ta, tb, tc, texture, in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeSolidColor:
+          DrawTriangle<kDrawBlendingModeSolidColor, kFilterNearest>(to_sprite,
+            a, b, c, ta, tb, tc, texture, in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeAdd:
+          DrawTriangle<kDrawBlendingModeAdd, kFilterNearest>(to_sprite,
+            a, b, c, ta, tb, tc, texture, in_color, clip_begin, clip_end);
+          break;
+      }
+      break;
+    case kFilterMipmap:
+    case kFilterBilinear:
+      switch (blending_mode) {
+        default:
+        case kDrawBlendingModeCopyRgba:
+          DrawTriangle<kDrawBlendingModeCopyRgba, kFilterBilinear>(to_sprite,
+            a, b, c, ta, tb, tc, texture, in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeAlphaBlend:
+          DrawTriangle<kDrawBlendingModeAlphaBlend, kFilterBilinear>(to_sprite,
+            a, b, c, ta, tb, tc, texture, in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModePremultipliedAlphaBlend:
+          DrawTriangle<kDrawBlendingModePremultipliedAlphaBlend, kFilterBilinear>(to_sprite,
+            a, b, c, ta, tb, tc, texture, in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeColorize:
+          DrawTriangle<kDrawBlendingModeColorize, kFilterBilinear>(to_sprite,
+            a, b, c, ta, tb, tc, texture, in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeSolidColor:
+          DrawTriangle<kDrawBlendingModeSolidColor, kFilterBilinear>(to_sprite,
+            a, b, c, ta, tb, tc, texture, in_color, clip_begin, clip_end);
+          break;
+        case kDrawBlendingModeAdd:
+          DrawTriangle<kDrawBlendingModeAdd, kFilterBilinear>(to_sprite,
+            a, b, c, ta, tb, tc, texture, in_color, clip_begin, clip_end);
+          break;
+      }
+      break;
+  }
+}
+
 void Sprite::Draw(const Si32 to_x, const Si32 to_y,
     const Si32 to_width, const Si32 to_height,
     DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
@@ -1556,6 +2072,32 @@ void Sprite::Draw(const Si32 to_x_pivot, const Si32 to_y_pivot,
   if (!sprite_instance_) {
     return;
   }
+  if (filter_mode == kFilterMipmap) {
+    // The level is selected here, so the tiled rasterizer workers
+    // never build the mip levels.
+    Sprite mip = *this;
+    Si32 mip_to_x_pivot = to_x_pivot;
+    Si32 mip_to_y_pivot = to_y_pivot;
+    Si32 mip_from_x = from_x;
+    Si32 mip_from_y = from_y;
+    Si32 mip_from_width = from_width;
+    Si32 mip_from_height = from_height;
+    SelectMipLevel(&mip, &mip_to_x_pivot, &mip_to_y_pivot, to_width, to_height,
+      &mip_from_x, &mip_from_y, &mip_from_width, &mip_from_height);
+    mip.Draw(mip_to_x_pivot, mip_to_y_pivot, to_width, to_height,
+      mip_from_x, mip_from_y, mip_from_width, mip_from_height,
+      to_sprite, blending_mode, kFilterBilinear, in_color);
+    return;
+  }
+  MarkSpriteDrawDirty(&to_sprite, to_x_pivot, to_y_pivot, to_width, to_height,
+    *this, from_width, from_height);
+  TiledRasterizer &tiles = GetEngine()->GetTiledRasterizer();
+  if (tiles.IsRecording() && tiles.RecordSprite(to_sprite,
+      to_x_pivot, to_y_pivot, to_width, to_height,
+      *this, from_x, from_y, from_width, from_height,
+      blending_mode, filter_mode, in_color)) {
+    return;
+  }
   switch (filter_mode) {
       case kFilterNearest:
       switch (blending_mode) {
@@ -1590,8 +2132,15 @@ void Sprite::Draw(const Si32 to_x_pivot, const Si32 to_y_pivot,
               *this, from_x, from_y, from_width, from_height,
               in_color);
           break;
+        case kDrawBlendingModeAdd:
+          DrawSprite<kDrawBlendingModeAdd, kFilterNearest>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              *this, from_x, from_y, from_width, from_height,
+              in_color);
+          break;
       }
       break;
+      case kFilterMipmap:
       case kFilterBilinear:
       switch (blending_mode) {
         default:
@@ -1625,6 +2174,12 @@ void Sprite::Draw(const Si32 to_x_pivot, const Si32 to_y_pivot,
               *this, from_x, from_y, from_width, from_height,
               in_color);
           break;
+        case kDrawBlendingModeAdd:
+          DrawSprite<kDrawBlendingModeAdd, kFilterBilinear>(&to_sprite,
+              to_x_pivot, to_y_pivot, to_width, to_height,
+              *this, from_x, from_y, from_width, from_height,
+              in_color);
+          break;
       }
       break;
   }
@@ -1663,10 +2218,16 @@ bool Sprite::IsRef() const {
 }
 
 Ui8* Sprite::RawData() {
+  MarkDirty();
   return sprite_instance_->RawData();
 }
 
 Rgba* Sprite::RgbaData() {
+  MarkDirty();
+  return UntrackedRgbaData();
+}
+
+Rgba* Sprite::UntrackedRgbaData() {
   return (static_cast<Rgba*>(static_cast<void*>(
       sprite_instance_->RawData())) +
     ref_pos_.y * StridePixels() +
@@ -1700,4 +2261,53 @@ void Sprite::ClearOpaqueSpans() {
   }
 }
 
+void Sprite::MarkDirty(Vec2Si32 begin, Vec2Si32 end) {
+  if (sprite_instance_ && (sprite_instance_->IsDirtyTracked()
+      || sprite_instance_->IsSolid())) {
+    sprite_instance_->AddDirtyRect(
+      ref_pos_ + Vec2Si32(std::max(begin.x, 0), std::max(begin.y, 0)),
+      ref_pos_ + Vec2Si32(std::min(end.x, ref_size_.x),
+        std::min(end.y, ref_size_.y)));
+  }
+}
+
+void Sprite::MarkDirty() {
+  MarkDirty(Vec2Si32(0, 0), ref_size_);
+}
+
+Sprite Sprite::MipLevel(Si32 level) const {
+  level = std::min(std::max(level, 0), MipLevelCount());
+  if (level == 0) {
+    return *this;
+  }
+  Sprite mip;
+  mip.sprite_instance_ = sprite_instance_->MipLevel(level);
+  const Vec2Si32 mip_size(mip.sprite_instance_->width(),
+    mip.sprite_instance_->height());
+  const Vec2Si32 end = ref_pos_ + ref_size_;
+  mip.ref_pos_ = Vec2Si32(std::min(ref_pos_.x >> level, mip_size.x - 1),
+    std::min(ref_pos_.y >> level, mip_size.y - 1));
+  mip.ref_size_ = Vec2Si32(
+    std::max(std::min(end.x >> level, mip_size.x) - mip.ref_pos_.x, 1),
+    std::max(std::min(end.y >> level, mip_size.y) - mip.ref_pos_.y, 1));
+  mip.pivot_ = Vec2Si32(pivot_.x >> level, pivot_.y >> level);
+  return mip;
+}
+
+Si32 Sprite::MipLevelCount() const {
+  return sprite_instance_ ? sprite_instance_->MipLevelCount() : 0;
+}
+
+void Sprite::UpdateMipmaps() {
+  if (sprite_instance_) {
+    sprite_instance_->UpdateMipLevels();
+  }
+}
+
+void Sprite::ClearMipmaps() {
+  if (sprite_instance_) {
+    sprite_instance_->ClearMipLevels();
+  }
+}
+
 }  // namespace arctic
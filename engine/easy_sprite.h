@@ -52,7 +52,10 @@ enum DrawBlendingMode {
 
 enum DrawFilterMode {
   kFilterNearest,
-  kFilterBilinear
+  kFilterBilinear,
+  /// Bilinear sampling of the mip level that matches the minification,
+  /// see Sprite::MipLevel.
+  kFilterMipmap
 };
 
 enum CloneTransform {
@@ -246,20 +249,48 @@ class Sprite {
   /// @brief Returns true if the sprite is actually a reference to another sprite
   bool IsRef() const;
   /// @brief Returns a pointer to the raw data bytes of the sprite
+  /// @details Marks the whole sprite as changed, see MarkDirty.
   Ui8* RawData();
   /// @brief Returns a pointer to the Rgba data of the sprite
+  /// @details Marks the whole sprite as changed, see MarkDirty.
   Rgba* RgbaData();
   /// @brief Returns a pointer to the read-only Rgba data of the sprite
   const Rgba* RgbaData() const;
+  /// @brief Returns a pointer to the Rgba data of the sprite without marking it as changed
+  /// @details The code writing the pixels through it should call MarkDirty for them.
+  Rgba* UntrackedRgbaData();
+  /// @brief Mark the [begin, end) rectangle of the sprite pixels as changed
+  /// @details
+  /// The changes are only collected for the sprite instances with dirty tracking enabled,
+  /// such as the backbuffer, which then uploads only the changed rectangles to the GPU.
+  /// The drawing functions mark the pixels they write, the rectangle is clipped to the sprite.
+  void MarkDirty(Vec2Si32 begin, Vec2Si32 end);
+  /// @brief Mark all the pixels of the sprite as changed
+  void MarkDirty();
   const std::shared_ptr<SpriteInstance> &SpriteInstance() const;
   const std::vector<SpanSi32> &Opaque() const;
   /// @brief Update the opaque span parameters of the sprite
   /// @details
   /// Sets up the span parameters so that currently transparent pixels will not be drawn.
+  /// Each row is split into fully transparent, fully opaque and partially transparent runs,
+  /// the scaled and rotated draws skip the transparent parts too.
   /// Changing pixel transparency may require calling either UpdateOpaqueSpans or ClearOpaqueSpans.
   void UpdateOpaqueSpans();
   /// @brief Clear the opaque span parameters of the sprite so that each pixel of the sprite is drawn
   void ClearOpaqueSpans();
+  /// @brief Returns the sprite downscaled 2^level times
+  /// @details
+  /// The mip levels are box filtered copies of the whole sprite instance, they are built
+  /// on the first use and shared by all the sprites that reference the instance.
+  /// Level 0 is the sprite itself, the levels above MipLevelCount() are clamped.
+  /// Changing the pixels requires calling either UpdateMipmaps or ClearMipmaps.
+  Sprite MipLevel(Si32 level) const;
+  /// @brief Get the number of mip levels below the full size one
+  Si32 MipLevelCount() const;
+  /// @brief Rebuild the mip levels of the sprite from its current pixels
+  void UpdateMipmaps();
+  /// @brief Release the mip levels of the sprite, they are rebuilt on demand
+  void ClearMipmaps();
 };
 
 /// @}
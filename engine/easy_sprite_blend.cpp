@@ -0,0 +1,840 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/easy_sprite_blend.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ARCTIC_BLEND_SSE2
+#define ARCTIC_BLEND_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define ARCTIC_BLEND_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define ARCTIC_BLEND_AVX2_TARGET
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ARCTIC_BLEND_NEON
+#include <arm_neon.h>
+#endif
+
+namespace arctic {
+
+// The scalar reference. Every vector kernel below reproduces these formulas
+// exactly, including the zero alpha they leave in blended pixels.
+template<DrawBlendingMode kBlendingMode, bool kIsColorizeAlphaCleared>
+inline void BlendPixel(Rgba *to_rgba, Rgba color, Rgba in_color) {
+  if (kBlendingMode == kDrawBlendingModeCopyRgba) {
+    to_rgba->rgba = color.rgba;
+  } else if (kBlendingMode == kDrawBlendingModeAlphaBlend) {
+    if (color.a == 255) {
+      to_rgba->rgba = color.rgba;
+    } else if (color.a) {
+      Ui32 m = 255 - color.a;
+      Ui32 rb = (to_rgba->rgba & 0x00ff00fful) * m;
+      Ui32 g = ((to_rgba->rgba & 0x0000ff00ul) >> 8u) * m;
+      Ui32 m2 = color.a;
+      Ui32 rb2 = (color.rgba & 0x00ff00fful) * m2;
+      Ui32 g2 = ((color.rgba & 0x0000ff00ul) >> 8u) * m2;
+      to_rgba->rgba = (((rb + rb2) >> 8u) & 0x00ff00fful) |
+        ((g + g2) & 0x0000ff00ul);
+    }
+  } else if (kBlendingMode == kDrawBlendingModePremultipliedAlphaBlend) {
+    if (color.a == 255) {
+      to_rgba->rgba = color.rgba;
+    } else if (color.a) {
+      Ui32 m = 255 - color.a;
+      Ui32 rb = ((to_rgba->rgba & 0x00ff00fful) * m) >> 8u;
+      Ui32 g = ((to_rgba->rgba & 0x0000ff00ul) >> 8u) * m;
+      Ui32 rb2 = (color.rgba & 0x00ff00fful);
+      Ui32 g2 = (color.rgba & 0x0000ff00ul);
+      to_rgba->rgba = ((rb + rb2) & 0x00ff00fful) | ((g + g2) & 0x0000ff00ul);
+    }
+  } else if (kBlendingMode == kDrawBlendingModeColorize) {
+    Ui32 ca = (Ui32(color.a) * (Ui32(in_color.a) + 1u)) >> 8u;
+    if (ca == 255) {
+      if (kIsColorizeAlphaCleared) {
+        Ui32 r2 = (Ui32(color.r) * (Ui32(in_color.r) + 1)) >> 8u;
+        Ui32 g2 = (Ui32(color.g) * (Ui32(in_color.g) + 1)) & 0xff00u;
+        Ui32 b2 = ((Ui32(color.b) * (Ui32(in_color.b) + 1)) << 8u)
+          & 0xff0000ull;
+        to_rgba->rgba = r2 | g2 | b2;
+      } else {
+        Ui32 r2 = (Ui32(color.r) * (Ui32(in_color.r) + 1)) >> 8u;
+        Ui32 g2 = (Ui32(color.g) * (Ui32(in_color.g) + 1)) >> 8u;
+        Ui32 b2 = (Ui32(color.b) * (Ui32(in_color.b) + 1)) >> 8u;
+        to_rgba->rgba = Rgba((Ui8)r2, (Ui8)g2, (Ui8)b2).rgba;
+      }
+    } else if (ca) {
+      Ui32 m = 255 - ca;
+      Ui32 rb = (to_rgba->rgba & 0x00ff00fful) * m;
+      Ui32 g = ((to_rgba->rgba & 0x0000ff00ul) >> 8u) * m;
+
+      Ui32 m2 = ca;
+      Ui32 rb2_ = (((color.rgba & 0x00ff00fful) * m2) & 0xff00ff00u) >> 8u;
+      Ui32 rb2  = ((rb2_ & 0x00ff0000u) * ((in_color.rgba & 0x00ff0000u) >> 16u)) | ((rb2_ & 0x000000ffu) * (in_color.rgba & 0x000000ffu));
+      Ui32 g2 = (Ui32(color.g) * m2 * (Ui32(in_color.g) + 1)) >> 8u;
+
+      to_rgba->rgba = (((rb + rb2) >> 8u) & 0x00ff00fful) | ((g + g2) & 0x0000ff00ul);
+    }
+  } else if (kBlendingMode == kDrawBlendingModeSolidColor) {
+    Ui32 ca = (Ui32(color.a) * (Ui32(in_color.a) + 1u)) >> 8u;
+    if (ca == 255) {
+      to_rgba->rgba = in_color.rgba;
+    } else if (ca) {
+      Ui32 m = 255 - ca;
+      Ui32 rb = (to_rgba->rgba & 0x00ff00fful) * m;
+      Ui32 g = ((to_rgba->rgba & 0x0000ff00ul) >> 8u) * m;
+
+      Ui32 rb2 = (in_color.rgba & 0x00ff00fful) * ca;
+      Ui32 g2 = ((in_color.rgba & 0x0000ff00ul) >> 8u) * ca;
+
+      to_rgba->rgba = (((rb + rb2) >> 8u) & 0x00ff00fful) | ((g + g2) & 0x0000ff00ul);
+    }
+  } else if (kBlendingMode == kDrawBlendingModeAdd) {
+    Ui32 r2 = Ui32(color.r) + Ui32(to_rgba->r);
+    Ui32 g2 = Ui32(color.g) + Ui32(to_rgba->g);
+    Ui32 b2 = Ui32(color.b) + Ui32(to_rgba->b);
+    r2 = r2 > 255 ? 255 : r2;
+    g2 = g2 > 255 ? 255 : g2;
+    b2 = b2 > 255 ? 255 : b2;
+    to_rgba->rgba = Rgba((Ui8)r2, (Ui8)g2, (Ui8)b2).rgba;
+  } else {  // Unknown blending mode!
+    to_rgba->rgba = color.rgba;
+  }
+}
+
+// Processes pixels strictly one by one and in order, so unlike the vector
+// kernels it may be used on overlapping rows.
+template<DrawBlendingMode kBlendingMode, bool kIsColorizeAlphaCleared>
+void BlendRowScalar(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color) {
+  for (Si32 i = 0; i < count; ++i) {
+    BlendPixel<kBlendingMode, kIsColorizeAlphaCleared>(
+        to + i, from[i], in_color);
+  }
+}
+
+struct BlendKernelSet {
+  BlendRowFunc copy_rgba;
+  BlendRowFunc alpha_blend;
+  BlendRowFunc premultiplied_alpha_blend;
+  BlendRowFunc colorize;
+  BlendRowFunc colorize_alpha_cleared;
+  BlendRowFunc solid_color;
+  BlendRowFunc add;
+};
+
+static const BlendKernelSet g_blend_kernels_scalar = {
+  BlendRowScalar<kDrawBlendingModeCopyRgba, false>,
+  BlendRowScalar<kDrawBlendingModeAlphaBlend, false>,
+  BlendRowScalar<kDrawBlendingModePremultipliedAlphaBlend, false>,
+  BlendRowScalar<kDrawBlendingModeColorize, false>,
+  BlendRowScalar<kDrawBlendingModeColorize, true>,
+  BlendRowScalar<kDrawBlendingModeSolidColor, false>,
+  BlendRowScalar<kDrawBlendingModeAdd, false>
+};
+
+void CopyRow(Rgba *to, const Rgba *from, Si32 count, Rgba in_color) {
+  memcpy(static_cast<void*>(to), from,
+    static_cast<size_t>(count) * sizeof(Rgba));
+}
+
+// The vector kernels keep one pixel per 32-bit lane and mirror the scalar
+// 32-bit arithmetic. SSE2 has no 32-bit multiply, but every product in the
+// formulas is a 0x00XX00XX value times a factor below 257, so the two 16-bit
+// halves never carry into each other and a 16-bit multiply gives the same bits.
+
+#if defined(ARCTIC_BLEND_SSE2)
+
+inline __m128i Sse2Select(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+inline __m128i Sse2Splat16(__m128i v) {
+  return _mm_or_si128(v, _mm_slli_epi32(v, 16));
+}
+
+// (((d.rb * m + rb2) >> 8) & 0x00ff00ff) | ((d.g * m + g2) & 0x0000ff00)
+inline __m128i Sse2Lerp(__m128i d, __m128i m2, __m128i rb2, __m128i g2) {
+  const __m128i k_rb = _mm_set1_epi32(0x00ff00ff);
+  const __m128i k_g = _mm_set1_epi32(0x0000ff00);
+  __m128i rb = _mm_mullo_epi16(_mm_and_si128(d, k_rb), m2);
+  __m128i g = _mm_mullo_epi16(_mm_srli_epi32(_mm_and_si128(d, k_g), 8), m2);
+  return _mm_or_si128(
+      _mm_and_si128(_mm_srli_epi32(_mm_add_epi32(rb, rb2), 8), k_rb),
+      _mm_and_si128(_mm_add_epi32(g, g2), k_g));
+}
+
+void AlphaBlendRowSse2(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color) {
+  const __m128i k_rb = _mm_set1_epi32(0x00ff00ff);
+  const __m128i k_g = _mm_set1_epi32(0x0000ff00);
+  const __m128i k_255 = _mm_set1_epi32(255);
+  const __m128i k_zero = _mm_setzero_si128();
+  Si32 i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+    __m128i a = _mm_srli_epi32(s, 24);
+    __m128i is_clear = _mm_cmpeq_epi32(a, k_zero);
+    if (_mm_movemask_epi8(is_clear) == 0xffff) {
+      continue;
+    }
+    __m128i *to_ptr = reinterpret_cast<__m128i*>(to + i);
+    __m128i d = _mm_loadu_si128(to_ptr);
+    __m128i a2 = Sse2Splat16(a);
+    __m128i m2 = Sse2Splat16(_mm_sub_epi32(k_255, a));
+    __m128i rb2 = _mm_mullo_epi16(_mm_and_si128(s, k_rb), a2);
+    __m128i g2 = _mm_mullo_epi16(_mm_srli_epi32(_mm_and_si128(s, k_g), 8), a2);
+    __m128i res = Sse2Lerp(d, m2, rb2, g2);
+    res = Sse2Select(is_clear, d, res);
+    res = Sse2Select(_mm_cmpeq_epi32(a, k_255), s, res);
+    _mm_storeu_si128(to_ptr, res);
+  }
+  BlendRowScalar<kDrawBlendingModeAlphaBlend, false>(
+      to + i, from + i, count - i, in_color);
+}
+
+void PremultipliedAlphaBlendRowSse2(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color) {
+  const __m128i k_rb = _mm_set1_epi32(0x00ff00ff);
+  const __m128i k_g = _mm_set1_epi32(0x0000ff00);
+  const __m128i k_255 = _mm_set1_epi32(255);
+  const __m128i k_zero = _mm_setzero_si128();
+  Si32 i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+    __m128i a = _mm_srli_epi32(s, 24);
+    __m128i is_clear = _mm_cmpeq_epi32(a, k_zero);
+    if (_mm_movemask_epi8(is_clear) == 0xffff) {
+      continue;
+    }
+    __m128i *to_ptr = reinterpret_cast<__m128i*>(to + i);
+    __m128i d = _mm_loadu_si128(to_ptr);
+    __m128i m2 = Sse2Splat16(_mm_sub_epi32(k_255, a));
+    __m128i rb = _mm_srli_epi32(
+        _mm_mullo_epi16(_mm_and_si128(d, k_rb), m2), 8);
+    __m128i g = _mm_mullo_epi16(_mm_srli_epi32(_mm_and_si128(d, k_g), 8), m2);
+    __m128i res = _mm_or_si128(
+        _mm_and_si128(_mm_add_epi32(rb, _mm_and_si128(s, k_rb)), k_rb),
+        _mm_and_si128(_mm_add_epi32(g, _mm_and_si128(s, k_g)), k_g));
+    res = Sse2Select(is_clear, d, res);
+    res = Sse2Select(_mm_cmpeq_epi32(a, k_255), s, res);
+    _mm_storeu_si128(to_ptr, res);
+  }
+  BlendRowScalar<kDrawBlendingModePremultipliedAlphaBlend, false>(
+      to + i, from + i, count - i, in_color);
+}
+
+template<bool kIsColorizeAlphaCleared>
+void ColorizeRowSse2(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color) {
+  const __m128i k_rb = _mm_set1_epi32(0x00ff00ff);
+  const __m128i k_g = _mm_set1_epi32(0x0000ff00);
+  const __m128i k_hi = _mm_set1_epi32(static_cast<Si32>(0xff00ff00u));
+  const __m128i k_255 = _mm_set1_epi32(255);
+  const __m128i k_zero = _mm_setzero_si128();
+  const __m128i k_alpha = kIsColorizeAlphaCleared ? k_zero
+    : _mm_set1_epi32(static_cast<Si32>(0xff000000u));
+  const __m128i k_in_a1 = _mm_set1_epi32(Si32(in_color.a) + 1);
+  const __m128i k_in_g1 = _mm_set1_epi32(Si32(in_color.g) + 1);
+  const __m128i k_in_rb1 = _mm_set1_epi32(
+      (Si32(in_color.r) + 1) | ((Si32(in_color.b) + 1) << 16));
+  const __m128i k_in_rb = _mm_set1_epi32(
+      static_cast<Si32>(in_color.rgba & 0x00ff00fful));
+  Si32 i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+    __m128i ca = _mm_srli_epi32(
+        _mm_mullo_epi16(_mm_srli_epi32(s, 24), k_in_a1), 8);
+    __m128i is_clear = _mm_cmpeq_epi32(ca, k_zero);
+    if (_mm_movemask_epi8(is_clear) == 0xffff) {
+      continue;
+    }
+    __m128i *to_ptr = reinterpret_cast<__m128i*>(to + i);
+    __m128i d = _mm_loadu_si128(to_ptr);
+    __m128i s_rb = _mm_and_si128(s, k_rb);
+    __m128i s_g = _mm_srli_epi32(_mm_and_si128(s, k_g), 8);
+
+    __m128i opaque = _mm_or_si128(_mm_or_si128(
+        _mm_and_si128(_mm_srli_epi32(_mm_mullo_epi16(s_rb, k_in_rb1), 8), k_rb),
+        _mm_and_si128(_mm_mullo_epi16(s_g, k_in_g1), k_g)), k_alpha);
+
+    __m128i ca2 = Sse2Splat16(ca);
+    __m128i m2 = Sse2Splat16(_mm_sub_epi32(k_255, ca));
+    __m128i rb2_ = _mm_srli_epi32(
+        _mm_and_si128(_mm_mullo_epi16(s_rb, ca2), k_hi), 8);
+    __m128i rb2 = _mm_mullo_epi16(rb2_, k_in_rb);
+    __m128i g_ca = _mm_mullo_epi16(s_g, ca2);
+    __m128i g2 = _mm_srli_epi32(_mm_or_si128(
+        _mm_mullo_epi16(g_ca, k_in_g1),
+        _mm_slli_epi32(_mm_mulhi_epu16(g_ca, k_in_g1), 16)), 8);
+    __m128i res = Sse2Lerp(d, m2, rb2, g2);
+    res = Sse2Select(is_clear, d, res);
+    res = Sse2Select(_mm_cmpeq_epi32(ca, k_255), opaque, res);
+    _mm_storeu_si128(to_ptr, res);
+  }
+  BlendRowScalar<kDrawBlendingModeColorize, kIsColorizeAlphaCleared>(
+      to + i, from + i, count - i, in_color);
+}
+
+void SolidColorRowSse2(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color) {
+  const __m128i k_255 = _mm_set1_epi32(255);
+  const __m128i k_zero = _mm_setzero_si128();
+  const __m128i k_in = _mm_set1_epi32(static_cast<Si32>(in_color.rgba));
+  const __m128i k_in_a1 = _mm_set1_epi32(Si32(in_color.a) + 1);
+  const __m128i k_in_rb = _mm_set1_epi32(
+      static_cast<Si32>(in_color.rgba & 0x00ff00fful));
+  const __m128i k_in_g = _mm_set1_epi32(Si32(in_color.g));
+  Si32 i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+    __m128i ca = _mm_srli_epi32(
+        _mm_mullo_epi16(_mm_srli_epi32(s, 24), k_in_a1), 8);
+    __m128i is_clear = _mm_cmpeq_epi32(ca, k_zero);
+    if (_mm_movemask_epi8(is_clear) == 0xffff) {
+      continue;
+    }
+    __m128i *to_ptr = reinterpret_cast<__m128i*>(to + i);
+    __m128i d = _mm_loadu_si128(to_ptr);
+    __m128i ca2 = Sse2Splat16(ca);
+    __m128i m2 = Sse2Splat16(_mm_sub_epi32(k_255, ca));
+    __m128i res = Sse2Lerp(d, m2,
+        _mm_mullo_epi16(k_in_rb, ca2), _mm_mullo_epi16(k_in_g, ca2));
+    res = Sse2Select(is_clear, d, res);
+    res = Sse2Select(_mm_cmpeq_epi32(ca, k_255), k_in, res);
+    _mm_storeu_si128(to_ptr, res);
+  }
+  BlendRowScalar<kDrawBlendingModeSolidColor, false>(
+      to + i, from + i, count - i, in_color);
+}
+
+void AddRowSse2(Rgba *to, const Rgba *from, Si32 count, Rgba in_color) {
+  const __m128i k_alpha = _mm_set1_epi32(static_cast<Si32>(0xff000000u));
+  Si32 i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+    __m128i *to_ptr = reinterpret_cast<__m128i*>(to + i);
+    __m128i d = _mm_loadu_si128(to_ptr);
+    _mm_storeu_si128(to_ptr, _mm_or_si128(_mm_adds_epu8(s, d), k_alpha));
+  }
+  BlendRowScalar<kDrawBlendingModeAdd, false>(
+      to + i, from + i, count - i, in_color);
+}
+
+static const BlendKernelSet g_blend_kernels_sse2 = {
+  CopyRow,
+  AlphaBlendRowSse2,
+  PremultipliedAlphaBlendRowSse2,
+  ColorizeRowSse2<false>,
+  ColorizeRowSse2<true>,
+  SolidColorRowSse2,
+  AddRowSse2
+};
+
+#endif  // ARCTIC_BLEND_SSE2
+
+#if defined(ARCTIC_BLEND_AVX2)
+
+ARCTIC_BLEND_AVX2_TARGET
+inline __m256i Avx2Select(__m256i mask, __m256i a, __m256i b) {
+  return _mm256_or_si256(_mm256_and_si256(mask, a),
+      _mm256_andnot_si256(mask, b));
+}
+
+ARCTIC_BLEND_AVX2_TARGET
+inline __m256i Avx2Lerp(__m256i d, __m256i m, __m256i rb2, __m256i g2) {
+  const __m256i k_rb = _mm256_set1_epi32(0x00ff00ff);
+  const __m256i k_g = _mm256_set1_epi32(0x0000ff00);
+  __m256i rb = _mm256_mullo_epi32(_mm256_and_si256(d, k_rb), m);
+  __m256i g = _mm256_mullo_epi32(
+      _mm256_srli_epi32(_mm256_and_si256(d, k_g), 8), m);
+  return _mm256_or_si256(
+      _mm256_and_si256(_mm256_srli_epi32(_mm256_add_epi32(rb, rb2), 8), k_rb),
+      _mm256_and_si256(_mm256_add_epi32(g, g2), k_g));
+}
+
+ARCTIC_BLEND_AVX2_TARGET
+void AlphaBlendRowAvx2(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color) {
+  const __m256i k_rb = _mm256_set1_epi32(0x00ff00ff);
+  const __m256i k_g = _mm256_set1_epi32(0x0000ff00);
+  const __m256i k_255 = _mm256_set1_epi32(255);
+  const __m256i k_zero = _mm256_setzero_si256();
+  Si32 i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i s = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(from + i));
+    __m256i a = _mm256_srli_epi32(s, 24);
+    __m256i is_clear = _mm256_cmpeq_epi32(a, k_zero);
+    if (_mm256_movemask_epi8(is_clear) == -1) {
+      continue;
+    }
+    __m256i *to_ptr = reinterpret_cast<__m256i*>(to + i);
+    __m256i d = _mm256_loadu_si256(to_ptr);
+    __m256i rb2 = _mm256_mullo_epi32(_mm256_and_si256(s, k_rb), a);
+    __m256i g2 = _mm256_mullo_epi32(
+        _mm256_srli_epi32(_mm256_and_si256(s, k_g), 8), a);
+    __m256i res = Avx2Lerp(d, _mm256_sub_epi32(k_255, a), rb2, g2);
+    res = Avx2Select(is_clear, d, res);
+    res = Avx2Select(_mm256_cmpeq_epi32(a, k_255), s, res);
+    _mm256_storeu_si256(to_ptr, res);
+  }
+  BlendRowScalar<kDrawBlendingModeAlphaBlend, false>(
+      to + i, from + i, count - i, in_color);
+}
+
+ARCTIC_BLEND_AVX2_TARGET
+void PremultipliedAlphaBlendRowAvx2(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color) {
+  const __m256i k_rb = _mm256_set1_epi32(0x00ff00ff);
+  const __m256i k_g = _mm256_set1_epi32(0x0000ff00);
+  const __m256i k_255 = _mm256_set1_epi32(255);
+  const __m256i k_zero = _mm256_setzero_si256();
+  Si32 i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i s = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(from + i));
+    __m256i a = _mm256_srli_epi32(s, 24);
+    __m256i is_clear = _mm256_cmpeq_epi32(a, k_zero);
+    if (_mm256_movemask_epi8(is_clear) == -1) {
+      continue;
+    }
+    __m256i *to_ptr = reinterpret_cast<__m256i*>(to + i);
+    __m256i d = _mm256_loadu_si256(to_ptr);
+    __m256i m = _mm256_sub_epi32(k_255, a);
+    __m256i rb = _mm256_srli_epi32(
+        _mm256_mullo_epi32(_mm256_and_si256(d, k_rb), m), 8);
+    __m256i g = _mm256_mullo_epi32(
+        _mm256_srli_epi32(_mm256_and_si256(d, k_g), 8), m);
+    __m256i res = _mm256_or_si256(
+        _mm256_and_si256(
+          _mm256_add_epi32(rb, _mm256_and_si256(s, k_rb)), k_rb),
+        _mm256_and_si256(
+          _mm256_add_epi32(g, _mm256_and_si256(s, k_g)), k_g));
+    res = Avx2Select(is_clear, d, res);
+    res = Avx2Select(_mm256_cmpeq_epi32(a, k_255), s, res);
+    _mm256_storeu_si256(to_ptr, res);
+  }
+  BlendRowScalar<kDrawBlendingModePremultipliedAlphaBlend, false>(
+      to + i, from + i, count - i, in_color);
+}
+
+template<bool kIsColorizeAlphaCleared>
+ARCTIC_BLEND_AVX2_TARGET
+void ColorizeRowAvx2(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color) {
+  const __m256i k_rb = _mm256_set1_epi32(0x00ff00ff);
+  const __m256i k_g = _mm256_set1_epi32(0x0000ff00);
+  const __m256i k_hi = _mm256_set1_epi32(static_cast<Si32>(0xff00ff00u));
+  const __m256i k_255 = _mm256_set1_epi32(255);
+  const __m256i k_zero = _mm256_setzero_si256();
+  const __m256i k_alpha = kIsColorizeAlphaCleared ? k_zero
+    : _mm256_set1_epi32(static_cast<Si32>(0xff000000u));
+  const __m256i k_in_a1 = _mm256_set1_epi32(Si32(in_color.a) + 1);
+  const __m256i k_in_g1 = _mm256_set1_epi32(Si32(in_color.g) + 1);
+  const __m256i k_in_rb1 = _mm256_set1_epi32(
+      (Si32(in_color.r) + 1) | ((Si32(in_color.b) + 1) << 16));
+  const __m256i k_in_rb = _mm256_set1_epi32(
+      static_cast<Si32>(in_color.rgba & 0x00ff00fful));
+  Si32 i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i s = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(from + i));
+    __m256i ca = _mm256_srli_epi32(
+        _mm256_mullo_epi32(_mm256_srli_epi32(s, 24), k_in_a1), 8);
+    __m256i is_clear = _mm256_cmpeq_epi32(ca, k_zero);
+    if (_mm256_movemask_epi8(is_clear) == -1) {
+      continue;
+    }
+    __m256i *to_ptr = reinterpret_cast<__m256i*>(to + i);
+    __m256i d = _mm256_loadu_si256(to_ptr);
+    __m256i s_rb = _mm256_and_si256(s, k_rb);
+    __m256i s_g = _mm256_srli_epi32(_mm256_and_si256(s, k_g), 8);
+
+    // The halves of the 0x00XX00XX products never overlap here either.
+    __m256i opaque = _mm256_or_si256(_mm256_or_si256(
+        _mm256_and_si256(
+          _mm256_srli_epi32(_mm256_mullo_epi16(s_rb, k_in_rb1), 8), k_rb),
+        _mm256_and_si256(_mm256_mullo_epi32(s_g, k_in_g1), k_g)), k_alpha);
+
+    __m256i rb2_ = _mm256_srli_epi32(
+        _mm256_and_si256(_mm256_mullo_epi32(s_rb, ca), k_hi), 8);
+    __m256i rb2 = _mm256_mullo_epi16(rb2_, k_in_rb);
+    __m256i g2 = _mm256_srli_epi32(_mm256_mullo_epi32(
+        _mm256_mullo_epi32(s_g, ca), k_in_g1), 8);
+    __m256i res = Avx2Lerp(d, _mm256_sub_epi32(k_255, ca), rb2, g2);
+    res = Avx2Select(is_clear, d, res);
+    res = Avx2Select(_mm256_cmpeq_epi32(ca, k_255), opaque, res);
+    _mm256_storeu_si256(to_ptr, res);
+  }
+  BlendRowScalar<kDrawBlendingModeColorize, kIsColorizeAlphaCleared>(
+      to + i, from + i, count - i, in_color);
+}
+
+ARCTIC_BLEND_AVX2_TARGET
+void SolidColorRowAvx2(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color) {
+  const __m256i k_255 = _mm256_set1_epi32(255);
+  const __m256i k_zero = _mm256_setzero_si256();
+  const __m256i k_in = _mm256_set1_epi32(static_cast<Si32>(in_color.rgba));
+  const __m256i k_in_a1 = _mm256_set1_epi32(Si32(in_color.a) + 1);
+  const __m256i k_in_rb = _mm256_set1_epi32(
+      static_cast<Si32>(in_color.rgba & 0x00ff00fful));
+  const __m256i k_in_g = _mm256_set1_epi32(Si32(in_color.g));
+  Si32 i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i s = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(from + i));
+    __m256i ca = _mm256_srli_epi32(
+        _mm256_mullo_epi32(_mm256_srli_epi32(s, 24), k_in_a1), 8);
+    __m256i is_clear = _mm256_cmpeq_epi32(ca, k_zero);
+    if (_mm256_movemask_epi8(is_clear) == -1) {
+      continue;
+    }
+    __m256i *to_ptr = reinterpret_cast<__m256i*>(to + i);
+    __m256i d = _mm256_loadu_si256(to_ptr);
+    __m256i res = Avx2Lerp(d, _mm256_sub_epi32(k_255, ca),
+        _mm256_mullo_epi32(k_in_rb, ca), _mm256_mullo_epi32(k_in_g, ca));
+    res = Avx2Select(is_clear, d, res);
+    res = Avx2Select(_mm256_cmpeq_epi32(ca, k_255), k_in, res);
+    _mm256_storeu_si256(to_ptr, res);
+  }
+  BlendRowScalar<kDrawBlendingModeSolidColor, false>(
+      to + i, from + i, count - i, in_color);
+}
+
+ARCTIC_BLEND_AVX2_TARGET
+void AddRowAvx2(Rgba *to, const Rgba *from, Si32 count, Rgba in_color) {
+  const __m256i k_alpha = _mm256_set1_epi32(static_cast<Si32>(0xff000000u));
+  Si32 i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i s = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(from + i));
+    __m256i *to_ptr = reinterpret_cast<__m256i*>(to + i);
+    __m256i d = _mm256_loadu_si256(to_ptr);
+    _mm256_storeu_si256(to_ptr,
+        _mm256_or_si256(_mm256_adds_epu8(s, d), k_alpha));
+  }
+  BlendRowScalar<kDrawBlendingModeAdd, false>(
+      to + i, from + i, count - i, in_color);
+}
+
+static const BlendKernelSet g_blend_kernels_avx2 = {
+  CopyRow,
+  AlphaBlendRowAvx2,
+  PremultipliedAlphaBlendRowAvx2,
+  ColorizeRowAvx2<false>,
+  ColorizeRowAvx2<true>,
+  SolidColorRowAvx2,
+  AddRowAvx2
+};
+
+#endif  // ARCTIC_BLEND_AVX2
+
+#if defined(ARCTIC_BLEND_NEON)
+
+// NEON has a 32-bit multiply, so the kernels are a literal translation.
+inline uint32x4_t NeonLerp(uint32x4_t d, uint32x4_t m,
+    uint32x4_t rb2, uint32x4_t g2) {
+  const uint32x4_t k_rb = vdupq_n_u32(0x00ff00ffu);
+  const uint32x4_t k_g = vdupq_n_u32(0x0000ff00u);
+  uint32x4_t rb = vmulq_u32(vandq_u32(d, k_rb), m);
+  uint32x4_t g = vmulq_u32(vshrq_n_u32(vandq_u32(d, k_g), 8), m);
+  return vorrq_u32(
+      vandq_u32(vshrq_n_u32(vaddq_u32(rb, rb2), 8), k_rb),
+      vandq_u32(vaddq_u32(g, g2), k_g));
+}
+
+inline bool NeonIsAllZero(uint32x4_t v) {
+  uint32x2_t r = vorr_u32(vget_low_u32(v), vget_high_u32(v));
+  return (vget_lane_u32(r, 0) | vget_lane_u32(r, 1)) == 0;
+}
+
+void AlphaBlendRowNeon(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color) {
+  const uint32x4_t k_rb = vdupq_n_u32(0x00ff00ffu);
+  const uint32x4_t k_g = vdupq_n_u32(0x0000ff00u);
+  const uint32x4_t k_255 = vdupq_n_u32(255u);
+  Si32 i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint32x4_t s = vld1q_u32(reinterpret_cast<const uint32_t*>(from + i));
+    uint32x4_t a = vshrq_n_u32(s, 24);
+    if (NeonIsAllZero(a)) {
+      continue;
+    }
+    uint32_t *to_ptr = reinterpret_cast<uint32_t*>(to + i);
+    uint32x4_t d = vld1q_u32(to_ptr);
+    uint32x4_t rb2 = vmulq_u32(vandq_u32(s, k_rb), a);
+    uint32x4_t g2 = vmulq_u32(vshrq_n_u32(vandq_u32(s, k_g), 8), a);
+    uint32x4_t res = NeonLerp(d, vsubq_u32(k_255, a), rb2, g2);
+    res = vbslq_u32(vceqq_u32(a, vdupq_n_u32(0)), d, res);
+    res = vbslq_u32(vceqq_u32(a, k_255), s, res);
+    vst1q_u32(to_ptr, res);
+  }
+  BlendRowScalar<kDrawBlendingModeAlphaBlend, false>(
+      to + i, from + i, count - i, in_color);
+}
+
+void PremultipliedAlphaBlendRowNeon(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color) {
+  const uint32x4_t k_rb = vdupq_n_u32(0x00ff00ffu);
+  const uint32x4_t k_g = vdupq_n_u32(0x0000ff00u);
+  const uint32x4_t k_255 = vdupq_n_u32(255u);
+  Si32 i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint32x4_t s = vld1q_u32(reinterpret_cast<const uint32_t*>(from + i));
+    uint32x4_t a = vshrq_n_u32(s, 24);
+    if (NeonIsAllZero(a)) {
+      continue;
+    }
+    uint32_t *to_ptr = reinterpret_cast<uint32_t*>(to + i);
+    uint32x4_t d = vld1q_u32(to_ptr);
+    uint32x4_t m = vsubq_u32(k_255, a);
+    uint32x4_t rb = vshrq_n_u32(vmulq_u32(vandq_u32(d, k_rb), m), 8);
+    uint32x4_t g = vmulq_u32(vshrq_n_u32(vandq_u32(d, k_g), 8), m);
+    uint32x4_t res = vorrq_u32(
+        vandq_u32(vaddq_u32(rb, vandq_u32(s, k_rb)), k_rb),
+        vandq_u32(vaddq_u32(g, vandq_u32(s, k_g)), k_g));
+    res = vbslq_u32(vceqq_u32(a, vdupq_n_u32(0)), d, res);
+    res = vbslq_u32(vceqq_u32(a, k_255), s, res);
+    vst1q_u32(to_ptr, res);
+  }
+  BlendRowScalar<kDrawBlendingModePremultipliedAlphaBlend, false>(
+      to + i, from + i, count - i, in_color);
+}
+
+template<bool kIsColorizeAlphaCleared>
+void ColorizeRowNeon(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color) {
+  const uint32x4_t k_rb = vdupq_n_u32(0x00ff00ffu);
+  const uint32x4_t k_g = vdupq_n_u32(0x0000ff00u);
+  const uint32x4_t k_hi = vdupq_n_u32(0xff00ff00u);
+  const uint32x4_t k_255 = vdupq_n_u32(255u);
+  const uint32x4_t k_alpha = vdupq_n_u32(
+      kIsColorizeAlphaCleared ? 0u : 0xff000000u);
+  const uint32x4_t k_in_a1 = vdupq_n_u32(Ui32(in_color.a) + 1u);
+  const uint32x4_t k_in_g1 = vdupq_n_u32(Ui32(in_color.g) + 1u);
+  const uint32x4_t k_in_rb1 = vdupq_n_u32(
+      (Ui32(in_color.r) + 1u) | ((Ui32(in_color.b) + 1u) << 16u));
+  const uint32x4_t k_in_rb = vdupq_n_u32(in_color.rgba & 0x00ff00ffu);
+  Si32 i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint32x4_t s = vld1q_u32(reinterpret_cast<const uint32_t*>(from + i));
+    uint32x4_t ca = vshrq_n_u32(vmulq_u32(vshrq_n_u32(s, 24), k_in_a1), 8);
+    if (NeonIsAllZero(ca)) {
+      continue;
+    }
+    uint32_t *to_ptr = reinterpret_cast<uint32_t*>(to + i);
+    uint32x4_t d = vld1q_u32(to_ptr);
+    uint32x4_t s_rb = vandq_u32(s, k_rb);
+    uint32x4_t s_g = vshrq_n_u32(vandq_u32(s, k_g), 8);
+    // The halves of the 0x00XX00XX products never overlap.
+    uint32x4_t opaque = vorrq_u32(vorrq_u32(
+        vandq_u32(vshrq_n_u32(vreinterpretq_u32_u16(vmulq_u16(
+          vreinterpretq_u16_u32(s_rb), vreinterpretq_u16_u32(k_in_rb1))), 8),
+          k_rb),
+        vandq_u32(vmulq_u32(s_g, k_in_g1), k_g)), k_alpha);
+
+    uint32x4_t rb2_ = vshrq_n_u32(vandq_u32(vmulq_u32(s_rb, ca), k_hi), 8);
+    uint32x4_t rb2 = vreinterpretq_u32_u16(vmulq_u16(
+        vreinterpretq_u16_u32(rb2_), vreinterpretq_u16_u32(k_in_rb)));
+    uint32x4_t g2 = vshrq_n_u32(vmulq_u32(vmulq_u32(s_g, ca), k_in_g1), 8);
+    uint32x4_t res = NeonLerp(d, vsubq_u32(k_255, ca), rb2, g2);
+    res = vbslq_u32(vceqq_u32(ca, vdupq_n_u32(0)), d, res);
+    res = vbslq_u32(vceqq_u32(ca, k_255), opaque, res);
+    vst1q_u32(to_ptr, res);
+  }
+  BlendRowScalar<kDrawBlendingModeColorize, kIsColorizeAlphaCleared>(
+      to + i, from + i, count - i, in_color);
+}
+
+void SolidColorRowNeon(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color) {
+  const uint32x4_t k_255 = vdupq_n_u32(255u);
+  const uint32x4_t k_in = vdupq_n_u32(in_color.rgba);
+  const uint32x4_t k_in_a1 = vdupq_n_u32(Ui32(in_color.a) + 1u);
+  const uint32x4_t k_in_rb = vdupq_n_u32(in_color.rgba & 0x00ff00ffu);
+  const uint32x4_t k_in_g = vdupq_n_u32(Ui32(in_color.g));
+  Si32 i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint32x4_t s = vld1q_u32(reinterpret_cast<const uint32_t*>(from + i));
+    uint32x4_t ca = vshrq_n_u32(vmulq_u32(vshrq_n_u32(s, 24), k_in_a1), 8);
+    if (NeonIsAllZero(ca)) {
+      continue;
+    }
+    uint32_t *to_ptr = reinterpret_cast<uint32_t*>(to + i);
+    uint32x4_t d = vld1q_u32(to_ptr);
+    uint32x4_t res = NeonLerp(d, vsubq_u32(k_255, ca),
+        vmulq_u32(k_in_rb, ca), vmulq_u32(k_in_g, ca));
+    res = vbslq_u32(vceqq_u32(ca, vdupq_n_u32(0)), d, res);
+    res = vbslq_u32(vceqq_u32(ca, k_255), k_in, res);
+    vst1q_u32(to_ptr, res);
+  }
+  BlendRowScalar<kDrawBlendingModeSolidColor, false>(
+      to + i, from + i, count - i, in_color);
+}
+
+void AddRowNeon(Rgba *to, const Rgba *from, Si32 count, Rgba in_color) {
+  const uint32x4_t k_alpha = vdupq_n_u32(0xff000000u);
+  Si32 i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint8x16_t s = vld1q_u8(reinterpret_cast<const uint8_t*>(from + i));
+    uint8_t *to_ptr = reinterpret_cast<uint8_t*>(to + i);
+    uint8x16_t d = vld1q_u8(to_ptr);
+    uint32x4_t res = vorrq_u32(vreinterpretq_u32_u8(vqaddq_u8(s, d)),
+        k_alpha);
+    vst1q_u8(to_ptr, vreinterpretq_u8_u32(res));
+  }
+  BlendRowScalar<kDrawBlendingModeAdd, false>(
+      to + i, from + i, count - i, in_color);
+}
+
+static const BlendKernelSet g_blend_kernels_neon = {
+  CopyRow,
+  AlphaBlendRowNeon,
+  PremultipliedAlphaBlendRowNeon,
+  ColorizeRowNeon<false>,
+  ColorizeRowNeon<true>,
+  SolidColorRowNeon,
+  AddRowNeon
+};
+
+#endif  // ARCTIC_BLEND_NEON
+
+static bool IsAvx2Supported() {
+#if defined(ARCTIC_BLEND_AVX2)
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  const int k_osxsave_and_avx = (1 << 27) | (1 << 28);
+  if ((info[2] & k_osxsave_and_avx) != k_osxsave_and_avx) {
+    return false;
+  }
+  if ((_xgetbv(0) & 6) != 6) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+#else
+  return false;
+#endif
+}
+
+bool IsBlendKernelIsaSupported(BlendKernelIsa isa) {
+  switch (isa) {
+  case kBlendKernelIsaScalar:
+    return true;
+  case kBlendKernelIsaSse2:
+#if defined(ARCTIC_BLEND_SSE2)
+    return true;
+#else
+    return false;
+#endif
+  case kBlendKernelIsaAvx2: {
+    static const bool is_avx2_supported = IsAvx2Supported();
+    return is_avx2_supported;
+  }
+  case kBlendKernelIsaNeon:
+#if defined(ARCTIC_BLEND_NEON)
+    return true;
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+BlendKernelIsa GetBlendKernelIsa() {
+  static const BlendKernelIsa isa =
+    IsBlendKernelIsaSupported(kBlendKernelIsaAvx2) ? kBlendKernelIsaAvx2 :
+    IsBlendKernelIsaSupported(kBlendKernelIsaSse2) ? kBlendKernelIsaSse2 :
+    IsBlendKernelIsaSupported(kBlendKernelIsaNeon) ? kBlendKernelIsaNeon :
+    kBlendKernelIsaScalar;
+  return isa;
+}
+
+BlendRowFunc GetBlendRowFunc(DrawBlendingMode blending_mode,
+    bool is_colorize_alpha_cleared, BlendKernelIsa isa) {
+  const BlendKernelSet *set = &g_blend_kernels_scalar;
+  switch (isa) {
+  case kBlendKernelIsaScalar:
+    break;
+  case kBlendKernelIsaSse2:
+#if defined(ARCTIC_BLEND_SSE2)
+    set = &g_blend_kernels_sse2;
+#endif
+    break;
+  case kBlendKernelIsaAvx2:
+#if defined(ARCTIC_BLEND_AVX2)
+    if (IsBlendKernelIsaSupported(kBlendKernelIsaAvx2)) {
+      set = &g_blend_kernels_avx2;
+    }
+#endif
+    break;
+  case kBlendKernelIsaNeon:
+#if defined(ARCTIC_BLEND_NEON)
+    set = &g_blend_kernels_neon;
+#endif
+    break;
+  }
+  switch (blending_mode) {
+  case kDrawBlendingModeAlphaBlend:
+    return set->alpha_blend;
+  case kDrawBlendingModePremultipliedAlphaBlend:
+    return set->premultiplied_alpha_blend;
+  case kDrawBlendingModeColorize:
+    return is_colorize_alpha_cleared ?
+      set->colorize_alpha_cleared : set->colorize;
+  case kDrawBlendingModeSolidColor:
+    return set->solid_color;
+  case kDrawBlendingModeAdd:
+    return set->add;
+  case kDrawBlendingModeCopyRgba:
+  default:
+    return set->copy_rgba;
+  }
+}
+
+BlendRowFunc GetBlendRowFunc(DrawBlendingMode blending_mode,
+    bool is_colorize_alpha_cleared) {
+  return GetBlendRowFunc(blending_mode, is_colorize_alpha_cleared,
+      GetBlendKernelIsa());
+}
+
+}  // namespace arctic
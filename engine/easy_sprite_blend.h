@@ -0,0 +1,72 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_EASY_SPRITE_BLEND_H_
+#define ENGINE_EASY_SPRITE_BLEND_H_
+
+#include "engine/arctic_types.h"
+#include "engine/easy_sprite.h"
+#include "engine/rgba.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+enum BlendKernelIsa {
+  kBlendKernelIsaScalar = 0,  ///< Plain C++, available everywhere.
+  kBlendKernelIsaSse2 = 1,  ///< x86 SSE2, 4 pixels per step.
+  kBlendKernelIsaAvx2 = 2,  ///< x86 AVX2, 8 pixels per step.
+  kBlendKernelIsaNeon = 3  ///< ARM NEON, 4 pixels per step.
+};
+
+/// @brief Blends count pixels of a source row into a destination row.
+/// @details The rows must not overlap.
+typedef void (*BlendRowFunc)(Rgba *to, const Rgba *from, Si32 count,
+    Rgba in_color);
+
+/// @brief Returns true if the kernels for the instruction set
+///  are compiled in and supported by the cpu the program runs on.
+bool IsBlendKernelIsaSupported(BlendKernelIsa isa);
+
+/// @brief Returns the fastest instruction set supported by the cpu.
+/// @details The detection is performed once, on the first call.
+BlendKernelIsa GetBlendKernelIsa();
+
+/// @brief Returns the row blending kernel for the specified blending mode.
+/// @param [in] blending_mode The blending mode to perform.
+/// @param [in] is_colorize_alpha_cleared Colorize in the scaled DrawSprite path
+///  writes fully opaque pixels with zero alpha, pass true to reproduce that.
+/// @param [in] isa The instruction set to use, must be supported.
+/// @return The kernel. All kernels produce bit-identical results.
+BlendRowFunc GetBlendRowFunc(DrawBlendingMode blending_mode,
+    bool is_colorize_alpha_cleared, BlendKernelIsa isa);
+
+/// @brief Returns the row blending kernel for the fastest instruction set.
+BlendRowFunc GetBlendRowFunc(DrawBlendingMode blending_mode,
+    bool is_colorize_alpha_cleared = false);
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_EASY_SPRITE_BLEND_H_
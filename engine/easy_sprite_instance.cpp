@@ -26,6 +26,7 @@
 
 #include "engine/easy_sprite_instance.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 #include <sstream>
@@ -46,38 +47,224 @@ namespace arctic {
       }
 
   void SpriteInstance::UpdateOpaqueSpans() {
+    // Shorter transparent gaps are kept inside the runs and shorter opaque
+    // stretches are blended, splitting the row there costs more than it saves.
+    const Si32 kMinTransparentGap = 16;
+    const Si32 kMinOpaqueRun = 16;
+    runs_.clear();
+    row_runs_.clear();
+    opaque_begin_ = Vec2Si32(width_, height_);
+    opaque_end_ = Vec2Si32(0, 0);
     if (!height_) {
       opaque_.clear();
+      opaque_begin_ = Vec2Si32(0, 0);
       return;
     }
     opaque_.resize(static_cast<size_t>(height_));
+    row_runs_.resize(static_cast<size_t>(height_) + 1);
     for (Si32 y = 0; y < height_; ++y) {
       const Rgba *line = reinterpret_cast<Rgba*>(
           reinterpret_cast<void*>(data_.data())) +
         width_ * y;
+      row_runs_[static_cast<size_t>(y)] = static_cast<Si32>(runs_.size());
       SpanSi32 &span = opaque_[static_cast<size_t>(y)];
       span.begin = 0;
       span.end = 0;
       Si32 x = 0;
-      for (; x < width_; ++x) {
-        if (line[x].a != 0) {
-          span.begin = x;
+      while (x < width_) {
+        while (x < width_ && line[x].a == 0) {
+          ++x;
+        }
+        if (x == width_) {
           break;
         }
-      }
-      if (x < width_) {
-        for (; x < width_; ++x) {
+        const Si32 begin = x;
+        Si32 end = x + 1;
+        for (++x; x < width_ && x - end < kMinTransparentGap; ++x) {
           if (line[x].a != 0) {
-            span.end = x;
+            end = x + 1;
+          }
+        }
+        x = end;
+        Si32 partial_begin = begin;
+        Si32 p = begin;
+        while (p < end) {
+          if (line[p].a != 255) {
+            ++p;
+            continue;
+          }
+          const Si32 opaque_begin = p;
+          while (p < end && line[p].a == 255) {
+            ++p;
           }
+          if (p - opaque_begin < kMinOpaqueRun) {
+            continue;
+          }
+          if (partial_begin < opaque_begin) {
+            runs_.push_back(RunSi32{partial_begin, opaque_begin, false});
+          }
+          runs_.push_back(RunSi32{opaque_begin, p, true});
+          partial_begin = p;
+        }
+        if (partial_begin < end) {
+          runs_.push_back(RunSi32{partial_begin, end, false});
         }
-        span.end++;
       }
+      if (row_runs_[static_cast<size_t>(y)] < static_cast<Si32>(runs_.size())) {
+        span.begin = runs_[static_cast<size_t>(
+          row_runs_[static_cast<size_t>(y)])].begin;
+        span.end = runs_.back().end;
+        opaque_begin_.x = std::min(opaque_begin_.x, span.begin);
+        opaque_begin_.y = std::min(opaque_begin_.y, y);
+        opaque_end_.x = std::max(opaque_end_.x, span.end);
+        opaque_end_.y = y + 1;
+      }
+    }
+    row_runs_[static_cast<size_t>(height_)] = static_cast<Si32>(runs_.size());
+    if (opaque_end_.y == 0) {
+      opaque_begin_ = Vec2Si32(0, 0);
     }
   }
 
   void SpriteInstance::ClearOpaqueSpans() {
     opaque_.clear();
+    runs_.clear();
+    row_runs_.clear();
+    opaque_begin_ = Vec2Si32(0, 0);
+    opaque_end_ = Vec2Si32(0, 0);
+  }
+
+  Si32 SpriteInstance::MipLevelCount() const {
+    Si32 count = 0;
+    for (Si32 size = std::max(width_, height_); size > 1; size /= 2) {
+      ++count;
+    }
+    return count;
+  }
+
+  const std::shared_ptr<SpriteInstance> &SpriteInstance::MipLevel(
+      Si32 level) {
+    while (static_cast<Si32>(mip_levels_.size()) < level) {
+      const SpriteInstance &from = mip_levels_.empty()
+        ? *this : *mip_levels_.back();
+      const Si32 width = std::max(from.width_ / 2, 1);
+      const Si32 height = std::max(from.height_ / 2, 1);
+      std::shared_ptr<SpriteInstance> to =
+        std::make_shared<SpriteInstance>(width, height);
+      const Rgba *from_data = reinterpret_cast<const Rgba*>(
+        static_cast<const void*>(from.data_.data()));
+      Rgba *to_data = reinterpret_cast<Rgba*>(
+        static_cast<void*>(to->data_.data()));
+      for (Si32 y = 0; y < height; ++y) {
+        const Rgba *line_0 = from_data + from.width_ * std::min(y * 2,
+          from.height_ - 1);
+        const Rgba *line_1 = from_data + from.width_ * std::min(y * 2 + 1,
+          from.height_ - 1);
+        for (Si32 x = 0; x < width; ++x) {
+          const Si32 x0 = std::min(x * 2, from.width_ - 1);
+          const Si32 x1 = std::min(x * 2 + 1, from.width_ - 1);
+          const Rgba p[4] = {line_0[x0], line_0[x1], line_1[x0], line_1[x1]};
+          Ui32 a = 0;
+          Ui32 r = 0;
+          Ui32 g = 0;
+          Ui32 b = 0;
+          for (const Rgba &c : p) {
+            a += c.a;
+            r += Ui32(c.r) * c.a;
+            g += Ui32(c.g) * c.a;
+            b += Ui32(c.b) * c.a;
+          }
+          // Transparent pixels must not bleed their color into the level,
+          // a fully transparent block keeps the plain average.
+          if (!a) {
+            r = Ui32(p[0].r) + p[1].r + p[2].r + p[3].r;
+            g = Ui32(p[0].g) + p[1].g + p[2].g + p[3].g;
+            b = Ui32(p[0].b) + p[1].b + p[2].b + p[3].b;
+            to_data[y * width + x] = Rgba(static_cast<Ui8>((r + 2) / 4),
+              static_cast<Ui8>((g + 2) / 4), static_cast<Ui8>((b + 2) / 4), 0);
+            continue;
+          }
+          to_data[y * width + x] = Rgba(static_cast<Ui8>((r + a / 2) / a),
+            static_cast<Ui8>((g + a / 2) / a),
+            static_cast<Ui8>((b + a / 2) / a),
+            static_cast<Ui8>((a + 2) / 4));
+        }
+      }
+      if (!opaque_.empty()) {
+        to->UpdateOpaqueSpans();
+      }
+      mip_levels_.push_back(to);
+    }
+    return mip_levels_[static_cast<size_t>(level) - 1];
+  }
+
+  void SpriteInstance::UpdateMipLevels() {
+    mip_levels_.clear();
+    MipLevel(MipLevelCount());
+  }
+
+  void SpriteInstance::ClearMipLevels() {
+    mip_levels_.clear();
+  }
+
+  void SpriteInstance::SetDirtyTracking(bool is_enabled) {
+    is_dirty_tracked_ = is_enabled;
+    dirty_rects_.clear();
+  }
+
+  void SpriteInstance::AddDirtyRect(Vec2Si32 begin, Vec2Si32 end) {
+    RectSi32 rect;
+    rect.begin = Vec2Si32(std::max(begin.x, 0), std::max(begin.y, 0));
+    rect.end = Vec2Si32(std::min(end.x, width_), std::min(end.y, height_));
+    if (rect.begin.x >= rect.end.x || rect.begin.y >= rect.end.y) {
+      return;
+    }
+    is_solid_ = false;
+    if (!is_dirty_tracked_) {
+      return;
+    }
+    // The merged rectangle may touch the ones checked before, so the search
+    // starts over after each merge.
+    for (size_t idx = 0; idx < dirty_rects_.size(); ) {
+      const RectSi32 &other = dirty_rects_[idx];
+      if (other.begin.x <= rect.end.x && rect.begin.x <= other.end.x
+          && other.begin.y <= rect.end.y && rect.begin.y <= other.end.y) {
+        rect.begin = Vec2Si32(std::min(rect.begin.x, other.begin.x),
+          std::min(rect.begin.y, other.begin.y));
+        rect.end = Vec2Si32(std::max(rect.end.x, other.end.x),
+          std::max(rect.end.y, other.end.y));
+        dirty_rects_[idx] = dirty_rects_.back();
+        dirty_rects_.pop_back();
+        idx = 0;
+      } else {
+        ++idx;
+      }
+    }
+    if (static_cast<Si32>(dirty_rects_.size()) < kMaxDirtyRects) {
+      dirty_rects_.push_back(rect);
+      return;
+    }
+    size_t best_idx = 0;
+    Si64 best_growth = 0;
+    for (size_t idx = 0; idx < dirty_rects_.size(); ++idx) {
+      const RectSi32 &other = dirty_rects_[idx];
+      const Si64 width = std::max(rect.end.x, other.end.x)
+        - std::min(rect.begin.x, other.begin.x);
+      const Si64 height = std::max(rect.end.y, other.end.y)
+        - std::min(rect.begin.y, other.begin.y);
+      const Si64 growth = width * height
+        - static_cast<Si64>(other.end.x - other.begin.x)
+        * (other.end.y - other.begin.y);
+      if (idx == 0 || growth < best_growth) {
+        best_idx = idx;
+        best_growth = growth;
+      }
+    }
+    RectSi32 &best = dirty_rects_[best_idx];
+    best.begin = Vec2Si32(std::min(rect.begin.x, best.begin.x),
+      std::min(rect.begin.y, best.begin.y));
+    best.end = Vec2Si32(std::max(rect.end.x, best.end.x),
+      std::max(rect.end.y, best.end.y));
   }
 
 #pragma pack(1)
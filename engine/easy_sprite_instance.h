@@ -26,6 +26,7 @@
 #include <memory>
 #include <vector>
 #include "engine/arctic_types.h"
+#include "engine/rgba.h"
 #include "engine/vec2si32.h"
 
 namespace arctic {
@@ -38,14 +39,39 @@ struct SpanSi32 {
   Si32 end;
 };
 
+/// @brief A run of sprite row pixels that are not all fully transparent.
+/// @details The pixels between the runs of a row are fully transparent.
+struct RunSi32 {
+  Si32 begin;
+  Si32 end;
+  bool is_opaque;  ///< All the pixels of the run have alpha 255.
+};
+
+/// @brief A rectangle of pixels, end is exclusive.
+struct RectSi32 {
+  Vec2Si32 begin;
+  Vec2Si32 end;
+};
+
 class SpriteInstance {
  private:
   Si32 width_;
   Si32 height_;
   std::vector<Ui8> data_;
   std::vector<SpanSi32> opaque_;
+  std::vector<RunSi32> runs_;
+  std::vector<Si32> row_runs_;
+  Vec2Si32 opaque_begin_ = Vec2Si32(0, 0);
+  Vec2Si32 opaque_end_ = Vec2Si32(0, 0);
+  std::vector<std::shared_ptr<SpriteInstance>> mip_levels_;
+  bool is_dirty_tracked_ = false;
+  std::vector<RectSi32> dirty_rects_;
+  bool is_solid_ = false;
+  Rgba solid_color_ = Rgba(0, 0, 0, 0);
 
  public:
+  static const Si32 kMaxDirtyRects = 16;
+
   SpriteInstance(Si32 width, Si32 height);
 
   Si32 width() const {
@@ -64,8 +90,71 @@ class SpriteInstance {
     return opaque_;
   }
 
+  bool HasRuns() const {
+    return !row_runs_.empty();
+  }
+
+  const RunSi32 *RowRunsBegin(Si32 y) const {
+    return runs_.data() + row_runs_[static_cast<size_t>(y)];
+  }
+
+  const RunSi32 *RowRunsEnd(Si32 y) const {
+    return runs_.data() + row_runs_[static_cast<size_t>(y) + 1];
+  }
+
+  /// @brief Returns the top left corner of the box bounding the runs.
+  Vec2Si32 OpaqueBegin() const {
+    return opaque_begin_;
+  }
+
+  /// @brief Returns the bottom right corner (exclusive) of the box
+  ///  bounding the runs.
+  Vec2Si32 OpaqueEnd() const {
+    return opaque_end_;
+  }
+
   void UpdateOpaqueSpans();
   void ClearOpaqueSpans();
+
+  /// @brief Returns the number of the mip levels below the full size one,
+  ///  the last level is 1 pixel wide or high.
+  Si32 MipLevelCount() const;
+  /// @brief Returns the instance downscaled 2^level times, level >= 1.
+  /// @details The missing levels are built on demand, each one is a 2x2 box
+  ///  filtered copy of the previous one with alpha weighted colors.
+  const std::shared_ptr<SpriteInstance> &MipLevel(Si32 level);
+  void UpdateMipLevels();
+  void ClearMipLevels();
+
+  /// @brief Starts or stops collecting the rectangles of changed pixels.
+  void SetDirtyTracking(bool is_enabled);
+  bool IsDirtyTracked() const {
+    return is_dirty_tracked_;
+  }
+  /// @brief Adds a rectangle of changed pixels if the tracking is enabled.
+  /// @details Touching rectangles are merged, and once there are
+  ///  kMaxDirtyRects of them the new one is merged into the rectangle
+  ///  that grows the least.
+  void AddDirtyRect(Vec2Si32 begin, Vec2Si32 end);
+  const std::vector<RectSi32> &DirtyRects() const {
+    return dirty_rects_;
+  }
+  void ClearDirtyRects() {
+    dirty_rects_.clear();
+  }
+  /// @brief Remembers that all the pixels are of the color, until the next
+  ///  AddDirtyRect call.
+  void SetSolidColor(Rgba color) {
+    is_solid_ = true;
+    solid_color_ = color;
+  }
+  /// @brief Returns true if all the pixels are known to be of one color.
+  bool IsSolid() const {
+    return is_solid_;
+  }
+  Rgba SolidColor() const {
+    return solid_color_;
+  }
 };
 
 
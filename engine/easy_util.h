@@ -42,6 +42,41 @@ void ResizeScreen(const Vec2Si32 size);
 /// @brief Enables/disables Y-coordinte inversion.
 /// By default Y axis is directed upward.
 void SetInverseY(bool is_inverse);
+/// @brief Enables/disables multithreaded tiled rendering of the backbuffer.
+/// While enabled, sprite draws to the backbuffer are recorded and rasterized
+/// in parallel on ShowFrame, the resulting pixels are exactly the same.
+/// Call FlushDraws before accessing the backbuffer pixels directly.
+/// @param is_enabled true enables tiled rendering
+/// @param thread_count number of threads to use, 0 means one per cpu core
+void SetTiledRendering(bool is_enabled, Si32 thread_count = 0);
+/// @brief Enables/disables streaming of the backbuffer to the GPU through
+/// a ring of pixel buffers, so ShowFrame does not wait for the transfer.
+/// Enabled by default, has no effect where pixel buffers are not supported.
+void SetStreamingUpload(bool is_enabled);
+/// @brief Enables/disables drawing to the hardware backbuffer straight to the
+/// window instead of to a texture composited over the software backbuffer.
+/// Takes effect from the next frame, only where the window is the size of
+/// the backbuffer and has an alpha channel. Each frame has to start with
+/// a Clear() of the hardware backbuffer, and it can not be drawn from.
+/// Disabled by default.
+void SetHwBackbufferDirect(bool is_enabled);
+/// @brief Enables/disables packing of the loaded hardware sprites into shared
+/// atlas textures, so that draws of different sprites can be batched.
+/// Enabled by default, affects only the sprites loaded afterwards.
+void SetHwSpriteAtlas(bool is_enabled);
+/// @brief Sets how much memory the released HwSprite render targets may keep
+/// for reuse by HwSprite::Create, 64 MiB by default. 0 disables the reuse.
+void SetHwSpritePoolLimit(Si64 limit_bytes);
+/// @brief Sets how many bytes of the HwSprite::LoadAsync pixels are uploaded
+/// to the GPU each frame, 4 MiB by default.
+void SetHwSpriteUploadBudget(Si64 bytes_per_frame);
+/// @brief Sets the directory the linked shader programs are saved to, so
+/// that the next launch loads them instead of compiling the source.
+/// "shader_cache" by default, an empty path disables saving and loading.
+/// The engine programs are loaded before EasyMain, with the default path.
+void SetShaderCacheDirectory(const char *path);
+/// @brief Rasterizes the recorded backbuffer draws right away.
+void FlushDraws();
 
 /// @brief Returns time in seconds since the game start
 double Time();
@@ -33,6 +33,7 @@
 #include "engine/arctic_math.h"
 #include "engine/unicode.h"
 #include "engine/gl_state.h"
+#include "engine/gl_program_cache.h"
 
 namespace arctic {
 
@@ -94,6 +95,7 @@ void Engine::Init(Si32 width, Si32 height) {
 
   math_tables_.Init();
 
+#ifndef ARCTIC_PLATFORM_HEADLESS
     const char copy_backbuffers_vShaderStr[] = R"SHADER(
 #ifdef GL_ES
 #endif
@@ -117,8 +119,8 @@ void main() {
 }
 )SHADER";
 
-  copy_backbuffers_program_ = std::make_shared<GlProgram>();
-  copy_backbuffers_program_->Create(copy_backbuffers_vShaderStr, copy_backbuffers_fShaderStr);
+  copy_backbuffers_program_ = GlProgramCache::Get(copy_backbuffers_vShaderStr,
+    copy_backbuffers_fShaderStr);
 
   const char default_sprite_vShaderStr[] = R"SHADER(
 #ifdef GL_ES
@@ -159,41 +161,170 @@ void main() {
 }
 )SHADER";
 
-  default_sprite_program_ = std::make_shared<GlProgram>();
-  default_sprite_program_->Create(default_sprite_vShaderStr, default_sprite_fShaderStr);
+  default_sprite_program_ = GlProgramCache::Get(default_sprite_vShaderStr,
+    default_sprite_fShaderStr);
+
+  // Same as the default sprite program, but the vertices come in the target
+  // pixel space and carry the color, see HwSpriteBatch.
+  const char batch_sprite_vShaderStr[] = R"SHADER(
+#ifdef GL_ES
+precision mediump float;
+#endif
+attribute vec2 vPosition;
+attribute vec2 vTex;
+attribute vec4 vColor;
+varying vec2 v_texCoord;
+varying vec4 v_color;
+uniform vec2 to_sprite_size;
+void main() {
+  vec2 position = vPosition;
+  position *= vec2(2.0 / to_sprite_size.x, 2.0 / to_sprite_size.y);
+  position -= vec2(1.0, 1.0);
+  gl_Position = vec4(position, 0.0, 1.0);
+
+  v_texCoord = vTex;
+  v_color = vColor;
+}
+)SHADER";
+
+  const char batch_sprite_fShaderStr[] = R"SHADER(
+#ifdef GL_ES
+precision lowp float;
+#endif
+varying vec2 v_texCoord;
+varying vec4 v_color;
+uniform sampler2D s_texture;
+uniform int is_solid_color;
+void main() {
+  if (is_solid_color == 1) {
+    gl_FragColor.rgb = v_color.rgb;
+    gl_FragColor.a = texture2D(s_texture, v_texCoord).a*v_color.a;
+  } else {
+    gl_FragColor = texture2D(s_texture, v_texCoord)*v_color;
+  }
+}
+)SHADER";
+
+  batch_sprite_program_ = GlProgramCache::Get(batch_sprite_vShaderStr,
+    batch_sprite_fShaderStr);
+  hw_sprite_batch_.Init(batch_sprite_program_);
+
+  // The default sprite program math with the pivot position, the angle, the
+  // zoom and the color coming per instance, see HwSpriteInstancer.
+  const char instanced_sprite_vShaderStr[] = R"SHADER(
+#ifdef GL_ES
+precision mediump float;
+#endif
+attribute vec2 vPosition;
+attribute vec2 vTex;
+attribute vec4 vColor;
+attribute vec4 vInstance;
+varying vec2 v_texCoord;
+varying vec4 v_color;
+uniform vec2 to_sprite_size;
+uniform int is_tinted;
+void main() {
+  float sin_a = sin(vInstance.z);
+  float cos_a = cos(vInstance.z);
+  vec2 position = vec2(cos_a * vPosition.x - sin_a * vPosition.y,
+    sin_a * vPosition.x + cos_a * vPosition.y);
+  position *= vInstance.w;
+  position += vInstance.xy;
+  position *= vec2(2.0 / to_sprite_size.x, 2.0 / to_sprite_size.y);
+  position -= vec2(1.0, 1.0);
+  gl_Position = vec4(position, 0.0, 1.0);
+
+  v_texCoord = vTex;
+  v_color = is_tinted == 1 ? vColor : vec4(1.0, 1.0, 1.0, 1.0);
+}
+)SHADER";
+
+  if (HwSpriteInstancer::IsContextSupported()) {
+    instanced_sprite_program_ = GlProgramCache::Get(
+      instanced_sprite_vShaderStr, batch_sprite_fShaderStr);
+  } else {
+    instanced_sprite_program_ = std::make_shared<GlProgram>();
+  }
+  hw_sprite_instancer_.Init(instanced_sprite_program_);
+#endif  // ARCTIC_PLATFORM_HEADLESS
 }
 
 void Engine::Draw2d() {
-  gl_backbuffer_texture_.UpdateData(backbuffer_texture_.RawData());
+  tiled_rasterizer_.Flush();
+  // Without a window the backbuffer pixels are the output.
+#ifndef ARCTIC_PLATFORM_HEADLESS
+  hw_sprite_batch_.Flush();
+  hw_sprite_upload_queue_.Update();
+  hw_sprite_readback_queue_.Update();
+
+  if (is_backbuffer_quad_dirty_) {
+    UpdateBackbufferQuad();
+  }
+  // With the window as the hw backbuffer the HwSprites are already drawn,
+  // the software backbuffer goes under them.
+  const bool is_direct = hw_backbuffer_texture_.IsWindowTarget();
+  // A software backbuffer that was only cleared is not uploaded, the window
+  // is cleared to its color instead. The dirty rects are kept for later.
+  const SpriteInstance &back = *backbuffer_texture_.SpriteInstance();
+  const bool is_back_skipped = back.IsSolid()
+    && (back.SolidColor() == Rgba(0, 0, 0, 0)
+      || (!is_direct && is_backbuffer_quad_full_));
+  if (!is_back_skipped) {
+    UploadBackbuffer();
+  }
 
   // render
 
   GlFramebuffer::BindDefault();
   GlState::SetViewport(0, 0, width_, height_);
 
-  ARCTIC_GL_CHECK_ERROR(glClearColor(0.f, 0.f, 0.f, 0.f));
-  ARCTIC_GL_CHECK_ERROR(glClear(GL_COLOR_BUFFER_BIT));
+  if (!is_direct) {
+    GlState::SetClearColor(is_back_skipped ? back.SolidColor()
+      : Rgba(0, 0, 0, 0));
+    ARCTIC_GL_CHECK_ERROR(glClear(GL_COLOR_BUFFER_BIT));
+  }
   // draw quad
 
-  visible_verts_.resize(16 << 20);
-  visible_normals_.resize(16 << 20);
-  visible_indices_.resize(16 << 20);
-  tex_coords_.resize(16 << 20);
-
-  verts_ = 0;
-  normals_ = 0;
-  tex_ = 0;
-  indices_ = 0;
-
-  Vec3F *vertex = static_cast<Vec3F*>(reinterpret_cast<void*>(
-        visible_verts_.data()));
-  Vec3F *normal = static_cast<Vec3F*>(reinterpret_cast<void*>(
-        visible_normals_.data()));
-  Vec2F *tex = static_cast<Vec2F*>(reinterpret_cast<void*>(
-        tex_coords_.data()));
-  Ui32 *index = static_cast<Ui32*>(reinterpret_cast<void*>(
-        visible_indices_.data()));
+  if (!is_back_skipped || !is_direct) {
+    backbuffer_quad_.Bind();
+    ARCTIC_GL_CHECK_ERROR(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 16, 0));
+    ARCTIC_GL_CHECK_ERROR(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 16, (void*)8));
+    GlState::SetVertexAttribArrays(0x3);
 
+    copy_backbuffers_program_->Bind();
+    copy_backbuffers_program_->SetUniform("s_texture", 0);
+    copy_backbuffers_program_->CheckActiveUniforms(1);
+  }
+
+  if (!is_back_skipped) {
+    if (is_direct) {
+      GlState::SetBlendingUnder();
+    } else {
+      GlState::SetBlending(kDrawBlendingModeCopyRgba);
+    }
+    gl_backbuffer_texture_.Bind(0);
+    ARCTIC_GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLES, 0, 6));
+  }
+
+  if (!is_direct) {
+    GlState::SetBlending(kDrawBlendingModePremultipliedAlphaBlend);
+
+    hw_backbuffer_texture_.sprite_instance()->texture().Bind(0);
+    ARCTIC_GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLES, 0, 6));
+  }
+#endif  // ARCTIC_PLATFORM_HEADLESS
+
+  Swap();
+
+#ifndef ARCTIC_PLATFORM_HEADLESS
+  // Switching between the window and the render target starts a new frame.
+  if (IsHwBackbufferDirect() != hw_backbuffer_texture_.IsWindowTarget()) {
+    CreateHwBackbuffer();
+  }
+#endif  // ARCTIC_PLATFORM_HEADLESS
+}
+
+void Engine::UpdateBackbufferQuad() {
   float aspect = static_cast<float>(width_) / static_cast<float>(height_);
   float back_aspect = static_cast<float>(backbuffer_texture_.Width()) /
     static_cast<float>(backbuffer_texture_.Height());
@@ -201,80 +332,131 @@ void Engine::Draw2d() {
   float x_aspect = aspect < back_aspect ? 1.f : ratio;
   float y_aspect = aspect < back_aspect ? 1.f / ratio : 1.f;
 
-  Vec3F base = Vec3F(-1.f * x_aspect, -1.f * y_aspect, 0.f);
-  Vec3F tx = Vec3F(2.f * x_aspect, 0.f, 0.f);
-  Vec3F ty = Vec3F(0.f, 2.f * y_aspect, 0.f);
-  Vec3F n = Vec3F(0.f, 0.f, 1.f);
-
-  Si32 idx = verts_;
-  vertex[verts_] = base;
-  ++verts_;
-  vertex[verts_] = base + tx;
-  ++verts_;
-  vertex[verts_] = base + ty + tx;
-  ++verts_;
-  vertex[verts_] = base + ty;
-  ++verts_;
-
-  normal[normals_] = n;
-  ++normals_;
-  normal[normals_] = n;
-  ++normals_;
-  normal[normals_] = n;
-  ++normals_;
-  normal[normals_] = n;
-  ++normals_;
-
-  tex[tex_] = Vec2F(0.0f, is_inverse_y_ ? 1.0f : 0.0f);
-  ++tex_;
-  tex[tex_] = Vec2F(1.0f, is_inverse_y_ ? 1.0f : 0.0f);
-  ++tex_;
-  tex[tex_] = Vec2F(1.0f, is_inverse_y_ ? 0.0f : 1.0f);
-  ++tex_;
-  tex[tex_] = Vec2F(0.0f, is_inverse_y_ ? 0.0f : 1.0f);
-  ++tex_;
-
-  index[indices_] = static_cast<Ui32>(idx);
-  indices_++;
-  index[indices_] = static_cast<Ui32>(idx + 1);
-  indices_++;
-  index[indices_] = static_cast<Ui32>(idx + 2);
-  indices_++;
-  index[indices_] = static_cast<Ui32>(idx + 2);
-  indices_++;
-  index[indices_] = static_cast<Ui32>(idx + 3);
-  indices_++;
-  index[indices_] = static_cast<Ui32>(idx);
-  indices_++;
-
-  GlBuffer::BindDefault();
-  ARCTIC_GL_CHECK_ERROR(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, visible_verts_.data()));
-  ARCTIC_GL_CHECK_ERROR(glEnableVertexAttribArray(0));
-  ARCTIC_GL_CHECK_ERROR(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, tex_coords_.data()));
-  ARCTIC_GL_CHECK_ERROR(glEnableVertexAttribArray(1));
-
-  copy_backbuffers_program_->Bind();
-  copy_backbuffers_program_->SetUniform("s_texture", 0);
-  copy_backbuffers_program_->CheckActiveUniforms(1);
-
-  GlState::SetBlending(kDrawBlendingModeCopyRgba);
-  
-  gl_backbuffer_texture_.Bind(0);
-  ARCTIC_GL_CHECK_ERROR(glDrawElements(GL_TRIANGLES, indices_, GL_UNSIGNED_INT, visible_indices_.data()));
-
-  GlState::SetBlending(kDrawBlendingModePremultipliedAlphaBlend);
-
-  hw_backbuffer_texture_.sprite_instance()->texture().Bind(0);
-  ARCTIC_GL_CHECK_ERROR(glDrawElements(GL_TRIANGLES, indices_, GL_UNSIGNED_INT, visible_indices_.data()));
+  // d c
+  // a b
+  Vec2F a(-x_aspect, -y_aspect);
+  Vec2F b(x_aspect, -y_aspect);
+  Vec2F c(x_aspect, y_aspect);
+  Vec2F d(-x_aspect, y_aspect);
+  float bottom = is_inverse_y_ ? 1.0f : 0.0f;
+  float top = is_inverse_y_ ? 0.0f : 1.0f;
+
+  const Vec2F kVerts[] = {
+    a, Vec2F(0.0f, bottom),
+    b, Vec2F(1.0f, bottom),
+    c, Vec2F(1.0f, top),
+
+    c, Vec2F(1.0f, top),
+    d, Vec2F(0.0f, top),
+    a, Vec2F(0.0f, bottom),
+  };
+  is_backbuffer_quad_full_ = x_aspect >= 1.f && y_aspect >= 1.f;
+  if (backbuffer_quad_.IsValid()) {
+    backbuffer_quad_.UpdateData(kVerts);
+  } else {
+    backbuffer_quad_.Create(kVerts, sizeof(kVerts));
+  }
+  is_backbuffer_quad_dirty_ = false;
+}
+
+void Engine::UploadBackbuffer() {
+  SpriteInstance &back = *backbuffer_texture_.SpriteInstance();
+  const std::vector<RectSi32> &rects = back.DirtyRects();
+  Si64 dirty_area = 0;
+  for (const RectSi32 &rect : rects) {
+    dirty_area += static_cast<Si64>(rect.end.x - rect.begin.x)
+      * (rect.end.y - rect.begin.y);
+  }
+  // A new backbuffer instance is uploaded in full and tracked from then on.
+  // Uploading most of the texture piecewise is slower than in one go.
+  const bool is_full = !back.IsDirtyTracked()
+    || dirty_area * 2 >= static_cast<Si64>(back.width()) * back.height();
+  upload_rects_.clear();
+  if (is_full) {
+    RectSi32 full;
+    full.begin = Vec2Si32(0, 0);
+    full.end = Vec2Si32(back.width(), back.height());
+    upload_rects_.push_back(full);
+    back.SetDirtyTracking(true);
+  } else {
+    upload_rects_ = rects;
+    back.ClearDirtyRects();
+  }
 
-  Swap();
+  if (is_streaming_upload_ && backbuffer_upload_ring_.IsValid()) {
+    backbuffer_upload_ring_.Upload(gl_backbuffer_texture_, back.RawData(),
+      upload_rects_);
+  } else if (is_full) {
+    gl_backbuffer_texture_.UpdateData(back.RawData());
+  } else {
+    for (const RectSi32 &rect : upload_rects_) {
+      gl_backbuffer_texture_.UpdateData(back.RawData(), rect.begin, rect.end);
+    }
+  }
+}
+
+bool Engine::IsHwBackbufferDirect() {
+  // The window replaces the render target only where it matches it pixel
+  // for pixel and keeps the alpha the software backbuffer is blended by.
+  if (!is_hw_backbuffer_direct_ || is_inverse_y_
+      || width_ != backbuffer_texture_.Width()
+      || height_ != backbuffer_texture_.Height()) {
+    return false;
+  }
+  if (window_alpha_bits_ < 0) {
+    GLint alpha_bits = 0;
+    GlFramebuffer::BindDefault();
+    ARCTIC_GL_CHECK_ERROR(glGetIntegerv(GL_ALPHA_BITS, &alpha_bits));
+    window_alpha_bits_ = alpha_bits;
+  }
+  return window_alpha_bits_ > 0;
+}
+
+void Engine::CreateHwBackbuffer() {
+  const Si32 width = backbuffer_texture_.Width();
+  const Si32 height = backbuffer_texture_.Height();
+  if (IsHwBackbufferDirect()) {
+    hw_backbuffer_texture_.CreateWindowTarget(width, height);
+  } else {
+    hw_backbuffer_texture_.Create(width, height);
+  }
 }
 
 void Engine::ResizeBackbuffer(const Si32 width, const Si32 height) {
-  hw_backbuffer_texture_.Create(width, height);
+  const bool is_tiled = tiled_rasterizer_.IsRecording();
+  tiled_rasterizer_.Stop();
+
   backbuffer_texture_.Create(width, height);
 
+#ifndef ARCTIC_PLATFORM_HEADLESS
+  CreateHwBackbuffer();
   gl_backbuffer_texture_.Create(width, height);
+  is_backbuffer_quad_dirty_ = true;
+  if (GlPixelBufferRing::IsSupported()) {
+    backbuffer_upload_ring_.Create(width, height);
+  }
+#endif  // ARCTIC_PLATFORM_HEADLESS
+
+  if (is_tiled) {
+    tiled_rasterizer_.Start(backbuffer_texture_,
+      tiled_rasterizer_.ThreadCount(), tiled_rasterizer_.TileSize());
+  }
+}
+
+void Engine::SetTiledRendering(bool is_enabled, Si32 thread_count) {
+  if (is_enabled) {
+    tiled_rasterizer_.Start(backbuffer_texture_, thread_count);
+  } else {
+    tiled_rasterizer_.Stop();
+  }
+}
+
+void Engine::SetStreamingUpload(bool is_enabled) {
+  is_streaming_upload_ = is_enabled;
+}
+
+void Engine::SetHwBackbufferDirect(bool is_enabled) {
+  is_hw_backbuffer_direct_ = is_enabled;
 }
 
 double Engine::GetTime() {
@@ -350,6 +532,9 @@ Vec2Si32 Engine::MouseToBackbuffer(Vec2F pos) const {
 }
 
 void Engine::OnWindowResize(Si32 width, Si32 height) {
+  if (width_ != width || height_ != height) {
+    is_backbuffer_quad_dirty_ = true;
+  }
   width_ = width;
   height_ = height;
 }
@@ -359,6 +544,9 @@ Vec2Si32 Engine::GetWindowSize() const {
 }
 
 void Engine::SetInverseY(bool is_inverse) {
+  if (is_inverse_y_ != is_inverse) {
+    is_backbuffer_quad_dirty_ = true;
+  }
   is_inverse_y_ = is_inverse;
 }
 
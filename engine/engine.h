@@ -32,11 +32,19 @@
 #include "engine/arctic_platform.h"
 #include "engine/easy_sprite.h"
 #include "engine/easy_hw_sprite.h"
+#include "engine/easy_hw_sprite_atlas.h"
+#include "engine/easy_hw_sprite_batch.h"
+#include "engine/easy_hw_sprite_instancer.h"
+#include "engine/easy_hw_sprite_pool.h"
+#include "engine/easy_hw_sprite_readback.h"
+#include "engine/easy_hw_sprite_upload_queue.h"
 #include "engine/vec2f.h"
 #include "engine/opengl.h"
 #include "engine/gl_texture2d.h"
 #include "engine/gl_program.h"
 #include "engine/gl_buffer.h"
+#include "engine/gl_pixel_buffer_ring.h"
+#include "engine/tiled_rasterizer.h"
 
 namespace arctic {
 
@@ -57,18 +65,24 @@ class Engine {
   Si32 width_ = 0;
   Si32 height_ = 0;
   GlTexture2D gl_backbuffer_texture_;
+  GlPixelBufferRing backbuffer_upload_ring_;
+  bool is_streaming_upload_ = true;
+  std::vector<RectSi32> upload_rects_;
   Sprite backbuffer_texture_;
   HwSprite hw_backbuffer_texture_;
-
-  std::vector<Ui8> visible_verts_;
-  std::vector<Ui8> visible_normals_;
-  std::vector<Ui8> tex_coords_;
-  std::vector<Ui8> visible_indices_;
-
-  Si32 verts_ = 0;
-  Si32 normals_ = 0;
-  Si32 tex_ = 0;
-  Si32 indices_ = 0;
+  HwSpriteBatch hw_sprite_batch_;
+  HwSpriteInstancer hw_sprite_instancer_;
+  HwSpriteAtlas hw_sprite_atlas_;
+  HwSpritePool hw_sprite_pool_;
+  HwSpriteUploadQueue hw_sprite_upload_queue_;
+  HwSpriteReadbackQueue hw_sprite_readback_queue_;
+  TiledRasterizer tiled_rasterizer_;
+
+  GlBuffer backbuffer_quad_;
+  bool is_backbuffer_quad_dirty_ = true;
+  bool is_backbuffer_quad_full_ = false;
+  bool is_hw_backbuffer_direct_ = false;
+  Si32 window_alpha_bits_ = -1;
 
   std::chrono::high_resolution_clock::time_point start_time_;
   double time_correction_;
@@ -86,10 +100,21 @@ class Engine {
 
   std::shared_ptr<GlProgram> copy_backbuffers_program_;
   std::shared_ptr<GlProgram> default_sprite_program_;
+  std::shared_ptr<GlProgram> batch_sprite_program_;
+  std::shared_ptr<GlProgram> instanced_sprite_program_;
 
   std::vector<const char*> cmd_line_argv_;
   std::vector<std::string> cmd_line_arguments_;
 
+  /// @brief Uploads the changed rectangles of the backbuffer to the GPU.
+  void UploadBackbuffer();
+  /// @brief Rebuilds the quad the backbuffers are drawn to the window with.
+  void UpdateBackbufferQuad();
+  /// @brief Returns true if the hw backbuffer should be the window itself.
+  bool IsHwBackbufferDirect();
+  /// @brief Makes the hw backbuffer a render target or the window target.
+  void CreateHwBackbuffer();
+
  public:
   void SetArgcArgv(Si64 argc, const char **argv);
   void SetArgcArgvW(Si64 argc, const wchar_t **argv);
@@ -108,6 +133,30 @@ class Engine {
   HwSprite &GetHwBackbuffer() {
       return hw_backbuffer_texture_;
   }
+  HwSpriteBatch &GetHwSpriteBatch() {
+    return hw_sprite_batch_;
+  }
+  HwSpriteInstancer &GetHwSpriteInstancer() {
+    return hw_sprite_instancer_;
+  }
+  HwSpriteAtlas &GetHwSpriteAtlas() {
+    return hw_sprite_atlas_;
+  }
+  HwSpritePool &GetHwSpritePool() {
+    return hw_sprite_pool_;
+  }
+  HwSpriteUploadQueue &GetHwSpriteUploadQueue() {
+    return hw_sprite_upload_queue_;
+  }
+  HwSpriteReadbackQueue &GetHwSpriteReadbackQueue() {
+    return hw_sprite_readback_queue_;
+  }
+  TiledRasterizer &GetTiledRasterizer() {
+    return tiled_rasterizer_;
+  }
+  void SetTiledRendering(bool is_enabled, Si32 thread_count);
+  void SetStreamingUpload(bool is_enabled);
+  void SetHwBackbufferDirect(bool is_enabled);
   void ResizeBackbuffer(const Si32 width, const Si32 height);
   double GetTime();
   Si64 GetRandom(Si64 min, Si64 max);
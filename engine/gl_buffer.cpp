@@ -27,32 +27,30 @@
 
 #include <sstream>
 #include "engine/arctic_platform.h"
+#include "engine/gl_state.h"
 #include "engine/log.h"
 #include "engine/rgba.h"
 #include "engine/opengl.h"
 
 namespace arctic {
 
-GLuint GlBuffer::current_buffer_id_ = 0;
-
 GlBuffer::GlBuffer() : buffer_id_(0), size_(0) {
 }
 
 GlBuffer::~GlBuffer() {
+    GlState::OnBufferDeleted(buffer_id_);
     ARCTIC_GL_CHECK_ERROR(glDeleteBuffers(1, &buffer_id_));
 }
 
 void GlBuffer::Create(const void *data, size_t size) {
+    GlState::OnBufferDeleted(buffer_id_);
     ARCTIC_GL_CHECK_ERROR(glDeleteBuffers(1, &buffer_id_));
     ARCTIC_GL_CHECK_ERROR(glGenBuffers(1, &buffer_id_));
     SetData(data, size);
 }
 
 void GlBuffer::Bind() const {
-    if (current_buffer_id_ != buffer_id_) {
-        current_buffer_id_ = buffer_id_;
-        ARCTIC_GL_CHECK_ERROR(glBindBuffer(GL_ARRAY_BUFFER, buffer_id_));
-    }
+    GlState::BindArrayBuffer(buffer_id_);
 }
 
 void GlBuffer::SetData(const void *data, size_t size) {
@@ -66,11 +64,14 @@ void GlBuffer::UpdateData(const void *data) {
     ARCTIC_GL_CHECK_ERROR(glBufferSubData(GL_ARRAY_BUFFER, 0, size_, data));
 }
 
+void GlBuffer::StreamData(const void *data, size_t size) {
+    Bind();
+    ARCTIC_GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STREAM_DRAW));
+    size_ = size;
+}
+
 void GlBuffer::BindDefault() {
-    if (current_buffer_id_ != 0) {
-        current_buffer_id_ = 0;
-        ARCTIC_GL_CHECK_ERROR(glBindBuffer(GL_ARRAY_BUFFER, 0));
-    }
+    GlState::BindArrayBuffer(0);
 }
 
 }  // namespace arctic
@@ -42,8 +42,6 @@ class GlBuffer {
   GLuint buffer_id_;
   size_t size_;
 
-  static GLuint current_buffer_id_;
-
  public:
   GlBuffer();
   ~GlBuffer();
@@ -52,6 +50,9 @@ class GlBuffer {
   void Bind() const;
   void SetData(const void *data, size_t size);
   void UpdateData(const void *data);
+  /// @brief Replaces the whole buffer with new storage of the given size.
+  /// The old storage is orphaned, so the GPU may still be reading it.
+  void StreamData(const void *data, size_t size);
 
   bool IsValid() const {
     return buffer_id_ != 0;
@@ -27,25 +27,26 @@
 
 #include <sstream>
 #include "engine/arctic_platform.h"
+#include "engine/gl_state.h"
 #include "engine/log.h"
 #include "engine/rgba.h"
 #include "engine/opengl.h"
 
 namespace arctic {
 
-GLuint GlFramebuffer::current_framebuffer_id_ = 0;
-
 GlFramebuffer::GlFramebuffer()
     : framebuffer_id_(0) {
 }
 
 GlFramebuffer::~GlFramebuffer() {
+    GlState::OnFramebufferDeleted(framebuffer_id_);
     ARCTIC_GL_CHECK_ERROR(glDeleteFramebuffers(1, &framebuffer_id_));
 }
 
 void GlFramebuffer::Create(GlTexture2D &texture) {
     if (framebuffer_id_ != 0) {
-        ARCTIC_GL_CHECK_ERROR(glDeleteFramebuffers(1, &framebuffer_id_));
+        GlState::OnFramebufferDeleted(framebuffer_id_);
+    ARCTIC_GL_CHECK_ERROR(glDeleteFramebuffers(1, &framebuffer_id_));
     }
 
     ARCTIC_GL_CHECK_ERROR(glGenFramebuffers(1, &framebuffer_id_));
@@ -72,16 +73,11 @@ void GlFramebuffer::Create(GlTexture2D &texture) {
 }
 
 void GlFramebuffer::Bind() {
-    if (current_framebuffer_id_ != framebuffer_id_) {
-        current_framebuffer_id_ = framebuffer_id_;
-        ARCTIC_GL_CHECK_ERROR(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id_));
-    }
+    GlState::BindFramebuffer(framebuffer_id_);
 }
 
 void GlFramebuffer::BindDefault() {
-    if (current_framebuffer_id_ != 0) {
-        current_framebuffer_id_ = 0;
-        ARCTIC_GL_CHECK_ERROR(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    if (GlState::BindFramebuffer(0)) {
         auto code = glCheckFramebufferStatus(GL_FRAMEBUFFER);
         switch(code) {
           case GL_FRAMEBUFFER_COMPLETE:
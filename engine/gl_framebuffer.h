@@ -41,8 +41,6 @@ private:
 
     GLuint framebuffer_id_;
 
-    static GLuint current_framebuffer_id_;
-
  public:
   GlFramebuffer();
   ~GlFramebuffer();
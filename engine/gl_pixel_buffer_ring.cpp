@@ -0,0 +1,217 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/gl_pixel_buffer_ring.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include "engine/arctic_platform.h"
+#include "engine/gl_state.h"
+#include "engine/log.h"
+#include "engine/rgba.h"
+#include "engine/opengl.h"
+
+namespace arctic {
+
+GlPixelBufferRing::GlPixelBufferRing() {
+}
+
+GlPixelBufferRing::~GlPixelBufferRing() {
+    Destroy();
+}
+
+bool GlPixelBufferRing::IsSupported() {
+#ifdef ARCTIC_GL_PIXEL_BUFFERS
+#ifdef ARCTIC_PLATFORM_WINDOWS
+    if (!glMapBufferRange || !glUnmapBuffer || !glFenceSync
+            || !glClientWaitSync || !glDeleteSync) {
+        return false;
+    }
+#endif  // ARCTIC_PLATFORM_WINDOWS
+    const char *version = reinterpret_cast<const char*>(
+        glGetString(GL_VERSION));
+    int major = 0;
+    int minor = 0;
+    if (!version || sscanf(version, "%d.%d", &major, &minor) != 2) {
+        return false;
+    }
+    return major > 3 || (major == 3 && minor >= 2);
+#else
+    return false;
+#endif  // ARCTIC_GL_PIXEL_BUFFERS
+}
+
+void GlPixelBufferRing::Create(Si32 width, Si32 height) {
+    Destroy();
+#ifdef ARCTIC_GL_PIXEL_BUFFERS
+    width_ = width;
+    height_ = height;
+    const size_t size = static_cast<size_t>(width) * height * sizeof(Rgba);
+    for (Slot &slot : slots_) {
+        ARCTIC_GL_CHECK_ERROR(glGenBuffers(1, &slot.buffer_id));
+        GlState::BindPixelUnpackBuffer(slot.buffer_id);
+        ARCTIC_GL_CHECK_ERROR(glBufferData(GL_PIXEL_UNPACK_BUFFER, size,
+            nullptr, GL_STREAM_DRAW));
+    }
+    GlState::BindPixelUnpackBuffer(0);
+    next_slot_ = 0;
+#endif  // ARCTIC_GL_PIXEL_BUFFERS
+}
+
+void GlPixelBufferRing::Destroy() {
+#ifdef ARCTIC_GL_PIXEL_BUFFERS
+    for (Slot &slot : slots_) {
+        if (slot.fence) {
+            ARCTIC_GL_CHECK_ERROR(glDeleteSync(
+                static_cast<GLsync>(slot.fence)));
+            slot.fence = nullptr;
+        }
+        if (slot.buffer_id) {
+            GlState::OnBufferDeleted(slot.buffer_id);
+            ARCTIC_GL_CHECK_ERROR(glDeleteBuffers(1, &slot.buffer_id));
+            slot.buffer_id = 0;
+        }
+    }
+#endif  // ARCTIC_GL_PIXEL_BUFFERS
+    width_ = 0;
+    height_ = 0;
+}
+
+void GlPixelBufferRing::Upload(GlTexture2D &texture, const void *data,
+        const std::vector<RectSi32> &rects) {
+#ifdef ARCTIC_GL_PIXEL_BUFFERS
+    Slot &slot = NextSlot();
+    const size_t stride = static_cast<size_t>(width_) * sizeof(Rgba);
+    const Ui8 *src = static_cast<const Ui8*>(data);
+    GlState::BindPixelUnpackBuffer(slot.buffer_id);
+    Ui8 *dst = nullptr;
+    ARCTIC_GL_CHECK_ERROR(dst = static_cast<Ui8*>(glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, 0, stride * height_,
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT)));
+    if (!dst) {
+        for (const RectSi32 &rect : rects) {
+            texture.UpdateData(data, rect.begin, rect.end);
+        }
+        return;
+    }
+    for (const RectSi32 &rect : rects) {
+        const size_t offset = static_cast<size_t>(rect.begin.y) * stride
+            + static_cast<size_t>(rect.begin.x) * sizeof(Rgba);
+        const size_t size = static_cast<size_t>(rect.end.x - rect.begin.x)
+            * sizeof(Rgba);
+        for (Si32 y = rect.begin.y; y < rect.end.y; ++y) {
+            const size_t row = offset + (y - rect.begin.y) * stride;
+            memcpy(dst + row, src + row, size);
+        }
+    }
+    GLboolean is_unmapped = GL_FALSE;
+    ARCTIC_GL_CHECK_ERROR(is_unmapped = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+    if (!is_unmapped) {
+        *Log() << "Pixel buffer contents lost, uploading directly";
+        for (const RectSi32 &rect : rects) {
+            texture.UpdateData(data, rect.begin, rect.end);
+        }
+        return;
+    }
+
+    // With a pixel buffer bound the data pointer is an offset into it.
+    // Texture uploads from client memory unbind the buffer themselves.
+    texture.Bind(0);
+    GlState::SetUnpackRowLength(width_);
+    for (const RectSi32 &rect : rects) {
+        const size_t offset = static_cast<size_t>(rect.begin.y) * stride
+            + static_cast<size_t>(rect.begin.x) * sizeof(Rgba);
+        ARCTIC_GL_CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_2D, 0,
+            rect.begin.x, rect.begin.y,
+            rect.end.x - rect.begin.x, rect.end.y - rect.begin.y,
+            GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(offset)));
+    }
+    GLsync fence = nullptr;
+    ARCTIC_GL_CHECK_ERROR(fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,
+        0));
+    slot.fence = fence;
+#else
+    for (const RectSi32 &rect : rects) {
+        texture.UpdateData(data, rect.begin, rect.end);
+    }
+#endif  // ARCTIC_GL_PIXEL_BUFFERS
+}
+
+void GlPixelBufferRing::UploadSubData(GlTexture2D &texture, const void *data,
+        Vec2Si32 pos, Vec2Si32 size) {
+#ifdef ARCTIC_GL_PIXEL_BUFFERS
+    const size_t bytes = static_cast<size_t>(size.x) * size.y * sizeof(Rgba);
+    if (!IsValid() || bytes > Capacity()) {
+        texture.UpdateSubData(data, pos, size);
+        return;
+    }
+    Slot &slot = NextSlot();
+    GlState::BindPixelUnpackBuffer(slot.buffer_id);
+    Ui8 *dst = nullptr;
+    ARCTIC_GL_CHECK_ERROR(dst = static_cast<Ui8*>(glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT)));
+    if (!dst) {
+        texture.UpdateSubData(data, pos, size);
+        return;
+    }
+    memcpy(dst, data, bytes);
+    GLboolean is_unmapped = GL_FALSE;
+    ARCTIC_GL_CHECK_ERROR(is_unmapped = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+    if (!is_unmapped) {
+        texture.UpdateSubData(data, pos, size);
+        return;
+    }
+    texture.Bind(0);
+    GlState::SetUnpackRowLength(0);
+    ARCTIC_GL_CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y,
+        size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+    GLsync fence = nullptr;
+    ARCTIC_GL_CHECK_ERROR(fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,
+        0));
+    slot.fence = fence;
+#else
+    texture.UpdateSubData(data, pos, size);
+#endif  // ARCTIC_GL_PIXEL_BUFFERS
+}
+
+GlPixelBufferRing::Slot &GlPixelBufferRing::NextSlot() {
+    Slot &slot = slots_[next_slot_];
+    next_slot_ = (next_slot_ + 1) % kBufferCount;
+#ifdef ARCTIC_GL_PIXEL_BUFFERS
+    // Wait until the GPU is done with the previous upload from this buffer.
+    if (slot.fence) {
+        const GLsync fence = static_cast<GLsync>(slot.fence);
+        GLenum result = GL_TIMEOUT_EXPIRED;
+        while (result == GL_TIMEOUT_EXPIRED) {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                1000000000ull);
+        }
+        ARCTIC_GL_CHECK_ERROR(glDeleteSync(fence));
+        slot.fence = nullptr;
+    }
+#endif  // ARCTIC_GL_PIXEL_BUFFERS
+    return slot;
+}
+
+}  // namespace arctic
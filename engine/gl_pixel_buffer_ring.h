@@ -0,0 +1,105 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_GL_PIXEL_BUFFER_RING_H_
+#define ENGINE_GL_PIXEL_BUFFER_RING_H_
+
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/opengl.h"
+#include "engine/easy_sprite_instance.h"
+#include "engine/gl_texture2d.h"
+
+// OpenGL ES 2 has no pixel buffers and the legacy macOS context has no fences.
+#if defined(ARCTIC_PLATFORM_WINDOWS) || defined(ARCTIC_PLATFORM_PI_OPENGL_GLX)
+#define ARCTIC_GL_PIXEL_BUFFERS
+#endif
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief Streams texture uploads through a ring of pixel unpack buffers.
+/// Each upload goes to the next buffer of the ring and is fenced, so the
+/// driver copies the pixels asynchronously and the CPU only waits if it laps
+/// the GPU by the whole ring.
+class GlPixelBufferRing {
+ public:
+  static const Si32 kBufferCount = 3;
+
+ private:
+  GlPixelBufferRing(GlPixelBufferRing &other) = delete;
+  GlPixelBufferRing(GlPixelBufferRing &&other) = delete;
+  GlPixelBufferRing &operator=(GlPixelBufferRing &other) = delete;
+  GlPixelBufferRing &operator=(GlPixelBufferRing &&other) = delete;
+
+  struct Slot {
+    GLuint buffer_id = 0;
+    void *fence = nullptr;
+  };
+
+  Slot slots_[kBufferCount];
+  Si32 next_slot_ = 0;
+  Si32 width_ = 0;
+  Si32 height_ = 0;
+
+  /// @brief Advances the ring, waits for the GPU to finish with the slot.
+  Slot &NextSlot();
+
+ public:
+  GlPixelBufferRing();
+  ~GlPixelBufferRing();
+
+  /// @brief Returns true if the current OpenGL context has pixel unpack
+  /// buffers, buffer mapping and fences.
+  static bool IsSupported();
+
+  /// @brief Creates the buffers for width x height Rgba textures.
+  void Create(Si32 width, Si32 height);
+  void Destroy();
+  /// @brief Uploads the rectangles of the data to the texture.
+  /// @param [in] data The pixels of the whole texture.
+  /// @param [in] rects The [begin, end) rectangles to upload.
+  void Upload(GlTexture2D &texture, const void *data,
+    const std::vector<RectSi32> &rects);
+  /// @brief Uploads the size.x by size.y rectangle of the texture at pos.
+  /// Rectangles larger than a buffer are uploaded directly.
+  /// @param [in] data The pixels of the rectangle only, rows without gaps.
+  void UploadSubData(GlTexture2D &texture, const void *data,
+    Vec2Si32 pos, Vec2Si32 size);
+
+  bool IsValid() const {
+    return slots_[0].buffer_id != 0;
+  }
+  /// @brief Size of each buffer in bytes.
+  size_t Capacity() const {
+    return static_cast<size_t>(width_) * height_ * sizeof(Rgba);
+  }
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_GL_PIXEL_BUFFER_RING_H_
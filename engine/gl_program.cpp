@@ -27,13 +27,15 @@
 
 #include <sstream>
 #include "engine/arctic_platform.h"
+#include "engine/gl_program_cache.h"
+#include "engine/gl_state.h"
 #include "engine/log.h"
 #include "engine/opengl.h"
 #include <cstring>
 
 namespace arctic {
 
-GLuint GlProgram::current_program_id_ = 0;
+Ui64 GlProgram::next_serial_ = 0;
 
 GLuint LoadShader(const char *shaderSrc, GLenum type) {
     // Create the shader object
@@ -70,7 +72,9 @@ GLuint LoadShader(const char *shaderSrc, GLenum type) {
 
 
 GlProgram::GlProgram()
-    : program_id_(0) {
+    : program_id_(0)
+    , serial_(0)
+    , active_uniform_count_(0) {
 }
 
 GlProgram::~GlProgram() {
@@ -82,19 +86,29 @@ void GlProgram::Create(const char *vs_src, const char *fs_src) {
         ARCTIC_GL_CHECK_ERROR(glDeleteProgram(program_id_));
     }
 
-    // Load the vertex/fragment shaders
-    GLuint vertexShader = LoadShader(vs_src, GL_VERTEX_SHADER);
-    GLuint fragmentShader = LoadShader(fs_src, GL_FRAGMENT_SHADER);
     // Create the program object
     ARCTIC_GL_CHECK_ERROR(program_id_ = glCreateProgram());
     if (program_id_ == 0) {
         Fatal("Unknown error creating program");
     }
+    const Ui64 key = GlProgramCache::Hash(vs_src, fs_src);
+    if (GlProgramCache::Load(key, program_id_)) {
+        serial_ = ++next_serial_;
+        ResolveUniforms();
+        return;
+    }
+
+    // Load the vertex/fragment shaders
+    GLuint vertexShader = LoadShader(vs_src, GL_VERTEX_SHADER);
+    GLuint fragmentShader = LoadShader(fs_src, GL_FRAGMENT_SHADER);
     ARCTIC_GL_CHECK_ERROR(glAttachShader(program_id_, vertexShader));
     ARCTIC_GL_CHECK_ERROR(glAttachShader(program_id_, fragmentShader));
     // Bind vPosition to attribute 0
     ARCTIC_GL_CHECK_ERROR(glBindAttribLocation(program_id_, 0, "vPosition"));
     ARCTIC_GL_CHECK_ERROR(glBindAttribLocation(program_id_, 1, "vTex"));
+    ARCTIC_GL_CHECK_ERROR(glBindAttribLocation(program_id_, 2, "vColor"));
+    ARCTIC_GL_CHECK_ERROR(glBindAttribLocation(program_id_, 3, "vInstance"));
+    GlProgramCache::PrepareToLink(program_id_);
     // Link the program
     ARCTIC_GL_CHECK_ERROR(glLinkProgram(program_id_));
     // Check the link status
@@ -112,86 +126,141 @@ void GlProgram::Create(const char *vs_src, const char *fs_src) {
         ARCTIC_GL_CHECK_ERROR(glDeleteProgram(program_id_));
         Fatal("Unknown error linking program");
     }
+    GlProgramCache::Save(key, program_id_);
+    serial_ = ++next_serial_;
+    ResolveUniforms();
+}
+
+void GlProgram::ResolveUniforms() {
+    uniform_locations_.clear();
+    uniform_values_.clear();
+    GLint count = 0;
+    ARCTIC_GL_CHECK_ERROR(glGetProgramiv(program_id_, GL_ACTIVE_UNIFORMS, &count));
+    GLint max_length = 0;
+    ARCTIC_GL_CHECK_ERROR(glGetProgramiv(program_id_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length));
+    std::string buffer;
+    buffer.resize(static_cast<size_t>(max_length) + 1);
+    for (GLint idx = 0; idx < count; ++idx) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        ARCTIC_GL_CHECK_ERROR(glGetActiveUniform(program_id_, static_cast<GLuint>(idx),
+            max_length + 1, &length, &size, &type, &buffer.front()));
+        std::string name(buffer.data(), static_cast<size_t>(length));
+        GLint loc;
+        ARCTIC_GL_CHECK_ERROR(loc = glGetUniformLocation(program_id_, name.c_str()));
+        uniform_locations_[name] = loc;
+        // Arrays are listed as "name[0]", but are set by the plain name too.
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+            uniform_locations_[name.substr(0, name.size() - 3)] = loc;
+        }
+    }
+    active_uniform_count_ = count;
 }
 
-void GlProgram::Bind() {
-    if (current_program_id_ != program_id_) {
-        current_program_id_ = program_id_;
-        ARCTIC_GL_CHECK_ERROR(glUseProgram(program_id_));
+bool GlProgram::IsUniformChanged(int id, Si32 kind, const void *data, size_t size) {
+    UniformValue &cached = uniform_values_[id];
+    if (cached.kind == kind && memcmp(cached.bytes, data, size) == 0) {
+        return false;
     }
+    cached.kind = kind;
+    memcpy(cached.bytes, data, size);
+    return true;
+}
+
+void GlProgram::Bind() {
+    GlState::UseProgram(program_id_);
 }
 
 void GlProgram::SetUniform(int id, int value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform1i(id, value));
+    if (IsUniformChanged(id, GL_INT, &value, sizeof(value))) {
+        ARCTIC_GL_CHECK_ERROR(glUniform1i(id, value));
+    }
 }
 
 void GlProgram::SetUniform(int id, const Vec2Si32 &value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform2i(id, value.x, value.y));
+    if (IsUniformChanged(id, GL_INT_VEC2, &value, sizeof(value))) {
+        ARCTIC_GL_CHECK_ERROR(glUniform2i(id, value.x, value.y));
+    }
 }
 
 void GlProgram::SetUniform(int id, const Vec3Si32 &value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform3i(id, value.x, value.y, value.z));
+    if (IsUniformChanged(id, GL_INT_VEC3, &value, sizeof(value))) {
+        ARCTIC_GL_CHECK_ERROR(glUniform3i(id, value.x, value.y, value.z));
+    }
 }
 
 void GlProgram::SetUniform(int id, const Vec4Si32 &value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform4i(id, value.x, value.y, value.z, value.w));
+    if (IsUniformChanged(id, GL_INT_VEC4, &value, sizeof(value))) {
+        ARCTIC_GL_CHECK_ERROR(glUniform4i(id, value.x, value.y, value.z, value.w));
+    }
 }
 
 void GlProgram::SetUniform(int id, float value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform1f(id, value));
+    if (IsUniformChanged(id, GL_FLOAT, &value, sizeof(value))) {
+        ARCTIC_GL_CHECK_ERROR(glUniform1f(id, value));
+    }
 }
 
 void GlProgram::SetUniform(int id, const Vec2F &value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform2f(id, value.x, value.y));
+    if (IsUniformChanged(id, GL_FLOAT_VEC2, &value, sizeof(value))) {
+        ARCTIC_GL_CHECK_ERROR(glUniform2f(id, value.x, value.y));
+    }
 }
 
 void GlProgram::SetUniform(int id, const Vec3F &value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform3f(id, value.x, value.y, value.z));
+    if (IsUniformChanged(id, GL_FLOAT_VEC3, &value, sizeof(value))) {
+        ARCTIC_GL_CHECK_ERROR(glUniform3f(id, value.x, value.y, value.z));
+    }
 }
 
 void GlProgram::SetUniform(int id, const Vec4F &value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform4f(id, value.x, value.y, value.z, value.w));
+    if (IsUniformChanged(id, GL_FLOAT_VEC4, &value, sizeof(value))) {
+        ARCTIC_GL_CHECK_ERROR(glUniform4f(id, value.x, value.y, value.z, value.w));
+    }
 }
 
 void GlProgram::SetUniform(const char *name, int value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform1i(GetUniformLocation(name), value));
+    SetUniform(GetUniformLocation(name), value);
 }
 
 void GlProgram::SetUniform(const char *name, const Vec2Si32 &value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform2i(GetUniformLocation(name), value.x, value.y));
+    SetUniform(GetUniformLocation(name), value);
 }
 
 void GlProgram::SetUniform(const char *name, const Vec3Si32 &value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform3i(GetUniformLocation(name), value.x, value.y, value.z));
+    SetUniform(GetUniformLocation(name), value);
 }
 
 void GlProgram::SetUniform(const char *name, const Vec4Si32 &value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform4i(GetUniformLocation(name), value.x, value.y, value.z, value.w));
+    SetUniform(GetUniformLocation(name), value);
 }
 
 void GlProgram::SetUniform(const char *name, float value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform1f(GetUniformLocation(name), value));
+    SetUniform(GetUniformLocation(name), value);
 }
 
 void GlProgram::SetUniform(const char *name, const Vec2F &value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform2f(GetUniformLocation(name), value.x, value.y));
+    SetUniform(GetUniformLocation(name), value);
 }
 
 void GlProgram::SetUniform(const char *name, const Vec3F &value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform3f(GetUniformLocation(name), value.x, value.y, value.z));
+    SetUniform(GetUniformLocation(name), value);
 }
 
 void GlProgram::SetUniform(const char *name, const Vec4F &value) {
-    ARCTIC_GL_CHECK_ERROR(glUniform4f(GetUniformLocation(name), value.x, value.y, value.z, value.w));
+    SetUniform(GetUniformLocation(name), value);
 }
 
 void GlProgram::CheckActiveUniforms(int required_count) {
-    GLint ufs;
-    ARCTIC_GL_CHECK_ERROR(glGetProgramiv(program_id_, GL_ACTIVE_UNIFORMS, &ufs));
-    Check(ufs == required_count, "Number of active uniforms does not match the required_count");
+    Check(active_uniform_count_ == required_count, "Number of active uniforms does not match the required_count");
 }
 
 int GlProgram::GetUniformLocation(const char *name) const {
+    auto it = uniform_locations_.find(name);
+    if (it != uniform_locations_.end()) {
+        return it->second;
+    }
     GLint loc;
     ARCTIC_GL_CHECK_ERROR(loc = glGetUniformLocation(program_id_, name));
     Check(loc >= 0, name, " not found");
@@ -200,44 +269,50 @@ int GlProgram::GetUniformLocation(const char *name) const {
 
 
 
-UniformsTable::UniformData::UniformData() : type(UniformDataType::Int), value({ 0 }) {
+UniformsTable::UniformData::UniformData() : type(UniformDataType::Int), location(-1), value({ 0 }) {
 }
 
 UniformsTable::UniformData &UniformsTable::UniformData::operator=(const UniformData &other) {
     type = other.type;
+    location = other.location;
     memcpy(&value, &other.value, sizeof(value));
     return *this;
 }
 
 void UniformsTable::Apply(GlProgram &program) const {
+    if (resolved_serial_ != program.Serial()) {
+        for (auto &uniform : table_) {
+            uniform.second.location = program.GetUniformLocation(uniform.first.c_str());
+        }
+        resolved_serial_ = program.Serial();
+    }
     for (auto &uniform : table_) {
-        auto &name = uniform.first;
         auto &data = uniform.second;
 
         switch (data.type) {
             case UniformDataType::Int:
-                program.SetUniform(name.data(), data.value.i);
+                program.SetUniform(data.location, data.value.i);
                 break;
             case UniformDataType::Int2:
-                program.SetUniform(name.data(), data.value.i2);
+                program.SetUniform(data.location, data.value.i2);
                 break;
             case UniformDataType::Int3:
-                program.SetUniform(name.data(), data.value.i3);
+                program.SetUniform(data.location, data.value.i3);
                 break;
             case UniformDataType::Int4:
-                program.SetUniform(name.data(), data.value.i4);
+                program.SetUniform(data.location, data.value.i4);
                 break;
             case UniformDataType::Float:
-                program.SetUniform(name.data(), data.value.f);
+                program.SetUniform(data.location, data.value.f);
                 break;
             case UniformDataType::Float2:
-                program.SetUniform(name.data(), data.value.f2);
+                program.SetUniform(data.location, data.value.f2);
                 break;
             case UniformDataType::Float3:
-                program.SetUniform(name.data(), data.value.f3);
+                program.SetUniform(data.location, data.value.f3);
                 break;
             case UniformDataType::Float4:
-                program.SetUniform(name.data(), data.value.f4);
+                program.SetUniform(data.location, data.value.f4);
                 break;
         }
     }
@@ -245,6 +320,7 @@ void UniformsTable::Apply(GlProgram &program) const {
 
 void UniformsTable::Clear() {
     table_.clear();
+    resolved_serial_ = 0;
 }
 
 void UniformsTable::SetUniform(const std::string &name, int value) {
@@ -252,6 +328,7 @@ void UniformsTable::SetUniform(const std::string &name, int value) {
     data.type = UniformDataType::Int;
     data.value.i = value;
     table_.insert(std::make_pair(name, data));
+    resolved_serial_ = 0;
 }
 
 void UniformsTable::SetUniform(const std::string &name, const Vec2Si32 &value) {
@@ -259,6 +336,7 @@ void UniformsTable::SetUniform(const std::string &name, const Vec2Si32 &value) {
     data.type = UniformDataType::Int2;
     data.value.i2 = value;
     table_.insert(std::make_pair(name, data));
+    resolved_serial_ = 0;
 }
 
 void UniformsTable::SetUniform(const std::string &name, const Vec3Si32 &value) {
@@ -266,6 +344,7 @@ void UniformsTable::SetUniform(const std::string &name, const Vec3Si32 &value) {
     data.type = UniformDataType::Int3;
     data.value.i3 = value;
     table_.insert(std::make_pair(name, data));
+    resolved_serial_ = 0;
 }
 
 void UniformsTable::SetUniform(const std::string &name, const Vec4Si32 &value) {
@@ -273,6 +352,7 @@ void UniformsTable::SetUniform(const std::string &name, const Vec4Si32 &value) {
     data.type = UniformDataType::Int4;
     data.value.i4 = value;
     table_.insert(std::make_pair(name, data));
+    resolved_serial_ = 0;
 }
 
 void UniformsTable::SetUniform(const std::string &name, float value) {
@@ -280,6 +360,7 @@ void UniformsTable::SetUniform(const std::string &name, float value) {
     data.type = UniformDataType::Float;
     data.value.f = value;
     table_.insert(std::make_pair(name, data));
+    resolved_serial_ = 0;
 }
 
 void UniformsTable::SetUniform(const std::string &name, const Vec2F &value) {
@@ -287,6 +368,7 @@ void UniformsTable::SetUniform(const std::string &name, const Vec2F &value) {
     data.type = UniformDataType::Float2;
     data.value.f2 = value;
     table_.insert(std::make_pair(name, data));
+    resolved_serial_ = 0;
 }
 
 void UniformsTable::SetUniform(const std::string &name, const Vec3F &value) {
@@ -294,6 +376,7 @@ void UniformsTable::SetUniform(const std::string &name, const Vec3F &value) {
     data.type = UniformDataType::Float3;
     data.value.f3 = value;
     table_.insert(std::make_pair(name, data));
+    resolved_serial_ = 0;
 }
 
 void UniformsTable::SetUniform(const std::string &name, const Vec4F &value) {
@@ -301,6 +384,7 @@ void UniformsTable::SetUniform(const std::string &name, const Vec4F &value) {
     data.type = UniformDataType::Float4;
     data.value.f4 = value;
     table_.insert(std::make_pair(name, data));
+    resolved_serial_ = 0;
 }
 
 size_t UniformsTable::Size() const {
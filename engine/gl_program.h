@@ -25,6 +25,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "engine/arctic_types.h"
 #include "engine/arctic_math.h"
@@ -42,9 +43,24 @@ private:
   GlProgram &operator=(GlProgram &other) = delete;
   GlProgram &operator=(GlProgram &&other) = delete;
 
+  /// @brief The value last uploaded to a uniform location.
+  struct UniformValue {
+    Si32 kind = 0;
+    Ui8 bytes[16] = {};
+  };
+
   GLuint program_id_;
+  Ui64 serial_;
+  Si32 active_uniform_count_;
+  std::unordered_map<std::string, GLint> uniform_locations_;
+  std::unordered_map<GLint, UniformValue> uniform_values_;
+
+  static Ui64 next_serial_;
 
-  static GLuint current_program_id_;
+  void ResolveUniforms();
+  /// @brief Remembers the value of the uniform at the location.
+  /// @return false if the location already holds exactly this value.
+  bool IsUniformChanged(int id, Si32 kind, const void *data, size_t size);
 
  public:
   GlProgram();
@@ -70,6 +86,11 @@ private:
   void SetUniform(const char *name, const Vec4F &value);
   void CheckActiveUniforms(int required_count);
   int GetUniformLocation(const char *name) const;
+  /// @brief Changes each time the program is (re)linked, so the locations
+  /// resolved for one program are never used with another.
+  Ui64 Serial() const {
+    return serial_;
+  }
 };
 
 class UniformsTable {
@@ -90,6 +111,8 @@ class UniformsTable {
         UniformData &operator=(const UniformData &other);
 
         UniformDataType type;
+        /// @brief Location in the program the table was last applied to.
+        mutable GLint location;
         union {
             int i;
             Vec2Si32 i2;
@@ -103,6 +126,8 @@ class UniformsTable {
     };
 
     std::unordered_map<std::string, UniformData> table_;
+    /// @brief Serial of the program the locations are resolved for.
+    mutable Ui64 resolved_serial_ = 0;
 
 public:
     void Apply(GlProgram &program) const;
@@ -0,0 +1,293 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/gl_program_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "engine/arctic_platform.h"
+#include "engine/easy_files.h"
+#include "engine/gl_program.h"
+#include "engine/log.h"
+#include "engine/opengl.h"
+
+#ifdef ARCTIC_PLATFORM_PI_ES_EGL
+#include <EGL/egl.h>
+#endif  // ARCTIC_PLATFORM_PI_ES_EGL
+
+namespace arctic {
+
+namespace {
+
+const char kMagic[8] = {'A', 'R', 'C', 'T', 'P', 'R', 'G', '1'};
+
+/// @brief Precedes the binary in the file.
+struct BinaryHeader {
+    char magic[8];
+    Ui64 source_hash;
+    Ui64 driver_hash;
+    Ui32 format;
+    Ui32 size;
+};
+
+#if defined(ARCTIC_PLATFORM_PI_ES_EGL)
+PFNGLGETPROGRAMBINARYOESPROC g_get_program_binary = nullptr;
+PFNGLPROGRAMBINARYOESPROC g_program_binary = nullptr;
+const GLenum kNumProgramBinaryFormats = GL_NUM_PROGRAM_BINARY_FORMATS_OES;
+const GLenum kProgramBinaryLength = GL_PROGRAM_BINARY_LENGTH_OES;
+#elif defined(ARCTIC_GL_PROGRAM_BINARY)
+const GLenum kNumProgramBinaryFormats = GL_NUM_PROGRAM_BINARY_FORMATS;
+const GLenum kProgramBinaryLength = GL_PROGRAM_BINARY_LENGTH;
+#endif
+
+Ui64 HashBytes(Ui64 hash, const char *data, size_t size) {
+    for (size_t idx = 0; idx < size; ++idx) {
+        hash ^= static_cast<Ui8>(data[idx]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+Ui64 HashString(Ui64 hash, const char *str) {
+    // The terminating zero separates the strings hashed one after another.
+    return str ? HashBytes(hash, str, strlen(str) + 1) : hash;
+}
+
+#ifdef ARCTIC_GL_PROGRAM_BINARY
+bool HasExtension(const char *name) {
+    const char *extensions = reinterpret_cast<const char*>(
+        glGetString(GL_EXTENSIONS));
+    if (!extensions) {
+        return false;
+    }
+    const size_t length = strlen(name);
+    for (const char *pos = strstr(extensions, name); pos;
+            pos = strstr(pos + length, name)) {
+        if (pos[length] == ' ' || pos[length] == '\0') {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GetProgramBinary(GLuint program_id, GLsizei size, GLenum *format,
+        void *data) {
+#ifdef ARCTIC_PLATFORM_PI_ES_EGL
+    ARCTIC_GL_CHECK_ERROR(g_get_program_binary(program_id, size, nullptr,
+        format, data));
+#else
+    ARCTIC_GL_CHECK_ERROR(glGetProgramBinary(program_id, size, nullptr,
+        format, data));
+#endif  // ARCTIC_PLATFORM_PI_ES_EGL
+}
+
+void ProgramBinary(GLuint program_id, GLenum format, const void *data,
+        GLsizei size) {
+    // A binary of an updated driver fails with an error, which is expected.
+#ifdef ARCTIC_PLATFORM_PI_ES_EGL
+    g_program_binary(program_id, format, data, size);
+#else
+    glProgramBinary(program_id, format, data, size);
+#endif  // ARCTIC_PLATFORM_PI_ES_EGL
+    while (glGetError() != GL_NO_ERROR) {
+    }
+}
+#endif  // ARCTIC_GL_PROGRAM_BINARY
+
+}  // namespace
+
+std::string GlProgramCache::directory_ = "shader_cache";
+std::unordered_map<Ui64, std::weak_ptr<GlProgram>> GlProgramCache::programs_;
+Si32 GlProgramCache::is_binary_supported_ = -1;
+Ui64 GlProgramCache::driver_hash_ = 0;
+Si64 GlProgramCache::loaded_count_ = 0;
+Si64 GlProgramCache::compiled_count_ = 0;
+
+std::shared_ptr<GlProgram> GlProgramCache::Get(const char *vs_src,
+        const char *fs_src) {
+    std::weak_ptr<GlProgram> &cached = programs_[Hash(vs_src, fs_src)];
+    std::shared_ptr<GlProgram> program = cached.lock();
+    if (!program) {
+        program = std::make_shared<GlProgram>();
+        program->Create(vs_src, fs_src);
+        cached = program;
+    }
+    return program;
+}
+
+Ui64 GlProgramCache::Hash(const char *vs_src, const char *fs_src) {
+    Ui64 hash = 14695981039346656037ull;
+    hash = HashString(hash, vs_src);
+    hash = HashString(hash, fs_src);
+    return hash;
+}
+
+bool GlProgramCache::IsBinarySupported() {
+    if (is_binary_supported_ >= 0) {
+        return is_binary_supported_ != 0;
+    }
+    is_binary_supported_ = 0;
+#ifdef ARCTIC_GL_PROGRAM_BINARY
+#if defined(ARCTIC_PLATFORM_PI_ES_EGL)
+    if (!HasExtension("GL_OES_get_program_binary")) {
+        return false;
+    }
+    g_get_program_binary = reinterpret_cast<PFNGLGETPROGRAMBINARYOESPROC>(
+        eglGetProcAddress("glGetProgramBinaryOES"));
+    g_program_binary = reinterpret_cast<PFNGLPROGRAMBINARYOESPROC>(
+        eglGetProcAddress("glProgramBinaryOES"));
+    if (!g_get_program_binary || !g_program_binary) {
+        return false;
+    }
+#else
+#ifdef ARCTIC_PLATFORM_WINDOWS
+    if (!glGetProgramBinary || !glProgramBinary || !glProgramParameteri) {
+        return false;
+    }
+#endif  // ARCTIC_PLATFORM_WINDOWS
+    const char *version = reinterpret_cast<const char*>(
+        glGetString(GL_VERSION));
+    int major = 0;
+    int minor = 0;
+    if (!version || sscanf(version, "%d.%d", &major, &minor) != 2) {
+        return false;
+    }
+    if (major < 4 || (major == 4 && minor < 1)) {
+        if (!HasExtension("GL_ARB_get_program_binary")) {
+            return false;
+        }
+    }
+#endif  // ARCTIC_PLATFORM_PI_ES_EGL
+    GLint format_count = 0;
+    ARCTIC_GL_CHECK_ERROR(glGetIntegerv(kNumProgramBinaryFormats,
+        &format_count));
+    if (format_count <= 0) {
+        return false;
+    }
+    // A binary is only valid for the exact driver it was made by.
+    driver_hash_ = 14695981039346656037ull;
+    const GLenum kDriverStrings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    for (GLenum name : kDriverStrings) {
+        driver_hash_ = HashString(driver_hash_,
+            reinterpret_cast<const char*>(glGetString(name)));
+    }
+    is_binary_supported_ = 1;
+    return true;
+#else
+    return false;
+#endif  // ARCTIC_GL_PROGRAM_BINARY
+}
+
+void GlProgramCache::PrepareToLink(GLuint program_id) {
+#if defined(ARCTIC_GL_PROGRAM_BINARY) && !defined(ARCTIC_PLATFORM_PI_ES_EGL)
+    if (!directory_.empty() && IsBinarySupported()) {
+        ARCTIC_GL_CHECK_ERROR(glProgramParameteri(program_id,
+            GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+#endif
+}
+
+std::string GlProgramCache::FileName(Ui64 key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin",
+        static_cast<unsigned long long>(key));
+    return directory_ + "/" + name;
+}
+
+bool GlProgramCache::Load(Ui64 key, GLuint program_id) {
+#ifdef ARCTIC_GL_PROGRAM_BINARY
+    if (directory_.empty() || !IsBinarySupported()) {
+        return false;
+    }
+    std::vector<Ui8> data = ReadFile(FileName(key).c_str(), true);
+    BinaryHeader header;
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+            || header.source_hash != key
+            || header.driver_hash != driver_hash_
+            || header.size != data.size() - sizeof(header)) {
+        return false;
+    }
+    ProgramBinary(program_id, header.format, data.data() + sizeof(header),
+        static_cast<GLsizei>(header.size));
+    GLint linked = 0;
+    ARCTIC_GL_CHECK_ERROR(glGetProgramiv(program_id, GL_LINK_STATUS, &linked));
+    if (!linked) {
+        return false;
+    }
+    ++loaded_count_;
+    return true;
+#else
+    return false;
+#endif  // ARCTIC_GL_PROGRAM_BINARY
+}
+
+void GlProgramCache::Save(Ui64 key, GLuint program_id) {
+    ++compiled_count_;
+#ifdef ARCTIC_GL_PROGRAM_BINARY
+    if (directory_.empty() || !IsBinarySupported()) {
+        return;
+    }
+    GLint size = 0;
+    ARCTIC_GL_CHECK_ERROR(glGetProgramiv(program_id, kProgramBinaryLength,
+        &size));
+    if (size <= 0) {
+        return;
+    }
+    BinaryHeader header;
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.source_hash = key;
+    header.driver_hash = driver_hash_;
+    header.format = 0;
+    header.size = static_cast<Ui32>(size);
+    std::vector<Ui8> data(sizeof(header) + static_cast<size_t>(size));
+    GLenum format = 0;
+    GetProgramBinary(program_id, size, &format, data.data() + sizeof(header));
+    header.format = static_cast<Ui32>(format);
+    memcpy(data.data(), &header, sizeof(header));
+
+    // The cache is an optimization, so a read-only disk is not an error.
+    if (DoesDirectoryExist(directory_.c_str()) != kTrivalentTrue) {
+        MakeDirectory(directory_.c_str());
+    }
+    const std::string file_name = FileName(key);
+    std::ofstream out(file_name.c_str(),
+        std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+    out.write(reinterpret_cast<const char*>(data.data()),
+        static_cast<std::streamsize>(data.size()));
+    out.close();
+    if (out.fail()) {
+        *Log() << "Can't save the shader program binary to " << file_name;
+    }
+#endif  // ARCTIC_GL_PROGRAM_BINARY
+}
+
+void GlProgramCache::SetDirectory(const std::string &path) {
+    directory_ = path;
+}
+
+}  // namespace arctic
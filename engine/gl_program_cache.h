@@ -0,0 +1,101 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_GL_PROGRAM_CACHE_H_
+#define ENGINE_GL_PROGRAM_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/opengl.h"
+
+// The legacy macOS context has no program binaries, OpenGL ES 2 has them
+// only as the GL_OES_get_program_binary extension.
+#if defined(ARCTIC_PLATFORM_WINDOWS) || defined(ARCTIC_PLATFORM_PI_OPENGL_GLX) \
+    || defined(ARCTIC_PLATFORM_PI_ES_EGL)
+#define ARCTIC_GL_PROGRAM_BINARY
+#endif
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+class GlProgram;
+
+/// @brief Cache of the linked shader programs keyed by a hash of their
+/// source. Programs alive in memory are shared, the linked binaries are saved
+/// to the cache directory where the driver supports it and are loaded instead
+/// of compiling the source on the next launch. A binary the driver rejects
+/// is silently replaced with a freshly compiled one.
+class GlProgramCache {
+  static std::string directory_;
+  static std::unordered_map<Ui64, std::weak_ptr<GlProgram>> programs_;
+  static Si32 is_binary_supported_;
+  static Ui64 driver_hash_;
+  static Si64 loaded_count_;
+  static Si64 compiled_count_;
+
+  static std::string FileName(Ui64 key);
+
+ public:
+  /// @brief Returns the shared program linked from the sources, compiles
+  ///   and links it only if it is neither in memory nor on disk.
+  static std::shared_ptr<GlProgram> Get(const char *vs_src,
+    const char *fs_src);
+  /// @brief Returns the cache key of the sources.
+  static Ui64 Hash(const char *vs_src, const char *fs_src);
+  /// @brief Returns true if the linked programs can be saved and loaded.
+  static bool IsBinarySupported();
+  /// @brief Tells GL to keep the binary of the program being linked.
+  static void PrepareToLink(GLuint program_id);
+  /// @brief Replaces the program contents with the saved binary.
+  /// @return true if the binary is found and the program is linked from it.
+  static bool Load(Ui64 key, GLuint program_id);
+  /// @brief Saves the binary of the program just linked from source, if
+  ///   possible.
+  static void Save(Ui64 key, GLuint program_id);
+
+  /// @brief Sets the directory the binaries are saved to, an empty path
+  ///   disables saving and loading them. "shader_cache" by default.
+  static void SetDirectory(const std::string &path);
+  static const std::string &Directory() {
+    return directory_;
+  }
+  /// @brief Number of programs linked from saved binaries.
+  static Si64 LoadedCount() {
+    return loaded_count_;
+  }
+  /// @brief Number of programs compiled from source.
+  static Si64 CompiledCount() {
+    return compiled_count_;
+  }
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_GL_PROGRAM_CACHE_H_
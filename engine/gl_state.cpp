@@ -33,19 +33,48 @@
 
 namespace arctic {
 
+namespace {
+
+const GLuint kUnknownId = ~static_cast<GLuint>(0);
+
+}  // namespace
+
 Vec4Si32 GlState::current_viewport_ = Vec4Si32(0, 0, 0, 0);
 DrawBlendingMode GlState::current_blending_mode_ = kDrawBlendingModeCopyRgba;
+bool GlState::is_blending_mode_known_ = true;
+Ui32 GlState::current_texture_slot_ = 0;
+GLuint GlState::current_texture_id_[GlState::kMaxTextureSlots] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+std::unordered_map<GLuint, DrawFilterMode> GlState::texture_filter_modes_;
+GLuint GlState::current_program_id_ = 0;
+GLuint GlState::current_array_buffer_id_ = 0;
+GLuint GlState::current_pixel_unpack_buffer_id_ = 0;
+GLuint GlState::current_pixel_pack_buffer_id_ = 0;
+GLuint GlState::current_framebuffer_id_ = 0;
+Ui32 GlState::enabled_vertex_attribs_ = 0;
+bool GlState::is_vertex_attribs_known_ = true;
+Ui32 GlState::instanced_vertex_attribs_ = 0;
+bool GlState::is_instanced_vertex_attribs_known_ = true;
+Si32 GlState::is_scissor_test_enabled_ = 0;
+Vec4Si32 GlState::current_scissor_ = Vec4Si32(-1, -1, -1, -1);
+Rgba GlState::current_clear_color_ = Rgba(0, 0, 0, 0);
+bool GlState::is_clear_color_known_ = false;
+GLint GlState::unpack_alignment_ = 4;
+GLint GlState::pack_alignment_ = 4;
+GLint GlState::unpack_row_length_ = 0;
+Si64 GlState::issued_call_count_ = 0;
+Si64 GlState::saved_call_count_ = 0;
 
 void GlState::SetViewport(Si32 x, Si32 y, Si32 w, Si32 h) {
-    if (current_viewport_ != Vec4Si32(x, y, w, h)) {
+    if (Count(current_viewport_ != Vec4Si32(x, y, w, h))) {
         current_viewport_ = Vec4Si32(x, y, w, h);
         ARCTIC_GL_CHECK_ERROR(glViewport(x, y, w, h));
     }
 }
 
 void GlState::SetBlending(DrawBlendingMode mode) {
-    if (current_blending_mode_ != mode) {
+    if (Count(!is_blending_mode_known_ || current_blending_mode_ != mode)) {
         current_blending_mode_ = mode;
+        is_blending_mode_known_ = true;
         switch (mode) {
             case kDrawBlendingModeCopyRgba:
                 ARCTIC_GL_CHECK_ERROR(glDisable(GL_BLEND));
@@ -77,4 +106,245 @@ void GlState::SetBlending(DrawBlendingMode mode) {
     }
 }
 
+void GlState::SetBlendingUnder() {
+    Count(true);
+    // Not one of the DrawBlendingMode values, the next SetBlending resets it.
+    is_blending_mode_known_ = false;
+    ARCTIC_GL_CHECK_ERROR(glEnable(GL_BLEND));
+    ARCTIC_GL_CHECK_ERROR(glBlendFunc(GL_ONE_MINUS_DST_ALPHA, GL_ONE));
+}
+
+void GlState::SetActiveTexture(Ui32 slot) {
+    Check(slot < kMaxTextureSlots, "invalid texture slot");
+    if (Count(current_texture_slot_ != slot)) {
+        current_texture_slot_ = slot;
+        ARCTIC_GL_CHECK_ERROR(glActiveTexture(GL_TEXTURE0 + slot));
+    }
+}
+
+void GlState::BindTexture(Ui32 slot, GLuint texture_id) {
+    // The unit is made active even if the texture is bound already, the
+    // callers set the parameters of and upload to the active unit.
+    SetActiveTexture(slot);
+    if (Count(current_texture_id_[slot] != texture_id)) {
+        current_texture_id_[slot] = texture_id;
+        ARCTIC_GL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, texture_id));
+    }
+}
+
+void GlState::SetTextureFilter(GLuint texture_id, DrawFilterMode filter_mode) {
+    auto it = texture_filter_modes_.find(texture_id);
+    if (Count(it == texture_filter_modes_.end() || it->second != filter_mode)) {
+        texture_filter_modes_[texture_id] = filter_mode;
+        BindTexture(0, texture_id);
+        switch (filter_mode) {
+            case kFilterNearest:
+                ARCTIC_GL_CHECK_ERROR(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+                ARCTIC_GL_CHECK_ERROR(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+                break;
+            case kFilterBilinear:
+            case kFilterMipmap:  // The textures have no mip levels.
+                ARCTIC_GL_CHECK_ERROR(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+                ARCTIC_GL_CHECK_ERROR(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+                break;
+        }
+    }
+}
+
+void GlState::UseProgram(GLuint program_id) {
+    if (Count(current_program_id_ != program_id)) {
+        current_program_id_ = program_id;
+        ARCTIC_GL_CHECK_ERROR(glUseProgram(program_id));
+    }
+}
+
+void GlState::BindArrayBuffer(GLuint buffer_id) {
+    if (Count(current_array_buffer_id_ != buffer_id)) {
+        current_array_buffer_id_ = buffer_id;
+        ARCTIC_GL_CHECK_ERROR(glBindBuffer(GL_ARRAY_BUFFER, buffer_id));
+    }
+}
+
+void GlState::BindPixelUnpackBuffer(GLuint buffer_id) {
+#ifdef GL_PIXEL_UNPACK_BUFFER
+    if (Count(current_pixel_unpack_buffer_id_ != buffer_id)) {
+        current_pixel_unpack_buffer_id_ = buffer_id;
+        ARCTIC_GL_CHECK_ERROR(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_id));
+    }
+#else
+    Check(buffer_id == 0, "Pixel buffers are not supported");
+#endif  // GL_PIXEL_UNPACK_BUFFER
+}
+
+void GlState::BindPixelPackBuffer(GLuint buffer_id) {
+#ifdef GL_PIXEL_PACK_BUFFER
+    if (Count(current_pixel_pack_buffer_id_ != buffer_id)) {
+        current_pixel_pack_buffer_id_ = buffer_id;
+        ARCTIC_GL_CHECK_ERROR(glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer_id));
+    }
+#else
+    Check(buffer_id == 0, "Pixel buffers are not supported");
+#endif  // GL_PIXEL_PACK_BUFFER
+}
+
+bool GlState::BindFramebuffer(GLuint framebuffer_id) {
+    if (Count(current_framebuffer_id_ != framebuffer_id)) {
+        current_framebuffer_id_ = framebuffer_id;
+        ARCTIC_GL_CHECK_ERROR(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id));
+        return true;
+    }
+    return false;
+}
+
+void GlState::SetVertexAttribArrays(Ui32 mask) {
+    const Ui32 changed = is_vertex_attribs_known_
+        ? (enabled_vertex_attribs_ ^ mask) : ~static_cast<Ui32>(0);
+    for (Ui32 idx = 0; idx < kMaxVertexAttribs; ++idx) {
+        const Ui32 bit = 1u << idx;
+        if (changed & bit) {
+            Count(true);
+            if (mask & bit) {
+                ARCTIC_GL_CHECK_ERROR(glEnableVertexAttribArray(idx));
+            } else {
+                ARCTIC_GL_CHECK_ERROR(glDisableVertexAttribArray(idx));
+            }
+        } else if (mask & bit) {
+            Count(false);
+        }
+    }
+    enabled_vertex_attribs_ = mask;
+    is_vertex_attribs_known_ = true;
+}
+
+void GlState::SetInstancedVertexAttribs(Ui32 mask) {
+#ifdef ARCTIC_GL_INSTANCING
+    const Ui32 changed = is_instanced_vertex_attribs_known_
+        ? (instanced_vertex_attribs_ ^ mask) : ~static_cast<Ui32>(0);
+    for (Ui32 idx = 0; idx < kMaxVertexAttribs; ++idx) {
+        const Ui32 bit = 1u << idx;
+        if (changed & bit) {
+            Count(true);
+            ARCTIC_GL_CHECK_ERROR(glVertexAttribDivisor(idx,
+                (mask & bit) ? 1 : 0));
+        } else if (mask & bit) {
+            Count(false);
+        }
+    }
+    instanced_vertex_attribs_ = mask;
+    is_instanced_vertex_attribs_known_ = true;
+#else
+    Check(mask == 0, "Instanced vertex attributes are not supported");
+#endif  // ARCTIC_GL_INSTANCING
+}
+
+void GlState::SetScissorTest(bool is_enabled) {
+    if (Count(is_scissor_test_enabled_ != static_cast<Si32>(is_enabled))) {
+        is_scissor_test_enabled_ = static_cast<Si32>(is_enabled);
+        if (is_enabled) {
+            ARCTIC_GL_CHECK_ERROR(glEnable(GL_SCISSOR_TEST));
+        } else {
+            ARCTIC_GL_CHECK_ERROR(glDisable(GL_SCISSOR_TEST));
+        }
+    }
+}
+
+void GlState::SetScissor(Si32 x, Si32 y, Si32 w, Si32 h) {
+    if (Count(current_scissor_ != Vec4Si32(x, y, w, h))) {
+        current_scissor_ = Vec4Si32(x, y, w, h);
+        ARCTIC_GL_CHECK_ERROR(glScissor(x, y, w, h));
+    }
+}
+
+void GlState::SetClearColor(Rgba color) {
+    if (Count(!is_clear_color_known_ || current_clear_color_ != color)) {
+        current_clear_color_ = color;
+        is_clear_color_known_ = true;
+        ARCTIC_GL_CHECK_ERROR(glClearColor(
+            static_cast<float>(color.r) / 255.0f,
+            static_cast<float>(color.g) / 255.0f,
+            static_cast<float>(color.b) / 255.0f,
+            static_cast<float>(color.a) / 255.0f));
+    }
+}
+
+void GlState::SetPixelStore(GLenum name, GLint value) {
+    GLint *current = nullptr;
+    switch (name) {
+        case GL_UNPACK_ALIGNMENT:
+            current = &unpack_alignment_;
+            break;
+        case GL_PACK_ALIGNMENT:
+            current = &pack_alignment_;
+            break;
+        default:
+            Fatal("GlState::SetPixelStore: unsupported name");
+            return;
+    }
+    if (Count(*current != value)) {
+        *current = value;
+        ARCTIC_GL_CHECK_ERROR(glPixelStorei(name, value));
+    }
+}
+
+void GlState::SetUnpackRowLength(GLint pixels) {
+#ifdef GL_UNPACK_ROW_LENGTH
+    if (Count(unpack_row_length_ != pixels)) {
+        unpack_row_length_ = pixels;
+        ARCTIC_GL_CHECK_ERROR(glPixelStorei(GL_UNPACK_ROW_LENGTH, pixels));
+    }
+#else
+    Check(pixels == 0, "GL_UNPACK_ROW_LENGTH is not supported");
+#endif  // GL_UNPACK_ROW_LENGTH
+}
+
+void GlState::OnTextureDeleted(GLuint texture_id) {
+    for (Ui32 slot = 0; slot < kMaxTextureSlots; ++slot) {
+        if (current_texture_id_[slot] == texture_id) {
+            current_texture_id_[slot] = 0;
+        }
+    }
+    texture_filter_modes_.erase(texture_id);
+}
+
+void GlState::OnBufferDeleted(GLuint buffer_id) {
+    if (current_array_buffer_id_ == buffer_id) {
+        current_array_buffer_id_ = 0;
+    }
+    if (current_pixel_unpack_buffer_id_ == buffer_id) {
+        current_pixel_unpack_buffer_id_ = 0;
+    }
+    if (current_pixel_pack_buffer_id_ == buffer_id) {
+        current_pixel_pack_buffer_id_ = 0;
+    }
+}
+
+void GlState::OnFramebufferDeleted(GLuint framebuffer_id) {
+    if (current_framebuffer_id_ == framebuffer_id) {
+        current_framebuffer_id_ = 0;
+    }
+}
+
+void GlState::Invalidate() {
+    current_viewport_ = Vec4Si32(-1, -1, -1, -1);
+    is_blending_mode_known_ = false;
+    current_texture_slot_ = kUnknownId;
+    for (Ui32 slot = 0; slot < kMaxTextureSlots; ++slot) {
+        current_texture_id_[slot] = kUnknownId;
+    }
+    texture_filter_modes_.clear();
+    current_program_id_ = kUnknownId;
+    current_array_buffer_id_ = kUnknownId;
+    current_pixel_unpack_buffer_id_ = kUnknownId;
+    current_pixel_pack_buffer_id_ = kUnknownId;
+    current_framebuffer_id_ = kUnknownId;
+    is_vertex_attribs_known_ = false;
+    is_instanced_vertex_attribs_known_ = false;
+    is_scissor_test_enabled_ = -1;
+    current_scissor_ = Vec4Si32(-1, -1, -1, -1);
+    is_clear_color_known_ = false;
+    unpack_alignment_ = -1;
+    pack_alignment_ = -1;
+    unpack_row_length_ = -1;
+}
+
 }  // namespace arctic
@@ -23,17 +23,33 @@
 #ifndef ENGINE_GL_STATE_H_
 #define ENGINE_GL_STATE_H_
 
+#include <unordered_map>
+
 #include "engine/arctic_types.h"
 #include "engine/opengl.h"
 #include "engine/easy_sprite.h"
+#include "engine/rgba.h"
 #include "engine/vec4si32.h"
 
+// OpenGL ES 2 has no instanced arrays and the legacy macOS context has them
+// only as an extension.
+#if defined(ARCTIC_PLATFORM_WINDOWS) || defined(ARCTIC_PLATFORM_PI_OPENGL_GLX)
+#define ARCTIC_GL_INSTANCING
+#endif
+
 namespace arctic {
 
 /// @addtogroup global_advanced
 /// @{
 
+/// @brief Shadow of the GL state the engine touches. Every wrapper changes
+/// the state through it, so a call that would not change anything is not
+/// issued. Calls that bypass the engine must be followed by Invalidate().
 class GlState {
+ public:
+  static const Ui32 kMaxTextureSlots = 8;
+  static const Ui32 kMaxVertexAttribs = 8;
+
  private:
   GlState() = delete;
   ~GlState() = delete;
@@ -44,10 +60,94 @@ class GlState {
 
   static Vec4Si32 current_viewport_;
   static DrawBlendingMode current_blending_mode_;
+  static bool is_blending_mode_known_;
+  static Ui32 current_texture_slot_;
+  static GLuint current_texture_id_[kMaxTextureSlots];
+  static std::unordered_map<GLuint, DrawFilterMode> texture_filter_modes_;
+  static GLuint current_program_id_;
+  static GLuint current_array_buffer_id_;
+  static GLuint current_pixel_unpack_buffer_id_;
+  static GLuint current_pixel_pack_buffer_id_;
+  static GLuint current_framebuffer_id_;
+  static Ui32 enabled_vertex_attribs_;
+  static bool is_vertex_attribs_known_;
+  static Ui32 instanced_vertex_attribs_;
+  static bool is_instanced_vertex_attribs_known_;
+  static Si32 is_scissor_test_enabled_;
+  static Vec4Si32 current_scissor_;
+  static Rgba current_clear_color_;
+  static bool is_clear_color_known_;
+  static GLint unpack_alignment_;
+  static GLint pack_alignment_;
+  static GLint unpack_row_length_;
+
+  static Si64 issued_call_count_;
+  static Si64 saved_call_count_;
+
+  /// @brief Counts one state change, issued or saved.
+  /// @return true if the change has to be issued.
+  static bool Count(bool is_changed) {
+    if (is_changed) {
+      ++issued_call_count_;
+    } else {
+      ++saved_call_count_;
+    }
+    return is_changed;
+  }
 
  public:
   static void SetViewport(Si32 x, Si32 y, Si32 w, Si32 h);
   static void SetBlending(DrawBlendingMode mode);
+  /// @brief Blends what is drawn under the premultiplied alpha already in
+  ///   the framebuffer, as if the framebuffer was drawn over it.
+  static void SetBlendingUnder();
+  static void SetActiveTexture(Ui32 slot);
+  /// @brief Binds the texture to the slot and leaves the slot active.
+  static void BindTexture(Ui32 slot, GLuint texture_id);
+  /// @brief Sets the min and mag filters of the texture, binds it to slot 0
+  ///   if they have to change.
+  static void SetTextureFilter(GLuint texture_id, DrawFilterMode filter_mode);
+  static void UseProgram(GLuint program_id);
+  static void BindArrayBuffer(GLuint buffer_id);
+  static void BindPixelUnpackBuffer(GLuint buffer_id);
+  static void BindPixelPackBuffer(GLuint buffer_id);
+  /// @return true if the binding has actually changed.
+  static bool BindFramebuffer(GLuint framebuffer_id);
+  /// @brief Enables exactly the vertex attribute arrays set in the mask.
+  static void SetVertexAttribArrays(Ui32 mask);
+  /// @brief Makes the vertex attributes set in the mask advance once per
+  ///   instance and the rest once per vertex. Only 0 is supported where
+  ///   ARCTIC_GL_INSTANCING is not defined.
+  static void SetInstancedVertexAttribs(Ui32 mask);
+  static void SetScissorTest(bool is_enabled);
+  static void SetScissor(Si32 x, Si32 y, Si32 w, Si32 h);
+  static void SetClearColor(Rgba color);
+  /// @brief glPixelStorei for GL_UNPACK_ALIGNMENT and GL_PACK_ALIGNMENT.
+  static void SetPixelStore(GLenum name, GLint value);
+  /// @brief Row length of the texture uploads, 0 means tightly packed rows.
+  ///   Only 0 is supported where GL_UNPACK_ROW_LENGTH is missing.
+  static void SetUnpackRowLength(GLint pixels);
+
+  /// @brief Forgets the bindings of a deleted object, GL may reuse its id.
+  static void OnTextureDeleted(GLuint texture_id);
+  static void OnBufferDeleted(GLuint buffer_id);
+  static void OnFramebufferDeleted(GLuint framebuffer_id);
+  /// @brief Forgets everything, so the next call of each kind is issued.
+  static void Invalidate();
+
+  /// @brief Number of state changes passed to GL since the last reset.
+  static Si64 GetIssuedCallCount() {
+    return issued_call_count_;
+  }
+  /// @brief Number of state changes skipped as redundant since the last
+  ///   reset.
+  static Si64 GetSavedCallCount() {
+    return saved_call_count_;
+  }
+  static void ResetCallCounts() {
+    issued_call_count_ = 0;
+    saved_call_count_ = 0;
+  }
 };
 
 /// @}
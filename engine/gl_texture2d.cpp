@@ -27,15 +27,13 @@
 
 #include <sstream>
 #include "engine/arctic_platform.h"
+#include "engine/gl_state.h"
 #include "engine/log.h"
 #include "engine/rgba.h"
 #include "engine/opengl.h"
 
 namespace arctic {
 
-GLuint GlTexture2D::current_texture_slot_ = 0;
-GLuint GlTexture2D::current_texture_id_[max_textures_slots] = { 0, 0, 0, 0, 0, 0, 0, 0 };
-
 GlTexture2D::GlTexture2D()
     : width_(0)
       , height_(0)
@@ -43,6 +41,7 @@ GlTexture2D::GlTexture2D()
 }
 
 GlTexture2D::~GlTexture2D() {
+    GlState::OnTextureDeleted(texture_id_);
     ARCTIC_GL_CHECK_ERROR(glDeleteTextures(1, &texture_id_));
 }
 
@@ -50,48 +49,68 @@ void GlTexture2D::Create(Si32 w, Si32 h) {
     width_ = w;
     height_ = h;
 
+    GlState::OnTextureDeleted(texture_id_);
     ARCTIC_GL_CHECK_ERROR(glDeleteTextures(1, &texture_id_));
 
-    ARCTIC_GL_CHECK_ERROR(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
-    ARCTIC_GL_CHECK_ERROR(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+    GlState::SetPixelStore(GL_UNPACK_ALIGNMENT, 1);
+    GlState::SetPixelStore(GL_PACK_ALIGNMENT, 1);
     ARCTIC_GL_CHECK_ERROR(glGenTextures(1, &texture_id_));
     Bind(0);
     Check(glIsTexture(texture_id_), "no texture");
 
     ARCTIC_GL_CHECK_ERROR(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
     ARCTIC_GL_CHECK_ERROR(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-    current_filter_mode_ = kFilterBilinear;
     SetFilterMode(kFilterNearest);
 
+    GlState::BindPixelUnpackBuffer(0);
     ARCTIC_GL_CHECK_ERROR(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA,
         GL_UNSIGNED_BYTE, nullptr));
 }
 
 void GlTexture2D::Bind(Ui32 slot) const {
-    Check(slot < max_textures_slots, "invalid texture slot");
-    if (current_texture_id_[slot] != texture_id_) {
-        if (current_texture_slot_ != slot) {
-            current_texture_slot_ = slot;
-            ARCTIC_GL_CHECK_ERROR(glActiveTexture(GL_TEXTURE0 + slot));
-        }
-        current_texture_id_[slot] = texture_id_;
-        ARCTIC_GL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, texture_id_));
-    }
+    GlState::BindTexture(slot, texture_id_);
+}
+
+void GlTexture2D::PrepareUpload(GLint row_length_pixels) const {
+    Bind(0);
+    GlState::BindPixelUnpackBuffer(0);
+    GlState::SetUnpackRowLength(row_length_pixels);
 }
 
 void GlTexture2D::SetData(const void *data, Si32 w, Si32 h) {
     width_ = w;
     height_ = h;
-    
-    Bind(0);
+
+    PrepareUpload(0);
     ARCTIC_GL_CHECK_ERROR(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data));
 }
 
 void GlTexture2D::UpdateData(const void *data) {
-    Bind(0);
+    PrepareUpload(0);
     ARCTIC_GL_CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, data));
 }
 
+void GlTexture2D::UpdateData(const void *data, Vec2Si32 begin, Vec2Si32 end) {
+    const Ui8 *bytes = static_cast<const Ui8*>(data);
+#ifdef ARCTIC_PLATFORM_PI_ES_EGL
+    PrepareUpload(0);
+    // OpenGL ES 2 has no GL_UNPACK_ROW_LENGTH, so whole rows are uploaded.
+    ARCTIC_GL_CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, begin.y, width_, end.y - begin.y,
+        GL_RGBA, GL_UNSIGNED_BYTE, bytes + static_cast<size_t>(begin.y) * width_ * sizeof(Rgba)));
+#else
+    PrepareUpload(width_);
+    ARCTIC_GL_CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_2D, 0, begin.x, begin.y,
+        end.x - begin.x, end.y - begin.y, GL_RGBA, GL_UNSIGNED_BYTE,
+        bytes + (static_cast<size_t>(begin.y) * width_ + begin.x) * sizeof(Rgba)));
+#endif  // ARCTIC_PLATFORM_PI_ES_EGL
+}
+
+void GlTexture2D::UpdateSubData(const void *data, Vec2Si32 pos, Vec2Si32 size) {
+    PrepareUpload(0);
+    ARCTIC_GL_CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y,
+        GL_RGBA, GL_UNSIGNED_BYTE, data));
+}
+
 /*void GlTexture2D::ReadData(void *dst) const {
     Bind(0);
     ARCTIC_GL_CHECK_ERROR(glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, dst));
@@ -113,20 +132,7 @@ void GlTexture2D::UpdateData(const void *data) {
 }*/
 
 void GlTexture2D::SetFilterMode(DrawFilterMode filter_mode) {
-    if (current_filter_mode_ != filter_mode) {
-        current_filter_mode_ = filter_mode;
-        Bind(0);
-        switch (filter_mode) {
-            case kFilterNearest:
-                ARCTIC_GL_CHECK_ERROR(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
-                ARCTIC_GL_CHECK_ERROR(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
-                break;
-            case kFilterBilinear:
-                ARCTIC_GL_CHECK_ERROR(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-                ARCTIC_GL_CHECK_ERROR(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-                break;
-        }
-    }
+    GlState::SetTextureFilter(texture_id_, filter_mode);
 }
 
 
@@ -26,6 +26,7 @@
 #include "engine/arctic_types.h"
 #include "engine/opengl.h"
 #include "engine/easy_sprite.h"
+#include "engine/vec2si32.h"
 
 namespace arctic {
 
@@ -42,11 +43,10 @@ class GlTexture2D {
   Si32 width_;
   Si32 height_;
   GLuint texture_id_;
-  DrawFilterMode current_filter_mode_;
 
-  static const GLuint max_textures_slots = 8;
-  static GLuint current_texture_slot_;
-  static GLuint current_texture_id_[max_textures_slots];
+  /// @brief Binds the texture for an upload from client memory with the
+  ///   given row length.
+  void PrepareUpload(GLint row_length_pixels) const;
 
  public:
   GlTexture2D();
@@ -56,6 +56,12 @@ class GlTexture2D {
   void Bind(Ui32 slot) const;
   void SetData(const void *data, Si32 w, Si32 h);
   void UpdateData(const void *data);
+  /// @brief Updates the [begin, end) rectangle of the texture.
+  /// @param [in] data The pixels of the whole texture.
+  void UpdateData(const void *data, Vec2Si32 begin, Vec2Si32 end);
+  /// @brief Updates the size.x by size.y rectangle of the texture at pos.
+  /// @param [in] data The pixels of the rectangle only, rows without gaps.
+  void UpdateSubData(const void *data, Vec2Si32 pos, Vec2Si32 size);
 //  void ReadData(void *dst) const;
   void SetFilterMode(DrawFilterMode filter_mode);
 
@@ -451,10 +451,12 @@ void Text::SetText(std::string text) {
 void DrawSelection(Si32 x1, Si32 y1, Si32 x2, Si32 y2,
     TextSelectionMode selection_mode,
     Rgba c1, Rgba c2, Sprite backbuffer) {
+  GetEngine()->GetTiledRasterizer().FlushBeforeWrite(backbuffer);
+  backbuffer.MarkDirty(Vec2Si32(x1, y1), Vec2Si32(x2, y2));
   switch (selection_mode) {
     case kTextSelectionModeInvert:
       for (Si32 y = y1; y < y2; ++y) {
-        Rgba *p = backbuffer.RgbaData() + backbuffer.StridePixels() * y;
+        Rgba *p = backbuffer.UntrackedRgbaData() + backbuffer.StridePixels() * y;
         for (Si32 x = x1; x < x2; ++x) {
           Rgba &c = p[x];
           c.r = 255 - c.r;
@@ -465,7 +467,7 @@ void DrawSelection(Si32 x1, Si32 y1, Si32 x2, Si32 y2,
       break;
     case kTextSelectionModeSwapColors:
       for (Si32 y = y1; y < y2; ++y) {
-        Rgba *p = backbuffer.RgbaData() + backbuffer.StridePixels() * y;
+        Rgba *p = backbuffer.UntrackedRgbaData() + backbuffer.StridePixels() * y;
         for (Si32 x = x1; x < x2; ++x) {
           Rgba &c = p[x];
           if (c.rgba == c1.rgba) {
@@ -52,6 +52,7 @@ extern PFNGLCREATESHADERPROC glCreateShader;
 extern PFNGLDELETEPROGRAMPROC glDeleteProgram;
 extern PFNGLDELETESHADERPROC glDeleteShader;
 extern PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArray;
+extern PFNGLGETACTIVEUNIFORMPROC glGetActiveUniform;
 extern PFNGLGETPROGRAMIVPROC glGetProgramiv;
 extern PFNGLGETPROGRAMINFOLOGPROC glGetProgramInfoLog;
 extern PFNGLGETSHADERIVPROC glGetShaderiv;
@@ -80,6 +81,17 @@ extern PFNGLDELETEBUFFERSPROC glDeleteBuffers;
 extern PFNGLBINDBUFFERPROC glBindBuffer;
 extern PFNGLBUFFERDATAPROC glBufferData;
 extern PFNGLBUFFERSUBDATAPROC glBufferSubData;
+// Optional, nullptr if the context does not support them.
+extern PFNGLMAPBUFFERRANGEPROC glMapBufferRange;
+extern PFNGLUNMAPBUFFERPROC glUnmapBuffer;
+extern PFNGLFENCESYNCPROC glFenceSync;
+extern PFNGLCLIENTWAITSYNCPROC glClientWaitSync;
+extern PFNGLDELETESYNCPROC glDeleteSync;
+extern PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisor;
+extern PFNGLDRAWARRAYSINSTANCEDPROC glDrawArraysInstanced;
+extern PFNGLGETPROGRAMBINARYPROC glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC glProgramParameteri;
 
 #endif  // ARCTIC_PLATFORM_WINDOWS
 
@@ -88,10 +100,10 @@ extern PFNGLBUFFERSUBDATAPROC glBufferSubData;
 #include <OpenGL/glu.h>
 #endif  // ARCTIC_PLATFORM_MACOSX
 
-#ifdef ARCTIC_PLATFORM_PI_OPENGL_GLX
+#if defined(ARCTIC_PLATFORM_PI_OPENGL_GLX) || defined(ARCTIC_PLATFORM_HEADLESS)
 #include <GL/gl.h>  // NOLINT
 #include <GL/glu.h>  // NOLINT
-#endif  // ARCTIC_PLATFORM_PI_OPENGL_GLX
+#endif  // defined(ARCTIC_PLATFORM_PI_OPENGL_GLX) || defined(ARCTIC_PLATFORM_HEADLESS)
 
 #ifdef ARCTIC_PLATFORM_PI_ES_EGL
 #include <GLES2/gl2.h>
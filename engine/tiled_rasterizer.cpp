@@ -0,0 +1,313 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/tiled_rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "engine/arctic_platform_fatal.h"
+
+namespace arctic {
+
+TiledRasterizer::~TiledRasterizer() {
+  StopWorkers();
+}
+
+void TiledRasterizer::Start(Sprite target, Si32 thread_count,
+    Si32 tile_size) {
+  Check(tile_size > 0,
+    "Error in TiledRasterizer::Start, tile_size must be positive.");
+  Stop();
+  if (thread_count <= 0) {
+    thread_count = static_cast<Si32>(std::thread::hardware_concurrency());
+  }
+  thread_count_ = std::max(thread_count, 1);
+  tile_size_ = tile_size;
+  target_ = target;
+  tile_count_ = Vec2Si32(
+    (target_.Width() + tile_size_ - 1) / tile_size_,
+    (target_.Height() + tile_size_ - 1) / tile_size_);
+  bins_.resize(static_cast<size_t>(tile_count_.x * tile_count_.y));
+  is_recording_ = true;
+  StartWorkers();
+}
+
+void TiledRasterizer::Stop() {
+  Flush();
+  StopWorkers();
+  is_recording_ = false;
+  target_ = Sprite();
+  bins_.clear();
+}
+
+bool TiledRasterizer::IsTarget(const Sprite &sprite) const {
+  return sprite.SpriteInstance() == target_.SpriteInstance()
+    && sprite.RefPos() == target_.RefPos()
+    && sprite.Size() == target_.Size();
+}
+
+bool TiledRasterizer::SharesTarget(const Sprite &sprite) const {
+  return sprite.SpriteInstance() == target_.SpriteInstance();
+}
+
+bool TiledRasterizer::RecordSprite(const Sprite &to_sprite,
+    const Si32 to_x_pivot, const Si32 to_y_pivot,
+    const Si32 to_width, const Si32 to_height,
+    const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
+    const Si32 from_width, const Si32 from_height,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    Rgba in_color) {
+  if (!IsTarget(to_sprite) || SharesTarget(from_sprite)) {
+    FlushBeforeWrite(to_sprite);
+    FlushBeforeRead(from_sprite);
+    return false;
+  }
+  if (!from_width || !from_height || !to_width || !to_height) {
+    return true;
+  }
+  Command command;
+  command.sprite = from_sprite;
+  command.bound_begin = Vec2Si32(
+    to_x_pivot - from_sprite.Pivot().x * to_width / from_width,
+    to_y_pivot - from_sprite.Pivot().y * to_height / from_height);
+  command.bound_end = command.bound_begin + Vec2Si32(to_width, to_height);
+  command.blending_mode = blending_mode;
+  command.filter_mode = filter_mode;
+  command.color = in_color;
+  command.is_triangle = false;
+  command.to_x_pivot = to_x_pivot;
+  command.to_y_pivot = to_y_pivot;
+  command.to_width = to_width;
+  command.to_height = to_height;
+  command.from_x = from_x;
+  command.from_y = from_y;
+  command.from_width = from_width;
+  command.from_height = from_height;
+  AddCommand(command);
+  return true;
+}
+
+bool TiledRasterizer::RecordTriangle(const Sprite &to_sprite,
+    Vec2F a, Vec2F b, Vec2F c,
+    Vec2F ta, Vec2F tb, Vec2F tc,
+    const Sprite &texture,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    Rgba in_color) {
+  if (!IsTarget(to_sprite) || SharesTarget(texture)) {
+    FlushBeforeWrite(to_sprite);
+    FlushBeforeRead(texture);
+    return false;
+  }
+  Command command;
+  command.sprite = texture;
+  // The edges are interpolated in floating point, so the bound is widened
+  // by a couple of pixels to cover the rounding. NaN covers the whole target.
+  const float x1 = std::min(a.x, std::min(b.x, c.x));
+  const float x2 = std::max(a.x, std::max(b.x, c.x));
+  const float y1 = std::min(a.y, std::min(b.y, c.y));
+  const float y2 = std::max(a.y, std::max(b.y, c.y));
+  if (x1 <= x2 && y1 <= y2) {
+    const float width_f = static_cast<float>(target_.Width());
+    const float height_f = static_cast<float>(target_.Height());
+    command.bound_begin = Vec2Si32(
+      static_cast<Si32>(std::floor(std::min(std::max(x1, -2.f), width_f))) - 2,
+      static_cast<Si32>(std::floor(std::min(std::max(y1, -2.f), height_f))) - 2);
+    command.bound_end = Vec2Si32(
+      static_cast<Si32>(std::max(std::min(x2, width_f + 2.f), -2.f)) + 2,
+      static_cast<Si32>(std::max(std::min(y2, height_f + 2.f), -2.f)) + 2);
+  } else {
+    command.bound_begin = Vec2Si32(0, 0);
+    command.bound_end = target_.Size();
+  }
+  command.blending_mode = blending_mode;
+  command.filter_mode = filter_mode;
+  command.color = in_color;
+  command.is_triangle = true;
+  command.a = a;
+  command.b = b;
+  command.c = c;
+  command.ta = ta;
+  command.tb = tb;
+  command.tc = tc;
+  AddCommand(command);
+  return true;
+}
+
+void TiledRasterizer::AddCommand(const Command &command) {
+  if (command.bound_begin.x >= command.bound_end.x
+      || command.bound_begin.y >= command.bound_end.y
+      || command.bound_end.x <= 0 || command.bound_end.y <= 0
+      || command.bound_begin.x >= target_.Width()
+      || command.bound_begin.y >= target_.Height()) {
+    return;
+  }
+  sources_.insert(command.sprite.SpriteInstance().get());
+  commands_.push_back(command);
+}
+
+void TiledRasterizer::FlushBeforeRead(const Sprite &sprite) {
+  if (!commands_.empty() && SharesTarget(sprite)) {
+    Flush();
+  }
+}
+
+void TiledRasterizer::FlushBeforeWrite(const Sprite &sprite) {
+  if (!commands_.empty() && (SharesTarget(sprite)
+      || sources_.count(sprite.SpriteInstance().get()))) {
+    Flush();
+  }
+}
+
+void TiledRasterizer::Execute(const Command &command,
+    Vec2Si32 clip_begin, Vec2Si32 clip_end) {
+  if (command.is_triangle) {
+    DrawTriangleClipped(target_,
+      command.a, command.b, command.c,
+      command.ta, command.tb, command.tc,
+      command.sprite, command.blending_mode, command.filter_mode,
+      command.color, clip_begin, clip_end);
+  } else {
+    DrawSpriteClipped(target_,
+      command.to_x_pivot, command.to_y_pivot,
+      command.to_width, command.to_height,
+      command.sprite, command.from_x, command.from_y,
+      command.from_width, command.from_height,
+      command.blending_mode, command.filter_mode,
+      command.color, clip_begin, clip_end);
+  }
+}
+
+void TiledRasterizer::Flush() {
+  if (commands_.empty()) {
+    return;
+  }
+  if (workers_.empty()) {
+    const Vec2Si32 clip_end = target_.Size();
+    for (const Command &command : commands_) {
+      Execute(command, Vec2Si32(0, 0), clip_end);
+    }
+  } else {
+    for (size_t idx = 0; idx < commands_.size(); ++idx) {
+      const Command &command = commands_[idx];
+      const Si32 tx1 = std::max(command.bound_begin.x, 0) / tile_size_;
+      const Si32 ty1 = std::max(command.bound_begin.y, 0) / tile_size_;
+      const Si32 tx2 = (std::min(command.bound_end.x, target_.Width()) - 1)
+        / tile_size_;
+      const Si32 ty2 = (std::min(command.bound_end.y, target_.Height()) - 1)
+        / tile_size_;
+      for (Si32 ty = ty1; ty <= ty2; ++ty) {
+        for (Si32 tx = tx1; tx <= tx2; ++tx) {
+          bins_[static_cast<size_t>(ty * tile_count_.x + tx)].push_back(
+            static_cast<Si32>(idx));
+        }
+      }
+    }
+    next_tile_.store(0);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      busy_workers_ = static_cast<Si32>(workers_.size());
+      ++generation_;
+    }
+    start_condvar_.notify_all();
+    RasterizeTiles();
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_condvar_.wait(lock, [this] { return busy_workers_ == 0; });
+    }
+    for (std::vector<Si32> &bin : bins_) {
+      bin.clear();
+    }
+  }
+  commands_.clear();
+  sources_.clear();
+}
+
+void TiledRasterizer::RasterizeTiles() {
+  const Si32 tile_count = tile_count_.x * tile_count_.y;
+  while (true) {
+    const Si32 tile_idx = next_tile_.fetch_add(1);
+    if (tile_idx >= tile_count) {
+      return;
+    }
+    const std::vector<Si32> &bin = bins_[static_cast<size_t>(tile_idx)];
+    if (bin.empty()) {
+      continue;
+    }
+    const Vec2Si32 clip_begin(
+      (tile_idx % tile_count_.x) * tile_size_,
+      (tile_idx / tile_count_.x) * tile_size_);
+    const Vec2Si32 clip_end(
+      std::min(clip_begin.x + tile_size_, target_.Width()),
+      std::min(clip_begin.y + tile_size_, target_.Height()));
+    for (Si32 command_idx : bin) {
+      Execute(commands_[static_cast<size_t>(command_idx)],
+        clip_begin, clip_end);
+    }
+  }
+}
+
+void TiledRasterizer::StartWorkers() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  is_quitting_ = false;
+  for (Si32 idx = 1; idx < thread_count_; ++idx) {
+    workers_.emplace_back(&TiledRasterizer::WorkerThreadFunction, this,
+      generation_);
+  }
+}
+
+void TiledRasterizer::StopWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_quitting_ = true;
+  }
+  start_condvar_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+void TiledRasterizer::WorkerThreadFunction(Ui64 generation) {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_condvar_.wait(lock, [this, generation] {
+        return is_quitting_ || generation_ != generation;
+      });
+      if (is_quitting_) {
+        return;
+      }
+      generation = generation_;
+    }
+    RasterizeTiles();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --busy_workers_;
+      if (busy_workers_ == 0) {
+        done_condvar_.notify_one();
+      }
+    }
+  }
+}
+
+}  // namespace arctic
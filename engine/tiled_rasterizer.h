@@ -0,0 +1,188 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_TILED_RASTERIZER_H_
+#define ENGINE_TILED_RASTERIZER_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/easy_sprite.h"
+#include "engine/rgba.h"
+#include "engine/vec2f.h"
+#include "engine/vec2si32.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief Draws a part of from_sprite to to_sprite just like Sprite::Draw,
+///  but writes only the pixels inside the [clip_begin, clip_end) rectangle.
+/// @details The pixels inside the rectangle are exactly the same as the ones
+///  an unclipped draw would produce.
+void DrawSpriteClipped(Sprite to_sprite,
+    const Si32 to_x_pivot, const Si32 to_y_pivot,
+    const Si32 to_width, const Si32 to_height,
+    const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
+    const Si32 from_width, const Si32 from_height,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    Rgba in_color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end);
+
+/// @brief Draws a textured triangle just like DrawTriangle,
+///  but writes only the pixels inside the [clip_begin, clip_end) rectangle.
+void DrawTriangleClipped(Sprite to_sprite,
+    Vec2F a, Vec2F b, Vec2F c,
+    Vec2F ta, Vec2F tb, Vec2F tc,
+    const Sprite &texture,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    Rgba in_color, const Vec2Si32 clip_begin, const Vec2Si32 clip_end);
+
+/// @brief Records the draws that target a sprite and rasterizes them later,
+///  in parallel, one screen tile per worker at a time.
+/// @details Draws are binned into square tiles and each tile executes its
+///  draws in the recorded order with the tile as the clip rectangle,
+///  so the result is pixel-identical to drawing serially.
+///  The engine flushes the recorded draws before the frame is shown and
+///  before any of its own functions accesses the target pixels directly.
+///  Code that writes the pixels of the target or of a sprite that was
+///  drawn to the target directly should call Flush first.
+class TiledRasterizer {
+ public:
+  static const Si32 kDefaultTileSize = 128;
+
+  TiledRasterizer() = default;
+  TiledRasterizer(const TiledRasterizer &other) = delete;
+  TiledRasterizer &operator=(const TiledRasterizer &other) = delete;
+  ~TiledRasterizer();
+
+  /// @brief Starts recording the draws that target the sprite.
+  /// @param [in] target The sprite to draw to, usually the backbuffer.
+  /// @param [in] thread_count The number of threads to rasterize with,
+  ///  including the calling one. 0 means one per hardware thread.
+  /// @param [in] tile_size The edge length of a tile in pixels.
+  void Start(Sprite target, Si32 thread_count = 0,
+    Si32 tile_size = kDefaultTileSize);
+  /// @brief Rasterizes the recorded draws and stops recording.
+  void Stop();
+  bool IsRecording() const {
+    return is_recording_;
+  }
+  Si32 ThreadCount() const {
+    return thread_count_;
+  }
+  Si32 TileSize() const {
+    return tile_size_;
+  }
+
+  /// @brief Records a Sprite::Draw call.
+  /// @return true if the draw is recorded, false if it must be performed
+  ///  immediately. Recorded draws it depends on are flushed in that case.
+  bool RecordSprite(const Sprite &to_sprite,
+    const Si32 to_x_pivot, const Si32 to_y_pivot,
+    const Si32 to_width, const Si32 to_height,
+    const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
+    const Si32 from_width, const Si32 from_height,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    Rgba in_color);
+  /// @brief Records a textured DrawTriangle call.
+  /// @return true if the draw is recorded, false if it must be performed
+  ///  immediately. Recorded draws it depends on are flushed in that case.
+  bool RecordTriangle(const Sprite &to_sprite,
+    Vec2F a, Vec2F b, Vec2F c,
+    Vec2F ta, Vec2F tb, Vec2F tc,
+    const Sprite &texture,
+    DrawBlendingMode blending_mode, DrawFilterMode filter_mode,
+    Rgba in_color);
+
+  /// @brief Rasterizes all the recorded draws.
+  void Flush();
+  /// @brief Flushes the recorded draws if they write the sprite pixels.
+  void FlushBeforeRead(const Sprite &sprite);
+  /// @brief Flushes the recorded draws if they write or read the sprite pixels.
+  void FlushBeforeWrite(const Sprite &sprite);
+
+ private:
+  struct Command {
+    Sprite sprite;
+    Vec2Si32 bound_begin;
+    Vec2Si32 bound_end;
+    DrawBlendingMode blending_mode;
+    DrawFilterMode filter_mode;
+    Rgba color;
+    bool is_triangle;
+    Si32 to_x_pivot;
+    Si32 to_y_pivot;
+    Si32 to_width;
+    Si32 to_height;
+    Si32 from_x;
+    Si32 from_y;
+    Si32 from_width;
+    Si32 from_height;
+    Vec2F a;
+    Vec2F b;
+    Vec2F c;
+    Vec2F ta;
+    Vec2F tb;
+    Vec2F tc;
+  };
+
+  bool IsTarget(const Sprite &sprite) const;
+  bool SharesTarget(const Sprite &sprite) const;
+  void AddCommand(const Command &command);
+  void Execute(const Command &command, Vec2Si32 clip_begin,
+    Vec2Si32 clip_end);
+  void RasterizeTiles();
+  void StartWorkers();
+  void StopWorkers();
+  void WorkerThreadFunction(Ui64 generation);
+
+  Sprite target_;
+  bool is_recording_ = false;
+  Si32 thread_count_ = 1;
+  Si32 tile_size_ = kDefaultTileSize;
+  Vec2Si32 tile_count_ = Vec2Si32(0, 0);
+
+  std::vector<Command> commands_;
+  std::vector<std::vector<Si32>> bins_;
+  std::unordered_set<const void*> sources_;
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_condvar_;
+  std::condition_variable done_condvar_;
+  Ui64 generation_ = 0;
+  Si32 busy_workers_ = 0;
+  bool is_quitting_ = false;
+  std::atomic<Si32> next_tile_{0};
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_TILED_RASTERIZER_H_
@@ -5,17 +5,102 @@
 #include <deque>
 #include <string>
 #include <iostream>
+#include <limits>
+#include <random>
 #include <sstream>
 
+#include "benchmark/benchmark_report.h"
 #include "engine/arctic_types.h"
 #include "engine/arctic_platform.h"
 #include "engine/easy.h"
+#include "engine/arctic_mix_kernel.h"
+#include "engine/arctic_mixer.h"
+#include "engine/arctic_resampler.h"
+#include "engine/arctic_sound_decoder.h"
+#include "engine/easy_hw_sprite_atlas.h"
+#include "engine/easy_hw_sprite_pool.h"
+#include "engine/easy_hw_sprite_upload_queue.h"
+#include "engine/easy_sprite_blend.h"
 #include "engine/rgb.h"
 #include <ctime>
 
 
 using namespace arctic;
 
+// A sprite of random colors with transparent, opaque and translucent runs,
+// the same one for the same seed.
+static Sprite MakeRandomSprite(Si32 width, Si32 height, Ui32 seed) {
+  std::mt19937 random(seed);
+  Sprite sprite;
+  sprite.Create(width, height);
+  for (Si32 y = 0; y < height; ++y) {
+    for (Si32 x = 0; x < width; ++x) {
+      Rgba c(static_cast<Ui32>(random()));
+      const Si32 zone = (x / 5 + y / 3) % 3;
+      c.a = (zone == 0 ? 0 : (zone == 1 ? 255 : c.a));
+      sprite.RgbaData()[x + y * sprite.StridePixels()] = c;
+    }
+  }
+  return sprite;
+}
+
+// Draws count copies of the sprite with every blending mode, both filters,
+// a range of colors, scales and angles. Records the draws to the list
+// instead of drawing them if there is one. Unscaled draws of a sprite with
+// opaque spans skip the transparent edges even when copying, so they are
+// replaced by scaled ones when comparing against a sprite without spans.
+static void DrawMixedSprites(Sprite from, Sprite to, Si32 count,
+    DrawList *list = nullptr, bool is_unscaled_drawn = true) {
+  for (Si32 i = 0; i < count; ++i) {
+    const DrawBlendingMode mode = static_cast<DrawBlendingMode>(i % 6);
+    const DrawFilterMode filter =
+      ((i / 6) % 2) ? kFilterBilinear : kFilterNearest;
+    const Rgba color(static_cast<Ui8>(255 - i), static_cast<Ui8>(128 + i),
+      static_cast<Ui8>(i * 2), static_cast<Ui8>((i % 4) ? 200 : 255));
+    const Si32 x = (i * 37) % 251 - 20;
+    const Si32 y = (i * 53) % 197 - 20;
+    const float angle = static_cast<float>(i) * 0.1f;
+    const float zoom = 0.5f + static_cast<float>(i) * 0.02f;
+    if (i % 3 == 0 && is_unscaled_drawn) {
+      if (list) {
+        list->Add(from, x, y, mode, filter, color);
+      } else {
+        from.Draw(to, x, y, mode, filter, color);
+      }
+    } else if (i % 3 != 2) {
+      if (list) {
+        list->Add(from, x, y, 20 + i, 10 + i / 2,
+          2, 1, from.Width() - 3, from.Height() - 2, mode, filter, color);
+      } else {
+        from.Draw(to, x, y, 20 + i, 10 + i / 2,
+          2, 1, from.Width() - 3, from.Height() - 2, mode, filter, color);
+      }
+    } else {
+      if (list) {
+        list->AddRotated(from, Vec2F(static_cast<float>(x),
+          static_cast<float>(y)), angle, zoom, mode, filter, color);
+      } else {
+        from.Draw(static_cast<float>(x), static_cast<float>(y), angle, zoom,
+          to, mode, filter, color);
+      }
+    }
+  }
+}
+
+// The number of pixels that differ between two sprites of the same size.
+static Si64 CountMismatches(const Sprite &a, const Sprite &b) {
+  Si64 mismatches = 0;
+  for (Si32 y = 0; y < a.Height(); ++y) {
+    for (Si32 x = 0; x < a.Width(); ++x) {
+      if (!(a.RgbaData()[x + y * a.StridePixels()] ==
+          b.RgbaData()[x + y * b.StridePixels()])) {
+        ++mismatches;
+      }
+    }
+  }
+  return mismatches;
+}
+
 template <class KeyT>
 void radix_sort(std::vector<KeyT> &in_out_data) {
   constexpr Ui64 kBits = sizeof(KeyT) <= 4 ? 2 : 4;
@@ -437,6 +522,726 @@ void test_rgba() {
   }
 }
 
+void test_blend_kernels() {
+  const DrawBlendingMode modes[] = {
+    kDrawBlendingModeCopyRgba,
+    kDrawBlendingModeAlphaBlend,
+    kDrawBlendingModePremultipliedAlphaBlend,
+    kDrawBlendingModeColorize,
+    kDrawBlendingModeSolidColor,
+    kDrawBlendingModeAdd
+  };
+  const BlendKernelIsa isas[] = {
+    kBlendKernelIsaSse2,
+    kBlendKernelIsaAvx2,
+    kBlendKernelIsaNeon
+  };
+  const Si32 kCount = 67;
+  std::vector<Rgba> from(kCount);
+  std::vector<Rgba> to(kCount);
+  std::vector<Rgba> expected(kCount);
+  std::vector<Rgba> actual(kCount);
+  for (Si32 iteration = 0; iteration < 200; ++iteration) {
+    for (Si32 i = 0; i < kCount; ++i) {
+      from[i] = Rgba(Random32());
+      to[i] = Rgba(Random32());
+      // Fully transparent and fully opaque pixels take separate paths.
+      if (i % 3 == 0) {
+        from[i].a = 0;
+      } else if (i % 3 == 1) {
+        from[i].a = 255;
+      }
+    }
+    Rgba in_color(Random32());
+    if (iteration % 4 == 0) {
+      in_color.a = 255;
+    } else if (iteration % 4 == 1) {
+      in_color = Rgba(255, 255, 255, 255);
+    }
+    for (DrawBlendingMode mode : modes) {
+      for (Si32 is_cleared = 0; is_cleared < 2; ++is_cleared) {
+        expected = to;
+        GetBlendRowFunc(mode, is_cleared != 0, kBlendKernelIsaScalar)(
+            expected.data(), from.data(), kCount, in_color);
+        for (BlendKernelIsa isa : isas) {
+          if (!IsBlendKernelIsaSupported(isa)) {
+            continue;
+          }
+          actual = to;
+          GetBlendRowFunc(mode, is_cleared != 0, isa)(
+              actual.data(), from.data(), kCount, in_color);
+          for (Si32 i = 0; i < kCount; ++i) {
+            TEST_CHECK_(actual[i] == expected[i],
+                "mode: %d isa: %d i: %d", static_cast<int>(mode),
+                static_cast<int>(isa), static_cast<int>(i));
+          }
+        }
+      }
+    }
+  }
+}
+
+void test_mix_kernels() {
+  const MixKernelIsa isas[] = {
+    kMixKernelIsaSse2,
+    kMixKernelIsaNeon
+  };
+  const Si32 gains[] = {0, 1, 16384, kMixGainOne - 1, kMixGainOne, kMixGainMax};
+  const Si32 kCount = 67;
+  std::vector<Si16> in(kCount);
+  std::vector<Si32> start(kCount);
+  std::vector<Si32> expected(kCount);
+  std::vector<Si32> actual(kCount);
+  std::vector<Si16> expected_out(kCount);
+  std::vector<Si16> actual_out(kCount);
+  for (Si32 iteration = 0; iteration < 200; ++iteration) {
+    for (Si32 i = 0; i < kCount; ++i) {
+      in[i] = static_cast<Si16>(Random32());
+      start[i] = static_cast<Si32>(Random32() % 200000) - 100000;
+    }
+    in[0] = -32768;
+    in[1] = 32767;
+    for (Si32 gain : gains) {
+      expected = start;
+      GetMixAddFunc(kMixKernelIsaScalar)(expected.data(), in.data(), kCount,
+        gain);
+      TEST_CHECK(expected[0] == start[0] + ((-32768 * gain) >> 15));
+      GetMixPackFunc(kMixKernelIsaScalar)(expected_out.data(),
+        expected.data(), kCount);
+      for (MixKernelIsa isa : isas) {
+        if (!IsMixKernelIsaSupported(isa)) {
+          continue;
+        }
+        actual = start;
+        GetMixAddFunc(isa)(actual.data(), in.data(), kCount, gain);
+        GetMixPackFunc(isa)(actual_out.data(), actual.data(), kCount);
+        for (Si32 i = 0; i < kCount; ++i) {
+          TEST_CHECK_(actual[i] == expected[i] &&
+              actual_out[i] == expected_out[i],
+              "gain: %d isa: %d i: %d", static_cast<int>(gain),
+              static_cast<int>(isa), static_cast<int>(i));
+        }
+      }
+    }
+  }
+  TEST_CHECK(MixGain(-1.f) == 0);
+  TEST_CHECK(MixGain(1.f) == kMixGainOne);
+  TEST_CHECK(MixGain(4.f) == kMixGainMax);
+  Si32 big[2] = {40000, -40000};
+  Si16 packed[2];
+  GetMixPackFunc()(packed, big, 2);
+  TEST_CHECK(packed[0] == 32767 && packed[1] == -32768);
+}
+
+struct ResamplerTestSource {
+  const std::vector<Si16> *samples;
+  Si32 position;
+};
+
+static Si32 ReadResamplerTestSource(void *context, Si16 *out, Si32 frames) {
+  ResamplerTestSource *source = static_cast<ResamplerTestSource*>(context);
+  Si32 left = static_cast<Si32>(source->samples->size() / 2)
+    - source->position;
+  Si32 size = std::min(frames, left);
+  std::copy(source->samples->begin() + source->position * 2,
+    source->samples->begin() + (source->position + size) * 2, out);
+  source->position += size;
+  return size;
+}
+
+static std::vector<Si16> Resample(const std::vector<Si16> &samples,
+    Si32 source_rate, Si32 output_rate, float pitch,
+    SoundResamplerQuality quality, Si32 chunk, Si32 scratch_frames) {
+  SoundResampler resampler;
+  resampler.Start(source_rate, output_rate, pitch, quality);
+  ResamplerTestSource source = {&samples, 0};
+  std::vector<Si16> scratch(static_cast<size_t>(scratch_frames) * 2);
+  std::vector<Si16> result;
+  std::vector<Si16> out(static_cast<size_t>(chunk) * 2);
+  while (true) {
+    Si32 size = resampler.Render(ReadResamplerTestSource, &source,
+      out.data(), chunk, scratch.data(), scratch_frames);
+    result.insert(result.end(), out.begin(), out.begin() + size * 2);
+    if (size < chunk) {
+      return result;
+    }
+  }
+}
+
+void test_resampler() {
+  const Si32 kFrames = 1000;
+  std::vector<Si16> samples(kFrames * 2);
+  for (Si32 i = 0; i < kFrames; ++i) {
+    samples[i * 2] = static_cast<Si16>(Random32());
+    samples[i * 2 + 1] = static_cast<Si16>(i * 13);
+  }
+  // Equal rates and no pitch pass the samples through.
+  std::vector<Si16> same = Resample(samples, 48000, 48000, 1.f,
+    kSoundResamplerSinc, 64, 256);
+  TEST_CHECK(same == samples);
+  // Linear interpolation at the source frames returns them unchanged.
+  std::vector<Si16> half = Resample(samples, 44100, 22050, 1.f,
+    kSoundResamplerLinear, 77, 100);
+  TEST_CHECK(half.size() == kFrames);
+  for (Si32 i = 0; i < kFrames / 2; ++i) {
+    TEST_CHECK(half[i * 2] == samples[i * 4]);
+    TEST_CHECK(half[i * 2 + 1] == samples[i * 4 + 1]);
+  }
+  std::vector<Si16> doubled = Resample(samples, 22050, 44100, 1.f,
+    kSoundResamplerLinear, 100, 64);
+  TEST_CHECK(doubled.size() == kFrames * 4);
+  TEST_CHECK(doubled[4] == samples[2] && doubled[5] == samples[3]);
+  TEST_CHECK(doubled[3] == (samples[1] + samples[3]) / 2);
+  // The result does not depend on how the output and the source are split.
+  for (SoundResamplerQuality quality :
+      {kSoundResamplerLinear, kSoundResamplerSinc}) {
+    for (float pitch : {0.3f, 0.9f, 1.7f, 10.f}) {
+      std::vector<Si16> expected = Resample(samples, 44100, 48000, pitch,
+        quality, 4096, 4096);
+      std::vector<Si16> actual = Resample(samples, 44100, 48000, pitch,
+        quality, 33, 40);
+      TEST_CHECK_(actual == expected, "quality: %d pitch: %f",
+        static_cast<int>(quality), static_cast<double>(pitch));
+      Si32 expected_frames = static_cast<Si32>(std::ceil(
+        kFrames / (pitch * 44100.0 / 48000.0)));
+      TEST_CHECK_(std::abs(static_cast<Si32>(expected.size() / 2)
+        - expected_frames) <= 1, "quality: %d pitch: %f",
+        static_cast<int>(quality), static_cast<double>(pitch));
+    }
+  }
+  // The sinc filter keeps a constant signal constant.
+  std::vector<Si16> constant(kFrames * 2, 12345);
+  std::vector<Si16> filtered = Resample(constant, 44100, 48000, 1.f,
+    kSoundResamplerSinc, 512, 512);
+  for (size_t i = 40; i + 40 < filtered.size(); ++i) {
+    TEST_CHECK(filtered[i] == 12345);
+  }
+
+  // Output after a skip matches the output of a voice that never skipped.
+  for (SoundResamplerQuality quality :
+      {kSoundResamplerLinear, kSoundResamplerSinc}) {
+    std::vector<Si16> expected = Resample(samples, 44100, 48000, 0.7f,
+      quality, 4096, 4096);
+    SoundResampler resampler;
+    resampler.Start(44100, 48000, 0.7f, quality);
+    ResamplerTestSource source = {&samples, 0};
+    std::vector<Si16> scratch(256 * 2);
+    std::vector<Si16> out(300 * 2);
+    resampler.Render(ReadResamplerTestSource, &source, out.data(), 100,
+      scratch.data(), 256);
+    source.position += resampler.Skip(200);
+    Si32 size = resampler.Render(ReadResamplerTestSource, &source,
+      out.data(), 300, scratch.data(), 256);
+    TEST_CHECK(size == 300);
+    TEST_CHECK(std::equal(out.begin(), out.end(), expected.begin() + 600));
+  }
+
+  Sound sound;
+  sound.Create(0.5, 22050);
+  TEST_CHECK(sound.SampleRate() == 22050);
+  TEST_CHECK(sound.DurationSamples() == 11025);
+  TEST_CHECK(std::abs(sound.Duration() - 0.5) < 1e-9);
+}
+
+void test_voice_limit() {
+  SoundMixerState state;
+  Sound sound;
+  sound.Create(0.01);
+  const Si32 duration = sound.DurationSamples();
+  const Si32 priorities[] = {1, 5, 3, 5, 0};
+  const float volumes[] = {1.f, 0.5f, 1.f, 1.f, 0.f};
+  for (Si32 i = 0; i < 5; ++i) {
+    SoundBuffer buffer;
+    buffer.sound = sound;
+    buffer.volume = volumes[i];
+    buffer.priority = priorities[i];
+    buffer.sequence = static_cast<Ui64>(i);
+    buffer.resampler.Start(sound.SampleRate(), 44100, 1.f,
+      kSoundResamplerLinear);
+    sound.GetInstance()->IncPlaying();
+    state.buffers.push_back(buffer);
+  }
+  state.max_voices = 2;
+  state.UpdateVoices(100);
+  TEST_CHECK(state.buffers.size() == 2);
+  TEST_CHECK(state.virtual_buffers.size() == 3);
+  // The priority comes first, then the volume.
+  for (const SoundBuffer &buffer : state.buffers) {
+    TEST_CHECK(buffer.priority == 5);
+    TEST_CHECK(buffer.next_position == 0);
+  }
+  TEST_CHECK(state.buffers[0].volume + state.buffers[1].volume == 1.5f);
+  for (const SoundBuffer &buffer : state.virtual_buffers) {
+    TEST_CHECK(buffer.next_position == 100);
+  }
+  // The silent voice stays virtual even when there is room.
+  state.max_voices = 10;
+  state.UpdateVoices(100);
+  TEST_CHECK(state.buffers.size() == 4);
+  TEST_CHECK(state.virtual_buffers.size() == 1);
+  TEST_CHECK(state.virtual_buffers[0].next_position == 200);
+  // Virtual voices end by themselves.
+  state.UpdateVoices(duration);
+  TEST_CHECK(state.virtual_buffers.empty());
+  TEST_CHECK(state.buffers.size() == 4);
+
+  Sound other;
+  other.Create(0.01);
+  TEST_CHECK(!state.IsDuplicate(&sound));
+  TEST_CHECK(!state.IsDuplicate(&sound));
+  state.duplicate_interval_us = 1000000;
+  TEST_CHECK(!state.IsDuplicate(&sound));
+  TEST_CHECK(state.IsDuplicate(&sound));
+  TEST_CHECK(!state.IsDuplicate(&other));
+  state.duplicate_interval_us = 0;
+  TEST_CHECK(!state.IsDuplicate(&sound));
+}
+
+bool IsSoundRingFrames(const std::vector<Si16> &out, Si32 from, Si32 to,
+    Si32 first_frame) {
+  for (Si32 i = from; i < to; ++i) {
+    const Si32 frame = first_frame + i - from;
+    if (out[i * 2] != frame || out[i * 2 + 1] != -frame) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsSoundRingSilence(const std::vector<Si16> &out, Si32 from, Si32 to) {
+  return std::all_of(out.begin() + from * 2, out.begin() + to * 2,
+    [](Si16 sample) { return sample == 0; });
+}
+
+void test_sound_ring() {
+  Sound sound;
+  sound.Create(1.0, 1000);
+  Si16 *data = sound.GetInstance()->GetWavData();
+  for (Si32 i = 0; i < sound.DurationSamples(); ++i) {
+    data[i * 2] = static_cast<Si16>(i);
+    data[i * 2 + 1] = static_cast<Si16>(-i);
+  }
+  SoundRing ring(sound, 64);
+  std::vector<Si16> out(64 * 2);
+
+  TEST_CHECK(!ring.IsStarted());
+  TEST_CHECK(ring.Fill(48));
+  TEST_CHECK(ring.IsStarted());
+  TEST_CHECK(ring.Read(0, out.data(), 32) == 32);
+  TEST_CHECK(IsSoundRingFrames(out, 0, 32, 0));
+  // Frames 32 to 79 lie across the end of the ring.
+  TEST_CHECK(ring.Fill(64));
+  TEST_CHECK(ring.Read(32, out.data(), 48) == 48);
+  TEST_CHECK(IsSoundRingFrames(out, 0, 48, 32));
+  // Only 96 frames are decoded, the rest of the read is silence.
+  TEST_CHECK(ring.Read(80, out.data(), 32) == 32);
+  TEST_CHECK(IsSoundRingFrames(out, 0, 16, 80));
+  TEST_CHECK(IsSoundRingSilence(out, 16, 32));
+
+  // A jump back is silent until the decoder acknowledges the restart and
+  // the mixer picks it up.
+  std::fill(out.begin(), out.end(), 1);
+  TEST_CHECK(ring.Read(10, out.data(), 8) == 8);
+  TEST_CHECK(IsSoundRingSilence(out, 0, 8));
+  TEST_CHECK(ring.Fill(64));
+  TEST_CHECK(!ring.Fill(64));
+  TEST_CHECK(ring.Read(10, out.data(), 8) == 8);
+  TEST_CHECK(IsSoundRingSilence(out, 0, 8));
+  TEST_CHECK(ring.Fill(64));
+  TEST_CHECK(ring.Read(18, out.data(), 16) == 16);
+  TEST_CHECK(IsSoundRingFrames(out, 0, 16, 18));
+
+  // The last read returns only the frames left in the sound.
+  TEST_CHECK(ring.Read(960, out.data(), 8) == 8);
+  TEST_CHECK(ring.Fill(64));
+  TEST_CHECK(!ring.Fill(64));
+  TEST_CHECK(ring.Read(968, out.data(), 48) == 32);
+  TEST_CHECK(IsSoundRingFrames(out, 0, 32, 968));
+  TEST_CHECK(ring.Read(1000, out.data(), 16) == 0);
+
+  // A voice is silent and keeps its start until the decoder fills the ring.
+  SoundBuffer voice;
+  voice.sound = sound;
+  voice.ring = std::make_shared<SoundRing>(sound, 64);
+  voice.resampler.Start(1000, 1000, 1.f, kSoundResamplerLinear);
+  std::vector<Si16> scratch(64 * 2);
+  std::fill(out.begin(), out.end(), 1);
+  TEST_CHECK(voice.Render(16, out.data(), 32, scratch.data(), 128) == 16);
+  TEST_CHECK(IsSoundRingSilence(out, 0, 16));
+  TEST_CHECK(voice.next_position == 0);
+  TEST_CHECK(voice.ring->Fill(64));
+  TEST_CHECK(voice.Render(16, out.data(), 32, scratch.data(), 128) == 16);
+  TEST_CHECK(IsSoundRingFrames(out, 0, 16, 0));
+}
+
+void test_upload_queue_budget() {
+  HwSpriteUploadQueue queue;
+  const Si32 default_rows = static_cast<Si32>(
+    HwSpriteUploadQueue::kDefaultBytesPerFrame
+    / (HwSpriteUploadQueue::kPixelBufferWidth * sizeof(Rgba)));
+  TEST_CHECK(queue.PixelBufferRows() == default_rows);
+  // Finish uploads everything at once, the buffers keep the budget size.
+  queue.Finish();
+  TEST_CHECK(queue.BytesPerFrame()
+    == HwSpriteUploadQueue::kDefaultBytesPerFrame);
+  TEST_CHECK(queue.PixelBufferRows() == default_rows);
+  queue.SetBytesPerFrame(std::numeric_limits<Si64>::max());
+  TEST_CHECK(queue.PixelBufferRows()
+    == HwSpriteUploadQueue::kMaxPixelBufferRows);
+  queue.SetBytesPerFrame(1);
+  TEST_CHECK(queue.PixelBufferRows() == 1);
+}
+
+static bool AreRectsOverlapping(const RectSi32 &a, const RectSi32 &b) {
+  return a.begin.x < b.end.x && b.begin.x < a.end.x
+    && a.begin.y < b.end.y && b.begin.y < a.end.y;
+}
+
+void test_atlas_allocator() {
+  HwSpriteAtlas atlas;
+  TEST_CHECK(!atlas.Allocate(HwSpriteAtlas::kMaxSpriteSize + 1, 8));
+  TEST_CHECK(!atlas.Allocate(8, HwSpriteAtlas::kMaxSpriteSize + 1));
+
+  const Si32 size = HwSpriteAtlas::kPageSize;
+  const Si32 padding = 2 * HwSpriteAtlas::kPadding;
+  HwSpriteAtlas::Page page(size);
+  RectSi32 rect;
+  TEST_CHECK(!page.Allocate(size + 1, 1, &rect));
+  std::vector<RectSi32> used;
+  for (Si32 i = 0; i < 10000; ++i) {
+    const Vec2Si32 wanted(
+      padding + 1 + (i * 37) % HwSpriteAtlas::kMaxSpriteSize,
+      padding + 1 + (i * 91) % HwSpriteAtlas::kMaxSpriteSize);
+    if (!page.Allocate(wanted.x, wanted.y, &rect)) {
+      break;
+    }
+    TEST_CHECK(rect.end - rect.begin == wanted);
+    used.push_back(rect);
+  }
+  // The page is full, so a sprite that fitted at first does not fit now.
+  TEST_CHECK(used.size() > 100 && used.size() < 10000);
+  TEST_CHECK(!page.Allocate(HwSpriteAtlas::kMaxSpriteSize + padding,
+    HwSpriteAtlas::kMaxSpriteSize + padding, &rect));
+  TEST_CHECK(page.region_count() == static_cast<Si32>(used.size()));
+  Si32 outside = 0;
+  Si32 overlapping = 0;
+  for (size_t i = 0; i < used.size(); ++i) {
+    if (used[i].begin.x < 0 || used[i].begin.y < 0
+        || used[i].end.x > size || used[i].end.y > size) {
+      ++outside;
+    }
+    for (size_t j = i + 1; j < used.size(); ++j) {
+      overlapping += AreRectsOverlapping(used[i], used[j]) ? 1 : 0;
+    }
+  }
+  TEST_CHECK_(outside == 0, "outside: %d", static_cast<int>(outside));
+  TEST_CHECK_(overlapping == 0, "overlapping: %d",
+    static_cast<int>(overlapping));
+
+  // A freed place is reused without touching the others.
+  page.Free(used[5]);
+  TEST_CHECK(page.Allocate(used[5].end.x - used[5].begin.x,
+    used[5].end.y - used[5].begin.y, &rect));
+  for (size_t i = 0; i < used.size(); ++i) {
+    TEST_CHECK(i == 5 || !AreRectsOverlapping(rect, used[i]));
+  }
+  used[5] = rect;
+
+  // The empty page is a single free rectangle again.
+  for (const RectSi32 &r : used) {
+    page.Free(r);
+  }
+  TEST_CHECK(page.region_count() == 0);
+  TEST_CHECK(page.Allocate(size, size, &rect));
+  TEST_CHECK(rect.begin == Vec2Si32(0, 0));
+  TEST_CHECK(rect.end == Vec2Si32(size, size));
+}
+
+void test_hw_sprite_pool() {
+  std::shared_ptr<HwSpriteInstance> live;
+  {
+    HwSpritePool pool;
+    pool.SetLimit(1024);
+    std::shared_ptr<HwSpriteInstance> a = pool.Acquire(8, 8);
+    std::shared_ptr<HwSpriteInstance> b = pool.Acquire(16, 8);
+    std::shared_ptr<HwSpriteInstance> c = pool.Acquire(8, 16);
+    HwSpriteInstance *b_instance = b.get();
+    TEST_CHECK(pool.AllocationCount() == 3);
+
+    // 256 + 512 + 512 bytes do not fit, so the first released one goes.
+    a.reset();
+    b.reset();
+    TEST_CHECK(pool.IdleBytes() == 768);
+    c.reset();
+    TEST_CHECK(pool.IdleBytes() == 1024);
+    a = pool.Acquire(8, 8);
+    TEST_CHECK(pool.AllocationCount() == 4);
+    TEST_CHECK(pool.ReuseCount() == 0);
+    b = pool.Acquire(16, 8);
+    TEST_CHECK(b.get() == b_instance);
+    TEST_CHECK(pool.ReuseCount() == 1);
+    TEST_CHECK(pool.IdleBytes() == 512);
+
+    // Acquiring does not count as a use, the release order does.
+    b.reset();
+    a.reset();
+    TEST_CHECK(pool.IdleBytes() == 768);
+    c = pool.Acquire(8, 16);
+    TEST_CHECK(pool.AllocationCount() == 5);
+    pool.SetLimit(512);
+    TEST_CHECK(pool.IdleBytes() == 256);
+    a = pool.Acquire(8, 8);
+    TEST_CHECK(pool.ReuseCount() == 2);
+    b = pool.Acquire(16, 8);
+    TEST_CHECK(pool.AllocationCount() == 6);
+
+    // An instance larger than the limit is never kept.
+    std::shared_ptr<HwSpriteInstance> big = pool.Acquire(32, 32);
+    big.reset();
+    TEST_CHECK(pool.IdleBytes() == 0);
+    a.reset();
+    TEST_CHECK(pool.IdleBytes() == 256);
+    pool.Clear();
+    TEST_CHECK(pool.IdleBytes() == 0);
+
+    live = pool.Acquire(4, 4);
+  }
+  // The pool is gone, so the instance is deleted instead of released.
+  TEST_CHECK(live.use_count() == 1);
+  live.reset();
+}
+
+void test_benchmark_report() {
+  std::vector<double> one = {5.0};
+  TEST_CHECK(Percentile(one, 0.0) == 5.0);
+  TEST_CHECK(Percentile(one, 0.5) == 5.0);
+  TEST_CHECK(Percentile(one, 1.0) == 5.0);
+  std::vector<double> four = {1.0, 2.0, 3.0, 4.0};
+  TEST_CHECK(Percentile(four, 0.0) == 1.0);
+  TEST_CHECK(Percentile(four, 0.25) == 1.0);
+  TEST_CHECK(Percentile(four, 0.5) == 2.0);
+  TEST_CHECK(Percentile(four, 0.99) == 4.0);
+  TEST_CHECK(Percentile(four, 1.0) == 4.0);
+  TEST_CHECK(Percentile(std::vector<double>(), 0.5) == 0.0);
+
+  // Prefixed names, reordered keys and free whitespace.
+  const std::string baseline =
+    "{\"scenes\": [\n"
+    "  {\"p50_ms\" : 3.5, \"name\":\"tiles_big\", \"mean_ms\": 9.0},\n"
+    "  {\n"
+    "    \"mean_ms\":  2.0,\n"
+    "    \"name\" : \"tiles\",\n"
+    "    \"p50_ms\":1.5\n"
+    "  },\n"
+    "  {\"name\": \"font\", \"mean_ms\": 4.0}\n"
+    "]}\n";
+  double value = 0.0;
+  TEST_CHECK(FindBaselineValue(baseline, "tiles", "mean_ms", &value));
+  TEST_CHECK(value == 2.0);
+  TEST_CHECK(FindBaselineValue(baseline, "tiles", "p50_ms", &value));
+  TEST_CHECK(value == 1.5);
+  TEST_CHECK(FindBaselineValue(baseline, "tiles_big", "p50_ms", &value));
+  TEST_CHECK(value == 3.5);
+  TEST_CHECK(!FindBaselineValue(baseline, "tile", "mean_ms", &value));
+  TEST_CHECK(!FindBaselineValue(baseline, "font", "p50_ms", &value));
+
+  std::vector<SceneResult> results(4);
+  results[0].name = "tiles";
+  results[0].mean_ms = 2.1;
+  results[0].p50_ms = 1.5;
+  results[1].name = "tiles_big";
+  results[1].mean_ms = 9.0;
+  results[1].p50_ms = 4.0;
+  results[2].name = "font";
+  results[2].mean_ms = 40.0;
+  results[2].p50_ms = 40.0;
+  results[3].name = "sprites";
+  results[3].mean_ms = 1.0;
+  results[3].p50_ms = 1.0;
+  TEST_CHECK(CompareWithBaseline(results, baseline, 10.0) == 1);
+  TEST_CHECK(CompareWithBaseline(results, baseline, 20.0) == 0);
+}
+
+void test_sprite_runs() {
+  Sprite with_runs = MakeRandomSprite(53, 31, 1);
+  Sprite without_runs = MakeRandomSprite(53, 31, 1);
+  with_runs.UpdateOpaqueSpans();
+  with_runs.SetPivot(Vec2Si32(7, 3));
+  without_runs.SetPivot(Vec2Si32(7, 3));
+
+  Sprite to[2];
+  for (Si32 pass = 0; pass < 2; ++pass) {
+    to[pass].Create(181, 137);
+    to[pass].Clear(Rgba(10, 20, 30, 40));
+    DrawMixedSprites(pass ? without_runs : with_runs, to[pass], 60,
+      nullptr, false);
+  }
+  const Si64 mismatches = CountMismatches(to[0], to[1]);
+  TEST_CHECK_(mismatches == 0, "mismatches: %lld",
+    static_cast<long long>(mismatches));
+}
+
+void test_mipmaps() {
+  Sprite from = MakeRandomSprite(75, 41, 2);
+  for (Si32 y = 0; y < from.Height(); ++y) {
+    for (Si32 x = 0; x < from.Width(); ++x) {
+      from.RgbaData()[x + y * from.StridePixels()].a = ((x + y) % 2) ? 255 : 0;
+    }
+  }
+  from.SetPivot(Vec2Si32(30, 20));
+  TEST_CHECK(from.MipLevelCount() == 6);
+  Sprite level = from.MipLevel(1);
+  TEST_CHECK(level.Size() == Vec2Si32(37, 20));
+  TEST_CHECK(level.Pivot() == Vec2Si32(15, 10));
+  // Only the opaque pixels contribute their colors.
+  const Rgba p01 = from.RgbaData()[1];
+  const Rgba p10 = from.RgbaData()[from.StridePixels()];
+  const Rgba c = level.RgbaData()[0];
+  TEST_CHECK(c.a == 128);
+  TEST_CHECK(c.r == (static_cast<Si32>(p01.r) + p10.r + 1) / 2);
+  TEST_CHECK(c.g == (static_cast<Si32>(p01.g) + p10.g + 1) / 2);
+
+  // A minified draw samples the largest level not smaller than the target.
+  Sprite to[2];
+  for (Si32 pass = 0; pass < 2; ++pass) {
+    to[pass].Create(64, 64);
+    to[pass].Clear(Rgba(10, 20, 30, 40));
+  }
+  from.Draw(40, 30, 17, 9, 0, 0, from.Width(), from.Height(), to[0],
+    kDrawBlendingModeAlphaBlend, kFilterMipmap);
+  level = from.MipLevel(2);
+  level.SetPivot(Vec2Si32(0, 0));
+  level.Draw(40 - 30 * 17 / 75, 30 - 20 * 9 / 41, 17, 9,
+    0, 0, level.Width(), level.Height(), to[1],
+    kDrawBlendingModeAlphaBlend, kFilterBilinear);
+  const Si64 mismatches = CountMismatches(to[0], to[1]);
+  TEST_CHECK_(mismatches == 0, "mismatches: %lld",
+    static_cast<long long>(mismatches));
+}
+
+void test_tiled_rasterizer() {
+  Sprite from = MakeRandomSprite(37, 23, 3);
+  from.UpdateOpaqueSpans();
+  from.SetPivot(Vec2Si32(5, 7));
+
+  Sprite serial;
+  serial.Create(211, 157);
+  serial.Clear(Rgba(10, 20, 30, 40));
+  Sprite tiled;
+  tiled.Create(211, 157);
+  tiled.Clear(Rgba(10, 20, 30, 40));
+  DrawMixedSprites(from, serial, 120);
+  TiledRasterizer &rasterizer = GetEngine()->GetTiledRasterizer();
+  rasterizer.Start(tiled, 3, 16);
+  DrawMixedSprites(from, tiled, 120);
+  rasterizer.Stop();
+  const Si64 mismatches = CountMismatches(serial, tiled);
+  TEST_CHECK_(mismatches == 0, "mismatches: %lld",
+    static_cast<long long>(mismatches));
+}
+
+void test_draw_list() {
+  Sprite from = MakeRandomSprite(37, 23, 4);
+  from.UpdateOpaqueSpans();
+  from.SetPivot(Vec2Si32(5, 7));
+
+  Sprite immediate;
+  immediate.Create(211, 157);
+  immediate.Clear(Rgba(10, 20, 30, 40));
+  Sprite listed;
+  listed.Create(211, 157);
+  listed.Clear(Rgba(10, 20, 30, 40));
+  DrawList list;
+  DrawMixedSprites(from, immediate, 90);
+  DrawMixedSprites(from, listed, 90, &list);
+  TEST_CHECK(list.Size() == 90);
+  list.Execute(listed);
+  const Si64 mismatches = CountMismatches(immediate, listed);
+  TEST_CHECK_(mismatches == 0, "mismatches: %lld",
+    static_cast<long long>(mismatches));
+  list.Clear();
+  TEST_CHECK(list.Size() == 0);
+}
+
+void test_dirty_rects() {
+  Sprite from;
+  from.Create(10, 10);
+  from.Clear(Rgba(255, 0, 0, 255));
+  Sprite to;
+  to.Create(100, 80);
+  from.Draw(to, 0, 0);
+  TEST_CHECK(to.SpriteInstance()->DirtyRects().empty());
+  to.SpriteInstance()->SetDirtyTracking(true);
+  const std::vector<RectSi32> &rects = to.SpriteInstance()->DirtyRects();
+  TEST_CHECK(rects.empty());
+
+  from.Draw(to, 5, 5);
+  TEST_CHECK(rects.size() == 1);
+  TEST_CHECK(rects[0].begin == Vec2Si32(5, 5));
+  TEST_CHECK(rects[0].end == Vec2Si32(15, 15));
+  // Overlapping rectangles are merged, clipped ones are clamped.
+  from.Draw(to, 12, 8);
+  TEST_CHECK(rects.size() == 1);
+  TEST_CHECK(rects[0].end == Vec2Si32(22, 18));
+  from.Draw(to, 95, -3);
+  TEST_CHECK(rects.size() == 2);
+  TEST_CHECK(rects[1].begin == Vec2Si32(95, 0));
+  TEST_CHECK(rects[1].end == Vec2Si32(100, 7));
+  from.Draw(to, 200, 200);
+  TEST_CHECK(rects.size() == 2);
+
+  // A view marks its own area of the shared instance.
+  Sprite view;
+  view.Reference(to, 30, 40, 20, 10);
+  view.Clear();
+  TEST_CHECK(rects.size() == 3);
+  TEST_CHECK(rects[2].begin == Vec2Si32(30, 40));
+  TEST_CHECK(rects[2].end == Vec2Si32(50, 50));
+  TEST_CHECK(to.RgbaData()[30 + 40 * to.StridePixels()] == Rgba(0, 0, 0, 0));
+  TEST_CHECK(to.RgbaData()[0] == Rgba(255, 0, 0, 255));
+
+  // The number of rectangles is capped and the union still covers every write.
+  to.SpriteInstance()->ClearDirtyRects();
+  for (Si32 i = 0; i < 40; ++i) {
+    SetPixel(to, (i * 37) % 100, (i * 23) % 80, Rgba(0, 255, 0, 255));
+  }
+  TEST_CHECK(static_cast<Si32>(rects.size()) <= SpriteInstance::kMaxDirtyRects);
+  Si32 uncovered = 0;
+  for (Si32 i = 0; i < 40; ++i) {
+    const Vec2Si32 p((i * 37) % 100, (i * 23) % 80);
+    bool is_covered = false;
+    for (const RectSi32 &r : rects) {
+      is_covered = is_covered || (p.x >= r.begin.x && p.y >= r.begin.y &&
+        p.x < r.end.x && p.y < r.end.y);
+    }
+    uncovered += is_covered ? 0 : 1;
+  }
+  TEST_CHECK_(uncovered == 0, "uncovered: %d", static_cast<int>(uncovered));
+
+  // Direct access to the pixel data marks the whole sprite.
+  to.SpriteInstance()->ClearDirtyRects();
+  to.RgbaData();
+  TEST_CHECK(rects.size() == 1);
+  TEST_CHECK(rects[0].begin == Vec2Si32(0, 0));
+  TEST_CHECK(rects[0].end == Vec2Si32(100, 80));
+  to.SpriteInstance()->SetDirtyTracking(false);
+  TEST_CHECK(rects.empty());
+
+  // A cleared sprite is solid until anything else is drawn to it.
+  to.Clear(Rgba(1, 2, 3, 4));
+  TEST_CHECK(to.SpriteInstance()->IsSolid());
+  TEST_CHECK(to.SpriteInstance()->SolidColor() == Rgba(1, 2, 3, 4));
+  view.Clear();
+  TEST_CHECK(!to.SpriteInstance()->IsSolid());
+  to.Clear();
+  from.Draw(to, 200, 200);
+  TEST_CHECK(to.SpriteInstance()->IsSolid());
+  from.Draw(to, 5, 5);
+  TEST_CHECK(!to.SpriteInstance()->IsSolid());
+  to.Clear();
+  to.RgbaData();
+  TEST_CHECK(!to.SpriteInstance()->IsSolid());
+}
 
 TEST_LIST = {
 //  {"Tga oom", test_tga_oom},
@@ -445,6 +1250,20 @@ TEST_LIST = {
   {"Radix sort correctness", test_radix_sort_correctness},
   {"Rgb", test_rgb},
   {"File operations", test_file_operations},
+  {"Blend kernels", test_blend_kernels},
+  {"Mix kernels", test_mix_kernels},
+  {"Resampler", test_resampler},
+  {"Voice limit", test_voice_limit},
+  {"Sound ring", test_sound_ring},
+  {"Upload queue budget", test_upload_queue_budget},
+  {"Atlas allocator", test_atlas_allocator},
+  {"Hw sprite pool", test_hw_sprite_pool},
+  {"Benchmark report", test_benchmark_report},
+  {"Sprite runs", test_sprite_runs},
+  {"Mipmaps", test_mipmaps},
+  {"Tiled rasterizer", test_tiled_rasterizer},
+  {"Draw list", test_draw_list},
+  {"Dirty rects", test_dirty_rects},
   {0}
 };
 